@@ -0,0 +1,417 @@
+#include "git_vid_codec.h"
+#include <math.h>
+#include <unistd.h>
+
+// codec-bench: time the codec's hot functions on synthetic frames held in memory,
+// so nothing touches git or the disk. Each content class is a pair of consecutive
+// frames from synth.c that stresses the coder differently:
+//
+//   static     identical frames; deltas are all identical runs
+//   noise      two frames of independent random bytes; nothing compresses
+//   pan        a textured still moved a few pixels; every pixel changes a little
+//   zoom       the still magnified 1% more; small changes, growing from the centre
+//   text       desktop UI as text is typed; a few glyphs change
+//   scene_cut  desktop UI cutting to an unrelated still; deltas are as large as the frame
+//   noise_edge noise one row into its last block row (1073 rows at 1080p); screen
+//              coding's worst case, palette-sized edge blocks
+//
+// Each backend compresses the current frame as a delta, as a raw frame and as an
+// intra screen-content frame (rANS only codes deltas), and decompresses it back.
+// Every operation is run -W times untimed to warm caches and the allocator, then
+// timed -n times. Results go to stdout (or -o) as one JSON document with the
+// median, mean, standard deviation and extremes of the timed runs; throughput is
+// measured in raw frame bytes per second at the median, so compressors and
+// decompressors are comparable:
+//
+//   {"width":1920,"height":1080,"channels":3,"warmup":3,"repetitions":20,"results":[
+//    {"content":"pan","backend":"lzfse","operation":"compress_delta","median_ms":...,
+//     "gb_per_s":...,"frames_per_s":...,"compression_ratio":...},
+//    ...]}
+
+#define BENCH_DEFAULT_WARMUP 3
+#define BENCH_DEFAULT_REPETITIONS 20
+#define BENCH_BACKEND_RANS BACKEND_COUNT  // Delta tokens rANS coded, no LZ backend
+
+typedef struct {
+    const char* name;
+    synth_class_t content;
+    uint32_t frame;          // Number of the pair's previous frame
+    int edge_row;            // Trim the height so the last row of screen blocks is one pixel tall
+} bench_content_t;
+
+static const bench_content_t contents[] = {
+    { "static", SYNTH_STATIC, 0, 0 },
+    { "noise", SYNTH_NOISE, 0, 0 },
+    { "pan", SYNTH_PAN, 0, 0 },
+    { "zoom", SYNTH_ZOOM, 0, 0 },
+    { "text", SYNTH_TEXT, 100, 0 },
+    { "scene_cut", SYNTH_SCENE_CUTS, 5 * SYNTH_SCENE_LENGTH - 1, 0 },  // Last text frame, then a still
+    { "noise_edge", SYNTH_NOISE, 0, 1 },
+};
+
+#define CONTENT_COUNT ((int)(sizeof(contents) / sizeof(contents[0])))
+
+typedef struct {
+    raw_frame_t previous;
+    raw_frame_t current;
+} bench_pair_t;
+
+typedef struct {
+    double median_ns;
+    double mean_ns;
+    double stddev_ns;
+    double min_ns;
+    double max_ns;
+} bench_stats_t;
+
+// One timed operation; returns GVC_SUCCESS or the codec's error
+typedef int (*bench_fn)(void* context);
+
+typedef struct {
+    FILE* out;
+    int warmup;
+    int repetitions;
+    int first_result;
+    double* samples;
+} bench_t;
+
+static uint64_t get_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Frames frame and frame + 1 of the content class
+static int make_pair(const bench_content_t* content, uint32_t width, uint32_t height, bench_pair_t* pair_out) {
+    synth_params_t params;
+    synth_params_init(&params);
+    params.content = content->content;
+    params.width = width;
+    params.height = content->edge_row ? (height - 1) / SCREEN_BLOCK_SIZE * SCREEN_BLOCK_SIZE + 1 : height;
+    
+    if (synth_alloc_frame(&params, &pair_out->previous) != GVC_SUCCESS ||
+        synth_alloc_frame(&params, &pair_out->current) != GVC_SUCCESS) {
+        return GVC_ERROR_MEMORY;
+    }
+    synth_render(&params, content->frame, &pair_out->previous);
+    synth_render(&params, content->frame + 1, &pair_out->current);
+    return GVC_SUCCESS;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Warm up, then time every repetition; fails on the operation's first error
+static int run_timed(bench_t* bench, bench_fn fn, void* context, bench_stats_t* stats_out) {
+    for (int i = 0; i < bench->warmup; i++) {
+        int result = fn(context);
+        if (result != GVC_SUCCESS) return result;
+    }
+    
+    double sum = 0;
+    for (int i = 0; i < bench->repetitions; i++) {
+        uint64_t start = get_time_ns();
+        int result = fn(context);
+        bench->samples[i] = (double)(get_time_ns() - start);
+        if (result != GVC_SUCCESS) return result;
+        sum += bench->samples[i];
+    }
+    
+    int n = bench->repetitions;
+    qsort(bench->samples, n, sizeof(double), compare_doubles);
+    stats_out->min_ns = bench->samples[0];
+    stats_out->max_ns = bench->samples[n - 1];
+    stats_out->median_ns = n % 2 ? bench->samples[n / 2] : (bench->samples[n / 2 - 1] + bench->samples[n / 2]) / 2;
+    stats_out->mean_ns = sum / n;
+    double variance = 0;
+    for (int i = 0; i < n; i++) {
+        variance += (bench->samples[i] - stats_out->mean_ns) * (bench->samples[i] - stats_out->mean_ns);
+    }
+    stats_out->stddev_ns = n > 1 ? sqrt(variance / (n - 1)) : 0;
+    return GVC_SUCCESS;
+}
+
+// bytes is the raw frame size the operation stands for; ratio is 0 where it means nothing
+static void report(bench_t* bench, const char* content, const char* backend, const char* operation,
+                   const bench_stats_t* stats, size_t bytes, double ratio) {
+    fprintf(bench->out, "%s\n  {\"content\":\"%s\",\"backend\":\"%s\",\"operation\":\"%s\","
+            "\"median_ms\":%.6f,\"mean_ms\":%.6f,\"stddev_ms\":%.6f,\"min_ms\":%.6f,\"max_ms\":%.6f,"
+            "\"gb_per_s\":%.3f,\"frames_per_s\":%.1f",
+            bench->first_result ? "" : ",", content, backend, operation,
+            stats->median_ns / 1e6, stats->mean_ns / 1e6, stats->stddev_ns / 1e6,
+            stats->min_ns / 1e6, stats->max_ns / 1e6,
+            bytes / stats->median_ns, 1e9 / stats->median_ns);
+    if (ratio > 0) {
+        fprintf(bench->out, ",\"compression_ratio\":%.3f", ratio);
+    }
+    fputc('}', bench->out);
+    bench->first_result = 0;
+    
+    fprintf(stderr, "  %-10s %-6s %-16s %9.3f ms %8.3f GB/s %9.1f fps\n", content, backend, operation,
+            stats->median_ns / 1e6, bytes / stats->median_ns, 1e9 / stats->median_ns);
+}
+
+// Operation contexts
+
+typedef enum {
+    CODING_DELTA,
+    CODING_RAW,
+    CODING_SCREEN,  // Intra: block copies within the frame only
+    CODING_COUNT
+} bench_coding_t;
+
+static const char* const compress_operations[CODING_COUNT] = {
+    "compress_delta", "compress_raw", "compress_screen"
+};
+static const char* const decompress_operations[CODING_COUNT] = {
+    "decompress_delta", "decompress_raw", "decompress_screen"
+};
+
+typedef struct {
+    const bench_pair_t* pair;
+    compression_params_t params;
+    frame_t compressed;  // Output of the last compress, input to decompress
+    bench_coding_t coding;
+} codec_context_t;
+
+static int compress_once(void* arg) {
+    codec_context_t* context = arg;
+    free_frame(&context->compressed);
+    switch (context->coding) {
+        case CODING_DELTA:
+            return compress_frame_delta(&context->pair->current, &context->pair->previous,
+                                        &context->params, &context->compressed);
+        case CODING_SCREEN:
+            return compress_frame_screen(&context->pair->current, NULL, &context->params,
+                                         &context->compressed, NULL);
+        default:
+            return compress_frame_raw(&context->pair->current, &context->params, &context->compressed);
+    }
+}
+
+static int decompress_once(void* arg) {
+    codec_context_t* context = arg;
+    raw_frame_t output;
+    int result = decompress_frame(&context->compressed,
+                                  context->coding == CODING_DELTA ? &context->pair->previous : NULL, &output);
+    if (result == GVC_SUCCESS) {
+        free_raw_frame(&output);
+    }
+    return result;
+}
+
+typedef struct {
+    const raw_frame_t* frame;
+    uint32_t checksum;
+} checksum_context_t;
+
+static int checksum_once(void* arg) {
+    checksum_context_t* context = arg;
+    context->checksum ^= calculate_checksum(context->frame->pixels, raw_frame_size(context->frame));
+    return GVC_SUCCESS;
+}
+
+typedef struct {
+    const frame_t* frame;
+    uint8_t* buffer;
+    size_t size;
+} serialize_context_t;
+
+static int serialize_once(void* arg) {
+    serialize_context_t* context = arg;
+    free(context->buffer);
+    context->buffer = NULL;
+    return serialize_frame(context->frame, &context->buffer, &context->size);
+}
+
+static int deserialize_once(void* arg) {
+    serialize_context_t* context = arg;
+    frame_t frame;
+    int result = deserialize_frame(context->buffer, context->size, &frame);
+    if (result == GVC_SUCCESS) {
+        free_frame(&frame);
+    }
+    return result;
+}
+
+static const char* bench_backend_name(int backend) {
+    return backend == BENCH_BACKEND_RANS ? "rans" : backend_name((uint8_t)backend);
+}
+
+// Compress and decompress one pair through one backend, as delta and (except
+// rANS, which only codes deltas) as raw and as screen content
+static void bench_backend(bench_t* bench, int content, const bench_pair_t* pair, int backend) {
+    const char* name = bench_backend_name(backend);
+    size_t frame_bytes = raw_frame_size(&pair->current);
+    
+    for (int coding = 0; coding < CODING_COUNT; coding++) {
+        if (coding != CODING_DELTA && backend == BENCH_BACKEND_RANS) break;
+    
+        codec_context_t context;
+        memset(&context, 0, sizeof(context));
+        context.pair = pair;
+        context.coding = (bench_coding_t)coding;
+        context.params.backend = backend == BENCH_BACKEND_RANS ? BACKEND_LZFSE : (uint8_t)backend;
+        context.params.entropy_delta = backend == BENCH_BACKEND_RANS;
+    
+        bench_stats_t stats;
+        if (run_timed(bench, compress_once, &context, &stats) != GVC_SUCCESS) {
+            fprintf(stderr, "  %-10s %-6s %-16s unsupported\n", contents[content].name, name,
+                    compress_operations[coding]);
+            free_frame(&context.compressed);
+            continue;
+        }
+        double ratio = (double)frame_bytes / MAX(context.compressed.data_size, 1);
+        report(bench, contents[content].name, name, compress_operations[coding],
+               &stats, frame_bytes, ratio);
+    
+        if (run_timed(bench, decompress_once, &context, &stats) == GVC_SUCCESS) {
+            report(bench, contents[content].name, name, decompress_operations[coding],
+                   &stats, frame_bytes, ratio);
+        } else {
+            fprintf(stderr, "  %-10s %-6s %-16s failed\n", contents[content].name, name,
+                    decompress_operations[coding]);
+        }
+        free_frame(&context.compressed);
+    }
+}
+
+// Backend-independent work: the payload checksum over a whole frame, and
+// serializing a delta frame to a blob and parsing it back
+static void bench_framing(bench_t* bench, int content, const bench_pair_t* pair) {
+    size_t frame_bytes = raw_frame_size(&pair->current);
+    bench_stats_t stats;
+    
+    checksum_context_t checksum = { .frame = &pair->current };
+    if (run_timed(bench, checksum_once, &checksum, &stats) == GVC_SUCCESS) {
+        report(bench, contents[content].name, "-", "checksum", &stats, frame_bytes, 0);
+    }
+    
+    frame_t compressed;
+    memset(&compressed, 0, sizeof(compressed));
+    if (compress_frame_delta(&pair->current, &pair->previous, NULL, &compressed) != GVC_SUCCESS) {
+        return;
+    }
+    
+    // Framing cost scales with the payload, so throughput is over the blob
+    serialize_context_t serialize = { .frame = &compressed };
+    if (run_timed(bench, serialize_once, &serialize, &stats) == GVC_SUCCESS) {
+        report(bench, contents[content].name, "-", "serialize", &stats, serialize.size, 0);
+        if (run_timed(bench, deserialize_once, &serialize, &stats) == GVC_SUCCESS) {
+            report(bench, contents[content].name, "-", "deserialize", &stats, serialize.size, 0);
+        }
+    }
+    free(serialize.buffer);
+    free_frame(&compressed);
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-s WxH] [-W warmup] [-n repetitions] [-b backend] [-c content] [-o results.json]\n",
+           program);
+    printf("\nTimes the codec on in-memory synthetic frames and writes the results as JSON.\n");
+    printf("\nOptions:\n");
+    printf("  -s WxH     Frame size (default: %dx%d)\n", FRAME_WIDTH, FRAME_HEIGHT);
+    printf("  -W n       Untimed warm-up runs per operation (default: %d)\n", BENCH_DEFAULT_WARMUP);
+    printf("  -n n       Timed runs per operation (default: %d)\n", BENCH_DEFAULT_REPETITIONS);
+    printf("  -b name    Only this backend: lzfse, lz4, zlib, lzma or rans (default: all)\n");
+    printf("  -c name    Only this content: static, noise, pan, zoom, text, scene_cut\n");
+    printf("             or noise_edge (default: all)\n");
+    printf("  -o file    Write the JSON here instead of stdout\n");
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t width = FRAME_WIDTH;
+    uint32_t height = FRAME_HEIGHT;
+    int only_backend = -1;
+    int only_content = -1;
+    const char* output_path = NULL;
+    bench_t bench = { .warmup = BENCH_DEFAULT_WARMUP, .repetitions = BENCH_DEFAULT_REPETITIONS,
+                      .first_result = 1 };
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "s:W:n:b:c:o:")) != -1) {
+        switch (opt) {
+            case 's':
+                if (sscanf(optarg, "%ux%u", &width, &height) != 2 || width == 0 || height == 0 ||
+                    width > MAX_FRAME_WIDTH || height > MAX_FRAME_HEIGHT) {
+                    fprintf(stderr, "Invalid frame size: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'W':
+                bench.warmup = MAX(atoi(optarg), 0);
+                break;
+            case 'n':
+                bench.repetitions = MAX(atoi(optarg), 1);
+                break;
+            case 'b':
+                for (int backend = 0; backend <= BENCH_BACKEND_RANS; backend++) {
+                    if (strcmp(optarg, bench_backend_name(backend)) == 0) only_backend = backend;
+                }
+                if (only_backend < 0) {
+                    fprintf(stderr, "Unknown backend: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'c':
+                for (int content = 0; content < CONTENT_COUNT; content++) {
+                    if (strcmp(optarg, contents[content].name) == 0) only_content = content;
+                }
+                if (only_content < 0) {
+                    fprintf(stderr, "Unknown content class: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    
+    bench.out = output_path ? fopen(output_path, "w") : stdout;
+    bench.samples = malloc(sizeof(double) * bench.repetitions);
+    if (!bench.out || !bench.samples) {
+        fprintf(stderr, "Error: Cannot write results%s%s\n", output_path ? " to " : "",
+                output_path ? output_path : "");
+        return 1;
+    }
+    
+    fprintf(bench.out, "{\"width\":%u,\"height\":%u,\"channels\":%d,\"warmup\":%d,\"repetitions\":%d,"
+            "\"results\":[", width, height, FRAME_CHANNELS, bench.warmup, bench.repetitions);
+    fprintf(stderr, "codec-bench: %ux%u, %d warm-up + %d timed runs per operation (median shown)\n",
+            width, height, bench.warmup, bench.repetitions);
+    
+    for (int content = 0; content < CONTENT_COUNT; content++) {
+        if (only_content >= 0 && content != only_content) continue;
+    
+        bench_pair_t pair;
+        memset(&pair, 0, sizeof(pair));
+        if (make_pair(&contents[content], width, height, &pair) != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Out of memory\n");
+            return 1;
+        }
+    
+        for (int backend = 0; backend <= BENCH_BACKEND_RANS; backend++) {
+            if (only_backend >= 0 && backend != only_backend) continue;
+            bench_backend(&bench, content, &pair, backend);
+        }
+        bench_framing(&bench, content, &pair);
+    
+        free_raw_frame(&pair.previous);
+        free_raw_frame(&pair.current);
+    }
+    
+    fprintf(bench.out, "\n]}\n");
+    free(bench.samples);
+    if (output_path && fclose(bench.out) != 0) {
+        fprintf(stderr, "Error: Failed to write %s\n", output_path);
+        return 1;
+    }
+    return 0;
+}
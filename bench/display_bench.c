@@ -0,0 +1,580 @@
+#include "git_vid_codec.h"
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <unistd.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+// display-bench: cost of getting a decoded frame onto an X11 window, per path,
+// at each frame size in -s. Meant for Xvfb (make display-bench starts one when
+// DISPLAY is unset), so display changes can be measured without a GPU:
+//
+//   convert     RGB24 -> BGRX with the frame_kernels.c kernel; no X involved
+//   xputimage   convert + XPutImage of the whole frame
+//   shm         convert + XShmPutImage of the whole frame (MIT-SHM)
+//   shm_dirty   compare with the previous frame in 64x64 tiles, then convert and
+//               XShmPutImage only the changed tiles, merged into runs per tile row
+//   shm_scaled  nearest-neighbour scale + convert to the -S output size, then
+//               XShmPutImage; by default 1080p goes up to 4K and 4K down to 1080p
+//   backend     display_frame() from display.m, the player's own Linux path
+//
+// Every path except backend ends with XSync, so its time includes the server's
+// copy and the frame is on screen when the next one starts; display.m only
+// flushes, so its server work overlaps the player's next frame. Frames are
+// consecutive frames of synthetic content (-c, default text) rendered untimed
+// between samples. max_fps is 1000 / p99_ms, the rate at which 99% of frames
+// would still make their deadline. Results go to stdout (or -o) as JSON.
+
+#define DISPLAY_DEFAULT_WARMUP 10
+#define DISPLAY_DEFAULT_FRAMES 120
+#define DISPLAY_MAX_SIZES 8
+#define DIRTY_TILE 64
+
+typedef enum {
+    PATH_CONVERT,
+    PATH_XPUTIMAGE,
+    PATH_SHM,
+    PATH_SHM_DIRTY,
+    PATH_SHM_SCALED,
+    PATH_BACKEND,
+    PATH_COUNT
+} display_path_t;
+
+static const char* const path_names[PATH_COUNT] = {
+    "convert", "xputimage", "shm", "shm_dirty", "shm_scaled", "backend"
+};
+
+typedef struct {
+    XImage* image;
+    XShmSegmentInfo shm;
+    int is_shm;
+} x_surface_t;
+
+typedef struct {
+    // X connection; display is NULL when there is no server, leaving only convert
+    Display* display;
+    Window window;
+    GC gc;
+    Visual* visual;
+    int depth;
+    int shm_available;
+    
+    // Current frame size and its surfaces
+    synth_params_t synth;
+    synth_generator_t generator;
+    raw_frame_t frames[2];
+    uint32_t next_frame;
+    const frame_kernels_t* kernels;
+    x_surface_t plain;        // XPutImage; also the convert target
+    x_surface_t shared;       // Frame-sized MIT-SHM image
+    x_surface_t scaled;       // Output-sized MIT-SHM image
+    uint32_t* scale_columns;  // Source byte offset within a row, per output column
+    uint32_t* scale_rows;     // Source row, per output row
+    
+    FILE* out;
+    int warmup;
+    int repetitions;
+    int first_result;
+    double* samples;
+} display_bench_t;
+
+static int x_error_seen = 0;
+
+static int trap_x_error(Display* display, XErrorEvent* event) {
+    (void)display;
+    (void)event;
+    x_error_seen = 1;
+    return 0;
+}
+
+static uint64_t get_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ---- X surfaces ----
+
+static void surface_destroy(display_bench_t* bench, x_surface_t* surface) {
+    if (!surface->image) return;
+    if (surface->is_shm) {
+        XShmDetach(bench->display, &surface->shm);
+        XSync(bench->display, False);
+        XDestroyImage(surface->image);
+        shmdt(surface->shm.shmaddr);
+    } else {
+        XDestroyImage(surface->image);  // Also frees the pixels
+    }
+    memset(surface, 0, sizeof(*surface));
+}
+
+static int surface_create(display_bench_t* bench, x_surface_t* surface, uint32_t width, uint32_t height,
+                          int use_shm) {
+    memset(surface, 0, sizeof(*surface));
+    if (!use_shm) {
+        surface->image = XCreateImage(bench->display, bench->visual, bench->depth, ZPixmap, 0,
+                                      NULL, width, height, 32, 0);
+        if (!surface->image) return GVC_ERROR_DISPLAY;
+        surface->image->data = malloc((size_t)surface->image->bytes_per_line * height);
+        if (!surface->image->data) {
+            XDestroyImage(surface->image);
+            surface->image = NULL;
+            return GVC_ERROR_MEMORY;
+        }
+        return GVC_SUCCESS;
+    }
+    
+    surface->image = XShmCreateImage(bench->display, bench->visual, bench->depth, ZPixmap, NULL,
+                                     &surface->shm, width, height);
+    if (!surface->image) return GVC_ERROR_DISPLAY;
+    surface->shm.shmid = shmget(IPC_PRIVATE, (size_t)surface->image->bytes_per_line * height, IPC_CREAT | 0600);
+    if (surface->shm.shmid < 0) {
+        XDestroyImage(surface->image);
+        surface->image = NULL;
+        return GVC_ERROR_MEMORY;
+    }
+    surface->shm.shmaddr = surface->image->data = shmat(surface->shm.shmid, NULL, 0);
+    surface->shm.readOnly = False;
+    
+    // A remote server accepts the request and fails it asynchronously
+    x_error_seen = 0;
+    int (*previous_handler)(Display*, XErrorEvent*) = XSetErrorHandler(trap_x_error);
+    int attached = surface->shm.shmaddr != (char*)-1 && XShmAttach(bench->display, &surface->shm);
+    XSync(bench->display, False);
+    XSetErrorHandler(previous_handler);
+    shmctl(surface->shm.shmid, IPC_RMID, NULL);  // Freed once both sides detach
+    if (!attached || x_error_seen) {
+        if (surface->shm.shmaddr != (char*)-1) shmdt(surface->shm.shmaddr);
+        XDestroyImage(surface->image);
+        surface->image = NULL;
+        return GVC_ERROR_DISPLAY;
+    }
+    surface->is_shm = 1;
+    return GVC_SUCCESS;
+}
+
+static int open_x(display_bench_t* bench, uint32_t max_width, uint32_t max_height) {
+    bench->display = XOpenDisplay(NULL);
+    if (!bench->display) return GVC_ERROR_DISPLAY;
+    
+    int screen = DefaultScreen(bench->display);
+    bench->visual = DefaultVisual(bench->display, screen);
+    bench->depth = DefaultDepth(bench->display, screen);
+    bench->shm_available = XShmQueryExtension(bench->display);
+    bench->window = XCreateSimpleWindow(bench->display, RootWindow(bench->display, screen), 0, 0,
+                                        max_width, max_height, 0, BlackPixel(bench->display, screen),
+                                        BlackPixel(bench->display, screen));
+    bench->gc = XCreateGC(bench->display, bench->window, 0, NULL);
+    
+    // Drawing to a window that is not mapped yet costs the server nothing
+    XSelectInput(bench->display, bench->window, StructureNotifyMask);
+    XMapWindow(bench->display, bench->window);
+    XEvent event;
+    do {
+        XWindowEvent(bench->display, bench->window, StructureNotifyMask, &event);
+    } while (event.type != MapNotify);
+    return GVC_SUCCESS;
+}
+
+static void close_x(display_bench_t* bench) {
+    if (!bench->display) return;
+    XFreeGC(bench->display, bench->gc);
+    XDestroyWindow(bench->display, bench->window);
+    XCloseDisplay(bench->display);
+    bench->display = NULL;
+}
+
+// ---- paths ----
+
+static void convert_frame(display_bench_t* bench, const raw_frame_t* frame, XImage* image) {
+    if (image->bits_per_pixel == 32) {
+        bench->kernels->to_bgrx(frame->pixels, (uint8_t*)image->data, frame->width, frame->height, frame->channels);
+    } else {
+        bench->kernels->to_bgr(frame->pixels, (uint8_t*)image->data, frame->width, frame->height, frame->channels);
+        // Packed rows to the image's padded stride, as display.m does
+        size_t packed_row = (size_t)frame->width * 3;
+        if ((size_t)image->bytes_per_line != packed_row) {
+            for (uint32_t y = frame->height; y-- > 1;) {
+                memmove(image->data + (size_t)y * image->bytes_per_line,
+                        image->data + (size_t)y * packed_row, packed_row);
+            }
+        }
+    }
+}
+
+static int tile_changed(const raw_frame_t* current, const raw_frame_t* previous,
+                        uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    size_t stride = (size_t)current->width * current->channels;
+    size_t offset = (size_t)y * stride + (size_t)x * current->channels;
+    for (uint32_t row = 0; row < height; row++, offset += stride) {
+        if (memcmp(current->pixels + offset, previous->pixels + offset, (size_t)width * current->channels) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void upload_rect(display_bench_t* bench, const raw_frame_t* frame,
+                        uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    XImage* image = bench->shared.image;
+    const frame_kernels_t* kernels = select_frame_kernels(width, 1, frame->channels, frame->pixel_format);
+    for (uint32_t row = y; row < y + height; row++) {
+        kernels->to_bgrx(frame->pixels + ((size_t)row * frame->width + x) * frame->channels,
+                         (uint8_t*)image->data + (size_t)row * image->bytes_per_line + (size_t)x * 4,
+                         width, 1, frame->channels);
+    }
+    XShmPutImage(bench->display, bench->window, bench->gc, image, x, y, x, y, width, height, False);
+}
+
+// Changed 64x64 tiles, merged into horizontal runs; returns the fraction uploaded
+static double upload_dirty(display_bench_t* bench, const raw_frame_t* current, const raw_frame_t* previous) {
+    uint64_t dirty_pixels = 0;
+    for (uint32_t y = 0; y < current->height; y += DIRTY_TILE) {
+        uint32_t height = MIN(DIRTY_TILE, current->height - y);
+        int in_run = 0;
+        uint32_t run_start = 0;
+        for (uint32_t x = 0; x < current->width; x += DIRTY_TILE) {
+            int changed = tile_changed(current, previous, x, y, MIN(DIRTY_TILE, current->width - x), height);
+            if (changed && !in_run) {
+                run_start = x;
+                in_run = 1;
+            } else if (!changed && in_run) {
+                upload_rect(bench, current, run_start, y, x - run_start, height);
+                dirty_pixels += (uint64_t)(x - run_start) * height;
+                in_run = 0;
+            }
+        }
+        if (in_run) {
+            upload_rect(bench, current, run_start, y, current->width - run_start, height);
+            dirty_pixels += (uint64_t)(current->width - run_start) * height;
+        }
+    }
+    return (double)dirty_pixels / ((double)current->width * current->height);
+}
+
+static void scale_to_bgrx(display_bench_t* bench, const raw_frame_t* frame) {
+    XImage* image = bench->scaled.image;
+    size_t stride = (size_t)frame->width * frame->channels;
+    for (int y = 0; y < image->height; y++) {
+        const uint8_t* src = frame->pixels + (size_t)bench->scale_rows[y] * stride;
+        uint8_t* dst = (uint8_t*)image->data + (size_t)y * image->bytes_per_line;
+        for (int x = 0; x < image->width; x++) {
+            const uint8_t* s = src + bench->scale_columns[x];
+            dst[x * 4] = s[2];
+            dst[x * 4 + 1] = s[1];
+            dst[x * 4 + 2] = s[0];
+            dst[x * 4 + 3] = 0;
+        }
+    }
+}
+
+// Present one frame along a path; dirty_out gets the fraction of the frame uploaded
+static int present(display_bench_t* bench, display_path_t path, const raw_frame_t* current,
+                   const raw_frame_t* previous, double* dirty_out) {
+    *dirty_out = 1.0;
+    switch (path) {
+        case PATH_CONVERT:
+            convert_frame(bench, current, bench->plain.image);
+            return GVC_SUCCESS;
+        case PATH_XPUTIMAGE:
+            convert_frame(bench, current, bench->plain.image);
+            XPutImage(bench->display, bench->window, bench->gc, bench->plain.image, 0, 0, 0, 0,
+                      current->width, current->height);
+            break;
+        case PATH_SHM:
+            convert_frame(bench, current, bench->shared.image);
+            XShmPutImage(bench->display, bench->window, bench->gc, bench->shared.image, 0, 0, 0, 0,
+                         current->width, current->height, False);
+            break;
+        case PATH_SHM_DIRTY:
+            *dirty_out = upload_dirty(bench, current, previous);
+            break;
+        case PATH_SHM_SCALED:
+            scale_to_bgrx(bench, current);
+            XShmPutImage(bench->display, bench->window, bench->gc, bench->scaled.image, 0, 0, 0, 0,
+                         bench->scaled.image->width, bench->scaled.image->height, False);
+            break;
+        case PATH_BACKEND:
+            return display_frame(current);
+        default:
+            return GVC_ERROR_FORMAT;
+    }
+    XSync(bench->display, False);
+    return GVC_SUCCESS;
+}
+
+// ---- runs ----
+
+static void next_frame(display_bench_t* bench, const raw_frame_t** current_out, const raw_frame_t** previous_out) {
+    raw_frame_t* current = &bench->frames[bench->next_frame % 2];
+    synth_generator_render(&bench->generator, bench->next_frame, current);
+    *current_out = current;
+    *previous_out = &bench->frames[(bench->next_frame + 1) % 2];
+    bench->next_frame++;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run_path(display_bench_t* bench, display_path_t path, uint32_t output_width, uint32_t output_height) {
+    uint32_t width = bench->synth.width;
+    uint32_t height = bench->synth.height;
+    if (path == PATH_BACKEND && display_init(width, height) != GVC_SUCCESS) {
+        fprintf(stderr, "  %-10s %ux%u  display backend unavailable\n", path_names[path], width, height);
+        return;
+    }
+    
+    double dirty_sum = 0;
+    int errors = 0;
+    for (int i = 0; i < bench->warmup + bench->repetitions; i++) {
+        const raw_frame_t* current;
+        const raw_frame_t* previous;
+        next_frame(bench, &current, &previous);
+    
+        double dirty;
+        uint64_t start = get_time_ns();
+        int result = present(bench, path, current, previous, &dirty);
+        uint64_t elapsed = get_time_ns() - start;
+        if (i < bench->warmup) continue;
+        bench->samples[i - bench->warmup] = elapsed / 1e6;
+        dirty_sum += dirty;
+        if (result != GVC_SUCCESS) errors++;
+    }
+    if (path == PATH_BACKEND) {
+        display_cleanup();
+    }
+    
+    int count = bench->repetitions;
+    double sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += bench->samples[i];
+    }
+    qsort(bench->samples, count, sizeof(double), compare_double);
+    double mean = sum / count;
+    double p50 = bench->samples[count / 2];
+    double p99 = bench->samples[CLAMP((int)(0.99 * (count - 1) + 0.5), 0, count - 1)];
+    double max = bench->samples[count - 1];
+    
+    fprintf(bench->out, "%s\n  {\"path\":\"%s\",\"size\":\"%ux%u\",\"output\":\"%ux%u\",\"frames\":%d,\"errors\":%d,"
+            "\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f,\"mean_fps\":%.1f,\"max_fps\":%.1f,"
+            "\"dirty_fraction\":%.4f}",
+            bench->first_result ? "" : ",", path_names[path], width, height, output_width, output_height,
+            count, errors, mean, p50, p99, max, 1000.0 / MAX(mean, 1e-9), 1000.0 / MAX(p99, 1e-9),
+            dirty_sum / count);
+    bench->first_result = 0;
+    fprintf(stderr, "  %-10s %ux%u -> %ux%u  mean %8.3f ms  p99 %8.3f ms  max %7.1f fps%s\n",
+            path_names[path], width, height, output_width, output_height, mean, p99,
+            1000.0 / MAX(p99, 1e-9), errors ? "  (errors)" : "");
+}
+
+// Every path at one frame size; the scaled output is output_width x output_height
+static int run_size(display_bench_t* bench, uint32_t width, uint32_t height,
+                    uint32_t output_width, uint32_t output_height, int num_threads) {
+    bench->synth.width = width;
+    bench->synth.height = height;
+    bench->next_frame = 0;
+    bench->kernels = select_frame_kernels(width, height, 3, PIXEL_FORMAT_RGB);
+    memset(bench->frames, 0, sizeof(bench->frames));
+    if (synth_alloc_frame(&bench->synth, &bench->frames[0]) != GVC_SUCCESS ||
+        synth_alloc_frame(&bench->synth, &bench->frames[1]) != GVC_SUCCESS ||
+        synth_generator_open(&bench->generator, &bench->synth, num_threads) != GVC_SUCCESS) {
+        free_raw_frame(&bench->frames[0]);
+        free_raw_frame(&bench->frames[1]);
+        return GVC_ERROR_MEMORY;
+    }
+    fprintf(stderr, "%ux%u (%s kernels):\n", width, height, bench->kernels->name);
+    
+    // Without a server the convert target is a plain buffer in the server's format
+    int have_x = bench->display != NULL;
+    if (have_x) {
+        if (surface_create(bench, &bench->plain, width, height, 0) != GVC_SUCCESS) have_x = 0;
+    } else {
+        bench->plain.image = calloc(1, sizeof(XImage));
+        if (bench->plain.image) {
+            bench->plain.image->bits_per_pixel = 32;
+            bench->plain.image->data = malloc((size_t)width * height * 4);
+        }
+    }
+    if (!bench->plain.image || !bench->plain.image->data) {
+        fprintf(stderr, "Error: Cannot allocate a %ux%u image\n", width, height);
+        if (bench->plain.image && !have_x) free(bench->plain.image);
+        memset(&bench->plain, 0, sizeof(bench->plain));
+        synth_generator_close(&bench->generator);
+        free_raw_frame(&bench->frames[0]);
+        free_raw_frame(&bench->frames[1]);
+        return GVC_ERROR_MEMORY;
+    }
+    int have_shm = have_x && bench->shm_available && bench->plain.image->bits_per_pixel == 32 &&
+                   surface_create(bench, &bench->shared, width, height, 1) == GVC_SUCCESS &&
+                   surface_create(bench, &bench->scaled, output_width, output_height, 1) == GVC_SUCCESS;
+    
+    bench->scale_columns = malloc(sizeof(uint32_t) * output_width);
+    bench->scale_rows = malloc(sizeof(uint32_t) * output_height);
+    if (bench->scale_columns && bench->scale_rows) {
+        for (uint32_t x = 0; x < output_width; x++) {
+            bench->scale_columns[x] = (uint32_t)((uint64_t)x * width / output_width) * 3;
+        }
+        for (uint32_t y = 0; y < output_height; y++) {
+            bench->scale_rows[y] = (uint32_t)((uint64_t)y * height / output_height);
+        }
+    } else {
+        have_shm = 0;
+    }
+    
+    for (int path = 0; path < PATH_COUNT; path++) {
+        int shm_path = path == PATH_SHM || path == PATH_SHM_DIRTY || path == PATH_SHM_SCALED;
+        if ((path != PATH_CONVERT && !have_x) || (shm_path && !have_shm)) continue;
+        int scaled = path == PATH_SHM_SCALED;
+        run_path(bench, (display_path_t)path, scaled ? output_width : width, scaled ? output_height : height);
+    }
+    if (have_x && !have_shm) {
+        fprintf(stderr, "  MIT-SHM unavailable%s: shm paths skipped\n",
+                bench->plain.image->bits_per_pixel != 32 ? " or not a 32-bit visual" : "");
+    }
+    
+    free(bench->scale_columns);
+    free(bench->scale_rows);
+    surface_destroy(bench, &bench->scaled);
+    surface_destroy(bench, &bench->shared);
+    if (have_x) {
+        surface_destroy(bench, &bench->plain);
+    } else {
+        free(bench->plain.image->data);
+        free(bench->plain.image);
+        memset(&bench->plain, 0, sizeof(bench->plain));
+    }
+    synth_generator_close(&bench->generator);
+    free_raw_frame(&bench->frames[0]);
+    free_raw_frame(&bench->frames[1]);
+    return GVC_SUCCESS;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-s WxH,...] [-S WxH] [-c content] [-W warmup] [-n frames] [-j threads] [-o results.json]\n",
+           program);
+    printf("\nTimes RGB -> BGRX conversion, XPutImage, MIT-SHM, dirty-rect and scaled\n");
+    printf("uploads and the display backend on the X server in DISPLAY (e.g. Xvfb).\n");
+    printf("Without a server only conversion is measured.\n");
+    printf("\nOptions:\n");
+    printf("  -s list      Frame sizes (default: 1920x1080,3840x2160)\n");
+    printf("  -S WxH       Scaled output size (default: double up to 1080p, half above)\n");
+    printf("  -c content   Synthetic content: static, pan, zoom, noise, text, scene_cuts, test\n");
+    printf("               or demo (default: text)\n");
+    printf("  -W count     Untimed frames per path (default: %d)\n", DISPLAY_DEFAULT_WARMUP);
+    printf("  -n count     Timed frames per path (default: %d)\n", DISPLAY_DEFAULT_FRAMES);
+    printf("  -j threads   Content render threads (default: one per CPU)\n");
+    printf("  -o file      Write the JSON here instead of stdout\n");
+    printf("\nExample:\n");
+    printf("  xvfb-run -a -s '-screen 0 3840x2160x24' %s\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    display_bench_t bench;
+    memset(&bench, 0, sizeof(bench));
+    synth_params_init(&bench.synth);
+    bench.synth.content = SYNTH_TEXT;
+    bench.warmup = DISPLAY_DEFAULT_WARMUP;
+    bench.repetitions = DISPLAY_DEFAULT_FRAMES;
+    bench.first_result = 1;
+    uint32_t widths[DISPLAY_MAX_SIZES] = { 1920, 3840 };
+    uint32_t heights[DISPLAY_MAX_SIZES] = { 1080, 2160 };
+    int num_sizes = 2;
+    uint32_t output_width = 0, output_height = 0;
+    int num_threads = 0;
+    const char* output_path = NULL;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "s:S:c:W:n:j:o:")) != -1) {
+        switch (opt) {
+            case 's':
+                num_sizes = 0;
+                for (char* token = strtok(optarg, ","); token && num_sizes < DISPLAY_MAX_SIZES;
+                     token = strtok(NULL, ",")) {
+                    if (sscanf(token, "%ux%u", &widths[num_sizes], &heights[num_sizes]) != 2 ||
+                        widths[num_sizes] == 0 || heights[num_sizes] == 0) {
+                        fprintf(stderr, "Error: Frame size must be WxH, e.g. 1920x1080\n");
+                        return 1;
+                    }
+                    num_sizes++;
+                }
+                break;
+            case 'S':
+                if (sscanf(optarg, "%ux%u", &output_width, &output_height) != 2 ||
+                    output_width == 0 || output_height == 0) {
+                    fprintf(stderr, "Error: Output size must be WxH, e.g. 3840x2160\n");
+                    return 1;
+                }
+                break;
+            case 'c':
+                if (parse_synth_class(optarg, &bench.synth.content) != GVC_SUCCESS) {
+                    fprintf(stderr, "Error: Unknown content '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'W':
+                bench.warmup = MAX(atoi(optarg), 0);
+                break;
+            case 'n':
+                bench.repetitions = MAX(atoi(optarg), 1);
+                break;
+            case 'j':
+                num_threads = atoi(optarg);
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (num_sizes == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    // The window holds the largest frame and the largest scaled output
+    uint32_t outputs_width[DISPLAY_MAX_SIZES], outputs_height[DISPLAY_MAX_SIZES];
+    uint32_t max_width = 0, max_height = 0;
+    for (int i = 0; i < num_sizes; i++) {
+        int upscale = heights[i] <= 1080;
+        outputs_width[i] = output_width ? output_width : upscale ? widths[i] * 2 : widths[i] / 2;
+        outputs_height[i] = output_height ? output_height : upscale ? heights[i] * 2 : heights[i] / 2;
+        max_width = MAX(max_width, MAX(widths[i], outputs_width[i]));
+        max_height = MAX(max_height, MAX(heights[i], outputs_height[i]));
+    }
+    
+    bench.out = output_path ? fopen(output_path, "w") : stdout;
+    bench.samples = malloc(sizeof(double) * bench.repetitions);
+    if (!bench.out || !bench.samples) {
+        fprintf(stderr, "Error: Cannot write results%s%s\n", output_path ? " to " : "",
+                output_path ? output_path : "");
+        return 1;
+    }
+    if (open_x(&bench, max_width, max_height) != GVC_SUCCESS) {
+        fprintf(stderr, "display-bench: no X server (set DISPLAY or use xvfb-run); measuring conversion only\n");
+    } else {
+        fprintf(stderr, "display-bench: %s, depth %d, MIT-SHM %s\n", DisplayString(bench.display),
+                bench.depth, bench.shm_available ? "available" : "unavailable");
+    }
+    
+    fprintf(bench.out, "{\"display\":\"%s\",\"depth\":%d,\"shm\":%s,\"content\":\"%s\",\"warmup\":%d,"
+            "\"repetitions\":%d,\"results\":[",
+            bench.display ? DisplayString(bench.display) : "", bench.depth,
+            bench.shm_available ? "true" : "false", synth_class_name(bench.synth.content),
+            bench.warmup, bench.repetitions);
+    int result = GVC_SUCCESS;
+    for (int i = 0; i < num_sizes && result == GVC_SUCCESS; i++) {
+        result = run_size(&bench, widths[i], heights[i], outputs_width[i], outputs_height[i], num_threads);
+    }
+    fprintf(bench.out, "\n]}\n");
+    
+    close_x(&bench);
+    free(bench.samples);
+    if (output_path && fclose(bench.out) != 0) result = GVC_ERROR_MEMORY;
+    return result == GVC_SUCCESS ? 0 : 1;
+}
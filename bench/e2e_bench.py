@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+"""End-to-end GitFlix benchmark: encode, play back headless, compare to a baseline.
+
+The encoder's synthetic test video (or, with --content, another synth.c class)
+is encoded into a fresh repository with each writer configuration and read back
+through each reader:
+
+  writers   fast       git-vid-encode -e fast (LZ4, delta every frame)
+            balanced   git-vid-encode (LZFSE, estimated intra/delta)
+            max        git-vid-encode -e max (LZMA, exhaustive)
+            rans       git-vid-encode -r (rANS-coded deltas)
+            bframes    git-vid-encode -b (B frames)
+
+  readers   play-repo   git-vid-play -H <repo>: one `git show` per frame, decoded inline
+            play-stdin  git-vid-play -H with hashes on stdin: decoder thread and frame buffer
+            batch       git-vid-verify -j 1: one `git cat-file --batch`, decoded and hash-checked
+
+Per writer it records encode fps and repository size; per reader, decode fps,
+time to first frame and per-stage latency percentiles (from git-vid-play's -T
+telemetry). Results are compared with a baseline JSON. The run fails when a
+metric is worse than the baseline by more than the threshold: lower fps, or a
+larger size, time or latency. A reader that drops any frame fails the run
+outright. With no baseline yet, the results become it.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+WRITERS = {
+    "fast": ["-e", "fast"],
+    "balanced": [],
+    "max": ["-e", "max"],
+    "rans": ["-r"],
+    "bframes": ["-b"],
+}
+READERS = ["play-repo", "play-stdin", "batch"]
+DEFAULT_WRITERS = "fast,balanced,rans"
+LATENCY_STAGES = ["fetch", "deserialize", "decompress", "delta_apply"]
+
+
+def run(command, cwd=None, stdin=None):
+    """Run a command, returning (wall seconds, stdout); raise with its output on failure."""
+    start = time.monotonic()
+    result = subprocess.run(command, cwd=cwd, input=stdin, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, universal_newlines=True)
+    elapsed = time.monotonic() - start
+    if result.returncode != 0:
+        raise RuntimeError("%s failed (%d):\n%s" % (" ".join(command), result.returncode,
+                                                     result.stdout[-2000:]))
+    return elapsed, result.stdout
+
+
+def directory_bytes(path):
+    total = 0
+    for root, _, files in os.walk(path):
+        for name in files:
+            total += os.path.getsize(os.path.join(root, name))
+    return total
+
+
+def git_output(repo, *args):
+    return subprocess.check_output(["git"] + list(args), cwd=repo, universal_newlines=True)
+
+
+def play(bin_dir, repo, reader, workdir):
+    """Headless playback through git-vid-play; metrics come from its telemetry JSON."""
+    telemetry_path = os.path.join(workdir, "telemetry-%s.json" % reader)
+    command = [os.path.join(bin_dir, "git-vid-play"), "-H", "-T", telemetry_path]
+    if reader == "play-repo":
+        run(command + [repo])
+    else:
+        hashes = git_output(repo, "log", "--reverse", "--format=%H")
+        run(command, cwd=repo, stdin=hashes)
+
+    with open(telemetry_path) as f:
+        telemetry = json.load(f)
+    # Headless playback never paces, so a drop means frames went undecoded and
+    # the fps below would be flattered
+    if telemetry["frames_dropped"] > 0:
+        raise RuntimeError("%s dropped %d frames headless" % (reader, telemetry["frames_dropped"]))
+    decode_seconds = telemetry["elapsed_seconds"] - telemetry["first_frame_ms"] / 1e3
+    result = {
+        "frames": telemetry["frames_presented"],
+        "decode_fps": telemetry["frames_presented"] / max(telemetry["elapsed_seconds"], 1e-9),
+        "first_frame_ms": telemetry["first_frame_ms"],
+        "steady_fps": (telemetry["frames_presented"] - 1) / max(decode_seconds, 1e-9),
+        "latency_ms": {},
+    }
+    for stage in LATENCY_STAGES:
+        summary = telemetry["stages"].get(stage)
+        if summary and summary["samples"] > 0:
+            result["latency_ms"][stage] = {q: summary[q] for q in ("p50", "p95", "p99")}
+    return result
+
+
+def read_batch(bin_dir, repo, frames):
+    """Sequential decode through one git cat-file --batch process."""
+    elapsed, output = run([os.path.join(bin_dir, "git-vid-verify"), "-j", "1", repo])
+    match = re.search(r"Verified (\d+) frames in ([\d.]+)s", output)
+    decoded = int(match.group(1)) if match else frames
+    return {"frames": decoded, "decode_fps": decoded / max(elapsed, 1e-9)}
+
+
+def measure(args, workdir):
+    results = {"writers": {}}
+    env_identity = {
+        "GIT_AUTHOR_NAME": "gitflix-bench", "GIT_AUTHOR_EMAIL": "bench@localhost",
+        "GIT_COMMITTER_NAME": "gitflix-bench", "GIT_COMMITTER_EMAIL": "bench@localhost",
+    }
+    for key, value in env_identity.items():
+        os.environ.setdefault(key, value)
+
+    for writer in args.writers:
+        repo = os.path.join(workdir, writer)
+        print("[%s] encoding" % writer, file=sys.stderr)
+        source = "test" if args.content == "test" else "synth:" + args.content
+        encode_seconds, _ = run([os.path.join(args.bin_dir, "git-vid-encode")] + WRITERS[writer] +
+                                [source, repo])
+        frames = int(git_output(repo, "rev-list", "--count", "HEAD"))
+        entry = {
+            "frames": frames,
+            "encode_fps": frames / encode_seconds,
+            "repo_bytes": directory_bytes(os.path.join(repo, ".git")),
+            "readers": {},
+        }
+
+        for reader in args.readers:
+            print("[%s] reading with %s" % (writer, reader), file=sys.stderr)
+            if reader == "batch":
+                entry["readers"][reader] = read_batch(args.bin_dir, repo, frames)
+            else:
+                entry["readers"][reader] = play(args.bin_dir, repo, reader, workdir)
+        results["writers"][writer] = entry
+    return results
+
+
+def flatten(node, prefix=""):
+    """{"a": {"b": 1}} -> {"a/b": 1}, numeric leaves only."""
+    flat = {}
+    for key, value in node.items():
+        path = prefix + key
+        if isinstance(value, dict):
+            flat.update(flatten(value, path + "/"))
+        elif isinstance(value, (int, float)) and not isinstance(value, bool):
+            flat[path] = value
+    return flat
+
+
+def compare(results, baseline, threshold, min_ms):
+    """Print a comparison table; return the metrics that regressed beyond threshold."""
+    current = flatten(results["writers"])
+    previous = flatten(baseline.get("writers", {}))
+    regressions = []
+    print("%-52s %14s %14s %8s" % ("metric", "baseline", "current", "change"))
+    for metric in sorted(current):
+        if metric not in previous or metric.endswith("/frames"):
+            continue
+        old, new = previous[metric], current[metric]
+        # Sub-resolution latencies are scheduler noise
+        if metric.endswith(("_ms", "/p50", "/p95", "/p99")) and max(old, new) < min_ms:
+            continue
+        higher_is_better = metric.endswith("_fps")
+        change = (new - old) / old if old else 0.0
+        worse = -change if higher_is_better else change
+        flag = ""
+        if worse > threshold:
+            flag = "  REGRESSION"
+            regressions.append(metric)
+        print("%-52s %14.3f %14.3f %+7.1f%%%s" % (metric, old, new, change * 100, flag))
+    return regressions
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--bin-dir", default=os.path.dirname(here),
+                        help="directory holding the built git-vid-* binaries")
+    parser.add_argument("--writers", default=DEFAULT_WRITERS,
+                        help="comma-separated writers (%s)" % ", ".join(WRITERS))
+    parser.add_argument("--readers", default=",".join(READERS),
+                        help="comma-separated readers (%s)" % ", ".join(READERS))
+    parser.add_argument("--content", default="test",
+                        help="synthetic input: test, static, pan, zoom, noise, text, scene_cuts "
+                             "or demo (default: test; compare only with a baseline of the same)")
+    parser.add_argument("--baseline", default=os.path.join(here, "e2e_baseline.json"))
+    parser.add_argument("--threshold", type=float, default=0.20,
+                        help="fractional regression that fails the run (default: 0.20)")
+    parser.add_argument("--min-ms", type=float, default=0.5,
+                        help="ignore latencies below this in both runs (default: 0.5)")
+    parser.add_argument("--output", help="also write this run's results here")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="replace the baseline with this run instead of comparing")
+    parser.add_argument("--keep", action="store_true", help="keep the temporary repositories")
+    args = parser.parse_args()
+
+    args.writers = [w for w in args.writers.split(",") if w]
+    args.readers = [r for r in args.readers.split(",") if r]
+    for writer in args.writers:
+        if writer not in WRITERS:
+            parser.error("unknown writer: %s" % writer)
+    for reader in args.readers:
+        if reader not in READERS:
+            parser.error("unknown reader: %s" % reader)
+
+    workdir = tempfile.mkdtemp(prefix="gitflix-e2e-")
+    try:
+        results = measure(args, workdir)
+    finally:
+        if args.keep:
+            print("Repositories kept in %s" % workdir, file=sys.stderr)
+        else:
+            shutil.rmtree(workdir, ignore_errors=True)
+    results["threshold"] = args.threshold
+    results["content"] = args.content
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    if args.update_baseline or not os.path.exists(args.baseline):
+        with open(args.baseline, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Baseline written to %s" % args.baseline)
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    regressions = compare(results, baseline, args.threshold, args.min_ms)
+    if regressions:
+        print("\n%d metric(s) regressed by more than %.0f%%" % (len(regressions), args.threshold * 100))
+        return 1
+    print("\nNo regressions beyond %.0f%%" % (args.threshold * 100))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
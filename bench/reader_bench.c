@@ -0,0 +1,273 @@
+#include <gitflix.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// reader-bench: drive libgitflix the way another program would, through
+// gitflix.h and the library alone, and check what it returns:
+//
+//   sequential  one reader, every frame in order; records a hash of each
+//               frame's pixels and checks frame numbers run 0..n-1
+//   seek        -s seeks to spread-out frames, each followed by one
+//               gvc_reader_next that must return that frame with the same
+//               pixels as the sequential pass; latency covers both calls
+//   concurrent  -r readers on as many threads, each playing the repository
+//               through and checking every frame against the sequential pass
+//
+// Results go to stdout (or -o) as JSON. Any mismatch or reader error is
+// printed to stderr and makes the exit status 1.
+
+#define READER_DEFAULT_SEEKS 20
+#define READER_DEFAULT_READERS 2
+
+typedef struct {
+    const char* repo_path;
+    gvc_reader_options_t options;
+    const uint64_t* hashes;  // From the sequential pass; NULL while recording
+    uint64_t* hashes_out;
+    uint32_t num_frames;
+    uint32_t frames;         // Frames returned
+    int failed;
+    double seconds;
+} reader_run_t;
+
+static uint64_t get_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// FNV-1a
+static uint64_t hash_pixels(const gvc_frame_t* frame) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < frame->size; i++) {
+        hash = (hash ^ frame->pixels[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int alloc_frame(gvc_reader_t* reader, gvc_frame_t* frame) {
+    gvc_reader_format(reader, frame);
+    frame->pixels = malloc(frame->size);
+    frame->capacity = frame->size;
+    return frame->pixels ? GVC_SUCCESS : GVC_ERROR_MEMORY;
+}
+
+// Play the whole repository through one reader
+static void* play_through(void* arg) {
+    reader_run_t* run = (reader_run_t*)arg;
+    gvc_reader_t* reader;
+    int result = gvc_reader_open(run->repo_path, &run->options, &reader);
+    if (result != GVC_SUCCESS) {
+        fprintf(stderr, "reader-bench: cannot open %s (error %d)\n", run->repo_path, result);
+        run->failed = 1;
+        return NULL;
+    }
+    
+    gvc_frame_t frame;
+    if (alloc_frame(reader, &frame) != GVC_SUCCESS) {
+        run->failed = 1;
+        gvc_reader_close(reader);
+        return NULL;
+    }
+    
+    uint64_t start = get_time_ns();
+    while ((result = gvc_reader_next(reader, &frame)) != GVC_READER_END) {
+        if (result != GVC_SUCCESS) {
+            fprintf(stderr, "reader-bench: frame after %u failed (error %d)\n", run->frames, result);
+            run->failed = 1;
+            break;
+        }
+        if (frame.frame_number != run->frames || frame.frame_number >= run->num_frames) {
+            fprintf(stderr, "reader-bench: got frame %u, expected %u\n", frame.frame_number, run->frames);
+            run->failed = 1;
+            break;
+        }
+        uint64_t hash = hash_pixels(&frame);
+        if (run->hashes_out) {
+            run->hashes_out[frame.frame_number] = hash;
+        } else if (hash != run->hashes[frame.frame_number]) {
+            fprintf(stderr, "reader-bench: frame %u differs from the sequential pass\n", frame.frame_number);
+            run->failed = 1;
+        }
+        run->frames++;
+    }
+    run->seconds = (get_time_ns() - start) / 1e9;
+    if (!run->failed && run->frames != run->num_frames) {
+        fprintf(stderr, "reader-bench: %u of %u frames returned\n", run->frames, run->num_frames);
+        run->failed = 1;
+    }
+    
+    free(frame.pixels);
+    gvc_reader_close(reader);
+    return NULL;
+}
+
+// Seek to num_seeks frames spread over the repository, last to first
+static int run_seeks(FILE* out, const char* repo_path, const gvc_reader_options_t* options,
+                     const uint64_t* hashes, uint32_t num_frames, int num_seeks) {
+    gvc_reader_t* reader;
+    if (gvc_reader_open(repo_path, options, &reader) != GVC_SUCCESS) return 1;
+    gvc_frame_t frame;
+    if (alloc_frame(reader, &frame) != GVC_SUCCESS) {
+        gvc_reader_close(reader);
+        return 1;
+    }
+    
+    uint64_t* latencies = calloc(num_seeks, sizeof(uint64_t));
+    int failed = !latencies;
+    for (int i = 0; i < num_seeks && !failed; i++) {
+        uint32_t target = (uint32_t)((uint64_t)(num_seeks - 1 - i) * num_frames / num_seeks + num_frames / (2 * num_seeks));
+        uint64_t start = get_time_ns();
+        int result = gvc_reader_seek(reader, target);
+        if (result == GVC_SUCCESS) {
+            result = gvc_reader_next(reader, &frame);
+        }
+        latencies[i] = get_time_ns() - start;
+        if (result != GVC_SUCCESS || frame.frame_number != target || hash_pixels(&frame) != hashes[target]) {
+            fprintf(stderr, "reader-bench: seek to %u returned the wrong frame (error %d)\n", target, result);
+            failed = 1;
+        }
+    }
+    
+    if (!failed) {
+        qsort(latencies, num_seeks, sizeof(uint64_t), compare_u64);
+        fprintf(out, ",\n{\"test\":\"seek\",\"seeks\":%d,\"p50_ms\":%.3f,\"max_ms\":%.3f}", num_seeks,
+                latencies[num_seeks / 2] / 1e6, latencies[num_seeks - 1] / 1e6);
+    }
+    free(latencies);
+    free(frame.pixels);
+    gvc_reader_close(reader);
+    return failed;
+}
+
+static int run_concurrent(FILE* out, const char* repo_path, const gvc_reader_options_t* options,
+                          const uint64_t* hashes, uint32_t num_frames, int num_readers) {
+    reader_run_t* runs = calloc(num_readers, sizeof(reader_run_t));
+    pthread_t* threads = calloc(num_readers, sizeof(pthread_t));
+    if (!runs || !threads) {
+        free(runs);
+        free(threads);
+        return 1;
+    }
+    
+    uint64_t start = get_time_ns();
+    int started = 0;
+    for (; started < num_readers; started++) {
+        runs[started] = (reader_run_t){ .repo_path = repo_path, .options = *options, .hashes = hashes,
+                                        .num_frames = num_frames };
+        if (pthread_create(&threads[started], NULL, play_through, &runs[started]) != 0) break;
+    }
+    int failed = started < num_readers;
+    uint32_t frames = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        failed |= runs[i].failed;
+        frames += runs[i].frames;
+    }
+    double seconds = (get_time_ns() - start) / 1e9;
+    
+    if (!failed) {
+        fprintf(out, ",\n{\"test\":\"concurrent\",\"readers\":%d,\"frames\":%u,\"fps\":%.1f}", num_readers,
+                frames, frames / seconds);
+    }
+    free(runs);
+    free(threads);
+    return failed;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-s seeks] [-r readers] [-t threads] [-o results.json] <repo_path>\n", program);
+    printf("\nReads a repository through libgitflix: one sequential pass, seeks and\n");
+    printf("concurrent readers, each checked against the sequential pass.\n");
+    printf("\nOptions:\n");
+    printf("  -s seeks     Seeks to time (default: %d; 0 = none)\n", READER_DEFAULT_SEEKS);
+    printf("  -r readers   Readers to run at once (default: %d; 0 = none)\n", READER_DEFAULT_READERS);
+    printf("  -t threads   Fetch threads per reader (default: one per CPU)\n");
+    printf("  -o file      Write the JSON here instead of stdout\n");
+}
+
+int main(int argc, char* argv[]) {
+    int num_seeks = READER_DEFAULT_SEEKS;
+    int num_readers = READER_DEFAULT_READERS;
+    const char* output_path = NULL;
+    gvc_reader_options_t options;
+    gvc_reader_options_init(&options);
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "s:r:t:o:")) != -1) {
+        switch (opt) {
+            case 's':
+                num_seeks = atoi(optarg);
+                break;
+            case 'r':
+                num_readers = atoi(optarg);
+                break;
+            case 't':
+                options.num_threads = atoi(optarg);
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    FILE* out = output_path ? fopen(output_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write results to %s\n", output_path);
+        return 1;
+    }
+    
+    const char* repo_path = argv[optind];
+    gvc_reader_t* reader;
+    if (gvc_reader_open(repo_path, &options, &reader) != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Cannot read frames from %s\n", repo_path);
+        return 1;
+    }
+    uint32_t num_frames = gvc_reader_frame_count(reader);
+    gvc_reader_close(reader);
+    if (num_frames == 0) {
+        fprintf(stderr, "Error: No frames in %s\n", repo_path);
+        return 1;
+    }
+    if (num_seeks < 0 || (uint32_t)num_seeks > num_frames) {
+        num_seeks = (int)num_frames;
+    }
+    
+    uint64_t* hashes = calloc(num_frames, sizeof(uint64_t));
+    if (!hashes) return 1;
+    reader_run_t sequential = { .repo_path = repo_path, .options = options, .hashes_out = hashes,
+                                .num_frames = num_frames };
+    play_through(&sequential);
+    int failed = sequential.failed;
+    fprintf(out, "{\"repo\":\"%s\",\"frames\":%u,\"results\":[", repo_path, num_frames);
+    fprintf(out, "\n{\"test\":\"sequential\",\"fps\":%.1f}", num_frames / sequential.seconds);
+    
+    if (!failed && num_seeks > 0) {
+        failed |= run_seeks(out, repo_path, &options, hashes, num_frames, num_seeks);
+    }
+    if (!failed && num_readers > 0) {
+        failed |= run_concurrent(out, repo_path, &options, hashes, num_frames, num_readers);
+    }
+    
+    fprintf(out, "\n]}\n");
+    free(hashes);
+    if (fclose(out) != 0) return 1;
+    return failed;
+}
@@ -0,0 +1,821 @@
+#include "git_vid_codec.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// storage-bench: read one repository's frame blobs through every reader
+// backend the tree has, so they can be compared on the same host and data:
+//
+//   popen    git_read_frame_from_commit: one `git show` process per frame
+//   batch    git_batch_read: one `git cat-file --batch` process per thread
+//   libgit2  git_read_blob_libgit2: shared repository behind one mutex
+//            (only when built with libgit2; see the Makefile's LIBGIT2)
+//   mmap     a read-only pack reader in this file: .idx/.pack mapped, objects
+//            inflated and deltas applied in-process, no lock and no fork.
+//            Loose objects are read as files. No delta base cache, so its
+//            cost grows with the pack's delta depth.
+//
+// Each backend reads the first -n frames (oldest first) with every thread count
+// in -t; threads claim the next frame from a shared counter, like prefetch
+// workers. "cold" runs first evict the repository's object files from the page
+// cache with posix_fadvise(POSIX_FADV_DONTNEED), which drops only clean pages
+// and needs no privileges; "warm" runs follow an untimed pass over the same
+// frames. Throughput counts blob bytes; latency is per read, including the
+// copy to a caller-owned buffer that every backend makes. Results go to stdout
+// (or -o) as JSON; anything the backends print goes to stderr.
+
+#define STORAGE_DEFAULT_FRAMES 2000
+#define STORAGE_MAX_THREAD_COUNTS 16
+#define PACK_MAX_DELTA_DEPTH 4096  // Guards against reference loops in a damaged pack
+
+typedef enum {
+    CACHE_COLD,
+    CACHE_WARM,
+    CACHE_MODE_COUNT
+} cache_mode_t;
+
+static const char* const cache_mode_names[CACHE_MODE_COUNT] = { "cold", "warm" };
+
+typedef struct {
+    const char* name;
+    int (*open)(void** state_out, int num_threads);
+    int (*read)(void* state, int thread, const char* commit, uint8_t** data_out, size_t* size_out);
+    void (*close)(void* state);
+} storage_backend_t;
+
+static char git_dir[1024];  // Absolute; cold runs evict everything under objects/
+
+static uint64_t get_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ---- popen ----
+
+static int popen_open(void** state_out, int num_threads) {
+    (void)num_threads;
+    *state_out = NULL;
+    return GVC_SUCCESS;
+}
+
+static int popen_read(void* state, int thread, const char* commit, uint8_t** data_out, size_t* size_out) {
+    (void)state;
+    (void)thread;
+    return git_read_frame_from_commit(commit, data_out, size_out);
+}
+
+static void popen_close(void* state) {
+    (void)state;
+}
+
+// ---- batch ----
+
+typedef struct {
+    git_batch_reader_t* readers;
+    int count;
+} batch_state_t;
+
+static void batch_close(void* arg) {
+    batch_state_t* state = arg;
+    for (int i = 0; i < state->count; i++) {
+        git_batch_close(&state->readers[i]);
+    }
+    free(state->readers);
+    free(state);
+}
+
+// One reader per thread, all started before any thread (see git_batch_open)
+static int batch_open(void** state_out, int num_threads) {
+    batch_state_t* state = calloc(1, sizeof(*state));
+    if (!state) return GVC_ERROR_MEMORY;
+    state->readers = calloc(num_threads, sizeof(git_batch_reader_t));
+    if (!state->readers) {
+        free(state);
+        return GVC_ERROR_MEMORY;
+    }
+    for (; state->count < num_threads; state->count++) {
+        if (git_batch_open(&state->readers[state->count]) != GVC_SUCCESS) {
+            batch_close(state);
+            return GVC_ERROR_GIT;
+        }
+    }
+    *state_out = state;
+    return GVC_SUCCESS;
+}
+
+static int batch_read(void* arg, int thread, const char* commit, uint8_t** data_out, size_t* size_out) {
+    batch_state_t* state = arg;
+    char object_name[GIT_HASH_SIZE + 16];
+    snprintf(object_name, sizeof(object_name), "%s:frame.bin", commit);
+    return git_batch_read(&state->readers[thread], object_name, data_out, size_out);
+}
+
+// ---- libgit2 ----
+
+#ifdef GVC_LIBGIT2
+// Reopened for every run, so a cold run does not inherit libgit2's pack windows
+static int libgit2_open(void** state_out, int num_threads) {
+    (void)num_threads;
+    *state_out = NULL;
+    return git_init_libgit2(".");
+}
+
+static int libgit2_read(void* state, int thread, const char* commit, uint8_t** data_out, size_t* size_out) {
+    (void)state;
+    (void)thread;
+    return git_read_blob_libgit2(commit, data_out, size_out);
+}
+
+static void libgit2_close(void* state) {
+    (void)state;
+    git_cleanup_libgit2();
+}
+#endif
+
+// ---- mmap pack reader ----
+
+#define OBJ_COMMIT 1
+#define OBJ_TREE 2
+#define OBJ_BLOB 3
+#define OBJ_OFS_DELTA 6
+#define OBJ_REF_DELTA 7
+
+typedef struct {
+    const uint8_t* idx;
+    size_t idx_size;
+    const uint8_t* pack;
+    size_t pack_size;
+    uint32_t count;
+} pack_file_t;
+
+typedef struct {
+    pack_file_t* packs;
+    int num_packs;
+} pack_state_t;
+
+static uint32_t read_be32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static int hex_to_oid(const char* hex, uint8_t* oid) {
+    for (int i = 0; i < 20; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) return GVC_ERROR_FORMAT;
+        oid[i] = (uint8_t)byte;
+    }
+    return GVC_SUCCESS;
+}
+
+static const void* map_file(const char* path, size_t* size_out) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat info;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    *size_out = (size_t)info.st_size;
+    return map;
+}
+
+// A version 2 index: magic, version, 256 fan-out entries, names, CRCs, offsets
+static int load_pack(const char* idx_path, pack_file_t* pack) {
+    memset(pack, 0, sizeof(*pack));
+    char pack_path[1100];
+    snprintf(pack_path, sizeof(pack_path), "%.*s.pack", (int)(strlen(idx_path) - 4), idx_path);
+    pack->idx = map_file(idx_path, &pack->idx_size);
+    pack->pack = map_file(pack_path, &pack->pack_size);
+    if (!pack->idx || !pack->pack || pack->idx_size < 8 + 256 * 4 ||
+        read_be32(pack->idx) != 0xff744f63 || read_be32(pack->idx + 4) != 2) {
+        return GVC_ERROR_FORMAT;
+    }
+    pack->count = read_be32(pack->idx + 8 + 255 * 4);
+    if (pack->idx_size < 8 + 256 * 4 + (size_t)pack->count * 28) return GVC_ERROR_FORMAT;
+    return GVC_SUCCESS;
+}
+
+static void unload_pack(pack_file_t* pack) {
+    if (pack->idx) munmap((void*)pack->idx, pack->idx_size);
+    if (pack->pack) munmap((void*)pack->pack, pack->pack_size);
+}
+
+// Offset of the object in the pack, or 0 if the pack does not have it
+static uint64_t pack_find(const pack_file_t* pack, const uint8_t* oid) {
+    const uint8_t* fanout = pack->idx + 8;
+    uint32_t low = oid[0] ? read_be32(fanout + (oid[0] - 1) * 4) : 0;
+    uint32_t high = read_be32(fanout + oid[0] * 4);
+    const uint8_t* names = fanout + 256 * 4;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        int order = memcmp(names + (size_t)middle * 20, oid, 20);
+        if (order == 0) {
+            const uint8_t* offsets = names + (size_t)pack->count * 24;
+            uint32_t offset = read_be32(offsets + (size_t)middle * 4);
+            if (!(offset & 0x80000000u)) return offset;
+            const uint8_t* large = offsets + (size_t)pack->count * 4 + (size_t)(offset & 0x7fffffffu) * 8;
+            if (large + 8 > pack->idx + pack->idx_size) return 0;
+            return (uint64_t)read_be32(large) << 32 | read_be32(large + 4);
+        }
+        if (order < 0) low = middle + 1;
+        else high = middle;
+    }
+    return 0;
+}
+
+// Inflate a zlib stream of known output size
+static int inflate_known(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_size) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK) return GVC_ERROR_COMPRESSION;
+    stream.next_in = (Bytef*)src;
+    stream.avail_in = (uInt)MIN(src_size, (size_t)UINT32_MAX);
+    stream.next_out = dst;
+    stream.avail_out = (uInt)dst_size;
+    int status = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    return status == Z_STREAM_END && stream.total_out == dst_size ? GVC_SUCCESS : GVC_ERROR_COMPRESSION;
+}
+
+static size_t delta_varint(const uint8_t** p, const uint8_t* end) {
+    size_t value = 0;
+    int shift = 0;
+    while (*p < end) {
+        uint8_t byte = *(*p)++;
+        value |= (size_t)(byte & 0x7f) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) break;
+    }
+    return value;
+}
+
+// Rebuild an object from its base and a git delta: copy and insert instructions
+static int apply_delta(const uint8_t* base, size_t base_size, const uint8_t* delta, size_t delta_size,
+                       uint8_t** out, size_t* out_size) {
+    const uint8_t* p = delta;
+    const uint8_t* end = delta + delta_size;
+    if (delta_varint(&p, end) != base_size) return GVC_ERROR_FORMAT;
+    size_t size = delta_varint(&p, end);
+    uint8_t* result = malloc(size > 0 ? size : 1);
+    if (!result) return GVC_ERROR_MEMORY;
+    
+    size_t written = 0;
+    while (p < end) {
+        uint8_t op = *p++;
+        if (op & 0x80) {
+            size_t offset = 0, length = 0;
+            for (int i = 0; i < 4; i++) {
+                if ((op & (1 << i)) && p < end) offset |= (size_t)*p++ << (8 * i);
+            }
+            for (int i = 0; i < 3; i++) {
+                if ((op & (0x10 << i)) && p < end) length |= (size_t)*p++ << (8 * i);
+            }
+            if (length == 0) length = 0x10000;
+            if (offset + length > base_size || written + length > size) break;
+            memcpy(result + written, base + offset, length);
+            written += length;
+        } else if (op) {
+            if (p + op > end || written + op > size) break;
+            memcpy(result + written, p, op);
+            p += op;
+            written += op;
+        } else {
+            break;  // Reserved
+        }
+    }
+    if (written != size || p != end) {
+        free(result);
+        return GVC_ERROR_FORMAT;
+    }
+    *out = result;
+    *out_size = size;
+    return GVC_SUCCESS;
+}
+
+static int read_object(const pack_state_t* state, const uint8_t* oid, int depth,
+                       int* type_out, uint8_t** data_out, size_t* size_out);
+
+static int read_pack_object(const pack_state_t* state, const pack_file_t* pack, uint64_t offset, int depth,
+                            int* type_out, uint8_t** data_out, size_t* size_out) {
+    if (depth > PACK_MAX_DELTA_DEPTH || offset >= pack->pack_size) return GVC_ERROR_FORMAT;
+    const uint8_t* p = pack->pack + offset;
+    const uint8_t* end = pack->pack + pack->pack_size;
+    
+    // Type and inflated size: 3 + 4 bits, then 7 bits per continuation byte
+    uint8_t byte = *p++;
+    int type = (byte >> 4) & 7;
+    size_t size = byte & 15;
+    for (int shift = 4; (byte & 0x80) && p < end; shift += 7) {
+        byte = *p++;
+        size |= (size_t)(byte & 0x7f) << shift;
+    }
+    
+    uint8_t* base = NULL;
+    size_t base_size = 0;
+    int result = GVC_SUCCESS;
+    if (type == OBJ_OFS_DELTA) {
+        if (p >= end) return GVC_ERROR_FORMAT;
+        byte = *p++;
+        uint64_t distance = byte & 0x7f;
+        while ((byte & 0x80) && p < end) {
+            byte = *p++;
+            distance = ((distance + 1) << 7) | (byte & 0x7f);
+        }
+        if (distance > offset) return GVC_ERROR_FORMAT;
+        result = read_pack_object(state, pack, offset - distance, depth + 1, type_out, &base, &base_size);
+    } else if (type == OBJ_REF_DELTA) {
+        if (p + 20 > end) return GVC_ERROR_FORMAT;
+        result = read_object(state, p, depth + 1, type_out, &base, &base_size);
+        p += 20;
+    } else {
+        *type_out = type;
+    }
+    if (result != GVC_SUCCESS) return result;
+    
+    uint8_t* data = malloc(size > 0 ? size : 1);
+    if (!data) {
+        free(base);
+        return GVC_ERROR_MEMORY;
+    }
+    result = inflate_known(p, (size_t)(end - p), data, size);
+    if (result == GVC_SUCCESS && base) {
+        uint8_t* delta = data;
+        data = NULL;
+        result = apply_delta(base, base_size, delta, size, &data, &size);
+        free(delta);
+    }
+    free(base);
+    if (result != GVC_SUCCESS) {
+        free(data);
+        return result;
+    }
+    *data_out = data;
+    *size_out = size;
+    return GVC_SUCCESS;
+}
+
+// Loose object: zlib("<type> <size>\0<data>") in objects/xx/yyyy...
+static int read_loose_object(const uint8_t* oid, int* type_out, uint8_t** data_out, size_t* size_out) {
+    char path[1200];
+    int length = snprintf(path, sizeof(path), "%s/objects/%02x/", git_dir, oid[0]);
+    for (int i = 1; i < 20; i++) {
+        length += snprintf(path + length, sizeof(path) - length, "%02x", oid[i]);
+    }
+    size_t file_size;
+    const uint8_t* file = map_file(path, &file_size);
+    if (!file) return GVC_ERROR_GIT;
+    
+    uint8_t header[64];
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int result = GVC_ERROR_COMPRESSION;
+    if (inflateInit(&stream) == Z_OK) {
+        stream.next_in = (Bytef*)file;
+        stream.avail_in = (uInt)file_size;
+        stream.next_out = header;
+        stream.avail_out = sizeof(header);
+        int status = inflate(&stream, Z_SYNC_FLUSH);
+        uint8_t* nul = memchr(header, '\0', sizeof(header) - stream.avail_out);
+        char type[16];
+        unsigned long long size;
+        if ((status == Z_OK || status == Z_STREAM_END) && nul &&
+            sscanf((const char*)header, "%15s %llu", type, &size) == 2) {
+            uint8_t* data = malloc(size > 0 ? size : 1);
+            size_t have = (size_t)(header + sizeof(header) - stream.avail_out - (nul + 1));
+            if (data && have <= size) {
+                memcpy(data, nul + 1, have);
+                stream.next_out = data + have;
+                stream.avail_out = (uInt)(size - have);
+                status = have == size ? Z_STREAM_END : inflate(&stream, Z_FINISH);
+                if (status == Z_STREAM_END) {
+                    *type_out = strcmp(type, "commit") == 0 ? OBJ_COMMIT :
+                                strcmp(type, "tree") == 0 ? OBJ_TREE : OBJ_BLOB;
+                    *data_out = data;
+                    *size_out = (size_t)size;
+                    data = NULL;
+                    result = GVC_SUCCESS;
+                }
+            }
+            free(data);
+        }
+        inflateEnd(&stream);
+    }
+    munmap((void*)file, file_size);
+    return result;
+}
+
+static int read_object(const pack_state_t* state, const uint8_t* oid, int depth,
+                       int* type_out, uint8_t** data_out, size_t* size_out) {
+    for (int i = 0; i < state->num_packs; i++) {
+        uint64_t offset = pack_find(&state->packs[i], oid);
+        if (offset) {
+            return read_pack_object(state, &state->packs[i], offset, depth, type_out, data_out, size_out);
+        }
+    }
+    return read_loose_object(oid, type_out, data_out, size_out);
+}
+
+static void mmap_close(void* arg) {
+    pack_state_t* state = arg;
+    for (int i = 0; i < state->num_packs; i++) {
+        unload_pack(&state->packs[i]);
+    }
+    free(state->packs);
+    free(state);
+}
+
+static int mmap_open(void** state_out, int num_threads) {
+    (void)num_threads;
+    pack_state_t* state = calloc(1, sizeof(*state));
+    if (!state) return GVC_ERROR_MEMORY;
+    
+    char pack_dir[1100];
+    snprintf(pack_dir, sizeof(pack_dir), "%s/objects/pack", git_dir);
+    DIR* dir = opendir(pack_dir);
+    struct dirent* entry;
+    while (dir && (entry = readdir(dir)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        if (length < 5 || strcmp(entry->d_name + length - 4, ".idx") != 0) continue;
+        pack_file_t* packs = realloc(state->packs, sizeof(pack_file_t) * (state->num_packs + 1));
+        if (!packs) break;
+        state->packs = packs;
+        char idx_path[1400];
+        snprintf(idx_path, sizeof(idx_path), "%s/%s", pack_dir, entry->d_name);
+        if (load_pack(idx_path, &state->packs[state->num_packs]) == GVC_SUCCESS) {
+            state->num_packs++;
+        } else {
+            unload_pack(&state->packs[state->num_packs]);
+        }
+    }
+    if (dir) closedir(dir);
+    *state_out = state;
+    return GVC_SUCCESS;
+}
+
+// commit -> "tree <hex>" -> "<mode> frame.bin\0<oid>" -> blob
+static int mmap_read(void* arg, int thread, const char* commit, uint8_t** data_out, size_t* size_out) {
+    (void)thread;
+    const pack_state_t* state = arg;
+    uint8_t oid[20];
+    uint8_t* object;
+    size_t size;
+    int type;
+    if (hex_to_oid(commit, oid) != GVC_SUCCESS) return GVC_ERROR_FORMAT;
+    int result = read_object(state, oid, 0, &type, &object, &size);
+    if (result != GVC_SUCCESS) return result;
+    if (type != OBJ_COMMIT || size < 5 + 40 || memcmp(object, "tree ", 5) != 0 ||
+        hex_to_oid((const char*)object + 5, oid) != GVC_SUCCESS) {
+        free(object);
+        return GVC_ERROR_FORMAT;
+    }
+    free(object);
+    
+    result = read_object(state, oid, 0, &type, &object, &size);
+    if (result != GVC_SUCCESS) return result;
+    result = GVC_ERROR_GIT;
+    for (const uint8_t* p = object; type == OBJ_TREE && p < object + size;) {
+        const uint8_t* nul = memchr(p, '\0', (size_t)(object + size - p));
+        const uint8_t* space = memchr(p, ' ', (size_t)(object + size - p));
+        if (!nul || !space || space > nul || nul + 21 > object + size) break;
+        if (strcmp((const char*)space + 1, "frame.bin") == 0) {
+            memcpy(oid, nul + 1, 20);
+            result = GVC_SUCCESS;
+            break;
+        }
+        p = nul + 21;
+    }
+    free(object);
+    if (result != GVC_SUCCESS) return result;
+    
+    result = read_object(state, oid, 0, &type, data_out, size_out);
+    if (result == GVC_SUCCESS && type != OBJ_BLOB) {
+        free(*data_out);
+        return GVC_ERROR_FORMAT;
+    }
+    return result;
+}
+
+static const storage_backend_t backends[] = {
+    { "popen", popen_open, popen_read, popen_close },
+    { "batch", batch_open, batch_read, batch_close },
+#ifdef GVC_LIBGIT2
+    { "libgit2", libgit2_open, libgit2_read, libgit2_close },
+#endif
+    { "mmap", mmap_open, mmap_read, mmap_close },
+};
+
+#define NUM_BACKENDS ((int)(sizeof(backends) / sizeof(backends[0])))
+
+// ---- runs ----
+
+// Evict every object file from the page cache; 0 if the platform cannot
+static int evict_objects(const char* path) {
+#ifdef POSIX_FADV_DONTNEED
+    DIR* dir = opendir(path);
+    if (!dir) return 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        char child[2048];
+        snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+        struct stat info;
+        if (lstat(child, &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) {
+            evict_objects(child);
+        } else if (S_ISREG(info.st_mode)) {
+            int fd = open(child, O_RDONLY);
+            if (fd >= 0) {
+                fdatasync(fd);  // Dirty pages are not dropped
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+            }
+        }
+    }
+    closedir(dir);
+    return 1;
+#else
+    (void)path;
+    return 0;
+#endif
+}
+
+typedef struct {
+    const storage_backend_t* backend;
+    void* state;
+    char** commits;
+    int num_frames;
+    atomic_int next_frame;
+    uint64_t* latencies_ns;  // Per frame, written by whichever thread read it
+    atomic_ullong bytes;
+    atomic_int errors;
+} storage_run_t;
+
+typedef struct {
+    storage_run_t* run;
+    int thread;
+} storage_worker_t;
+
+static void* storage_worker(void* arg) {
+    storage_worker_t* worker = arg;
+    storage_run_t* run = worker->run;
+    for (;;) {
+        int frame = atomic_fetch_add(&run->next_frame, 1);
+        if (frame >= run->num_frames) break;
+    
+        uint8_t* data = NULL;
+        size_t size = 0;
+        uint64_t start = get_time_ns();
+        int result = run->backend->read(run->state, worker->thread, run->commits[frame], &data, &size);
+        run->latencies_ns[frame] = get_time_ns() - start;
+        if (result == GVC_SUCCESS) {
+            atomic_fetch_add(&run->bytes, size);
+            free(data);
+        } else {
+            atomic_fetch_add(&run->errors, 1);
+        }
+    }
+    return NULL;
+}
+
+// Read every frame once with num_threads threads; returns wall-clock nanoseconds
+static uint64_t read_all(storage_run_t* run, int num_threads) {
+    atomic_store(&run->next_frame, 0);
+    atomic_store(&run->bytes, 0);
+    atomic_store(&run->errors, 0);
+    
+    pthread_t* threads = malloc(sizeof(pthread_t) * num_threads);
+    storage_worker_t* workers = malloc(sizeof(storage_worker_t) * num_threads);
+    if (!threads || !workers) {
+        free(threads);
+        free(workers);
+        return 0;
+    }
+    uint64_t start = get_time_ns();
+    int started = 0;
+    for (; started < num_threads; started++) {
+        workers[started].run = run;
+        workers[started].thread = started;
+        if (pthread_create(&threads[started], NULL, storage_worker, &workers[started]) != 0) break;
+    }
+    if (started == 0) {
+        storage_worker(&workers[0]);  // Read on this thread rather than not at all
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t elapsed = get_time_ns() - start;
+    free(threads);
+    free(workers);
+    return elapsed;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const uint64_t* sorted, int count, double fraction) {
+    int index = (int)(fraction * (count - 1) + 0.5);
+    return sorted[CLAMP(index, 0, count - 1)] / 1e3;
+}
+
+typedef struct {
+    FILE* out;
+    int first_result;
+} storage_report_t;
+
+static void run_backend(storage_report_t* report, const storage_backend_t* backend, char** commits,
+                        int num_frames, int num_threads, cache_mode_t cache) {
+    storage_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.backend = backend;
+    run.commits = commits;
+    run.num_frames = num_frames;
+    run.latencies_ns = calloc(num_frames, sizeof(uint64_t));
+    if (!run.latencies_ns) return;
+    
+    if (cache == CACHE_COLD) {
+        char objects[1100];
+        snprintf(objects, sizeof(objects), "%s/objects", git_dir);
+        evict_objects(objects);
+    }
+    if (backend->open(&run.state, num_threads) != GVC_SUCCESS) {
+        fprintf(stderr, "  %-8s %2d threads %-4s unavailable\n", backend->name, num_threads,
+                cache_mode_names[cache]);
+        free(run.latencies_ns);
+        return;
+    }
+    if (cache == CACHE_WARM) {
+        read_all(&run, num_threads);
+    }
+    uint64_t elapsed_ns = read_all(&run, num_threads);
+    backend->close(run.state);
+    
+    int errors = atomic_load(&run.errors);
+    uint64_t bytes = atomic_load(&run.bytes);
+    double seconds = elapsed_ns / 1e9;
+    double sum_ns = 0;
+    for (int i = 0; i < num_frames; i++) {
+        sum_ns += run.latencies_ns[i];
+    }
+    qsort(run.latencies_ns, num_frames, sizeof(uint64_t), compare_u64);
+    double p50 = percentile_us(run.latencies_ns, num_frames, 0.50);
+    double p99 = percentile_us(run.latencies_ns, num_frames, 0.99);
+    
+    fprintf(report->out, "%s\n  {\"backend\":\"%s\",\"threads\":%d,\"cache\":\"%s\",\"frames\":%d,\"errors\":%d,"
+            "\"bytes\":%llu,\"seconds\":%.6f,\"mb_per_s\":%.3f,\"frames_per_s\":%.1f,"
+            "\"latency_us\":{\"mean\":%.1f,\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f}}",
+            report->first_result ? "" : ",", backend->name, num_threads, cache_mode_names[cache],
+            num_frames, errors, (unsigned long long)bytes, seconds, bytes / 1e6 / MAX(seconds, 1e-9),
+            (num_frames - errors) / MAX(seconds, 1e-9), sum_ns / num_frames / 1e3, p50,
+            percentile_us(run.latencies_ns, num_frames, 0.90), p99,
+            percentile_us(run.latencies_ns, num_frames, 0.999), run.latencies_ns[num_frames - 1] / 1e3);
+    report->first_result = 0;
+    fprintf(stderr, "  %-8s %2d threads %-4s %9.1f MB/s %9.1f frames/s  p50 %8.1f us  p99 %8.1f us%s\n",
+            backend->name, num_threads, cache_mode_names[cache], bytes / 1e6 / MAX(seconds, 1e-9),
+            (num_frames - errors) / MAX(seconds, 1e-9), p50, p99, errors ? "  (read errors)" : "");
+    free(run.latencies_ns);
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-n frames] [-t threads,...] [-b backend,...] [-c cold|warm] [-o results.json] <repo_path>\n",
+           program);
+    printf("\nReads the same frame blobs through each storage backend and writes MB/s,\n");
+    printf("frames/s and per-read latency percentiles as JSON.\n");
+    printf("\nOptions:\n");
+    printf("  -n frames    Frames to read per run, oldest first (default: %d; 0 = all)\n", STORAGE_DEFAULT_FRAMES);
+    printf("  -t list      Thread counts (default: 1 and one per CPU)\n");
+    printf("  -b list      Backends (default: all of");
+    for (int i = 0; i < NUM_BACKENDS; i++) {
+        printf(" %s", backends[i].name);
+    }
+    printf(")\n");
+    printf("  -c mode      Only cold (page cache evicted first) or warm runs (default: both)\n");
+    printf("  -o file      Write the JSON here instead of stdout\n");
+}
+
+static int backend_selected(const char* list, const char* name) {
+    if (!list) return 1;
+    size_t length = strlen(name);
+    for (const char* p = list; (p = strstr(p, name)) != NULL; p += length) {
+        if ((p == list || p[-1] == ',') && (p[length] == ',' || p[length] == '\0')) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int num_frames = STORAGE_DEFAULT_FRAMES;
+    int thread_counts[STORAGE_MAX_THREAD_COUNTS];
+    int num_thread_counts = 0;
+    const char* backend_list = NULL;
+    int only_cache = -1;
+    const char* output_path = NULL;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:b:c:o:")) != -1) {
+        switch (opt) {
+            case 'n':
+                num_frames = atoi(optarg);
+                break;
+            case 't':
+                for (char* token = strtok(optarg, ","); token && num_thread_counts < STORAGE_MAX_THREAD_COUNTS;
+                     token = strtok(NULL, ",")) {
+                    thread_counts[num_thread_counts++] = MAX(atoi(token), 1);
+                }
+                break;
+            case 'b':
+                backend_list = optarg;
+                break;
+            case 'c':
+                only_cache = strcmp(optarg, "cold") == 0 ? CACHE_COLD : strcmp(optarg, "warm") == 0 ? CACHE_WARM : -2;
+                if (only_cache == -2) {
+                    fprintf(stderr, "Unknown cache mode: %s (cold or warm)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (num_thread_counts == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_counts[num_thread_counts++] = 1;
+        if (cpus > 1) thread_counts[num_thread_counts++] = (int)cpus;
+    }
+    
+    // The JSON keeps the real stdout; everything else printed there (libgit2's
+    // progress lines) goes to stderr
+    FILE* out;
+    if (output_path) {
+        out = fopen(output_path, "w");
+    } else {
+        fflush(stdout);
+        int json_fd = dup(STDOUT_FILENO);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        out = json_fd >= 0 ? fdopen(json_fd, "w") : NULL;
+    }
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write results%s%s\n", output_path ? " to " : "",
+                output_path ? output_path : "");
+        return 1;
+    }
+    
+    const char* repo_path = argv[optind];
+    FILE* pipe = NULL;
+    if (chdir(repo_path) != 0 || !(pipe = popen("git rev-parse --absolute-git-dir", "r")) ||
+        !fgets(git_dir, sizeof(git_dir), pipe)) {
+        fprintf(stderr, "Error: Not a Git repository: %s\n", repo_path);
+        if (pipe) pclose(pipe);
+        return 1;
+    }
+    pclose(pipe);
+    git_dir[strcspn(git_dir, "\n")] = '\0';
+    
+    char** commits;
+    int num_commits;
+    if (git_list_commits(&commits, NULL, &num_commits) != GVC_SUCCESS || num_commits == 0) {
+        fprintf(stderr, "Error: No commits in %s\n", repo_path);
+        return 1;
+    }
+    if (num_frames <= 0 || num_frames > num_commits) {
+        num_frames = num_commits;
+    }
+
+#ifndef POSIX_FADV_DONTNEED
+    if (only_cache != CACHE_WARM) {
+        fprintf(stderr, "storage-bench: posix_fadvise is unavailable; cold runs only reflect what the OS kept\n");
+    }
+#endif
+    fprintf(out, "{\"repo\":\"%s\",\"frames\":%d,\"results\":[", repo_path, num_frames);
+    fprintf(stderr, "storage-bench: %d of %d frames in %s\n", num_frames, num_commits, repo_path);
+    
+    storage_report_t report = { .out = out, .first_result = 1 };
+    for (int b = 0; b < NUM_BACKENDS; b++) {
+        if (!backend_selected(backend_list, backends[b].name)) continue;
+        for (int t = 0; t < num_thread_counts; t++) {
+            for (int cache = 0; cache < CACHE_MODE_COUNT; cache++) {
+                if (only_cache >= 0 && cache != only_cache) continue;
+                run_backend(&report, &backends[b], commits, num_frames, thread_counts[t], cache);
+            }
+        }
+    }
+    
+    fprintf(out, "\n]}\n");
+    git_free_commit_list(commits, num_commits);
+    return fclose(out) == 0 ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+#include "git_vid_codec.h"
+#include <zlib.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define GVC_CRC32C_SSE42 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define GVC_CRC32C_ARM 1
+#endif
+
+// Payload checksums. Frames written before the checksum type field carry zlib's
+// CRC32. CRC32C (Castagnoli) has a dedicated instruction on SSE4.2 and ARMv8
+// CPUs that consumes 8 bytes per step, several times faster than zlib's
+// table-driven CRC32; other CPUs fall back to a slicing-by-8 table.
+
+#define CRC32C_POLY 0x82F63B78u  // Reflected Castagnoli polynomial
+
+static uint32_t crc32c_table[8][256];
+static pthread_once_t crc32c_table_once = PTHREAD_ONCE_INIT;
+
+static void init_crc32c_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t previous = crc32c_table[t - 1][i];
+            crc32c_table[t][i] = (previous >> 8) ^ crc32c_table[0][previous & 0xFF];
+        }
+    }
+}
+
+// Frame data is little-endian throughout, so words are read in that order
+static uint32_t crc32c_software(uint32_t crc, const uint8_t* data, size_t size) {
+    pthread_once(&crc32c_table_once, init_crc32c_table);
+    
+    while (size >= 8) {
+        uint32_t low, high;
+        memcpy(&low, data, sizeof(low));
+        memcpy(&high, data + 4, sizeof(high));
+        low ^= crc;
+        crc = crc32c_table[7][low & 0xFF] ^ crc32c_table[6][(low >> 8) & 0xFF] ^
+              crc32c_table[5][(low >> 16) & 0xFF] ^ crc32c_table[4][low >> 24] ^
+              crc32c_table[3][high & 0xFF] ^ crc32c_table[2][(high >> 8) & 0xFF] ^
+              crc32c_table[1][(high >> 16) & 0xFF] ^ crc32c_table[0][high >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+#if GVC_CRC32C_SSE42
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, size_t size) {
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = (uint32_t)crc64;
+    while (size-- > 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+#elif GVC_CRC32C_ARM
+static uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, size_t size) {
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = __crc32cd(crc, word);
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = __crc32cb(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+static uint32_t crc32c(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+#if GVC_CRC32C_SSE42
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ~crc32c_hardware(crc, data, size);
+    }
+#elif GVC_CRC32C_ARM
+    return ~crc32c_hardware(crc, data, size);
+#endif
+    return ~crc32c_software(crc, data, size);
+}
+
+// CRC32 as written by every encoder before CRC32C was added
+uint32_t calculate_checksum(const uint8_t* data, size_t size) {
+    return crc32(0L, data, size);
+}
+
+uint32_t calculate_payload_checksum(uint8_t checksum_type, const uint8_t* data, size_t size) {
+    return checksum_type == CHECKSUM_CRC32C ? crc32c(data, size) : calculate_checksum(data, size);
+}
+
+const char* checksum_name(uint8_t checksum_type) {
+    return checksum_type == CHECKSUM_CRC32C ? "crc32c" : "crc32";
+}
+
+int parse_checksum_type(const char* name, uint8_t* checksum_type_out) {
+    if (!name || !checksum_type_out) return GVC_ERROR_MEMORY;
+    
+    if (strcmp(name, "crc32") == 0) {
+        *checksum_type_out = CHECKSUM_CRC32;
+    } else if (strcmp(name, "crc32c") == 0) {
+        *checksum_type_out = CHECKSUM_CRC32C;
+    } else {
+        return GVC_ERROR_FORMAT;
+    }
+    return GVC_SUCCESS;
+}
+
+// Decoded-pixel hashes: 128 bits over a frame's pixels, so a lossless round trip
+// can be checked end to end. Four 64-bit multiply-rotate lanes (the xxHash64
+// round) consume 32 bytes per step; two differently mixed finalizations of the
+// lanes give the two halves. The frame's layout seeds the lanes, so equal bytes
+// in different shapes hash differently.
+
+#define PIXEL_HASH_PRIME1 0x9E3779B185EBCA87ull
+#define PIXEL_HASH_PRIME2 0xC2B2AE3D27D4EB4Full
+#define PIXEL_HASH_PRIME3 0x165667B19E3779F9ull
+
+static inline uint64_t rotate_left(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t pixel_hash_round(uint64_t lane, uint64_t input) {
+    lane += input * PIXEL_HASH_PRIME2;
+    return rotate_left(lane, 31) * PIXEL_HASH_PRIME1;
+}
+
+static uint64_t pixel_hash_avalanche(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= PIXEL_HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= PIXEL_HASH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+void hash_frame_pixels(const raw_frame_t* frame, pixel_hash_t* hash_out) {
+    const uint8_t* data = frame->pixels;
+    size_t size = raw_frame_size(frame);
+    uint64_t seed = ((uint64_t)frame->width << 32) ^ ((uint64_t)frame->height << 8) ^
+                    ((uint64_t)frame->channels << 4) ^ frame->pixel_format;
+    uint64_t lanes[4] = {seed + PIXEL_HASH_PRIME1 + PIXEL_HASH_PRIME2, seed + PIXEL_HASH_PRIME2,
+                         seed, seed - PIXEL_HASH_PRIME1};
+    
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32) {
+        uint64_t words[4];
+        memcpy(words, data + offset, sizeof(words));
+        lanes[0] = pixel_hash_round(lanes[0], words[0]);
+        lanes[1] = pixel_hash_round(lanes[1], words[1]);
+        lanes[2] = pixel_hash_round(lanes[2], words[2]);
+        lanes[3] = pixel_hash_round(lanes[3], words[3]);
+    }
+    
+    // Tail: whole words, then the last bytes zero-padded (the size is mixed in below)
+    int lane = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        uint64_t word;
+        memcpy(&word, data + offset, sizeof(word));
+        lanes[lane] = pixel_hash_round(lanes[lane], word);
+        lane++;
+    }
+    if (offset < size) {
+        uint64_t word = 0;
+        memcpy(&word, data + offset, size - offset);
+        lanes[lane] = pixel_hash_round(lanes[lane], word);
+    }
+    
+    uint64_t low = rotate_left(lanes[0], 1) + rotate_left(lanes[1], 7) +
+                   rotate_left(lanes[2], 12) + rotate_left(lanes[3], 18);
+    uint64_t high = (lanes[0] * PIXEL_HASH_PRIME3) ^ rotate_left(lanes[1], 29) ^
+                    (lanes[2] * PIXEL_HASH_PRIME2) ^ rotate_left(lanes[3], 47);
+    hash_out->low = pixel_hash_avalanche(low ^ size);
+    hash_out->high = pixel_hash_avalanche(high + size * PIXEL_HASH_PRIME1);
+}
+
+int pixel_hash_equal(const pixel_hash_t* a, const pixel_hash_t* b) {
+    return a->low == b->low && a->high == b->high;
+}
+
+// 32 hex digits, high half first
+void format_pixel_hash(const pixel_hash_t* hash, char* hex_out) {
+    snprintf(hex_out, PIXEL_HASH_HEX_SIZE, "%016llx%016llx",
+             (unsigned long long)hash->high, (unsigned long long)hash->low);
+}
@@ -1,20 +1,99 @@
 #include "git_vid_codec.h"
+#include "probes.h"
 #include <zlib.h>
 #include <compression.h>
 
+static compression_algorithm backend_algorithm(uint8_t backend) {
+    switch (backend) {
+        case BACKEND_LZ4: return COMPRESSION_LZ4;
+        case BACKEND_LZMA: return COMPRESSION_LZMA;
+        default: return COMPRESSION_LZFSE;
+    }
+}
+
+const char* backend_name(uint8_t backend) {
+    switch (backend) {
+        case BACKEND_LZFSE: return "lzfse";
+        case BACKEND_LZ4: return "lz4";
+        case BACKEND_ZLIB: return "zlib";
+        case BACKEND_LZMA: return "lzma";
+        default: return "unknown";
+    }
+}
+
+// Apple's COMPRESSION_ZLIB has no level setting, so the zlib backend calls
+// zlib directly; the others go through the Compression framework
+static size_t backend_encode(uint8_t* dst, size_t dst_size, const uint8_t* src, size_t src_size,
+                             const compression_params_t* params) {
+    uint8_t backend = params ? params->backend : BACKEND_LZFSE;
+    
+    if (backend == BACKEND_ZLIB) {
+        uLongf out_size = dst_size;
+        int level = params->level > 0 ? params->level : Z_DEFAULT_COMPRESSION;
+        if (compress2(dst, &out_size, src, src_size, level) != Z_OK) {
+            return 0;
+        }
+        return out_size;
+    }
+    
+    return compression_encode_buffer(dst, dst_size, src, src_size, NULL, backend_algorithm(backend));
+}
+
+// Output room backend_encode needs for src_size bytes. Apple documents no bound;
+// LZ4, LZMA (xz) and LZFSE store incompressible input as raw blocks, which stays
+// well within a sixteenth plus container headers.
+static size_t backend_encode_bound(size_t src_size, const compression_params_t* params) {
+    if (params && params->backend == BACKEND_ZLIB) {
+        return compressBound(src_size);
+    }
+    return src_size + src_size / 16 + 4096;
+}
+
+static size_t backend_decode(uint8_t* dst, size_t dst_size, const uint8_t* src, size_t src_size,
+                             uint8_t backend) {
+    uint64_t start = telemetry_stage_begin();
+    size_t decoded;
+    
+    if (backend == BACKEND_ZLIB) {
+        uLongf out_size = dst_size;
+        decoded = uncompress(dst, &out_size, src, src_size) == Z_OK ? out_size : 0;
+    } else {
+        decoded = compression_decode_buffer(dst, dst_size, src, src_size, NULL, backend_algorithm(backend));
+    }
+    
+    telemetry_stage_end(TELEMETRY_DECOMPRESS, start);
+    return decoded;
+}
+
+static int same_layout(const raw_frame_t* a, const raw_frame_t* b) {
+    return a->width == b->width && a->height == b->height &&
+           a->channels == b->channels && a->pixel_format == b->pixel_format;
+}
+
+// Largest delta stream for a frame of pixel_count bytes: alternating one-byte
+// identical and different runs cost 2 and 3 bytes
+static size_t delta_stream_bound(size_t pixel_count) {
+    return pixel_count * 2 + pixel_count / 2 + 2;
+}
+
 // Simple delta compression using run-length encoding of differences
 int compress_frame_delta(const raw_frame_t* current, const raw_frame_t* previous, 
-                        frame_t* output) {
+                        const compression_params_t* params, frame_t* output) {
     if (!current || !previous || !output) return GVC_ERROR_MEMORY;
+    if (params && params->entropy_delta) {
+        return compress_frame_delta_rans(current, previous, output);
+    }
     
     if (current->width != previous->width || 
         current->height != previous->height ||
-        current->channels != previous->channels) {
+        current->channels != previous->channels ||
+        current->pixel_format != previous->pixel_format) {
         return GVC_ERROR_FORMAT;
     }
     
-    size_t pixel_count = current->width * current->height * current->channels;
-    uint8_t* delta_buffer = malloc(pixel_count * 2); // Worst case: every pixel different
+    // Planar YUV frames are coded as one run over the concatenated Y, U and V planes
+    size_t pixel_count = raw_frame_size(current);
+    uint8_t* delta_buffer = malloc(delta_stream_bound(pixel_count));
     if (!delta_buffer) return GVC_ERROR_MEMORY;
     
     size_t delta_pos = 0;
@@ -60,28 +139,30 @@ int compress_frame_delta(const raw_frame_t* current, const raw_frame_t* previous
     }
     
     // Apply compression to delta buffer
-    uLongf compressed_size = compressBound(delta_pos);
+    size_t compressed_size = backend_encode_bound(delta_pos, params);
     uint8_t* compressed_data = malloc(compressed_size);
     if (!compressed_data) {
         free(delta_buffer);
         return GVC_ERROR_MEMORY;
     }
     
-    size_t result = compression_encode_buffer(compressed_data, compressed_size,
-                                             delta_buffer, delta_pos,
-                                             NULL, COMPRESSION_LZFSE);
+    size_t result = backend_encode(compressed_data, compressed_size,
+                                  delta_buffer, delta_pos, params);
+    free(delta_buffer);
     if (result == 0) {
         free(compressed_data);
-        free(delta_buffer);
         return GVC_ERROR_COMPRESSION;
     }
     compressed_size = result;
     
     // Fill output frame
+    memset(&output->header, 0, sizeof(output->header));
     output->header.frame_number = 0; // Will be set by caller
     output->header.width = current->width;
     output->header.height = current->height;
     output->header.channels = current->channels;
+    output->header.pixel_format = (uint8_t)current->pixel_format;
+    output->header.backend = params ? params->backend : BACKEND_LZFSE;
     output->header.compressed_size = compressed_size;
     output->header.compression_type = 1; // Delta compression
     output->header.checksum = calculate_checksum(compressed_data, compressed_size);
@@ -92,25 +173,20 @@ int compress_frame_delta(const raw_frame_t* current, const raw_frame_t* previous
     return GVC_SUCCESS;
 }
 
-int decompress_frame_delta(const frame_t* compressed, const raw_frame_t* previous,
-                          raw_frame_t* output) {
-    if (!compressed || !previous || !output) return GVC_ERROR_MEMORY;
-    
-    // Skip checksum verification for performance
-    // uint32_t checksum = calculate_checksum(compressed->data, compressed->data_size);
-    // if (checksum != compressed->header.checksum) {
-    //     return GVC_ERROR_FORMAT;
-    // }
+static int decode_delta_frame(const frame_t* compressed, const raw_frame_t* previous,
+                              raw_frame_t* output) {
     
     // Decompress delta buffer
-    size_t delta_size = compressed->header.width * compressed->header.height * 
-                       compressed->header.channels * 2;
+    size_t delta_size = delta_stream_bound(frame_buffer_size(compressed->header.width,
+                                                             compressed->header.height,
+                                                             compressed->header.channels,
+                                                             compressed->header.pixel_format));
     uint8_t* delta_buffer = malloc(delta_size);
     if (!delta_buffer) return GVC_ERROR_MEMORY;
     
-    size_t decompressed_size = compression_decode_buffer(delta_buffer, delta_size,
-                                                        compressed->data, compressed->data_size,
-                                                        NULL, COMPRESSION_LZFSE);
+    size_t decompressed_size = backend_decode(delta_buffer, delta_size,
+                                              compressed->data, compressed->data_size,
+                                              FRAME_BACKEND(&compressed->header));
     if (decompressed_size == 0) {
         free(delta_buffer);
         return GVC_ERROR_COMPRESSION;
@@ -118,8 +194,14 @@ int decompress_frame_delta(const frame_t* compressed, const raw_frame_t* previou
     delta_size = decompressed_size;
     
     // Allocate output frame
-    size_t pixel_count = compressed->header.width * compressed->header.height * 
-                        compressed->header.channels;
+    size_t pixel_count = frame_buffer_size(compressed->header.width, compressed->header.height,
+                                           compressed->header.channels,
+                                           compressed->header.pixel_format);
+    if (raw_frame_size(previous) != pixel_count) {
+        free(delta_buffer);
+        return GVC_ERROR_FORMAT;
+    }
+    
     output->pixels = malloc(pixel_count);
     if (!output->pixels) {
         free(delta_buffer);
@@ -129,8 +211,10 @@ int decompress_frame_delta(const frame_t* compressed, const raw_frame_t* previou
     output->width = compressed->header.width;
     output->height = compressed->header.height;
     output->channels = compressed->header.channels;
+    output->pixel_format = compressed->header.pixel_format;
     
     // Apply deltas to previous frame
+    uint64_t apply_start = telemetry_stage_begin();
     memcpy(output->pixels, previous->pixels, pixel_count);
     
     size_t delta_pos = 0;
@@ -146,33 +230,230 @@ int decompress_frame_delta(const frame_t* compressed, const raw_frame_t* previou
             // Identical run - pixels already copied, just advance
             pixel_pos += run_length;
         } else if (command == 0x01) {
-            // Different run - apply deltas
+            // Different run - deltas wrap modulo 256, exactly inverting the encoder's
+            // subtraction (clamping corrupted any change larger than +-127)
             for (int i = 0; i < run_length && pixel_pos < pixel_count && delta_pos < delta_size; i++) {
-                int16_t delta = (int8_t)delta_buffer[delta_pos++]; // Sign extend
-                int16_t new_value = (int16_t)output->pixels[pixel_pos] + delta;
-                output->pixels[pixel_pos] = (uint8_t)CLAMP(new_value, 0, 255);
+                output->pixels[pixel_pos] = (uint8_t)(output->pixels[pixel_pos] + delta_buffer[delta_pos++]);
                 pixel_pos++;
             }
         }
     }
+    telemetry_stage_end(TELEMETRY_DELTA_APPLY, apply_start);
     
     free(delta_buffer);
     return GVC_SUCCESS;
 }
 
-int compress_frame_raw(const raw_frame_t* input, frame_t* output) {
+int decompress_frame_delta(const frame_t* compressed, const raw_frame_t* previous,
+                          raw_frame_t* output) {
+    if (!compressed || !previous || !output) return GVC_ERROR_MEMORY;
+    
+    GVC_PROBE2(decompress_delta_start, compressed->header.frame_number, compressed->data_size);
+    int result = decode_delta_frame(compressed, previous, output);
+    GVC_PROBE3(decompress_delta_done, compressed->header.frame_number,
+               result == GVC_SUCCESS ? raw_frame_size(output) : 0, result);
+    return result;
+}
+
+// Entropy-coded delta frames: the same runs as a delta frame, but with commands,
+// run lengths and delta values split into three streams that are each rANS coded
+// with their own statistics instead of going through an LZ backend. Payload:
+//   u32 number of runs, u32 number of delta values,
+//   u32 coded size of the command stream, u32 coded size of the length stream,
+//   command stream, length stream, delta stream (the rest)
+#define DELTA_RANS_PREAMBLE_SIZE (4 * sizeof(uint32_t))
+
+int compress_frame_delta_rans(const raw_frame_t* current, const raw_frame_t* previous,
+                             frame_t* output) {
+    if (!current || !previous || !output) return GVC_ERROR_MEMORY;
+    if (!same_layout(current, previous)) return GVC_ERROR_FORMAT;
+    
+    // A run covers at least one byte, so no stream outgrows the frame
+    size_t pixel_count = raw_frame_size(current);
+    uint8_t* commands = malloc(pixel_count);
+    uint8_t* lengths = malloc(pixel_count);
+    uint8_t* deltas = malloc(pixel_count);
+    if (!commands || !lengths || !deltas) {
+        free(commands);
+        free(lengths);
+        free(deltas);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    size_t num_runs = 0;
+    size_t num_deltas = 0;
+    size_t i = 0;
+    while (i < pixel_count) {
+        int identical = current->pixels[i] == previous->pixels[i];
+        size_t run = 0;
+        while (i + run < pixel_count && run < 255 &&
+               (current->pixels[i + run] == previous->pixels[i + run]) == identical) {
+            if (!identical) {
+                deltas[num_deltas++] = (uint8_t)(current->pixels[i + run] - previous->pixels[i + run]);
+            }
+            run++;
+        }
+        commands[num_runs] = identical ? 0x00 : 0x01;
+        lengths[num_runs] = (uint8_t)run;
+        num_runs++;
+        i += run;
+    }
+    
+    size_t payload_capacity = DELTA_RANS_PREAMBLE_SIZE + 2 * rans_encode_bound(num_runs) +
+                              rans_encode_bound(num_deltas);
+    uint8_t* payload = malloc(payload_capacity);
+    if (!payload) {
+        free(commands);
+        free(lengths);
+        free(deltas);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    uint8_t* out = payload + DELTA_RANS_PREAMBLE_SIZE;
+    uint8_t* payload_end = payload + payload_capacity;
+    size_t command_bytes = rans_encode(commands, num_runs, out, payload_end - out);
+    out += command_bytes;
+    size_t length_bytes = command_bytes ? rans_encode(lengths, num_runs, out, payload_end - out) : 0;
+    out += length_bytes;
+    size_t delta_bytes = length_bytes ? rans_encode(deltas, num_deltas, out, payload_end - out) : 0;
+    out += delta_bytes;
+    
+    free(commands);
+    free(lengths);
+    free(deltas);
+    
+    if (delta_bytes == 0) {
+        free(payload);
+        return GVC_ERROR_COMPRESSION;
+    }
+    
+    uint32_t preamble[4] = {(uint32_t)num_runs, (uint32_t)num_deltas,
+                            (uint32_t)command_bytes, (uint32_t)length_bytes};
+    memcpy(payload, preamble, sizeof(preamble));
+    size_t payload_size = (size_t)(out - payload);
+    
+    memset(&output->header, 0, sizeof(output->header));
+    output->header.frame_number = 0; // Will be set by caller
+    output->header.width = current->width;
+    output->header.height = current->height;
+    output->header.channels = current->channels;
+    output->header.pixel_format = (uint8_t)current->pixel_format;
+    output->header.compressed_size = payload_size;
+    output->header.compression_type = COMPRESSION_TYPE_DELTA_RANS;
+    output->header.checksum = calculate_checksum(payload, payload_size);
+    
+    output->data = payload;
+    output->data_size = payload_size;
+    
+    return GVC_SUCCESS;
+}
+
+int decompress_frame_delta_rans(const frame_t* compressed, const raw_frame_t* previous,
+                               raw_frame_t* output) {
+    if (!compressed || !previous || !output) return GVC_ERROR_MEMORY;
+    
+    const frame_header_t* header = &compressed->header;
+    size_t pixel_count = frame_buffer_size(header->width, header->height, header->channels,
+                                           header->pixel_format);
+    if (raw_frame_size(previous) != pixel_count || !compressed->data ||
+        compressed->data_size < DELTA_RANS_PREAMBLE_SIZE) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    uint32_t preamble[4];
+    memcpy(preamble, compressed->data, sizeof(preamble));
+    size_t num_runs = preamble[0];
+    size_t num_deltas = preamble[1];
+    size_t command_bytes = preamble[2];
+    size_t length_bytes = preamble[3];
+    size_t stream_bytes = compressed->data_size - DELTA_RANS_PREAMBLE_SIZE;
+    if (num_runs > pixel_count || num_deltas > pixel_count ||
+        command_bytes > stream_bytes || length_bytes > stream_bytes - command_bytes) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    const uint8_t* command_stream = compressed->data + DELTA_RANS_PREAMBLE_SIZE;
+    const uint8_t* length_stream = command_stream + command_bytes;
+    const uint8_t* delta_stream = length_stream + length_bytes;
+    size_t delta_bytes = stream_bytes - command_bytes - length_bytes;
+    
+    uint8_t* tokens = malloc(2 * num_runs + num_deltas);
+    if (!tokens) return GVC_ERROR_MEMORY;
+    uint8_t* commands = tokens;
+    uint8_t* lengths = tokens + num_runs;
+    uint8_t* deltas = tokens + 2 * num_runs;
+    
+    uint64_t start = telemetry_stage_begin();
+    int result = rans_decode(command_stream, command_bytes, commands, num_runs);
+    if (result == GVC_SUCCESS) {
+        result = rans_decode(length_stream, length_bytes, lengths, num_runs);
+    }
+    if (result == GVC_SUCCESS) {
+        result = rans_decode(delta_stream, delta_bytes, deltas, num_deltas);
+    }
+    telemetry_stage_end(TELEMETRY_DECOMPRESS, start);
+    if (result != GVC_SUCCESS) {
+        free(tokens);
+        return result;
+    }
+    
+    output->pixels = malloc(pixel_count);
+    if (!output->pixels) {
+        free(tokens);
+        return GVC_ERROR_MEMORY;
+    }
+    output->width = header->width;
+    output->height = header->height;
+    output->channels = header->channels;
+    output->pixel_format = header->pixel_format;
+    start = telemetry_stage_begin();
+    memcpy(output->pixels, previous->pixels, pixel_count);
+    
+    // Deltas wrap modulo 256, exactly inverting the encoder's subtraction
+    size_t pixel_pos = 0;
+    size_t delta_pos = 0;
+    for (size_t run = 0; run < num_runs; run++) {
+        size_t length = lengths[run];
+        if (length > pixel_count - pixel_pos) {
+            result = GVC_ERROR_FORMAT;
+            break;
+        }
+        if (commands[run] == 0x01) {
+            if (length > num_deltas - delta_pos) {
+                result = GVC_ERROR_FORMAT;
+                break;
+            }
+            uint8_t* pixels = output->pixels + pixel_pos;
+            for (size_t j = 0; j < length; j++) {
+                pixels[j] = (uint8_t)(pixels[j] + deltas[delta_pos + j]);
+            }
+            delta_pos += length;
+        }
+        pixel_pos += length;
+    }
+    telemetry_stage_end(TELEMETRY_DELTA_APPLY, start);
+    
+    free(tokens);
+    if (result != GVC_SUCCESS) {
+        free(output->pixels);
+        output->pixels = NULL;
+    }
+    return result;
+}
+
+int compress_frame_raw(const raw_frame_t* input, const compression_params_t* params,
+                      frame_t* output) {
     if (!input || !output) return GVC_ERROR_MEMORY;
     
-    size_t pixel_count = input->width * input->height * input->channels;
+    size_t pixel_count = raw_frame_size(input);
     
     // Apply compression
-    uLongf compressed_size = compressBound(pixel_count);
+    size_t compressed_size = backend_encode_bound(pixel_count, params);
     uint8_t* compressed_data = malloc(compressed_size);
     if (!compressed_data) return GVC_ERROR_MEMORY;
     
-    size_t result = compression_encode_buffer(compressed_data, compressed_size,
-                                             input->pixels, pixel_count,
-                                             NULL, COMPRESSION_LZFSE);
+    size_t result = backend_encode(compressed_data, compressed_size,
+                                  input->pixels, pixel_count, params);
     if (result == 0) {
         free(compressed_data);
         return GVC_ERROR_COMPRESSION;
@@ -180,10 +461,13 @@ int compress_frame_raw(const raw_frame_t* input, frame_t* output) {
     compressed_size = result;
     
     // Fill output frame
+    memset(&output->header, 0, sizeof(output->header));
     output->header.frame_number = 0; // Will be set by caller
     output->header.width = input->width;
     output->header.height = input->height;
     output->header.channels = input->channels;
+    output->header.pixel_format = (uint8_t)input->pixel_format;
+    output->header.backend = params ? params->backend : BACKEND_LZFSE;
     output->header.compressed_size = compressed_size;
     output->header.compression_type = 0; // Raw compression
     output->header.checksum = calculate_checksum(compressed_data, compressed_size);
@@ -194,17 +478,10 @@ int compress_frame_raw(const raw_frame_t* input, frame_t* output) {
     return GVC_SUCCESS;
 }
 
-int decompress_frame_raw(const frame_t* compressed, raw_frame_t* output) {
-    if (!compressed || !output) return GVC_ERROR_MEMORY;
-    
-    // Skip checksum verification for performance
-    // uint32_t checksum = calculate_checksum(compressed->data, compressed->data_size);
-    // if (checksum != compressed->header.checksum) {
-    //     return GVC_ERROR_FORMAT;
-    // }
-    
-    size_t pixel_count = compressed->header.width * compressed->header.height * 
-                        compressed->header.channels;
+static int decode_raw_frame(const frame_t* compressed, raw_frame_t* output) {
+    size_t pixel_count = frame_buffer_size(compressed->header.width, compressed->header.height,
+                                           compressed->header.channels,
+                                           compressed->header.pixel_format);
     
     output->pixels = malloc(pixel_count);
     if (!output->pixels) return GVC_ERROR_MEMORY;
@@ -212,10 +489,11 @@ int decompress_frame_raw(const frame_t* compressed, raw_frame_t* output) {
     output->width = compressed->header.width;
     output->height = compressed->header.height;
     output->channels = compressed->header.channels;
+    output->pixel_format = compressed->header.pixel_format;
     
-    size_t decompressed_size = compression_decode_buffer(output->pixels, pixel_count,
-                                                        compressed->data, compressed->data_size,
-                                                        NULL, COMPRESSION_LZFSE);
+    size_t decompressed_size = backend_decode(output->pixels, pixel_count,
+                                              compressed->data, compressed->data_size,
+                                              FRAME_BACKEND(&compressed->header));
     
     if (decompressed_size == 0 || decompressed_size != pixel_count) {
         free(output->pixels);
@@ -226,6 +504,332 @@ int decompress_frame_raw(const frame_t* compressed, raw_frame_t* output) {
     return GVC_SUCCESS;
 }
 
+int decompress_frame_raw(const frame_t* compressed, raw_frame_t* output) {
+    if (!compressed || !output) return GVC_ERROR_MEMORY;
+    
+    GVC_PROBE2(decompress_raw_start, compressed->header.frame_number, compressed->data_size);
+    int result = decode_raw_frame(compressed, output);
+    GVC_PROBE3(decompress_raw_done, compressed->header.frame_number,
+               result == GVC_SUCCESS ? raw_frame_size(output) : 0, result);
+    return result;
+}
+
+// Repeat frames carry no pixels: the decoder reuses the referenced frame
+int compress_frame_repeat(const raw_frame_t* current, uint32_t reference_frame_number,
+                         frame_t* output) {
+    if (!current || !output) return GVC_ERROR_MEMORY;
+    
+    uint8_t* payload = malloc(sizeof(reference_frame_number));
+    if (!payload) return GVC_ERROR_MEMORY;
+    memcpy(payload, &reference_frame_number, sizeof(reference_frame_number));
+    
+    memset(&output->header, 0, sizeof(output->header));
+    output->header.frame_number = 0; // Will be set by caller
+    output->header.width = current->width;
+    output->header.height = current->height;
+    output->header.channels = current->channels;
+    output->header.pixel_format = (uint8_t)current->pixel_format;
+    output->header.compressed_size = sizeof(reference_frame_number);
+    output->header.compression_type = COMPRESSION_TYPE_REPEAT;
+    output->header.checksum = calculate_checksum(payload, sizeof(reference_frame_number));
+    
+    output->data = payload;
+    output->data_size = sizeof(reference_frame_number);
+    
+    return GVC_SUCCESS;
+}
+
+// Bidirectional frames: the prediction is assembled tile by tile from the past
+// frame, the future frame or their rounded average, and the residual against it
+// is coded exactly like a delta frame. Payload layout:
+//   u32 past frame number, u32 future frame number,
+//   one BIDIR_PREDICT_* byte per BIDIR_TILE_BYTES of frame buffer,
+//   delta payload against the prediction
+#define BIDIR_PREAMBLE_SIZE (2 * sizeof(uint32_t))
+
+static size_t bidir_tile_count(size_t frame_size) {
+    return (frame_size + BIDIR_TILE_BYTES - 1) / BIDIR_TILE_BYTES;
+}
+
+static void build_bidir_prediction(const raw_frame_t* past, const raw_frame_t* future,
+                                   const uint8_t* tile_modes, size_t frame_size, uint8_t* prediction) {
+    for (size_t tile = 0; tile < bidir_tile_count(frame_size); tile++) {
+        size_t offset = tile * BIDIR_TILE_BYTES;
+        size_t length = MIN(BIDIR_TILE_BYTES, frame_size - offset);
+        
+        switch (tile_modes[tile]) {
+            case BIDIR_PREDICT_FUTURE:
+                memcpy(prediction + offset, future->pixels + offset, length);
+                break;
+            case BIDIR_PREDICT_AVERAGE:
+                average_u8(past->pixels + offset, future->pixels + offset, prediction + offset, length);
+                break;
+            default:
+                memcpy(prediction + offset, past->pixels + offset, length);
+                break;
+        }
+    }
+}
+
+int compress_frame_bidir(const raw_frame_t* current, const raw_frame_t* past, const raw_frame_t* future,
+                        uint32_t past_frame_number, uint32_t future_frame_number,
+                        const compression_params_t* params, frame_t* output) {
+    if (!current || !past || !future || !output) return GVC_ERROR_MEMORY;
+    if (!same_layout(current, past) || !same_layout(current, future)) return GVC_ERROR_FORMAT;
+    
+    size_t frame_size = raw_frame_size(current);
+    size_t num_tiles = bidir_tile_count(frame_size);
+    
+    raw_frame_t prediction = *current;
+    prediction.pixels = malloc(frame_size);
+    uint8_t* tile_modes = malloc(num_tiles);
+    if (!prediction.pixels || !tile_modes) {
+        free(prediction.pixels);
+        free(tile_modes);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    // Pick the closest source per tile; the average often wins on smooth motion
+    for (size_t tile = 0; tile < num_tiles; tile++) {
+        size_t offset = tile * BIDIR_TILE_BYTES;
+        size_t length = MIN(BIDIR_TILE_BYTES, frame_size - offset);
+        const uint8_t* target = current->pixels + offset;
+        uint8_t* averaged = prediction.pixels + offset;
+        
+        average_u8(past->pixels + offset, future->pixels + offset, averaged, length);
+        uint64_t sad_average = sum_abs_diff_u8(target, averaged, length);
+        uint64_t sad_past = sum_abs_diff_u8(target, past->pixels + offset, length);
+        uint64_t sad_future = sum_abs_diff_u8(target, future->pixels + offset, length);
+        
+        if (sad_past <= sad_future && sad_past <= sad_average) {
+            tile_modes[tile] = BIDIR_PREDICT_PAST;
+            memcpy(averaged, past->pixels + offset, length);
+        } else if (sad_future <= sad_average) {
+            tile_modes[tile] = BIDIR_PREDICT_FUTURE;
+            memcpy(averaged, future->pixels + offset, length);
+        } else {
+            tile_modes[tile] = BIDIR_PREDICT_AVERAGE;
+        }
+    }
+    
+    // The payload embeds a backend-coded delta frame
+    compression_params_t residual_params = params ? *params : (compression_params_t){0};
+    residual_params.entropy_delta = 0;
+    
+    frame_t residual;
+    int result = compress_frame_delta(current, &prediction, &residual_params, &residual);
+    free(prediction.pixels);
+    if (result != GVC_SUCCESS) {
+        free(tile_modes);
+        return result;
+    }
+    
+    size_t payload_size = BIDIR_PREAMBLE_SIZE + num_tiles + residual.data_size;
+    uint8_t* payload = malloc(payload_size);
+    if (!payload) {
+        free(tile_modes);
+        free_frame(&residual);
+        return GVC_ERROR_MEMORY;
+    }
+    memcpy(payload, &past_frame_number, sizeof(uint32_t));
+    memcpy(payload + sizeof(uint32_t), &future_frame_number, sizeof(uint32_t));
+    memcpy(payload + BIDIR_PREAMBLE_SIZE, tile_modes, num_tiles);
+    memcpy(payload + BIDIR_PREAMBLE_SIZE + num_tiles, residual.data, residual.data_size);
+    free(tile_modes);
+    
+    output->header = residual.header;
+    output->header.compression_type = COMPRESSION_TYPE_BIDIR;
+    output->header.compressed_size = payload_size;
+    output->header.checksum = calculate_checksum(payload, payload_size);
+    output->data = payload;
+    output->data_size = payload_size;
+    
+    free_frame(&residual);
+    return GVC_SUCCESS;
+}
+
+int bidir_frame_references(const frame_t* compressed, uint32_t* past_frame_number_out,
+                           uint32_t* future_frame_number_out) {
+    if (!compressed || !past_frame_number_out || !future_frame_number_out) return GVC_ERROR_MEMORY;
+    if (compressed->header.compression_type != COMPRESSION_TYPE_BIDIR ||
+        !compressed->data || compressed->data_size < BIDIR_PREAMBLE_SIZE) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    memcpy(past_frame_number_out, compressed->data, sizeof(uint32_t));
+    memcpy(future_frame_number_out, compressed->data + sizeof(uint32_t), sizeof(uint32_t));
+    return GVC_SUCCESS;
+}
+
+int decompress_frame_bidir(const frame_t* compressed, const raw_frame_t* past, const raw_frame_t* future,
+                          raw_frame_t* output) {
+    if (!compressed || !output) return GVC_ERROR_MEMORY;
+    if (!past || !future || !same_layout(past, future)) return GVC_ERROR_FORMAT;
+    
+    size_t frame_size = frame_buffer_size(compressed->header.width, compressed->header.height,
+                                          compressed->header.channels,
+                                          compressed->header.pixel_format);
+    size_t num_tiles = bidir_tile_count(frame_size);
+    if (raw_frame_size(past) != frame_size ||
+        compressed->data_size < BIDIR_PREAMBLE_SIZE + num_tiles) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    raw_frame_t prediction = *past;
+    prediction.pixels = malloc(frame_size);
+    if (!prediction.pixels) return GVC_ERROR_MEMORY;
+    uint64_t start = telemetry_stage_begin();
+    build_bidir_prediction(past, future, compressed->data + BIDIR_PREAMBLE_SIZE, frame_size,
+                           prediction.pixels);
+    telemetry_stage_end(TELEMETRY_DELTA_APPLY, start);
+    
+    // The rest of the payload is an ordinary delta frame against the prediction
+    frame_t residual = *compressed;
+    residual.header.compression_type = COMPRESSION_TYPE_DELTA;
+    residual.data = compressed->data + BIDIR_PREAMBLE_SIZE + num_tiles;
+    residual.data_size = compressed->data_size - BIDIR_PREAMBLE_SIZE - num_tiles;
+    
+    int result = decompress_frame_delta(&residual, &prediction, output);
+    free(prediction.pixels);
+    return result;
+}
+
+// Screen-content frames: the block stream from screen_encode_blocks, compressed
+// with the frame's backend. A reference of REFERENCE_LONG_TERM marks an intra
+// frame (no copies from another frame) that becomes the long-term reference, as
+// for raw frames; otherwise the reference is the frame blocks may be copied from.
+int compress_frame_screen(const raw_frame_t* current, const raw_frame_t* reference,
+                         const compression_params_t* params, frame_t* output,
+                         screen_stats_t* stats_out) {
+    if (!current || !output) return GVC_ERROR_MEMORY;
+    
+    screen_stats_t stats;
+    uint8_t* stream;
+    size_t stream_size;
+    int result = screen_encode_blocks(current, reference, &stream, &stream_size, &stats);
+    if (result != GVC_SUCCESS) return result;
+    if (stats_out) {
+        *stats_out = stats;
+    }
+    
+    size_t compressed_size = backend_encode_bound(stream_size, params);
+    uint8_t* compressed_data = malloc(compressed_size);
+    if (!compressed_data) {
+        free(stream);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    size_t encoded = backend_encode(compressed_data, compressed_size, stream, stream_size, params);
+    free(stream);
+    if (encoded == 0) {
+        free(compressed_data);
+        return GVC_ERROR_COMPRESSION;
+    }
+    
+    memset(&output->header, 0, sizeof(output->header));
+    output->header.frame_number = 0; // Will be set by caller
+    output->header.width = current->width;
+    output->header.height = current->height;
+    output->header.channels = current->channels;
+    output->header.pixel_format = (uint8_t)current->pixel_format;
+    output->header.backend = params ? params->backend : BACKEND_LZFSE;
+    output->header.compressed_size = encoded;
+    output->header.compression_type = COMPRESSION_TYPE_SCREEN;
+    output->header.reference = reference ? 0 : REFERENCE_LONG_TERM; // Callers name other references
+    output->header.checksum = calculate_checksum(compressed_data, encoded);
+    
+    output->data = compressed_data;
+    output->data_size = encoded;
+    
+    return GVC_SUCCESS;
+}
+
+int decompress_frame_screen(const frame_t* compressed, const raw_frame_t* reference,
+                           raw_frame_t* output) {
+    if (!compressed || !output) return GVC_ERROR_MEMORY;
+    
+    const frame_header_t* header = &compressed->header;
+    size_t stream_bound = screen_stream_bound(header->width, header->height, header->channels,
+                                              header->pixel_format);
+    uint8_t* stream = malloc(stream_bound);
+    if (!stream) return GVC_ERROR_MEMORY;
+    
+    size_t stream_size = backend_decode(stream, stream_bound, compressed->data, compressed->data_size,
+                                        FRAME_BACKEND(header));
+    if (stream_size == 0) {
+        free(stream);
+        return GVC_ERROR_COMPRESSION;
+    }
+    
+    output->width = header->width;
+    output->height = header->height;
+    output->channels = header->channels;
+    output->pixel_format = header->pixel_format;
+    output->pixels = malloc(frame_buffer_size(header->width, header->height, header->channels,
+                                              header->pixel_format));
+    if (!output->pixels) {
+        free(stream);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    uint64_t start = telemetry_stage_begin();
+    int result = screen_decode_blocks(stream, stream_size, reference, output);
+    telemetry_stage_end(TELEMETRY_DELTA_APPLY, start);
+    free(stream);
+    if (result != GVC_SUCCESS) {
+        free(output->pixels);
+        output->pixels = NULL;
+    }
+    return result;
+}
+
+// Decode any single-reference frame type against its reference (see
+// reference_cache_resolve); the reference may be NULL only for raw frames.
+// Bidirectional frames need two references and go through decode_frame.
+int decompress_frame(const frame_t* compressed, const raw_frame_t* reference,
+                    raw_frame_t* output) {
+    if (!compressed || !output) return GVC_ERROR_MEMORY;
+    
+    switch (compressed->header.compression_type) {
+        case COMPRESSION_TYPE_RAW:
+            return decompress_frame_raw(compressed, output);
+        case COMPRESSION_TYPE_DELTA:
+            if (!reference) return GVC_ERROR_FORMAT;
+            return decompress_frame_delta(compressed, reference, output);
+        case COMPRESSION_TYPE_DELTA_RANS:
+            if (!reference) return GVC_ERROR_FORMAT;
+            return decompress_frame_delta_rans(compressed, reference, output);
+        case COMPRESSION_TYPE_REPEAT: {
+            if (!reference || reference->width != compressed->header.width ||
+                reference->height != compressed->header.height ||
+                reference->pixel_format != compressed->header.pixel_format) {
+                return GVC_ERROR_FORMAT;
+            }
+            uint64_t start = telemetry_stage_begin();
+            int result = copy_raw_frame(reference, output);
+            telemetry_stage_end(TELEMETRY_DELTA_APPLY, start);
+            return result;
+        }
+        case COMPRESSION_TYPE_SCREEN:
+            // Intra screen frames and ones that copy nothing from the reference decode without it
+            return decompress_frame_screen(compressed, reference, output);
+        default:
+            return GVC_ERROR_FORMAT;
+    }
+}
+
+const char* compression_type_name(uint8_t compression_type) {
+    switch (compression_type) {
+        case COMPRESSION_TYPE_RAW: return "raw";
+        case COMPRESSION_TYPE_DELTA: return "delta";
+        case COMPRESSION_TYPE_REPEAT: return "repeat";
+        case COMPRESSION_TYPE_BIDIR: return "bidir";
+        case COMPRESSION_TYPE_SCREEN: return "screen";
+        case COMPRESSION_TYPE_DELTA_RANS: return "delta-rans";
+        default: return "unknown";
+    }
+}
+
 // Batch decompress two frames at once for better SIMD utilization
 int decompress_frames_batch(const frame_t* frame1, const frame_t* frame2,
                            const raw_frame_t* previous_frame __attribute__((unused)),
@@ -234,8 +838,11 @@ int decompress_frames_batch(const frame_t* frame1, const frame_t* frame2,
     
     // Calculate total compressed size for batch operation
     size_t total_compressed_size = frame1->data_size + frame2->data_size;
-    size_t total_decompressed_size = (frame1->header.width * frame1->header.height * frame1->header.channels) +
-                                    (frame2->header.width * frame2->header.height * frame2->header.channels);
+    size_t frame1_size = frame_buffer_size(frame1->header.width, frame1->header.height,
+                                           frame1->header.channels, frame1->header.pixel_format);
+    size_t frame2_size = frame_buffer_size(frame2->header.width, frame2->header.height,
+                                           frame2->header.channels, frame2->header.pixel_format);
+    size_t total_decompressed_size = frame1_size + frame2_size;
     
     // Allocate combined buffers
     uint8_t* combined_compressed = malloc(total_compressed_size);
@@ -252,9 +859,11 @@ int decompress_frames_batch(const frame_t* frame1, const frame_t* frame2,
     memcpy(combined_compressed + frame1->data_size, frame2->data, frame2->data_size);
     
     // Batch decompress using Apple Compression
+    uint64_t start = telemetry_stage_begin();
     size_t actual_decompressed = compression_decode_buffer(combined_decompressed, total_decompressed_size,
                                                           combined_compressed, total_compressed_size,
                                                           NULL, COMPRESSION_ZLIB);
+    telemetry_stage_end(TELEMETRY_DECOMPRESS, start);
     
     free(combined_compressed);
     
@@ -264,9 +873,6 @@ int decompress_frames_batch(const frame_t* frame1, const frame_t* frame2,
     }
     
     // Split decompressed data back into individual frames
-    size_t frame1_size = frame1->header.width * frame1->header.height * frame1->header.channels;
-    size_t frame2_size = frame2->header.width * frame2->header.height * frame2->header.channels;
-    
     // Allocate output frames
     output1->pixels = malloc(frame1_size);
     output2->pixels = malloc(frame2_size);
@@ -286,15 +892,13 @@ int decompress_frames_batch(const frame_t* frame1, const frame_t* frame2,
     output1->width = frame1->header.width;
     output1->height = frame1->header.height;
     output1->channels = frame1->header.channels;
+    output1->pixel_format = frame1->header.pixel_format;
     
     output2->width = frame2->header.width;
     output2->height = frame2->header.height;
     output2->channels = frame2->header.channels;
+    output2->pixel_format = frame2->header.pixel_format;
     
     free(combined_decompressed);
     return GVC_SUCCESS;
 }
-
-uint32_t calculate_checksum(const uint8_t* data, size_t size) {
-    return crc32(0L, data, size);
-}
\ No newline at end of file
@@ -1,4 +1,9 @@
 #include "git_vid_codec.h"
+#include "probes.h"
+
+// Frame shape the window was created for
+static uint32_t display_width = 0;
+static uint32_t display_height = 0;
 
 #ifdef __linux__
 #include <X11/Xlib.h>
@@ -60,6 +65,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 #endif
 
 int display_init(uint32_t width, uint32_t height) {
+    display_width = width;
+    display_height = height;
+    
 #ifdef __linux__
     display = XOpenDisplay(NULL);
     if (!display) return GVC_ERROR_DISPLAY;
@@ -83,21 +91,22 @@ int display_init(uint32_t width, uint32_t height) {
     
     gc = XCreateGC(display, window, 0, NULL);
     
-    // Allocate image data
-    int bytes_per_pixel = (depth == 32) ? 4 : 3;
-    image_data = malloc(width * height * bytes_per_pixel);
-    if (!image_data) {
-        XCloseDisplay(display);
-        return GVC_ERROR_MEMORY;
-    }
-    
+    // The server's pixmap format sets the pixel size: depth 24 is 32 bits per
+    // pixel on most servers (Xvfb included), so size the buffer from the image
     ximage = XCreateImage(display, visual, depth, ZPixmap, 0,
-                         image_data, width, height, 32, 0);
+                         NULL, width, height, 32, 0);
     if (!ximage) {
-        free(image_data);
         XCloseDisplay(display);
         return GVC_ERROR_DISPLAY;
     }
+    image_data = malloc((size_t)ximage->bytes_per_line * height);
+    if (!image_data) {
+        XDestroyImage(ximage);
+        ximage = NULL;
+        XCloseDisplay(display);
+        return GVC_ERROR_MEMORY;
+    }
+    ximage->data = image_data;
     
 #elif __APPLE__
     // Initialize Cocoa application
@@ -206,7 +215,7 @@ int display_init(uint32_t width, uint32_t height) {
     bmi.bmiHeader.biWidth = width;
     bmi.bmiHeader.biHeight = -height; // Top-down DIB
     bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 24;
+    bmi.bmiHeader.biBitCount = 32;
     bmi.bmiHeader.biCompression = BI_RGB;
     
     window_width = width;
@@ -218,57 +227,56 @@ int display_init(uint32_t width, uint32_t height) {
     return GVC_SUCCESS;
 }
 
-int display_frame(const raw_frame_t* frame) {
-    if (!frame || !frame->pixels) return GVC_ERROR_MEMORY;
+static int present_frame(const raw_frame_t* frame) {
+    // The window and image buffers are sized for the stream's first frame
+    if (frame->width != display_width || frame->height != display_height) {
+        return GVC_ERROR_DISPLAY;
+    }
+    
+    // Conversion depends on the frame's pixel format as well as its shape
+    const frame_kernels_t* kernels = select_frame_kernels(frame->width, frame->height,
+                                                          frame->channels, frame->pixel_format);
     
 #ifdef __linux__
     if (!display || !ximage) return GVC_ERROR_DISPLAY;
     
     // Convert RGB to display format
-    int bytes_per_pixel = (depth == 32) ? 4 : 3;
-    
-    for (int y = 0; y < frame->height; y++) {
-        for (int x = 0; x < frame->width; x++) {
-            int src_idx = (y * frame->width + x) * 3;
-            int dst_idx = (y * frame->width + x) * bytes_per_pixel;
-            
-            uint8_t r = frame->pixels[src_idx];
-            uint8_t g = frame->pixels[src_idx + 1];
-            uint8_t b = frame->pixels[src_idx + 2];
-            
-            if (bytes_per_pixel == 4) {
-                image_data[dst_idx] = b;
-                image_data[dst_idx + 1] = g;
-                image_data[dst_idx + 2] = r;
-                image_data[dst_idx + 3] = 0;
-            } else {
-                image_data[dst_idx] = b;
-                image_data[dst_idx + 1] = g;
-                image_data[dst_idx + 2] = r;
+    uint64_t start = telemetry_stage_begin();
+    if (ximage->bits_per_pixel == 32) {
+        kernels->to_bgrx(frame->pixels, (uint8_t*)image_data,
+                         frame->width, frame->height, frame->channels);
+    } else {
+        kernels->to_bgr(frame->pixels, (uint8_t*)image_data,
+                        frame->width, frame->height, frame->channels);
+    
+        // Kernels write packed rows, but X pads each to bytes_per_line. Spread
+        // them out from the bottom up so no row is overwritten before it moves.
+        size_t packed_row = (size_t)frame->width * 3;
+        if ((size_t)ximage->bytes_per_line != packed_row) {
+            for (uint32_t y = frame->height; y-- > 1;) {
+                memmove(image_data + (size_t)y * ximage->bytes_per_line,
+                        image_data + (size_t)y * packed_row, packed_row);
             }
         }
     }
+    telemetry_stage_end(TELEMETRY_CONVERT, start);
     
+    start = telemetry_stage_begin();
     XPutImage(display, window, gc, ximage, 0, 0, 0, 0, 
               frame->width, frame->height);
     XFlush(display);
+    telemetry_stage_end(TELEMETRY_PRESENT, start);
     
 #elif __APPLE__
     if (!bitmapContext || !bitmapData || !window || !imageView) return GVC_ERROR_DISPLAY;
     
     // Convert RGB to RGBA and copy to bitmap context
-    uint8_t* src = frame->pixels;
-    uint8_t* dst = bitmapData;
-    for (uint32_t i = 0; i < frame->width * frame->height; i++) {
-        dst[0] = src[0]; // R
-        dst[1] = src[1]; // G
-        dst[2] = src[2]; // B
-        dst[3] = 255;    // A (fully opaque)
-        src += 3;
-        dst += 4;
-    }
+    uint64_t start = telemetry_stage_begin();
+    kernels->to_rgba(frame->pixels, bitmapData, frame->width, frame->height, frame->channels);
+    telemetry_stage_end(TELEMETRY_CONVERT, start);
     
     // Create CGImage from bitmap context
+    start = telemetry_stage_begin();
     CGImageRef cgImage = CGBitmapContextCreateImage(bitmapContext);
     if (cgImage) {
         // Convert CGImage to NSImage and display
@@ -291,24 +299,25 @@ int display_frame(const raw_frame_t* frame) {
             should_close = 1;
         }
     }
+    telemetry_stage_end(TELEMETRY_PRESENT, start);
     
 #elif _WIN32
     if (!hwnd || !hdc) return GVC_ERROR_DISPLAY;
     
-    // Convert RGB to BGR for Windows
-    uint8_t* bgr_data = malloc(frame->width * frame->height * 3);
-    if (!bgr_data) return GVC_ERROR_MEMORY;
+    // Convert RGB to BGRX for Windows (32-bit rows need no padding at any width)
+    uint8_t* bgrx_data = malloc(frame->width * frame->height * 4);
+    if (!bgrx_data) return GVC_ERROR_MEMORY;
     
-    for (int i = 0; i < frame->width * frame->height; i++) {
-        bgr_data[i * 3] = frame->pixels[i * 3 + 2];     // B
-        bgr_data[i * 3 + 1] = frame->pixels[i * 3 + 1]; // G
-        bgr_data[i * 3 + 2] = frame->pixels[i * 3];     // R
-    }
+    uint64_t start = telemetry_stage_begin();
+    kernels->to_bgrx(frame->pixels, bgrx_data, frame->width, frame->height, frame->channels);
+    telemetry_stage_end(TELEMETRY_CONVERT, start);
     
+    start = telemetry_stage_begin();
     SetDIBitsToDevice(hdc, 0, 0, frame->width, frame->height,
-                     0, 0, 0, frame->height, bgr_data, &bmi, DIB_RGB_COLORS);
+                     0, 0, 0, frame->height, bgrx_data, &bmi, DIB_RGB_COLORS);
+    telemetry_stage_end(TELEMETRY_PRESENT, start);
     
-    free(bgr_data);
+    free(bgrx_data);
     
     // Process Windows messages
     MSG msg;
@@ -322,6 +331,15 @@ int display_frame(const raw_frame_t* frame) {
     return GVC_SUCCESS;
 }
 
+int display_frame(const raw_frame_t* frame) {
+    if (!frame || !frame->pixels) return GVC_ERROR_MEMORY;
+    
+    GVC_PROBE2(display_start, frame->width, frame->height);
+    int result = present_frame(frame);
+    GVC_PROBE2(display_done, raw_frame_size(frame), result);
+    return result;
+}
+
 int display_should_close(void) {
 #ifdef __linux__
     if (!display) return 1;
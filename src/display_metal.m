@@ -4,6 +4,7 @@
 #import <QuartzCore/CAMetalLayer.h>
 #import <Cocoa/Cocoa.h>
 #include "git_vid_codec.h"
+#include "probes.h"
 #include <dispatch/dispatch.h>
 #include <mach/semaphore.h>
 #include <mach/task.h>
@@ -44,6 +45,10 @@ static dispatch_queue_t decodeQueue;
 static dispatch_queue_t displayQueue;
 static volatile int shouldExit = 0;
 
+// Frame shape fixed at display_init
+static uint32_t frameWidth = 0;
+static uint32_t frameHeight = 0;
+
 // Performance monitoring
 static uint64_t frameStartTime;
 static int totalFrames = 0;
@@ -105,7 +110,7 @@ static int ring_buffer_put_frame(uint8_t* pixels) {
     }
     
     // Copy frame data
-    memcpy(slot->pixels, pixels, FRAME_WIDTH * FRAME_HEIGHT * 4); // RGBA
+    memcpy(slot->pixels, pixels, (size_t)frameWidth * frameHeight * 4); // RGBA
     slot->ready = 1;
     
     // Advance write index
@@ -195,7 +200,7 @@ static uint8_t* texturePointers[NUM_BUFFERS];
 
 static int create_metal_textures(void) {
     // Create shared buffers for direct CPU write, GPU read
-    size_t buffer_size = FRAME_WIDTH * FRAME_HEIGHT * 4; // RGBA
+    size_t buffer_size = (size_t)frameWidth * frameHeight * 4; // RGBA
     
     for (int i = 0; i < NUM_BUFFERS; i++) {
         frame_buffers[i] = [device newBufferWithLength:buffer_size
@@ -216,15 +221,15 @@ static int create_metal_textures(void) {
     // Create textures from buffers for GPU rendering
     MTLTextureDescriptor* textureDescriptor = [MTLTextureDescriptor new];
     textureDescriptor.pixelFormat = MTLPixelFormatRGBA8Unorm;
-    textureDescriptor.width = FRAME_WIDTH;
-    textureDescriptor.height = FRAME_HEIGHT;
+    textureDescriptor.width = frameWidth;
+    textureDescriptor.height = frameHeight;
     textureDescriptor.usage = MTLTextureUsageShaderRead;
     textureDescriptor.storageMode = MTLStorageModeShared;
     
     for (int i = 0; i < NUM_BUFFERS; i++) {
         textures[i] = [frame_buffers[i] newTextureWithDescriptor:textureDescriptor
                                                          offset:0
-                                                    bytesPerRow:FRAME_WIDTH * 4];
+                                                    bytesPerRow:frameWidth * 4];
         if (!textures[i]) {
             fprintf(stderr, "Failed to create Metal texture %d\n", i);
             return GVC_ERROR_DISPLAY;
@@ -236,14 +241,17 @@ static int create_metal_textures(void) {
 
 // Display initialization
 int display_init(uint32_t width, uint32_t height) {
-    if (width != FRAME_WIDTH || height != FRAME_HEIGHT) {
+    if (validate_frame_dimensions(width, height, FRAME_CHANNELS) != GVC_SUCCESS) {
         fprintf(stderr, "Unsupported resolution: %dx%d\n", width, height);
         return GVC_ERROR_DISPLAY;
     }
     
+    frameWidth = width;
+    frameHeight = height;
+    
     // Initialize ring buffer
     for (int i = 0; i < RING_BUFFER_SIZE; i++) {
-        frame_ring[i].pixels = malloc(FRAME_WIDTH * FRAME_HEIGHT * 4); // RGBA
+        frame_ring[i].pixels = malloc((size_t)width * height * 4); // RGBA
         frame_ring[i].ready = 0;
         if (!frame_ring[i].pixels) {
             fprintf(stderr, "Failed to allocate ring buffer slot %d\n", i);
@@ -333,18 +341,14 @@ int display_init(uint32_t width, uint32_t height) {
 }
 
 // Direct memory write to shared buffer (zero-copy)
-static void write_frame_to_texture(uint8_t* rgbData, int bufferIndex) {
+static void write_frame_to_texture(const raw_frame_t* frame, int bufferIndex) {
     // Write directly to mapped buffer memory - no CPU copy!
     uint8_t* dst = texturePointers[bufferIndex];
-    uint8_t* src = rgbData;
-    
-    // Fast RGB to RGBA conversion directly into buffer memory
-    for (int i = 0; i < FRAME_WIDTH * FRAME_HEIGHT; i++) {
-        *dst++ = *src++; // R
-        *dst++ = *src++; // G
-        *dst++ = *src++; // B
-        *dst++ = 255;    // A
-    }
+    
+    // RGB or YUV to RGBA conversion directly into buffer memory
+    const frame_kernels_t* kernels = select_frame_kernels(frame->width, frame->height,
+                                                          frame->channels, frame->pixel_format);
+    kernels->to_rgba(frame->pixels, dst, frame->width, frame->height, frame->channels);
 }
 
 // Optimized Metal rendering with minimal object allocation
@@ -377,10 +381,10 @@ static void render_frame(int bufferIndex) {
     }
 }
 
-// High-performance frame display with zero-copy
-int display_frame(const raw_frame_t* frame) {
-    if (!frame || !frame->pixels) {
-        return GVC_ERROR_MEMORY;
+static int present_frame(const raw_frame_t* frame) {
+    // Textures are sized for the stream's first frame
+    if (frame->width != frameWidth || frame->height != frameHeight) {
+        return GVC_ERROR_DISPLAY;
     }
     
     // Wait for available buffer (double-buffering)
@@ -389,10 +393,14 @@ int display_frame(const raw_frame_t* frame) {
     int writeBuffer = atomic_load(&currentWriteBuffer);
     
     // Write directly to mapped texture memory (zero-copy!)
-    write_frame_to_texture(frame->pixels, writeBuffer);
+    uint64_t stage_start = telemetry_stage_begin();
+    write_frame_to_texture(frame, writeBuffer);
+    telemetry_stage_end(TELEMETRY_CONVERT, stage_start);
     
     // Render frame
+    stage_start = telemetry_stage_begin();
     render_frame(writeBuffer);
+    telemetry_stage_end(TELEMETRY_PRESENT, stage_start);
     
     // Advance to next buffer
     atomic_store(&currentWriteBuffer, (writeBuffer + 1) % NUM_BUFFERS);
@@ -414,6 +422,18 @@ int display_frame(const raw_frame_t* frame) {
     return GVC_SUCCESS;
 }
 
+// High-performance frame display with zero-copy
+int display_frame(const raw_frame_t* frame) {
+    if (!frame || !frame->pixels) {
+        return GVC_ERROR_MEMORY;
+    }
+    
+    GVC_PROBE2(display_start, frame->width, frame->height);
+    int result = present_frame(frame);
+    GVC_PROBE2(display_done, raw_frame_size(frame), result);
+    return result;
+}
+
 // Check if window should close
 int display_should_close(void) {
     return shouldExit || ![window isVisible];
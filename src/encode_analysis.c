@@ -0,0 +1,299 @@
+#include "git_vid_codec.h"
+#include <sys/time.h>
+
+// Scene analysis ahead of encoding: measure how much every frame differs from
+// its predecessor across the whole source, then plan frame modes from the
+// global picture. A per-frame encoder can only compare a frame against its
+// immediate neighbour; with the full difference curve we can tell a genuine
+// scene cut from fast but continuous motion.
+//
+// Every encode runs a sampled scan to place keyframes at scene cuts, so delta
+// frames never straddle a cut (where they are larger than intra frames and slow
+// to decode). Two-pass encodes scan every byte instead, which also finds
+// repeated frames that can be stored as references.
+
+typedef struct {
+    const frame_source_t* source;
+    frame_analysis_t* frames;
+    analysis_scan_t scan;
+    int first_frame;
+    int end_frame;
+    int result;
+} analysis_chunk_t;
+
+static int same_frame_layout(const raw_frame_t* a, const raw_frame_t* b) {
+    return a->width == b->width && a->height == b->height &&
+           a->channels == b->channels && a->pixel_format == b->pixel_format;
+}
+
+// Mean absolute difference over every Nth row; frames of different layouts differ maximally.
+// Cuts show up in brightness alone, so YUV frames only sample the luma plane.
+double frame_difference_sampled(const raw_frame_t* current, const raw_frame_t* reference) {
+    if (!same_frame_layout(current, reference)) {
+        return 255.0;
+    }
+    
+    size_t row_bytes = current->pixel_format == PIXEL_FORMAT_YUV420P
+                           ? current->width
+                           : (size_t)current->width * current->channels;
+    uint64_t sad = 0;
+    size_t sampled = 0;
+    for (uint32_t y = 0; y < current->height; y += ANALYSIS_SAMPLE_ROW_STEP) {
+        size_t offset = (size_t)y * row_bytes;
+        sad += sum_abs_diff_u8(current->pixels + offset, reference->pixels + offset, row_bytes);
+        sampled += row_bytes;
+    }
+    return (double)sad / sampled;
+}
+
+// Compare one frame against its predecessor
+static void measure_frame_difference(const raw_frame_t* current, const raw_frame_t* previous,
+                                     analysis_scan_t scan, frame_analysis_t* analysis_out) {
+    if (scan == ANALYSIS_SAMPLED) {
+        analysis_out->mean_abs_diff = frame_difference_sampled(current, previous);
+        return;
+    }
+    
+    if (!same_frame_layout(current, previous)) {
+        analysis_out->mean_abs_diff = 255.0;
+        return;
+    }
+    
+    size_t size = raw_frame_size(current);
+    uint64_t sad = sum_abs_diff_u8(current->pixels, previous->pixels, size);
+    analysis_out->duplicate = sad == 0;
+    analysis_out->mean_abs_diff = (double)sad / size;
+}
+
+// Measure a contiguous range of frames. The source is the encoder's frame window, so
+// the predecessor frame a chunk starts from is shared with the chunk before it.
+static void* analysis_worker(void* arg) {
+    analysis_chunk_t* chunk = (analysis_chunk_t*)arg;
+    const frame_source_t* source = chunk->source;
+    raw_frame_t previous_frame, current_frame;
+    int has_previous = 0;
+    
+    chunk->result = GVC_SUCCESS;
+    
+    if (chunk->first_frame > 0) {
+        chunk->result = source->load(source->ctx, chunk->first_frame - 1, &previous_frame);
+        if (chunk->result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Failed to read frame %d\n", chunk->first_frame - 1);
+            return NULL;
+        }
+        has_previous = 1;
+    }
+    
+    for (int i = chunk->first_frame; i < chunk->end_frame; i++) {
+        chunk->result = source->load(source->ctx, i, &current_frame);
+        if (chunk->result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Failed to read frame %d\n", i);
+            break;
+        }
+        
+        if (has_previous) {
+            measure_frame_difference(&current_frame, &previous_frame, chunk->scan, &chunk->frames[i]);
+            source->release(source->ctx, &previous_frame);
+        }
+        previous_frame = current_frame;
+        has_previous = 1;
+    }
+    
+    if (has_previous) {
+        source->release(source->ctx, &previous_frame);
+    }
+    
+    return NULL;
+}
+
+// A cut stands out both in absolute terms and against the motion around it
+static int is_scene_cut(const frame_analysis_t* frames, int num_frames, int frame_index) {
+    double diff = frames[frame_index].mean_abs_diff;
+    if (diff < ANALYSIS_SCENE_CUT_MIN_DIFF) {
+        return 0;
+    }
+    
+    double window_sum = 0.0;
+    int window_count = 0;
+    int first = MAX(1, frame_index - ANALYSIS_SCENE_WINDOW);
+    int last = MIN(num_frames - 1, frame_index + ANALYSIS_SCENE_WINDOW);
+    for (int i = first; i <= last; i++) {
+        if (i != frame_index) {
+            window_sum += frames[i].mean_abs_diff;
+            window_count++;
+        }
+    }
+    
+    if (window_count == 0) {
+        return 1;
+    }
+    return diff >= ANALYSIS_SCENE_CUT_RATIO * (window_sum / window_count);
+}
+
+static void plan_frame_modes(video_analysis_t* analysis, analysis_scan_t scan,
+                             const keyframe_params_t* keyframes) {
+    frame_analysis_t* frames = analysis->frames;
+    int min_gop = keyframes ? MAX(1, keyframes->min_gop) : DEFAULT_MIN_GOP;
+    int max_gop = keyframes ? MAX(min_gop, keyframes->max_gop) : DEFAULT_MAX_GOP;
+    int last_keyframe = 0;
+    int in_static_span = 0;
+    
+    frames[0].keyframe = 1;
+    frames[0].mode = FRAME_MODE_INTRA;
+    analysis->keyframes = 1;
+    
+    for (int i = 1; i < analysis->num_frames; i++) {
+        int since_keyframe = i - last_keyframe;
+        frames[i].gop_start = last_keyframe;
+        
+        // A forced keyframe takes precedence, so repeats never extend a chain past max_gop
+        if (frames[i].duplicate && since_keyframe < max_gop) {
+            frames[i].mode = FRAME_MODE_REPEAT;
+            analysis->duplicate_frames++;
+            if (!in_static_span) {
+                analysis->static_spans++;
+                in_static_span = 1;
+            }
+            continue;
+        }
+        in_static_span = 0;
+        
+        if (is_scene_cut(frames, analysis->num_frames, i)) {
+            frames[i].scene_cut = 1;
+            analysis->scene_cuts++;
+        }
+        
+        if (since_keyframe >= max_gop || (frames[i].scene_cut && since_keyframe >= min_gop)) {
+            frames[i].keyframe = 1;
+            frames[i].mode = FRAME_MODE_INTRA;
+            analysis->keyframes++;
+            frames[i].gop_start = i;
+            last_keyframe = i;
+        } else {
+            // Sampled scans leave the intra/delta choice between keyframes to the profile
+            frames[i].mode = scan == ANALYSIS_FULL ? FRAME_MODE_DELTA : FRAME_MODE_AUTO;
+        }
+    }
+}
+
+int analyze_video(const frame_source_t* source, int num_threads, analysis_scan_t scan,
+                  const keyframe_params_t* keyframes, video_analysis_t* analysis_out) {
+    if (!source || !source->load || !source->release || !analysis_out) return GVC_ERROR_MEMORY;
+    if (source->num_frames <= 0) return GVC_ERROR_FORMAT;
+    
+    memset(analysis_out, 0, sizeof(*analysis_out));
+    
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);
+    
+    analysis_out->num_frames = source->num_frames;
+    analysis_out->frames = calloc(source->num_frames, sizeof(frame_analysis_t));
+    if (!analysis_out->frames) return GVC_ERROR_MEMORY;
+    
+    num_threads = MAX(1, MIN(num_threads, source->num_frames));
+    analysis_chunk_t* chunks = calloc(num_threads, sizeof(analysis_chunk_t));
+    pthread_t* workers = malloc(sizeof(pthread_t) * num_threads);
+    if (!chunks || !workers) {
+        free(chunks);
+        free(workers);
+        free_video_analysis(analysis_out);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    int frames_per_chunk = (source->num_frames + num_threads - 1) / num_threads;
+    int num_started = 0;
+    for (int i = 0; i < num_threads; i++) {
+        chunks[i].source = source;
+        chunks[i].frames = analysis_out->frames;
+        chunks[i].scan = scan;
+        chunks[i].first_frame = i * frames_per_chunk;
+        chunks[i].end_frame = MIN(source->num_frames, (i + 1) * frames_per_chunk);
+        chunks[i].result = GVC_ERROR_THREAD;
+        if (chunks[i].first_frame >= chunks[i].end_frame) {
+            chunks[i].result = GVC_SUCCESS;
+            continue;
+        }
+        if (pthread_create(&workers[num_started], NULL, analysis_worker, &chunks[i]) != 0) {
+            break;
+        }
+        num_started++;
+    }
+    
+    for (int i = 0; i < num_started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    
+    int result = GVC_SUCCESS;
+    for (int i = 0; i < num_threads && result == GVC_SUCCESS; i++) {
+        result = chunks[i].result;
+    }
+    
+    free(chunks);
+    free(workers);
+    
+    if (result != GVC_SUCCESS) {
+        free_video_analysis(analysis_out);
+        return result;
+    }
+    
+    plan_frame_modes(analysis_out, scan, keyframes);
+    
+    gettimeofday(&end_time, NULL);
+    analysis_out->elapsed_seconds = (end_time.tv_sec - start_time.tv_sec) +
+                                    (end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+    
+    printf("Analysis (%s): %d frames, %d keyframes, %d scene cuts",
+           scan == ANALYSIS_FULL ? "full" : "sampled", analysis_out->num_frames,
+           analysis_out->keyframes, analysis_out->scene_cuts);
+    if (scan == ANALYSIS_FULL) {
+        printf(", %d duplicate frames in %d static spans",
+               analysis_out->duplicate_frames, analysis_out->static_spans);
+    }
+    printf(" (%.2fs)\n", analysis_out->elapsed_seconds);
+    
+    return GVC_SUCCESS;
+}
+
+static int is_inter_mode(const frame_analysis_t* frame) {
+    return !frame->keyframe && (frame->mode == FRAME_MODE_DELTA || frame->mode == FRAME_MODE_AUTO);
+}
+
+// Turn every other inter frame into a bidirectional one where the following frame
+// is also inter coded within the same GOP. Only one B frame sits between its two
+// references, so a decoder holds back at most one frame.
+void plan_bidir_frames(video_analysis_t* analysis) {
+    if (!analysis || !analysis->frames) return;
+    
+    frame_analysis_t* frames = analysis->frames;
+    analysis->bidir_frames = 0;
+    for (int i = 1; i + 1 < analysis->num_frames; i++) {
+        if (is_inter_mode(&frames[i]) && is_inter_mode(&frames[i + 1]) &&
+            frames[i - 1].mode != FRAME_MODE_BIDIR) {
+            frames[i].mode = FRAME_MODE_BIDIR;
+            analysis->bidir_frames++;
+        }
+    }
+}
+
+// Order frames are coded and committed in: each B frame follows its future reference
+int plan_coding_order(const video_analysis_t* analysis, int* order_out) {
+    if (!analysis || !analysis->frames || !order_out) return 0;
+    
+    int count = 0;
+    for (int i = 0; i < analysis->num_frames; i++) {
+        if (analysis->frames[i].mode == FRAME_MODE_BIDIR) continue;
+        order_out[count++] = i;
+        if (i > 0 && analysis->frames[i - 1].mode == FRAME_MODE_BIDIR) {
+            order_out[count++] = i - 1;
+        }
+    }
+    return count;
+}
+
+void free_video_analysis(video_analysis_t* analysis) {
+    if (analysis && analysis->frames) {
+        free(analysis->frames);
+        analysis->frames = NULL;
+        analysis->num_frames = 0;
+    }
+}
@@ -0,0 +1,389 @@
+#include "git_vid_codec.h"
+#include <unistd.h>
+#include <sys/time.h>
+
+// Encode pipeline: worker threads read, compress, serialize and store frame
+// blobs several frames ahead, while the calling thread commits them in order.
+// Delta frames only depend on earlier *source* frames (the codec is lossless, so
+// they equal what the decoder will hold), so every frame can be compressed
+// independently; only the parent-linked commit chain is serial. Workers and the
+// scene analysis pull frames through one frame window, so a frame is loaded once
+// however many workers use it as a reference.
+//
+// Frames are handed out and committed in coding order, which differs from frame
+// order only when B frames are enabled: a bidirectional frame is committed after
+// the frame that follows it, so a player has decoded both its references first.
+
+typedef struct {
+    int position;      // Coding-order position occupying this slot, -1 when free
+    int done;
+    int result;
+    size_t raw_size;   // Uncompressed pixel bytes of the source frame
+    double decode_seconds;  // Sampled decode time, < 0 when not sampled
+    char blob_hash[GIT_HASH_SIZE + 1];
+    frame_header_t header;
+} pipeline_slot_t;
+
+typedef struct {
+    const frame_source_t* source;
+    const encode_profile_t* profile;
+    const video_analysis_t* analysis;  // Planned keyframes and frame modes
+    const int* coding_order; // Frame index at each coding position
+    pipeline_slot_t* slots;
+    int window;              // Number of slots; frames in flight ahead of the commit stage
+    int next_position;       // Next coding position to hand to a worker
+    int abort;
+    pthread_mutex_t mutex;
+    pthread_cond_t slot_done;
+    pthread_cond_t slot_free;
+} pipeline_t;
+
+static int get_online_cpus(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+// Frames a delta may predict from: the most recent ones back to the GOP's keyframe,
+// plus the keyframe itself as the long-term reference when it is further back.
+// B frames are never cached by a decoder, so they are never candidates; a B frame
+// itself predicts from exactly the frames either side of it.
+static int plan_references(const encode_profile_t* profile, const frame_analysis_t* frames,
+                           int frame_index, int* frame_indices, uint8_t* references) {
+    const frame_analysis_t* analysis = &frames[frame_index];
+    if (frame_index == 0 || analysis->mode == FRAME_MODE_INTRA) {
+        return 0;
+    }
+    
+    if (analysis->mode == FRAME_MODE_BIDIR) {
+        // Its future reference was decoded last, so name the past one explicitly
+        frame_indices[0] = frame_index - 1;
+        references[0] = 1;
+        return 1;
+    }
+    
+    int max_references = profile ? MAX(1, MIN(profile->max_references, REFERENCE_CACHE_SIZE)) : 1;
+    int count = 0;
+    for (int distance = 1; distance <= max_references; distance++) {
+        if (frame_index - distance < analysis->gop_start) break;
+        if (frames[frame_index - distance].mode == FRAME_MODE_BIDIR) continue;
+        frame_indices[count] = frame_index - distance;
+        references[count] = distance == 1 ? 0 : (uint8_t)distance;
+        count++;
+    }
+    if (max_references > 1 && frame_index - analysis->gop_start > max_references) {
+        frame_indices[count] = analysis->gop_start;
+        references[count] = REFERENCE_LONG_TERM;
+        count++;
+    }
+    return count;
+}
+
+// Load, compress and store one frame as a blob
+static int encode_pipeline_frame(const frame_source_t* source, const encode_profile_t* profile,
+                                 const frame_analysis_t* frames, int frame_index,
+                                 pipeline_slot_t* slot) {
+    const frame_analysis_t* analysis = &frames[frame_index];
+    raw_frame_t current_frame;
+    raw_frame_t future_frame;
+    raw_frame_t reference_frames[REFERENCE_CACHE_SIZE + 1];
+    int reference_indices[REFERENCE_CACHE_SIZE + 1];
+    reference_set_t references;
+    memset(&references, 0, sizeof(references));
+    
+    uint64_t span_start = trace_begin();
+    int result = source->load(source->ctx, frame_index, &current_frame);
+    if (result != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Failed to read frame %d\n", frame_index);
+        return result;
+    }
+    
+    int num_references = plan_references(profile, frames, frame_index, reference_indices,
+                                         references.references);
+    for (int i = 0; i < num_references; i++) {
+        result = source->load(source->ctx, reference_indices[i], &reference_frames[i]);
+        if (result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Failed to read frame %d\n", reference_indices[i]);
+            break;
+        }
+        references.frames[i] = &reference_frames[i];
+        references.frame_numbers[i] = (uint32_t)reference_indices[i];
+        references.count++;
+    }
+    
+    if (result == GVC_SUCCESS && analysis->mode == FRAME_MODE_BIDIR) {
+        result = source->load(source->ctx, frame_index + 1, &future_frame);
+        if (result == GVC_SUCCESS) {
+            references.future = &future_frame;
+            references.future_frame_number = (uint32_t)(frame_index + 1);
+        } else {
+            fprintf(stderr, "Error: Failed to read frame %d\n", frame_index + 1);
+        }
+    }
+    trace_end("load", span_start);
+    
+    if (result == GVC_SUCCESS) {
+        slot->raw_size = raw_frame_size(&current_frame);
+        slot->decode_seconds = -1.0;
+        int sample_decode = (frame_index % PIPELINE_DECODE_SAMPLE_INTERVAL) == 0;
+        
+        result = encode_frame_to_blob(&current_frame, &references, (uint32_t)frame_index, profile,
+                                      analysis->mode, slot->blob_hash, &slot->header,
+                                      sample_decode ? &slot->decode_seconds : NULL);
+        if (result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Failed to encode frame %d\n", frame_index);
+        }
+    }
+    
+    for (int i = 0; i < references.count; i++) {
+        source->release(source->ctx, &reference_frames[i]);
+    }
+    if (references.future) {
+        source->release(source->ctx, &future_frame);
+    }
+    source->release(source->ctx, &current_frame);
+    
+    return result;
+}
+
+static void* pipeline_worker(void* arg) {
+    pipeline_t* pipeline = (pipeline_t*)arg;
+    trace_thread_name("encode worker");
+    telemetry_bind_thread();  // Spans for the sampled decodes
+    
+    uint64_t span_start = trace_begin();
+    pthread_mutex_lock(&pipeline->mutex);
+    trace_end("lock pipeline", span_start);
+    while (!pipeline->abort && pipeline->next_position < pipeline->source->num_frames) {
+        int position = pipeline->next_position;
+        pipeline_slot_t* slot = &pipeline->slots[position % pipeline->window];
+        
+        // Don't run further ahead than the window allows
+        if (slot->position != -1) {
+            span_start = trace_begin();
+            pthread_cond_wait(&pipeline->slot_free, &pipeline->mutex);
+            trace_end("wait slot_free", span_start);
+            continue;
+        }
+        
+        slot->position = position;
+        slot->done = 0;
+        pipeline->next_position++;
+        pthread_mutex_unlock(&pipeline->mutex);
+        
+        trace_set_frame(pipeline->coding_order[position]);
+        span_start = trace_begin();
+        int result = encode_pipeline_frame(pipeline->source, pipeline->profile,
+                                           pipeline->analysis->frames,
+                                           pipeline->coding_order[position], slot);
+        trace_end("encode frame", span_start);
+        trace_set_frame(-1);
+        
+        span_start = trace_begin();
+        pthread_mutex_lock(&pipeline->mutex);
+        trace_end("lock pipeline", span_start);
+        slot->result = result;
+        slot->done = 1;
+        pthread_cond_broadcast(&pipeline->slot_done);
+    }
+    pthread_mutex_unlock(&pipeline->mutex);
+    
+    return NULL;
+}
+
+int encode_pipeline_run(const frame_source_t* source, const encode_options_t* options,
+                        encode_stats_t* stats_out) {
+    if (!source || !source->load || !source->release) return GVC_ERROR_MEMORY;
+    
+    int num_threads = (options && options->num_threads > 0) ? options->num_threads : get_online_cpus();
+    num_threads = MAX(1, MIN(num_threads, source->num_frames));
+    
+    // Room for the frames being coded plus everything they may reference
+    frame_window_t frames;
+    int window_result = frame_window_init(&frames, source, num_threads * 2 + REFERENCE_CACHE_SIZE + 2);
+    if (window_result != GVC_SUCCESS) return window_result;
+    frame_source_t shared;
+    frame_window_source(&frames, &shared);
+    
+    // Place keyframes at scene cuts before any frame is coded
+    trace_thread_name("commit");
+    uint64_t span_start = trace_begin();
+    video_analysis_t analysis;
+    int analysis_result = analyze_video(&shared, num_threads,
+                                        (options && options->two_pass) ? ANALYSIS_FULL : ANALYSIS_SAMPLED,
+                                        options ? &options->keyframes : NULL, &analysis);
+    trace_end("analyze", span_start);
+    if (analysis_result != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Scene analysis failed\n");
+        frame_window_destroy(&frames);
+        return analysis_result;
+    }
+    
+    int* coding_order = malloc(sizeof(int) * source->num_frames);
+    if (!coding_order) {
+        free_video_analysis(&analysis);
+        frame_window_destroy(&frames);
+        return GVC_ERROR_MEMORY;
+    }
+    if (options && options->bframes) {
+        plan_bidir_frames(&analysis);
+    }
+    plan_coding_order(&analysis, coding_order);
+    
+    pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.source = &shared;
+    pipeline.profile = options ? &options->profile : NULL;
+    pipeline.analysis = &analysis;
+    pipeline.coding_order = coding_order;
+    pipeline.window = num_threads * PIPELINE_FRAMES_PER_THREAD;
+    pipeline.slots = malloc(sizeof(pipeline_slot_t) * pipeline.window);
+    if (!pipeline.slots) {
+        free(coding_order);
+        free_video_analysis(&analysis);
+        frame_window_destroy(&frames);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    for (int i = 0; i < pipeline.window; i++) {
+        pipeline.slots[i].position = -1;
+    }
+    
+    pthread_mutex_init(&pipeline.mutex, NULL);
+    pthread_cond_init(&pipeline.slot_done, NULL);
+    pthread_cond_init(&pipeline.slot_free, NULL);
+    
+    pthread_t* workers = malloc(sizeof(pthread_t) * num_threads);
+    if (!workers) {
+        free(pipeline.slots);
+        free(coding_order);
+        free_video_analysis(&analysis);
+        frame_window_destroy(&frames);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);
+    
+    int num_started = 0;
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&workers[i], NULL, pipeline_worker, &pipeline) != 0) {
+            break;
+        }
+        num_started++;
+    }
+    
+    int result = num_started > 0 ? GVC_SUCCESS : GVC_ERROR_THREAD;
+    char commit_hash[GIT_HASH_SIZE + 1] = {0};
+    char parent_hash[GIT_HASH_SIZE + 1] = {0};
+    size_t encoded_bytes = 0;
+    size_t original_bytes = 0;
+    int frames_committed = 0;
+    int intra_frames = 0;
+    int repeat_frames = 0;
+    int bidir_frames = 0;
+    int screen_frames = 0;
+    double decode_seconds = 0.0;
+    int decode_samples = 0;
+    
+    printf("Encoding %d frames with %d worker threads\n", source->num_frames, num_started);
+    
+    // Ordered commit stage
+    for (int i = 0; i < source->num_frames && result == GVC_SUCCESS; i++) {
+        pipeline_slot_t* slot = &pipeline.slots[i % pipeline.window];
+        trace_set_frame(coding_order[i]);
+        
+        span_start = trace_begin();
+        pthread_mutex_lock(&pipeline.mutex);
+        while (!(slot->position == i && slot->done)) {
+            pthread_cond_wait(&pipeline.slot_done, &pipeline.mutex);
+        }
+        pthread_mutex_unlock(&pipeline.mutex);
+        trace_end("wait slot_done", span_start);
+        
+        result = slot->result;
+        if (result == GVC_SUCCESS) {
+            span_start = trace_begin();
+            result = commit_encoded_frame(slot->blob_hash, &slot->header,
+                                          i == 0 ? NULL : parent_hash, commit_hash);
+            trace_end("commit", span_start);
+            if (result != GVC_SUCCESS) {
+                fprintf(stderr, "Error: Failed to commit frame %d\n", coding_order[i]);
+            }
+        }
+        
+        if (result == GVC_SUCCESS) {
+            encoded_bytes += slot->header.compressed_size;
+            original_bytes += slot->raw_size;
+            strcpy(parent_hash, commit_hash);
+            frames_committed++;
+            if (slot->header.compression_type == COMPRESSION_TYPE_RAW) {
+                intra_frames++;
+            } else if (slot->header.compression_type == COMPRESSION_TYPE_REPEAT) {
+                repeat_frames++;
+            } else if (slot->header.compression_type == COMPRESSION_TYPE_BIDIR) {
+                bidir_frames++;
+            } else if (slot->header.compression_type == COMPRESSION_TYPE_SCREEN) {
+                screen_frames++;
+            }
+            if (slot->decode_seconds >= 0) {
+                decode_seconds += slot->decode_seconds;
+                decode_samples++;
+            }
+        }
+        
+        // Hand the slot back to the workers
+        pthread_mutex_lock(&pipeline.mutex);
+        slot->position = -1;
+        if (result != GVC_SUCCESS) {
+            pipeline.abort = 1;
+        }
+        pthread_cond_broadcast(&pipeline.slot_free);
+        pthread_mutex_unlock(&pipeline.mutex);
+        
+        // Progress indicator
+        if (i % 60 == 0 || i == source->num_frames - 1) {
+            printf("Progress: %d/%d frames (%.1f%%)\n",
+                   i + 1, source->num_frames,
+                   (float)(i + 1) / source->num_frames * 100.0f);
+        }
+    }
+    
+    trace_set_frame(-1);
+    pthread_mutex_lock(&pipeline.mutex);
+    pipeline.abort = 1;
+    pthread_cond_broadcast(&pipeline.slot_free);
+    pthread_mutex_unlock(&pipeline.mutex);
+    
+    for (int i = 0; i < num_started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    
+    gettimeofday(&end_time, NULL);
+    double elapsed = (end_time.tv_sec - start_time.tv_sec) +
+                     (end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+    
+    if (stats_out) {
+        stats_out->frames_encoded = frames_committed;
+        stats_out->num_threads = num_started;
+        stats_out->intra_frames = intra_frames;
+        stats_out->repeat_frames = repeat_frames;
+        stats_out->bidir_frames = bidir_frames;
+        stats_out->screen_frames = screen_frames;
+        stats_out->original_bytes = original_bytes;
+        stats_out->encoded_bytes = encoded_bytes;
+        stats_out->elapsed_seconds = elapsed;
+        stats_out->encode_fps = elapsed > 0 ? frames_committed / elapsed : 0.0;
+        stats_out->decode_ms_per_frame = decode_samples > 0 ? decode_seconds * 1000.0 / decode_samples : 0.0;
+    }
+    
+    pthread_cond_destroy(&pipeline.slot_free);
+    pthread_cond_destroy(&pipeline.slot_done);
+    pthread_mutex_destroy(&pipeline.mutex);
+    free(workers);
+    free(pipeline.slots);
+    free(coding_order);
+    free_video_analysis(&analysis);
+    frame_window_destroy(&frames);
+    
+    return result;
+}
@@ -1,19 +1,140 @@
 #include "git_vid_codec.h"
+#include <unistd.h>
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-j threads] [-p format] [-S WxH] [-e preset] [-l level] [-g max] [-G min] [-2] [-b] [-s] [-r] [-c checksum] [-t trace.json] <input_path|test|synth:class> <output_repo_path>\n", program);
+    printf("\nOptions:\n");
+    printf("  -j threads   Encoder worker threads (default: one per CPU)\n");
+    printf("  -p format    Pixel format of input frame files: rgb24 or yuv420p (default: rgb24)\n");
+    printf("  -S WxH       Size of input frame files and synthetic frames (default: %dx%d)\n",
+           FRAME_WIDTH, FRAME_HEIGHT);
+    printf("  -e preset    Encoder effort (default: balanced):\n");
+    printf("                 fast      LZ4, delta every frame (live ingest)\n");
+    printf("                 balanced  LZFSE, estimated intra/delta choice\n");
+    printf("                 max       LZMA, intra and delta tried per frame (archives)\n");
+    printf("  -l level     Compress payloads with zlib at this level (1-9) instead of the\n");
+    printf("               preset's backend\n");
+    printf("  -g frames    Maximum keyframe interval (default: %d)\n", DEFAULT_MAX_GOP);
+    printf("  -G frames    Minimum keyframe interval at scene cuts (default: %d)\n", DEFAULT_MIN_GOP);
+    printf("  -2           Two-pass: analyze every byte of the input first and store\n");
+    printf("               repeated frames as references\n");
+    printf("  -b           B frames: predict alternate frames from both neighbours\n");
+    printf("  -s           Screen content: palette and block-copy coding for recordings\n");
+    printf("  -r           Entropy-code delta frames with rANS instead of the backend\n");
+    printf("               (faster to decode, larger on camera footage)\n");
+    printf("  -c checksum  Payload checksum: crc32c (default, hardware-accelerated)\n");
+    printf("               or crc32\n");
+    printf("  -t file      Write a per-thread timeline of the encode as Chrome trace-event\n");
+    printf("               JSON (open in chrome://tracing or ui.perfetto.dev)\n");
+    printf("\nInput 'test' is a generated gradient; 'synth:class' is other generated content,\n");
+    printf("one of static, pan, zoom, noise, text, scene_cuts or demo (600 frames each).\n");
+    printf("\nExamples:\n");
+    printf("  %s test ./video_repo          # Generate test frames\n", program);
+    printf("  %s synth:text ./video_repo    # Synthetic desktop recording\n", program);
+    printf("  %s ./frames ./video_repo      # Encode from frame files\n", program);
+}
 
 // Main function for encoder binary
 int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        printf("Usage: %s <input_path|test> <output_repo_path>\n", argv[0]);
-        printf("\nExamples:\n");
-        printf("  %s test ./video_repo          # Generate test frames\n", argv[0]);
-        printf("  %s ./frames ./video_repo      # Encode from frame files\n", argv[0]);
+    encode_options_t options;
+    encode_options_init(&options);
+    
+    int screen_content = 0;
+    int entropy_delta = 0;
+    int zlib_level = 0;
+    uint8_t checksum = CHECKSUM_CRC32C;
+    const char* trace_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:p:S:e:l:g:G:2bsrc:t:")) != -1) {
+        switch (opt) {
+            case 'j':
+                options.num_threads = atoi(optarg);
+                break;
+            case 'p':
+                if (parse_pixel_format(optarg, &options.pixel_format) != GVC_SUCCESS) {
+                    fprintf(stderr, "Unknown pixel format: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'S':
+                if (sscanf(optarg, "%ux%u", &options.width, &options.height) != 2 ||
+                    validate_frame_dimensions(options.width, options.height, FRAME_CHANNELS) != GVC_SUCCESS) {
+                    fprintf(stderr, "Invalid frame size: %s (WxH, up to %dx%d)\n", optarg,
+                            MAX_FRAME_WIDTH, MAX_FRAME_HEIGHT);
+                    return 1;
+                }
+                break;
+            case 'e':
+                if (parse_encode_preset(optarg, &options.profile) != GVC_SUCCESS) {
+                    fprintf(stderr, "Unknown preset: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'l':
+                zlib_level = atoi(optarg);
+                if (zlib_level < 1 || zlib_level > 9) {
+                    fprintf(stderr, "zlib level must be 1-9\n");
+                    return 1;
+                }
+                break;
+            case 'g':
+                options.keyframes.max_gop = atoi(optarg);
+                break;
+            case 'G':
+                options.keyframes.min_gop = atoi(optarg);
+                break;
+            case '2':
+                options.two_pass = 1;
+                break;
+            case 'b':
+                options.bframes = 1;
+                break;
+            case 's':
+                screen_content = 1;
+                break;
+            case 'r':
+                entropy_delta = 1;
+                break;
+            case 'c':
+                if (parse_checksum_type(optarg, &checksum) != GVC_SUCCESS) {
+                    fprintf(stderr, "Unknown checksum: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 't':
+                trace_path = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    options.profile.screen_content = screen_content; // -e resets the profile, so apply last
+    options.profile.compression.entropy_delta = entropy_delta;
+    options.profile.compression.checksum = checksum;
+    if (zlib_level > 0) {
+        options.profile.compression.backend = BACKEND_ZLIB;
+        options.profile.compression.level = zlib_level;
+    }
+    
+    if (argc - optind < 2) {
+        print_usage(argv[0]);
         return 1;
     }
     
-    const char* input_path = argv[1];
-    const char* repo_path = argv[2];
+    const char* input_path = argv[optind];
+    const char* repo_path = argv[optind + 1];
     
-    int result = encode_video_sequence(input_path, repo_path);
+    if (trace_path && trace_start(trace_path) != GVC_SUCCESS) {
+        fprintf(stderr, "Invalid trace path: %s\n", trace_path);
+        return 1;
+    }
+    
+    int result = encode_video_sequence(input_path, repo_path, &options);
+    
+    if (trace_path && trace_stop() != GVC_SUCCESS) {
+        fprintf(stderr, "Warning: Failed to write trace to %s\n", trace_path);
+    }
     
     if (result != GVC_SUCCESS) {
         fprintf(stderr, "Error: Encoding failed with error code: %d\n", result);
@@ -2,9 +2,17 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <sys/time.h>
 
-// Function to read a raw RGB frame from file
-int read_raw_frame(const char* filename, raw_frame_t* frame) {
+// Average absolute difference above which the previous frame is treated as a
+// poor predictor (scene cut, noise) and the frame is coded intra
+#define MODE_ESTIMATE_INTRA_DIFF 32
+#define MODE_ESTIMATE_STRIDE 61  // Sample every Nth byte; odd stride walks all channels/planes
+#define ENTROPY_DELTA_MAX_GROWTH_PERCENT 125  // rANS delta size kept relative to the backend delta
+
+// Function to read a raw frame of known dimensions from file
+int read_raw_frame(const char* filename, uint32_t width, uint32_t height,
+                   uint32_t channels, raw_frame_t* frame) {
     FILE* file = fopen(filename, "rb");
     if (!file) return GVC_ERROR_IO;
     
@@ -14,7 +22,7 @@ int read_raw_frame(const char* filename, raw_frame_t* frame) {
     fseek(file, 0, SEEK_SET);
     
     // Verify expected size
-    size_t expected_size = FRAME_WIDTH * FRAME_HEIGHT * FRAME_CHANNELS;
+    size_t expected_size = (size_t)width * height * channels;
     if ((size_t)file_size != expected_size) {
         fclose(file);
         return GVC_ERROR_FORMAT;
@@ -35,68 +43,276 @@ int read_raw_frame(const char* filename, raw_frame_t* frame) {
         return GVC_ERROR_IO;
     }
     
-    frame->width = FRAME_WIDTH;
-    frame->height = FRAME_HEIGHT;
-    frame->channels = FRAME_CHANNELS;
+    frame->width = width;
+    frame->height = height;
+    frame->channels = channels;
+    frame->pixel_format = PIXEL_FORMAT_RGB;
     
     return GVC_SUCCESS;
 }
 
-// Function to generate test frames (for demonstration)
-static int generate_test_frame(uint32_t frame_number, raw_frame_t* frame) {
-    frame->pixels = malloc(FRAME_SIZE);
-    if (!frame->pixels) return GVC_ERROR_MEMORY;
+// Frame source callbacks for synthetic input; ctx is the synth_params_t
+static int test_source_load(void* ctx, int frame_index, raw_frame_t* frame_out) {
+    const synth_params_t* params = ctx;
+    int result = synth_alloc_frame(params, frame_out);
+    if (result != GVC_SUCCESS) return result;
+    
+    result = synth_render(params, (uint32_t)frame_index, frame_out);
+    if (result != GVC_SUCCESS) {
+        free_raw_frame(frame_out);
+    }
+    return result;
+}
+
+static void test_source_release(void* ctx, raw_frame_t* frame) {
+    (void)ctx;
+    free_raw_frame(frame);
+}
+
+static double get_time_seconds(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Cheap mode estimate from a sparse sample of byte differences
+static int prefer_intra_estimate(const raw_frame_t* current, const raw_frame_t* previous) {
+    size_t size = raw_frame_size(current);
+    uint64_t total_diff = 0;
+    size_t samples = 0;
+    
+    for (size_t i = 0; i < size; i += MODE_ESTIMATE_STRIDE) {
+        int diff = (int8_t)(current->pixels[i] - previous->pixels[i]);
+        total_diff += (uint64_t)(diff < 0 ? -diff : diff);
+        samples++;
+    }
     
-    frame->width = FRAME_WIDTH;
-    frame->height = FRAME_HEIGHT;
-    frame->channels = FRAME_CHANNELS;
+    return samples > 0 && total_diff > (uint64_t)MODE_ESTIMATE_INTRA_DIFF * samples;
+}
+
+// Index of the candidate reference closest to the current frame, by sampled difference
+static int select_reference(const raw_frame_t* current, const reference_set_t* references,
+                            double* difference_out) {
+    int best = 0;
+    double best_difference = -1.0;
+    
+    if (references->count > 1) {
+        best_difference = frame_difference_sampled(current, references->frames[0]);
+        for (int i = 1; i < references->count && best_difference > 0.0; i++) {
+            double difference = frame_difference_sampled(current, references->frames[i]);
+            if (difference < best_difference) {
+                best_difference = difference;
+                best = i;
+            }
+        }
+    }
     
-    // Generate animated pattern
-    for (uint32_t y = 0; y < FRAME_HEIGHT; y++) {
-        for (uint32_t x = 0; x < FRAME_WIDTH; x++) {
-            uint32_t pixel_idx = (y * FRAME_WIDTH + x) * FRAME_CHANNELS;
-            
-            // Create moving gradient pattern
-            uint8_t r = (uint8_t)((x + frame_number) % 256);
-            uint8_t g = (uint8_t)((y + frame_number / 2) % 256);
-            uint8_t b = (uint8_t)((x + y + frame_number) % 256);
+    *difference_out = best_difference;
+    return best;
+}
+
+// Screen coding is only kept when most blocks avoid raw pixels; camera footage
+// falls back to the generic coders
+static int try_screen_frame(const raw_frame_t* current_frame, const raw_frame_t* reference,
+                            const compression_params_t* params, frame_t* compressed_out) {
+    screen_stats_t stats;
+    if (compress_frame_screen(current_frame, reference, params, compressed_out, &stats) != GVC_SUCCESS) {
+        return 0;
+    }
+    if (stats.raw_blocks * 100 > stats.blocks * SCREEN_MAX_RAW_PERCENT) {
+        free_frame(compressed_out);
+        return 0;
+    }
+    return 1;
+}
+
+// Code one frame as planned, or by the profile's mode decision for FRAME_MODE_AUTO.
+// Delta frames predict from whichever candidate reference is closest.
+static int encode_frame_data(const raw_frame_t* current_frame,
+                             const reference_set_t* references,
+                             const encode_profile_t* profile,
+                             int frame_mode,
+                             frame_t* compressed_out,
+                             const raw_frame_t** reference_out) {
+    const compression_params_t* params = profile ? &profile->compression : NULL;
+    int mode_decision = profile ? profile->mode_decision : MODE_DECISION_NONE;
+    
+    *reference_out = NULL;
+    
+    // Keyframes have nothing to predict from; planned ones become the long-term reference
+    // (intra screen frames always do)
+    if (!references || references->count == 0 || frame_mode == FRAME_MODE_INTRA) {
+        if (profile && profile->screen_content &&
+            try_screen_frame(current_frame, NULL, params, compressed_out)) {
+            return GVC_SUCCESS;
+        }
+        int result = compress_frame_raw(current_frame, params, compressed_out);
+        if (result == GVC_SUCCESS && frame_mode == FRAME_MODE_INTRA) {
+            compressed_out->header.reference = REFERENCE_LONG_TERM;
+        }
+        return result;
+    }
+    
+    if (frame_mode == FRAME_MODE_REPEAT) {
+        *reference_out = references->frames[0];
+        return compress_frame_repeat(current_frame, references->frame_numbers[0], compressed_out);
+    }
+    
+    if (frame_mode == FRAME_MODE_BIDIR && references->future) {
+        *reference_out = references->frames[0];
+        return compress_frame_bidir(current_frame, references->frames[0], references->future,
+                                    references->frame_numbers[0], references->future_frame_number,
+                                    params, compressed_out);
+    }
+    
+    double difference;
+    int best = select_reference(current_frame, references, &difference);
+    const raw_frame_t* reference = references->frames[best];
+    *reference_out = reference;
+    
+    // Content returning to an earlier state exactly (toggles, blinking) costs one header
+    if (difference == 0.0 &&
+        memcmp(current_frame->pixels, reference->pixels, raw_frame_size(current_frame)) == 0) {
+        return compress_frame_repeat(current_frame, references->frame_numbers[best], compressed_out);
+    }
+    
+    if (profile && profile->screen_content) {
+        // Screen frames cannot copy from the long-term reference; use the nearest frame instead
+        int screen_reference = references->references[best] == REFERENCE_LONG_TERM ? 0 : best;
+        if (try_screen_frame(current_frame, references->frames[screen_reference], params, compressed_out)) {
+            compressed_out->header.reference = references->references[screen_reference];
+            *reference_out = references->frames[screen_reference];
+            if (mode_decision != MODE_DECISION_EXHAUSTIVE) {
+                return GVC_SUCCESS;
+            }
             
-            frame->pixels[pixel_idx] = r;
-            frame->pixels[pixel_idx + 1] = g;
-            frame->pixels[pixel_idx + 2] = b;
+            // Exhaustive: keep a delta frame instead if it is smaller
+            frame_t delta_frame;
+            if (compress_frame_delta(current_frame, reference, params, &delta_frame) == GVC_SUCCESS) {
+                if (delta_frame.data_size < compressed_out->data_size) {
+                    free_frame(compressed_out);
+                    *compressed_out = delta_frame;
+                    compressed_out->header.reference = references->references[best];
+                    *reference_out = reference;
+                } else {
+                    free_frame(&delta_frame);
+                }
+            }
+            return GVC_SUCCESS;
+        }
+    }
+    
+    if (frame_mode == FRAME_MODE_AUTO && mode_decision == MODE_DECISION_ESTIMATE &&
+        prefer_intra_estimate(current_frame, reference)) {
+        *reference_out = NULL;
+        return compress_frame_raw(current_frame, params, compressed_out);
+    }
+    
+    int result = compress_frame_delta(current_frame, reference, params, compressed_out);
+    if (result != GVC_SUCCESS) {
+        return result;
+    }
+    compressed_out->header.reference = references->references[best];
+    
+    // rANS-coded deltas decode faster where residuals are sparse, but dense residuals
+    // are where the backend's matches pay off. Exhaustive keeps the smaller coding;
+    // otherwise rANS stays unless it grows the frame too much.
+    if (params && (params->entropy_delta || mode_decision == MODE_DECISION_EXHAUSTIVE)) {
+        compression_params_t other_params = *params;
+        other_params.entropy_delta = !params->entropy_delta;
+        size_t limit = compressed_out->data_size;
+        if (params->entropy_delta && mode_decision != MODE_DECISION_EXHAUSTIVE) {
+            limit = compressed_out->data_size * 100 / ENTROPY_DELTA_MAX_GROWTH_PERCENT;
+        }
+        
+        frame_t other_delta;
+        if (compress_frame_delta(current_frame, reference, &other_params, &other_delta) == GVC_SUCCESS) {
+            if (other_delta.data_size < limit) {
+                free_frame(compressed_out);
+                *compressed_out = other_delta;
+                compressed_out->header.reference = references->references[best];
+            } else {
+                free_frame(&other_delta);
+            }
+        }
+    }
+    
+    if (mode_decision != MODE_DECISION_EXHAUSTIVE) {
+        return GVC_SUCCESS;
+    }
+    
+    // Exhaustive: also code intra and keep whichever is smaller
+    frame_t intra_frame;
+    if (compress_frame_raw(current_frame, params, &intra_frame) == GVC_SUCCESS) {
+        if (intra_frame.data_size < compressed_out->data_size) {
+            free_frame(compressed_out);
+            *compressed_out = intra_frame;
+            *reference_out = NULL;
+        } else {
+            free_frame(&intra_frame);
         }
     }
     
     return GVC_SUCCESS;
 }
 
-// Function to encode a single frame and create Git commit
-int encode_frame_to_commit(const raw_frame_t* current_frame, 
-                          const raw_frame_t* previous_frame,
-                          uint32_t frame_number,
-                          const char* parent_commit_hash,
-                          char* commit_hash_out) {
+// Time a decode of the frame just coded, as a player would run it
+static double measure_decode_seconds(const frame_t* compressed_frame,
+                                     const raw_frame_t* reference_frame,
+                                     const raw_frame_t* future_frame) {
+    raw_frame_t decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    
+    double start = get_time_seconds();
+    int result = compressed_frame->header.compression_type == COMPRESSION_TYPE_BIDIR
+                     ? decompress_frame_bidir(compressed_frame, reference_frame, future_frame, &decoded)
+                     : decompress_frame(compressed_frame, reference_frame, &decoded);
+    double elapsed = get_time_seconds() - start;
+    
+    free_raw_frame(&decoded);
+    return result == GVC_SUCCESS ? elapsed : -1.0;
+}
+
+// Compress a frame and store it as a Git blob; safe to call from worker threads.
+// When decode_seconds_out is set the frame is also decoded once and timed.
+int encode_frame_to_blob(const raw_frame_t* current_frame,
+                        const reference_set_t* references,
+                        uint32_t frame_number,
+                        const encode_profile_t* profile,
+                        int frame_mode,
+                        char* blob_hash_out,
+                        frame_header_t* header_out,
+                        double* decode_seconds_out) {
     frame_t compressed_frame;
-    int result;
-    
-    // Choose compression method
-    if (previous_frame) {
-        // Use delta compression for non-keyframes
-        result = compress_frame_delta(current_frame, previous_frame, &compressed_frame);
-    } else {
-        // Use raw compression for keyframes
-        result = compress_frame_raw(current_frame, &compressed_frame);
-    }
+    const raw_frame_t* reference_frame;
+    uint64_t span_start = trace_begin();
+    int result = encode_frame_data(current_frame, references, profile, frame_mode,
+                                   &compressed_frame, &reference_frame);
+    trace_end("compress", span_start);
     
     if (result != GVC_SUCCESS) return result;
     
+    if (decode_seconds_out) {
+        span_start = trace_begin();
+        *decode_seconds_out = measure_decode_seconds(&compressed_frame, reference_frame,
+                                                     references ? references->future : NULL);
+        trace_end("decode sample", span_start);
+    }
+    
     // Set frame number
     compressed_frame.header.frame_number = frame_number;
+    if (profile && profile->compression.checksum != CHECKSUM_CRC32) {
+        set_frame_checksum(&compressed_frame, profile->compression.checksum);
+    }
     
-    // Serialize frame to buffer
+    // Serialize frame to buffer, with the source pixels' hash for end-to-end verification
+    span_start = trace_begin();
+    pixel_hash_t pixel_hash;
+    hash_frame_pixels(current_frame, &pixel_hash);
     uint8_t* frame_buffer;
     size_t frame_buffer_size;
-    result = serialize_frame(&compressed_frame, &frame_buffer, &frame_buffer_size);
+    result = serialize_frame_with_hash(&compressed_frame, &pixel_hash, &frame_buffer, &frame_buffer_size);
+    trace_end("serialize", span_start);
     
     if (result != GVC_SUCCESS) {
         free_frame(&compressed_frame);
@@ -104,43 +320,171 @@ int encode_frame_to_commit(const raw_frame_t* current_frame,
     }
     
     // Create Git blob
-    char blob_hash[GIT_HASH_SIZE + 1];
-    result = git_create_blob(frame_buffer, frame_buffer_size, blob_hash);
+    span_start = trace_begin();
+    result = git_create_blob(frame_buffer, frame_buffer_size, blob_hash_out);
+    trace_end("write blob", span_start);
     
-    if (result != GVC_SUCCESS) {
-        free(frame_buffer);
-        free_frame(&compressed_frame);
-        return result;
+    if (result == GVC_SUCCESS && header_out) {
+        *header_out = compressed_frame.header;
     }
     
+    free(frame_buffer);
+    free_frame(&compressed_frame);
+    
+    return result;
+}
+
+// Create the commit for an already stored frame blob; must run in frame order
+int commit_encoded_frame(const char* blob_hash,
+                        const frame_header_t* header,
+                        const char* parent_commit_hash,
+                        char* commit_hash_out) {
     // Create commit message
     char commit_message[MAX_COMMIT_MESSAGE];
     snprintf(commit_message, sizeof(commit_message), 
              "Frame %06u (%s, %u bytes)", 
-             frame_number,
-             compressed_frame.header.compression_type == 0 ? "raw" : "delta",
-             compressed_frame.header.compressed_size);
+             header->frame_number,
+             compression_type_name(header->compression_type),
+             header->compressed_size);
     
     // Create Git commit
-    result = git_create_commit(blob_hash, commit_message, parent_commit_hash, commit_hash_out);
-    
-    // Cleanup
-    free(frame_buffer);
-    free_frame(&compressed_frame);
+    int result = git_create_commit(blob_hash, commit_message, parent_commit_hash, commit_hash_out);
     
     if (result == GVC_SUCCESS) {
         printf("Encoded frame %06u: %s compression, %u bytes\n", 
-               frame_number,
-               compressed_frame.header.compression_type == 0 ? "raw" : "delta",
-               compressed_frame.header.compressed_size);
+               header->frame_number,
+               compression_type_name(header->compression_type),
+               header->compressed_size);
     }
     
     return result;
 }
 
-int encode_video_sequence(const char* input_path, const char* repo_path) {
+// Function to encode a single frame and create Git commit
+int encode_frame_to_commit(const raw_frame_t* current_frame, 
+                          const raw_frame_t* previous_frame,
+                          uint32_t frame_number,
+                          const char* parent_commit_hash,
+                          char* commit_hash_out) {
+    char blob_hash[GIT_HASH_SIZE + 1];
+    frame_header_t header;
+    reference_set_t references;
+    memset(&references, 0, sizeof(references));
+    if (previous_frame) {
+        references.frames[0] = previous_frame;
+        references.frame_numbers[0] = frame_number - 1;
+        references.count = 1;
+    }
+    
+    int result = encode_frame_to_blob(current_frame, &references, frame_number, NULL,
+                                      FRAME_MODE_AUTO, blob_hash, &header, NULL);
+    if (result != GVC_SUCCESS) return result;
+    
+    return commit_encoded_frame(blob_hash, &header, parent_commit_hash, commit_hash_out);
+}
+
+void encode_profile_init(encode_profile_t* profile, encode_preset_t preset) {
+    if (!profile) return;
+    memset(profile, 0, sizeof(*profile));
+    profile->preset = preset;
+    profile->compression.checksum = CHECKSUM_CRC32C;
+    
+    switch (preset) {
+        case ENCODE_PRESET_FAST:
+            profile->name = "fast";
+            profile->compression.backend = BACKEND_LZ4;
+            profile->mode_decision = MODE_DECISION_NONE;
+            profile->max_references = 1;
+            break;
+        case ENCODE_PRESET_MAX:
+            profile->name = "max";
+            profile->compression.backend = BACKEND_LZMA;
+            profile->mode_decision = MODE_DECISION_EXHAUSTIVE;
+            profile->max_references = REFERENCE_CACHE_SIZE;
+            break;
+        case ENCODE_PRESET_BALANCED:
+        default:
+            profile->preset = ENCODE_PRESET_BALANCED;
+            profile->name = "balanced";
+            profile->compression.backend = BACKEND_LZFSE;
+            profile->mode_decision = MODE_DECISION_ESTIMATE;
+            profile->max_references = 4;
+            break;
+    }
+}
+
+int parse_encode_preset(const char* name, encode_profile_t* profile_out) {
+    if (!name || !profile_out) return GVC_ERROR_MEMORY;
+    
+    if (strcmp(name, "fast") == 0) {
+        encode_profile_init(profile_out, ENCODE_PRESET_FAST);
+    } else if (strcmp(name, "balanced") == 0) {
+        encode_profile_init(profile_out, ENCODE_PRESET_BALANCED);
+    } else if (strcmp(name, "max") == 0) {
+        encode_profile_init(profile_out, ENCODE_PRESET_MAX);
+    } else {
+        return GVC_ERROR_FORMAT;
+    }
+    return GVC_SUCCESS;
+}
+
+void encode_options_init(encode_options_t* options) {
+    if (!options) return;
+    memset(options, 0, sizeof(*options));
+    options->num_threads = 0; // One worker per online CPU
+    options->pixel_format = PIXEL_FORMAT_RGB;
+    options->width = FRAME_WIDTH;
+    options->height = FRAME_HEIGHT;
+    encode_profile_init(&options->profile, ENCODE_PRESET_BALANCED);
+    options->keyframes.min_gop = DEFAULT_MIN_GOP;
+    options->keyframes.max_gop = DEFAULT_MAX_GOP;
+}
+
+// Summary shared by the encoder and the MP4 converter
+void print_encode_stats(const encode_stats_t* stats, const encode_options_t* options) {
+    printf("Profile: %s (%s backend)\n", options->profile.name,
+           backend_name(options->profile.compression.backend));
+    printf("Total frames: %d (%d intra, %d repeat, %d bidir)\n", stats->frames_encoded,
+           stats->intra_frames, stats->repeat_frames, stats->bidir_frames);
+    if (stats->screen_frames > 0) {
+        printf("Screen-content frames: %d\n", stats->screen_frames);
+    }
+    printf("Original size: %.2f MB\n", stats->original_bytes / (1024.0 * 1024.0));
+    printf("Encoded size: %.2f MB\n", stats->encoded_bytes / (1024.0 * 1024.0));
+    if (stats->encoded_bytes > 0) {
+        printf("Compression ratio: %.2f:1\n", (double)stats->original_bytes / stats->encoded_bytes);
+    }
+    printf("Encode speed: %.1f fps (%d threads)\n", stats->encode_fps, stats->num_threads);
+    if (stats->decode_ms_per_frame > 0) {
+        printf("Expected decode cost: %.2f ms/frame (~%.0f fps on one core)\n",
+               stats->decode_ms_per_frame, 1000.0 / stats->decode_ms_per_frame);
+    }
+}
+
+int encode_video_sequence(const char* input_path, const char* repo_path,
+                          const encode_options_t* options) {
     if (!input_path || !repo_path) return GVC_ERROR_MEMORY;
     
+    encode_options_t default_options;
+    if (!options) {
+        encode_options_init(&default_options);
+        options = &default_options;
+    }
+    
+    // "test" is the original gradient; "synth:<class>" any other synthetic content
+    synth_params_t synth;
+    synth_params_init(&synth);
+    synth.width = options->width;
+    synth.height = options->height;
+    int use_test_frames = (strcmp(input_path, "test") == 0);
+    if (strncmp(input_path, "synth:", 6) == 0) {
+        if (parse_synth_class(input_path + 6, &synth.content) != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Unknown synthetic content '%s'\n", input_path + 6);
+            return GVC_ERROR_FORMAT;
+        }
+        use_test_frames = 1;
+    }
+    
     // Initialize Git repository
     int result = git_init_repo(repo_path);
     if (result != GVC_SUCCESS) {
@@ -156,74 +500,39 @@ int encode_video_sequence(const char* input_path, const char* repo_path) {
     
     printf("Encoding video sequence to Git repository: %s\n", repo_path);
     
-    raw_frame_t current_frame, previous_frame;
-    char current_commit_hash[GIT_HASH_SIZE + 1] = {0};
-    char previous_commit_hash[GIT_HASH_SIZE + 1] = {0};
-    
-    size_t total_original_size = 0;
-    // size_t total_compressed_size = 0; // Unused for now
-    
-    // For demonstration, generate 600 test frames (10 seconds at 60fps)
+    // Synthetic input is 600 frames (10 seconds at 60fps)
     const int num_frames = 600;
     
-    for (int frame_num = 0; frame_num < num_frames; frame_num++) {
-        // Generate or read frame
-        if (strcmp(input_path, "test") == 0) {
-            // Generate test frames
-            result = generate_test_frame(frame_num, &current_frame);
-        } else {
-            // Read from input files (would need to be implemented based on input format)
-            char frame_filename[256];
-            generate_frame_path(input_path, frame_num, frame_filename, sizeof(frame_filename));
-            result = read_raw_frame(frame_filename, &current_frame);
-        }
-        
+    // Input frame files are mapped read-only rather than copied into the heap
+    frame_source_t source;
+    frame_ingest_t ingest;
+    
+    if (use_test_frames) {
+        source.ctx = &synth;
+        source.num_frames = num_frames;
+        source.load = test_source_load;
+        source.release = test_source_release;
+    } else {
+        result = frame_ingest_open(&ingest, input_path, 0, num_frames,
+                                   options->width, options->height, FRAME_CHANNELS, options->pixel_format);
         if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Error: Failed to read frame %d\n", frame_num);
-            break;
-        }
-        
-        // Encode frame to Git commit
-        const char* parent_hash = (frame_num == 0) ? NULL : previous_commit_hash;
-        const raw_frame_t* prev_frame = (frame_num == 0) ? NULL : &previous_frame;
-        
-        result = encode_frame_to_commit(&current_frame, prev_frame, frame_num, 
-                                       parent_hash, current_commit_hash);
-        
-        if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Error: Failed to encode frame %d\n", frame_num);
-            free_raw_frame(&current_frame);
-            break;
-        }
-        
-        // Update statistics
-        total_original_size += FRAME_SIZE;
-        
-        // Free previous frame and update
-        if (frame_num > 0) {
-            free_raw_frame(&previous_frame);
-        }
-        
-        previous_frame = current_frame;
-        strcpy(previous_commit_hash, current_commit_hash);
-        
-        // Progress indicator
-        if (frame_num % 60 == 0) {
-            printf("Progress: %d/%d frames (%.1f%%)\n", 
-                   frame_num + 1, num_frames, 
-                   (float)(frame_num + 1) / num_frames * 100.0f);
+            fprintf(stderr, "Error: Cannot read %ux%u frames from %s\n", options->width, options->height,
+                    input_path);
+            return result;
         }
+        frame_ingest_source(&ingest, &source);
     }
     
-    // Cleanup last frame
-    if (num_frames > 0) {
-        free_raw_frame(&previous_frame);
+    encode_stats_t stats;
+    result = encode_pipeline_run(&source, options, &stats);
+    
+    if (!use_test_frames) {
+        frame_ingest_close(&ingest);
     }
     
     if (result == GVC_SUCCESS) {
         printf("\nEncoding completed successfully!\n");
-        printf("Total frames: %d\n", num_frames);
-        printf("Original size: %.2f MB\n", total_original_size / (1024.0 * 1024.0));
+        print_encode_stats(&stats, options);
         printf("\nYou can now play the video with: ./git-vid-play %s\n", repo_path);
     }
     
@@ -0,0 +1,213 @@
+#include "git_vid_codec.h"
+
+// Order-0 rANS entropy coder for the token streams of entropy-coded delta frames.
+// Residual tokens have skewed byte statistics but almost no long repeats, so a
+// static entropy coder gets most of what a general LZ coder would, without the
+// match search. Four interleaved states let the decoder overlap the dependency
+// chains of consecutive symbols.
+//
+// Stream layout:
+//   u16 number of distinct symbols, then (u8 symbol, u16 frequency) for each;
+//   frequencies sum to 1 << RANS_PROB_BITS
+//   u32 final state of each of the RANS_STATES coders
+//   renormalization bytes, in the order the decoder consumes them
+
+#define RANS_PROB_BITS 12
+#define RANS_PROB_SCALE (1u << RANS_PROB_BITS)
+#define RANS_STATES 4
+#define RANS_LOWER_BOUND (1u << 23)  // States are kept in [RANS_LOWER_BOUND, RANS_LOWER_BOUND << 8)
+
+typedef struct {
+    uint16_t freq[256];
+    uint16_t start[256];
+    int num_symbols;
+} rans_table_t;
+
+// Scale symbol counts to RANS_PROB_SCALE, keeping every present symbol at least 1
+static void build_rans_table(const uint8_t* src, size_t size, rans_table_t* table) {
+    uint32_t counts[256] = {0};
+    for (size_t i = 0; i < size; i++) {
+        counts[src[i]]++;
+    }
+    
+    uint32_t total = 0;
+    int largest = 0;
+    table->num_symbols = 0;
+    for (int s = 0; s < 256; s++) {
+        table->freq[s] = 0;
+        if (counts[s] == 0) continue;
+        
+        uint64_t scaled = (uint64_t)counts[s] * RANS_PROB_SCALE / size;
+        table->freq[s] = (uint16_t)MAX(1, scaled);
+        total += table->freq[s];
+        table->num_symbols++;
+        if (counts[s] > counts[largest]) {
+            largest = s;
+        }
+    }
+    
+    // Rounding error goes to (or comes from) the most frequent symbol, then to the
+    // next ones down if that would leave it empty
+    while (total != RANS_PROB_SCALE) {
+        if (total < RANS_PROB_SCALE) {
+            table->freq[largest] += (uint16_t)(RANS_PROB_SCALE - total);
+            total = RANS_PROB_SCALE;
+        } else {
+            int donor = largest;
+            for (int s = 0; s < 256; s++) {
+                if (table->freq[s] > table->freq[donor]) donor = s;
+            }
+            uint32_t take = MIN(total - RANS_PROB_SCALE, (uint32_t)table->freq[donor] - 1);
+            table->freq[donor] -= (uint16_t)take;
+            total -= take;
+        }
+    }
+    
+    uint32_t start = 0;
+    for (int s = 0; s < 256; s++) {
+        table->start[s] = (uint16_t)start;
+        start += table->freq[s];
+    }
+}
+
+// A renormalization emits at most two bytes per symbol
+size_t rans_encode_bound(size_t size) {
+    return 2 + 256 * 3 + RANS_STATES * sizeof(uint32_t) + size * 2;
+}
+
+// Returns the encoded size, or 0 if dst is too small
+size_t rans_encode(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_size) {
+    if (!dst || dst_size < rans_encode_bound(size)) return 0;
+    
+    uint8_t* out = dst;
+    if (size == 0) {
+        memset(out, 0, 2);
+        return 2;
+    }
+    
+    rans_table_t table;
+    build_rans_table(src, size, &table);
+    
+    uint16_t num_symbols = (uint16_t)table.num_symbols;
+    memcpy(out, &num_symbols, sizeof(num_symbols));
+    out += sizeof(num_symbols);
+    for (int s = 0; s < 256; s++) {
+        if (table.freq[s] == 0) continue;
+        *out++ = (uint8_t)s;
+        memcpy(out, &table.freq[s], sizeof(uint16_t));
+        out += sizeof(uint16_t);
+    }
+    
+    // rANS encodes back to front; bytes are written downwards from the end of a
+    // scratch area and then moved after the states
+    size_t scratch_size = size * 2;
+    uint8_t* scratch = malloc(scratch_size);
+    if (!scratch) return 0;
+    uint8_t* ptr = scratch + scratch_size;
+    
+    uint32_t states[RANS_STATES];
+    for (int i = 0; i < RANS_STATES; i++) {
+        states[i] = RANS_LOWER_BOUND;
+    }
+    
+    for (size_t i = size; i-- > 0;) {
+        uint32_t* x = &states[i % RANS_STATES];
+        uint32_t freq = table.freq[src[i]];
+        uint32_t x_max = ((RANS_LOWER_BOUND >> RANS_PROB_BITS) << 8) * freq;
+        while (*x >= x_max) {
+            *--ptr = (uint8_t)*x;
+            *x >>= 8;
+        }
+        *x = ((*x / freq) << RANS_PROB_BITS) + (*x % freq) + table.start[src[i]];
+    }
+    
+    memcpy(out, states, sizeof(states));
+    out += sizeof(states);
+    size_t stream_bytes = (size_t)(scratch + scratch_size - ptr);
+    memcpy(out, ptr, stream_bytes);
+    out += stream_bytes;
+    free(scratch);
+    
+    return (size_t)(out - dst);
+}
+
+// Decode exactly `size` symbols; returns GVC_ERROR_FORMAT on a malformed stream
+int rans_decode(const uint8_t* src, size_t src_size, uint8_t* dst, size_t size) {
+    const uint8_t* in = src;
+    const uint8_t* end = src + src_size;
+    
+    uint16_t num_symbols;
+    if (src_size < sizeof(num_symbols)) return GVC_ERROR_FORMAT;
+    memcpy(&num_symbols, in, sizeof(num_symbols));
+    in += sizeof(num_symbols);
+    if (num_symbols == 0) {
+        return size == 0 ? GVC_SUCCESS : GVC_ERROR_FORMAT;
+    }
+    if (num_symbols > 256 || (size_t)(end - in) < (size_t)num_symbols * 3 + RANS_STATES * sizeof(uint32_t)) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    // Slot -> symbol lookup, plus each symbol's frequency and start
+    uint8_t slot_symbol[RANS_PROB_SCALE];
+    uint16_t freq[256] = {0};
+    uint16_t start[256] = {0};
+    uint32_t total = 0;
+    for (int i = 0; i < num_symbols; i++) {
+        uint8_t symbol = *in++;
+        memcpy(&freq[symbol], in, sizeof(uint16_t));
+        in += sizeof(uint16_t);
+        if (freq[symbol] == 0 || total + freq[symbol] > RANS_PROB_SCALE) return GVC_ERROR_FORMAT;
+        start[symbol] = (uint16_t)total;
+        memset(slot_symbol + total, symbol, freq[symbol]);
+        total += freq[symbol];
+    }
+    if (total != RANS_PROB_SCALE) return GVC_ERROR_FORMAT;
+    
+    uint32_t states[RANS_STATES];
+    memcpy(states, in, sizeof(states));
+    in += sizeof(states);
+    for (int k = 0; k < RANS_STATES; k++) {
+        if (states[k] < RANS_LOWER_BOUND || states[k] >= RANS_LOWER_BOUND << 8) return GVC_ERROR_FORMAT;
+    }
+    
+    const uint32_t mask = RANS_PROB_SCALE - 1;
+    size_t i = 0;
+    
+    // Main loop: one symbol per state. A renormalization reads at most two bytes,
+    // so with three left per state the bounds checks can be hoisted out.
+    uint32_t x0 = states[0], x1 = states[1], x2 = states[2], x3 = states[3];
+#define RANS_DECODE_STEP(x, out)                                                    \
+    do {                                                                            \
+        uint8_t symbol = slot_symbol[(x) & mask];                                   \
+        (out) = symbol;                                                             \
+        (x) = freq[symbol] * ((x) >> RANS_PROB_BITS) + ((x) & mask) - start[symbol]; \
+        while ((x) < RANS_LOWER_BOUND) {                                            \
+            (x) = ((x) << 8) | *in++;                                               \
+        }                                                                           \
+    } while (0)
+    while (i + RANS_STATES <= size && (size_t)(end - in) >= RANS_STATES * 3) {
+        RANS_DECODE_STEP(x0, dst[i]);
+        RANS_DECODE_STEP(x1, dst[i + 1]);
+        RANS_DECODE_STEP(x2, dst[i + 2]);
+        RANS_DECODE_STEP(x3, dst[i + 3]);
+        i += RANS_STATES;
+    }
+#undef RANS_DECODE_STEP
+    states[0] = x0;
+    states[1] = x1;
+    states[2] = x2;
+    states[3] = x3;
+    
+    for (; i < size; i++) {
+        uint32_t* x = &states[i % RANS_STATES];
+        uint8_t symbol = slot_symbol[*x & mask];
+        dst[i] = symbol;
+        *x = freq[symbol] * (*x >> RANS_PROB_BITS) + (*x & mask) - start[symbol];
+        while (*x < RANS_LOWER_BOUND) {
+            if (in >= end) return GVC_ERROR_FORMAT;
+            *x = (*x << 8) | *in++;
+        }
+    }
+    
+    return in == end ? GVC_SUCCESS : GVC_ERROR_FORMAT;
+}
@@ -1,13 +1,122 @@
 #include "git_vid_codec.h"
+#include "probes.h"
 
-// Magic number to identify our frame format
-#define FRAME_MAGIC 0x47564346  // "GVCF" in little endian
+// Helper function to validate frame dimensions read from a header
+int validate_frame_dimensions(uint32_t width, uint32_t height, uint32_t channels) {
+    if (width == 0 || width > MAX_FRAME_WIDTH ||
+        height == 0 || height > MAX_FRAME_HEIGHT) {
+        return GVC_ERROR_FORMAT;
+    }
+    if (channels != 1 && channels != 3 && channels != 4) {
+        return GVC_ERROR_FORMAT;
+    }
+    return GVC_SUCCESS;
+}
+
+// Helper function to validate a pixel format against its channel count
+int validate_pixel_format(uint32_t channels, uint32_t pixel_format) {
+    if (pixel_format == PIXEL_FORMAT_RGB) {
+        return GVC_SUCCESS;
+    }
+    if (pixel_format == PIXEL_FORMAT_YUV420P && channels == 3) {
+        return GVC_SUCCESS;
+    }
+    return GVC_ERROR_FORMAT;
+}
+
+// Helper function to validate everything in a header needed to decode its payload
+int validate_frame_header(const frame_header_t* header) {
+    if (validate_frame_dimensions(header->width, header->height, header->channels) != GVC_SUCCESS ||
+        validate_pixel_format(header->channels, header->pixel_format) != GVC_SUCCESS) {
+        return GVC_ERROR_FORMAT;
+    }
+    if (FRAME_BACKEND(header) >= BACKEND_COUNT || FRAME_CHECKSUM_TYPE(header) >= CHECKSUM_COUNT) {
+        return GVC_ERROR_FORMAT;
+    }
+    // References beyond the decoder cache could never be resolved
+    if (header->reference > REFERENCE_CACHE_SIZE && header->reference != REFERENCE_LONG_TERM) {
+        return GVC_ERROR_FORMAT;
+    }
+    return GVC_SUCCESS;
+}
+
+// Bytes needed to hold one frame; chroma planes of odd-sized YUV420P frames round up
+size_t frame_buffer_size(uint32_t width, uint32_t height, uint32_t channels, uint32_t pixel_format) {
+    if (pixel_format == PIXEL_FORMAT_YUV420P) {
+        size_t chroma_size = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+        return (size_t)width * height + 2 * chroma_size;
+    }
+    return (size_t)width * height * channels;
+}
+
+size_t raw_frame_size(const raw_frame_t* frame) {
+    return frame_buffer_size(frame->width, frame->height, frame->channels, frame->pixel_format);
+}
+
+// Pixel format names as used by FFmpeg's -pix_fmt
+const char* pixel_format_name(uint32_t pixel_format) {
+    return pixel_format == PIXEL_FORMAT_YUV420P ? "yuv420p" : "rgb24";
+}
+
+int parse_pixel_format(const char* name, uint32_t* pixel_format_out) {
+    if (!name || !pixel_format_out) return GVC_ERROR_MEMORY;
+    
+    if (strcmp(name, "rgb24") == 0 || strcmp(name, "rgb") == 0) {
+        *pixel_format_out = PIXEL_FORMAT_RGB;
+    } else if (strcmp(name, "yuv420p") == 0 || strcmp(name, "yuv") == 0) {
+        *pixel_format_out = PIXEL_FORMAT_YUV420P;
+    } else {
+        return GVC_ERROR_FORMAT;
+    }
+    return GVC_SUCCESS;
+}
+
+int frame_magic_supported(uint32_t magic) {
+    return magic == FRAME_MAGIC || magic == FRAME_MAGIC_V2;
+}
+
+// Copy the header out of a serialized frame whose size and magic have been checked.
+// Bytes a FRAME_MAGIC encoder never set are read as 0.
+void unpack_frame_header(const uint8_t* buffer, frame_header_t* header_out) {
+    uint32_t magic;
+    memcpy(&magic, buffer, sizeof(magic));
+    memcpy(header_out, buffer + sizeof(magic), sizeof(*header_out));
+    if (magic == FRAME_MAGIC) {
+        header_out->pixel_format = PIXEL_FORMAT_RGB;
+        header_out->backend = BACKEND_LZFSE | (CHECKSUM_CRC32 << 4);
+        header_out->reference = 0;
+    }
+}
+
+// Read and validate only the header of a serialized frame, without copying the payload
+int read_frame_header(const uint8_t* buffer, size_t size, frame_header_t* header_out) {
+    if (!buffer || !header_out || size < sizeof(uint32_t) + sizeof(frame_header_t)) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    uint32_t magic;
+    memcpy(&magic, buffer, sizeof(magic));
+    if (!frame_magic_supported(magic)) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    unpack_frame_header(buffer, header_out);
+    return validate_frame_header(header_out);
+}
 
 int serialize_frame(const frame_t* frame, uint8_t** buffer_out, size_t* size_out) {
+    return serialize_frame_with_hash(frame, NULL, buffer_out, size_out);
+}
+
+int serialize_frame_with_hash(const frame_t* frame, const pixel_hash_t* pixel_hash,
+                              uint8_t** buffer_out, size_t* size_out) {
     if (!frame || !buffer_out || !size_out) return GVC_ERROR_MEMORY;
     
-    // Calculate total size: magic + header + data
+    // Calculate total size: magic + header + data (+ pixel hash trailer)
     size_t total_size = sizeof(uint32_t) + sizeof(frame_header_t) + frame->data_size;
+    if (pixel_hash) {
+        total_size += PIXEL_HASH_TRAILER_SIZE;
+    }
     
     uint8_t* buffer = malloc(total_size);
     if (!buffer) return GVC_ERROR_MEMORY;
@@ -15,7 +124,7 @@ int serialize_frame(const frame_t* frame, uint8_t** buffer_out, size_t* size_out
     size_t offset = 0;
     
     // Write magic number
-    uint32_t magic = FRAME_MAGIC;
+    uint32_t magic = FRAME_MAGIC_V2;
     memcpy(buffer + offset, &magic, sizeof(magic));
     offset += sizeof(magic);
     
@@ -29,14 +138,91 @@ int serialize_frame(const frame_t* frame, uint8_t** buffer_out, size_t* size_out
         offset += frame->data_size;
     }
     
+    // Write pixel hash trailer
+    if (pixel_hash) {
+        uint32_t trailer_magic = PIXEL_HASH_MAGIC;
+        memcpy(buffer + offset, &trailer_magic, sizeof(trailer_magic));
+        offset += sizeof(trailer_magic);
+        memcpy(buffer + offset, &pixel_hash->low, sizeof(pixel_hash->low));
+        offset += sizeof(pixel_hash->low);
+        memcpy(buffer + offset, &pixel_hash->high, sizeof(pixel_hash->high));
+        offset += sizeof(pixel_hash->high);
+    }
+    
     *buffer_out = buffer;
     *size_out = total_size;
     
     return GVC_SUCCESS;
 }
 
+// Pixel hash of a serialized frame; GVC_ERROR_FORMAT if it was written without one
+int read_frame_pixel_hash(const uint8_t* buffer, size_t size, pixel_hash_t* hash_out) {
+    frame_header_t header;
+    if (!hash_out || read_frame_header(buffer, size, &header) != GVC_SUCCESS) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    size_t offset = sizeof(uint32_t) + sizeof(frame_header_t) + header.compressed_size;
+    if (size < offset || size - offset < PIXEL_HASH_TRAILER_SIZE) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    uint32_t trailer_magic;
+    memcpy(&trailer_magic, buffer + offset, sizeof(trailer_magic));
+    if (trailer_magic != PIXEL_HASH_MAGIC) {
+        return GVC_ERROR_FORMAT;
+    }
+    offset += sizeof(trailer_magic);
+    memcpy(&hash_out->low, buffer + offset, sizeof(hash_out->low));
+    offset += sizeof(hash_out->low);
+    memcpy(&hash_out->high, buffer + offset, sizeof(hash_out->high));
+    
+    return GVC_SUCCESS;
+}
+
+// Intra frames anchor everything up to the next keyframe, so they are checked
+// under every policy but off; sampling goes by frame number so that players
+// dropping frames still check a steady share of the stream
+int frame_needs_verification(const frame_header_t* header, verify_policy_t policy) {
+    switch (policy) {
+        case VERIFY_OFF:
+            return 0;
+        case VERIFY_SAMPLED:
+            return header->frame_number % VERIFY_SAMPLE_INTERVAL == 0;
+        case VERIFY_KEYFRAMES:
+            return header->compression_type == COMPRESSION_TYPE_RAW ||
+                   (header->compression_type == COMPRESSION_TYPE_SCREEN &&
+                    header->reference == REFERENCE_LONG_TERM);
+        case VERIFY_FULL:
+        default:
+            return 1;
+    }
+}
+
+int verify_frame_checksum(const frame_t* frame) {
+    if (!frame) return GVC_ERROR_MEMORY;
+    if (frame->data_size == 0) return GVC_SUCCESS;
+    
+    uint32_t calculated = calculate_payload_checksum(FRAME_CHECKSUM_TYPE(&frame->header),
+                                                     frame->data, frame->data_size);
+    return calculated == frame->header.checksum ? GVC_SUCCESS : GVC_ERROR_FORMAT;
+}
+
+// Re-stamp a coded frame's payload checksum with another algorithm
+void set_frame_checksum(frame_t* frame, uint8_t checksum_type) {
+    if (!frame) return;
+    
+    frame->header.backend = (uint8_t)(FRAME_BACKEND(&frame->header) | (checksum_type << 4));
+    frame->header.checksum = calculate_payload_checksum(checksum_type, frame->data, frame->data_size);
+}
+
 int deserialize_frame(const uint8_t* buffer, size_t size, frame_t* frame_out) {
-    if (!buffer || !frame_out || size < sizeof(uint32_t) + sizeof(frame_header_t)) {
+    return deserialize_frame_verified(buffer, size, VERIFY_FULL, frame_out);
+}
+
+static int parse_frame(const uint8_t* buffer, size_t size, verify_policy_t policy,
+                       frame_t* frame_out) {
+    if (size < sizeof(uint32_t) + sizeof(frame_header_t)) {
         return GVC_ERROR_FORMAT;
     }
     
@@ -47,18 +233,16 @@ int deserialize_frame(const uint8_t* buffer, size_t size, frame_t* frame_out) {
     memcpy(&magic, buffer + offset, sizeof(magic));
     offset += sizeof(magic);
     
-    if (magic != FRAME_MAGIC) {
+    if (!frame_magic_supported(magic)) {
         return GVC_ERROR_FORMAT;
     }
     
     // Read header
-    memcpy(&frame_out->header, buffer + offset, sizeof(frame_out->header));
+    unpack_frame_header(buffer, &frame_out->header);
     offset += sizeof(frame_out->header);
     
     // Validate header
-    if (frame_out->header.width != FRAME_WIDTH ||
-        frame_out->header.height != FRAME_HEIGHT ||
-        frame_out->header.channels != FRAME_CHANNELS) {
+    if (validate_frame_header(&frame_out->header) != GVC_SUCCESS) {
         return GVC_ERROR_FORMAT;
     }
     
@@ -76,8 +260,8 @@ int deserialize_frame(const uint8_t* buffer, size_t size, frame_t* frame_out) {
         memcpy(frame_out->data, buffer + offset, frame_out->data_size);
         
         // Verify checksum
-        uint32_t calculated_checksum = calculate_checksum(frame_out->data, frame_out->data_size);
-        if (calculated_checksum != frame_out->header.checksum) {
+        if (frame_needs_verification(&frame_out->header, policy) &&
+            verify_frame_checksum(frame_out) != GVC_SUCCESS) {
             free(frame_out->data);
             frame_out->data = NULL;
             return GVC_ERROR_FORMAT;
@@ -89,6 +273,45 @@ int deserialize_frame(const uint8_t* buffer, size_t size, frame_t* frame_out) {
     return GVC_SUCCESS;
 }
 
+int deserialize_frame_verified(const uint8_t* buffer, size_t size, verify_policy_t policy,
+                               frame_t* frame_out) {
+    if (!buffer || !frame_out) return GVC_ERROR_FORMAT;
+    
+    GVC_PROBE1(deserialize_start, size);
+    int result = parse_frame(buffer, size, policy, frame_out);
+    // The header is only trustworthy once the frame parsed
+    GVC_PROBE3(deserialize_done, result == GVC_SUCCESS ? frame_out->header.frame_number : 0,
+               result == GVC_SUCCESS ? frame_out->data_size : 0, result);
+    return result;
+}
+
+const char* verify_policy_name(verify_policy_t policy) {
+    switch (policy) {
+        case VERIFY_OFF: return "off";
+        case VERIFY_SAMPLED: return "sampled";
+        case VERIFY_KEYFRAMES: return "keyframes";
+        case VERIFY_FULL:
+        default: return "full";
+    }
+}
+
+int parse_verify_policy(const char* name, verify_policy_t* policy_out) {
+    if (!name || !policy_out) return GVC_ERROR_MEMORY;
+    
+    if (strcmp(name, "off") == 0) {
+        *policy_out = VERIFY_OFF;
+    } else if (strcmp(name, "sampled") == 0) {
+        *policy_out = VERIFY_SAMPLED;
+    } else if (strcmp(name, "keyframes") == 0) {
+        *policy_out = VERIFY_KEYFRAMES;
+    } else if (strcmp(name, "full") == 0) {
+        *policy_out = VERIFY_FULL;
+    } else {
+        return GVC_ERROR_FORMAT;
+    }
+    return GVC_SUCCESS;
+}
+
 void free_frame(frame_t* frame) {
     if (frame && frame->data) {
         free(frame->data);
@@ -118,23 +341,17 @@ int create_raw_frame(const uint8_t* rgb_data, uint32_t width, uint32_t height,
     frame_out->width = width;
     frame_out->height = height;
     frame_out->channels = FRAME_CHANNELS;
+    frame_out->pixel_format = PIXEL_FORMAT_RGB;
     
     return GVC_SUCCESS;
 }
 
-// Helper function to validate frame dimensions
-int validate_frame_dimensions(uint32_t width, uint32_t height, uint32_t channels) {
-    if (width != FRAME_WIDTH || height != FRAME_HEIGHT || channels != FRAME_CHANNELS) {
-        return GVC_ERROR_FORMAT;
-    }
-    return GVC_SUCCESS;
-}
 
 // Helper function to copy raw frame
 int copy_raw_frame(const raw_frame_t* src, raw_frame_t* dst) {
     if (!src || !dst) return GVC_ERROR_MEMORY;
     
-    size_t pixel_count = src->width * src->height * src->channels;
+    size_t pixel_count = raw_frame_size(src);
     
     dst->pixels = malloc(pixel_count);
     if (!dst->pixels) return GVC_ERROR_MEMORY;
@@ -143,6 +360,7 @@ int copy_raw_frame(const raw_frame_t* src, raw_frame_t* dst) {
     dst->width = src->width;
     dst->height = src->height;
     dst->channels = src->channels;
+    dst->pixel_format = src->pixel_format;
     
     return GVC_SUCCESS;
 }
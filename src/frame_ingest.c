@@ -0,0 +1,145 @@
+#include "git_vid_codec.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Ask the kernel to start reading a frame file into the page cache without
+// blocking. The mapping made later by frame_ingest_map then faults on cached
+// pages instead of waiting on storage.
+static void advise_frame_file(const char* filename, size_t size) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return;
+
+#if defined(__APPLE__)
+    struct radvisory advice;
+    advice.ra_offset = 0;
+    advice.ra_count = (int)size;
+    fcntl(fd, F_RDADVISE, &advice);
+#elif defined(POSIX_FADV_WILLNEED)
+    posix_fadvise(fd, 0, (off_t)size, POSIX_FADV_WILLNEED);
+#else
+    (void)size;
+#endif
+
+    close(fd);
+}
+
+int frame_ingest_open(frame_ingest_t* ingest, const char* directory,
+                      uint32_t first_file_number, int num_frames,
+                      uint32_t width, uint32_t height, uint32_t channels,
+                      uint32_t pixel_format) {
+    if (!ingest || !directory) return GVC_ERROR_MEMORY;
+    if (validate_frame_dimensions(width, height, channels) != GVC_SUCCESS ||
+        validate_pixel_format(channels, pixel_format) != GVC_SUCCESS) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    memset(ingest, 0, sizeof(*ingest));
+    snprintf(ingest->directory, sizeof(ingest->directory), "%s", directory);
+    ingest->first_file_number = first_file_number;
+    ingest->num_frames = num_frames;
+    ingest->width = width;
+    ingest->height = height;
+    ingest->channels = channels;
+    ingest->pixel_format = pixel_format;
+    ingest->readahead = INGEST_READAHEAD_FRAMES;
+    ingest->next_advised = 0;
+    
+    if (pthread_mutex_init(&ingest->advise_mutex, NULL) != 0) {
+        return GVC_ERROR_THREAD;
+    }
+    
+    return GVC_SUCCESS;
+}
+
+// Map one input frame read-only. The returned pixels point straight into the
+// page cache and must be released with frame_ingest_unmap, not free_raw_frame.
+int frame_ingest_map(frame_ingest_t* ingest, int frame_index, raw_frame_t* frame_out) {
+    if (!ingest || !frame_out) return GVC_ERROR_MEMORY;
+    if (frame_index < 0 || frame_index >= ingest->num_frames) return GVC_ERROR_IO;
+    
+    size_t expected_size = frame_buffer_size(ingest->width, ingest->height,
+                                             ingest->channels, ingest->pixel_format);
+    char filename[1024];
+    
+    // Keep the read-ahead window topped up before touching this frame. Several
+    // encoder workers map frames concurrently, so claim advice ranges under a lock.
+    int advise_end = MIN(frame_index + 1 + ingest->readahead, ingest->num_frames);
+    pthread_mutex_lock(&ingest->advise_mutex);
+    int advise_start = MAX(ingest->next_advised, frame_index + 1);
+    if (advise_end > ingest->next_advised) {
+        ingest->next_advised = advise_end;
+    }
+    pthread_mutex_unlock(&ingest->advise_mutex);
+    
+    for (int i = advise_start; i < advise_end; i++) {
+        generate_frame_path(ingest->directory, ingest->first_file_number + i,
+                            filename, sizeof(filename));
+        advise_frame_file(filename, expected_size);
+    }
+    
+    generate_frame_path(ingest->directory, ingest->first_file_number + frame_index,
+                        filename, sizeof(filename));
+    
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return GVC_ERROR_IO;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return GVC_ERROR_IO;
+    }
+    
+    if ((size_t)st.st_size != expected_size) {
+        close(fd);
+        return GVC_ERROR_FORMAT;
+    }
+    
+    void* mapping = mmap(NULL, expected_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file referenced
+    
+    if (mapping == MAP_FAILED) return GVC_ERROR_IO;
+    
+    madvise(mapping, expected_size, MADV_SEQUENTIAL);
+    
+    frame_out->pixels = (uint8_t*)mapping;
+    frame_out->width = ingest->width;
+    frame_out->height = ingest->height;
+    frame_out->channels = ingest->channels;
+    frame_out->pixel_format = ingest->pixel_format;
+    
+    return GVC_SUCCESS;
+}
+
+void frame_ingest_unmap(raw_frame_t* frame) {
+    if (frame && frame->pixels) {
+        munmap(frame->pixels, raw_frame_size(frame));
+        frame->pixels = NULL;
+    }
+}
+
+void frame_ingest_close(frame_ingest_t* ingest) {
+    if (ingest) {
+        pthread_mutex_destroy(&ingest->advise_mutex);
+        ingest->num_frames = 0;
+        ingest->next_advised = 0;
+    }
+}
+
+// Frame source callbacks so the encode pipeline can pull mapped frames
+static int ingest_source_load(void* ctx, int frame_index, raw_frame_t* frame_out) {
+    return frame_ingest_map((frame_ingest_t*)ctx, frame_index, frame_out);
+}
+
+static void ingest_source_release(void* ctx, raw_frame_t* frame) {
+    (void)ctx;
+    frame_ingest_unmap(frame);
+}
+
+void frame_ingest_source(frame_ingest_t* ingest, frame_source_t* source_out) {
+    source_out->ctx = ingest;
+    source_out->num_frames = ingest->num_frames;
+    source_out->load = ingest_source_load;
+    source_out->release = ingest_source_release;
+}
@@ -0,0 +1,423 @@
+#include "git_vid_codec.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GVC_SIMD_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GVC_SIMD_SSE2 1
+#endif
+
+// Pixel conversion kernels for the display backends.
+//
+// Frames carry their own dimensions, so the generic kernels take width,
+// height and channel count at run time. The common RGB24 sizes get their own
+// instantiations with the dimensions baked in as constants, which lets the
+// compiler fully unroll and vectorize the inner loops instead of handling an
+// unknown trip count and channel stride per pixel.
+//
+// The byte-buffer kernels at the end (SAD, averaging) serve the encoder's
+// scene analysis and bidirectional prediction, which the decoder also needs.
+
+// Generic fallbacks: any size, 1 (gray), 3 (RGB) or 4 (RGBA) channels
+static void generic_to_bgrx(const uint8_t* src, uint8_t* dst,
+                            uint32_t width, uint32_t height, uint32_t channels) {
+    size_t pixel_count = (size_t)width * height;
+    
+    for (size_t i = 0; i < pixel_count; i++) {
+        const uint8_t* s = src + i * channels;
+        uint8_t* d = dst + i * 4;
+        if (channels == 1) {
+            d[0] = d[1] = d[2] = s[0];
+        } else {
+            d[0] = s[2];
+            d[1] = s[1];
+            d[2] = s[0];
+        }
+        d[3] = 0;
+    }
+}
+
+static void generic_to_bgr(const uint8_t* src, uint8_t* dst,
+                           uint32_t width, uint32_t height, uint32_t channels) {
+    size_t pixel_count = (size_t)width * height;
+    
+    for (size_t i = 0; i < pixel_count; i++) {
+        const uint8_t* s = src + i * channels;
+        uint8_t* d = dst + i * 3;
+        if (channels == 1) {
+            d[0] = d[1] = d[2] = s[0];
+        } else {
+            d[0] = s[2];
+            d[1] = s[1];
+            d[2] = s[0];
+        }
+    }
+}
+
+static void generic_to_rgba(const uint8_t* src, uint8_t* dst,
+                            uint32_t width, uint32_t height, uint32_t channels) {
+    size_t pixel_count = (size_t)width * height;
+    
+    for (size_t i = 0; i < pixel_count; i++) {
+        const uint8_t* s = src + i * channels;
+        uint8_t* d = dst + i * 4;
+        if (channels == 1) {
+            d[0] = d[1] = d[2] = s[0];
+        } else {
+            d[0] = s[0];
+            d[1] = s[1];
+            d[2] = s[2];
+        }
+        d[3] = (channels == 4) ? s[3] : 255;
+    }
+}
+
+// YUV420P -> RGB, BT.601 limited range, 6-bit fixed point:
+//   Y' = (Y * 0x0101 * 18997) >> 16 - 1160   (1.164 * 64 * (Y - 16), plus rounding)
+//   R = (Y' + 102 * V') >> 6
+//   G = (Y' - 25 * U' - 52 * V') >> 6
+//   B = (Y' + 129 * U') >> 6                  with U' = U - 128, V' = V - 128
+// The SIMD paths use exactly this arithmetic, so every path produces identical pixels.
+#define YUV_Y_SCALE 18997
+#define YUV_Y_BIAS 1160
+#define YUV_V_TO_R 102
+#define YUV_U_TO_G 25
+#define YUV_V_TO_G 52
+#define YUV_U_TO_B 129
+
+static inline uint8_t clamp_pixel(int value) {
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static inline void yuv_to_rgb_pixel(int y, int u, int v, uint8_t* r, uint8_t* g, uint8_t* b) {
+    int luma = (int)(((uint32_t)y * 0x0101 * YUV_Y_SCALE) >> 16) - YUV_Y_BIAS;
+    u -= 128;
+    v -= 128;
+    *r = clamp_pixel((luma + YUV_V_TO_R * v) >> 6);
+    *g = clamp_pixel((luma - YUV_U_TO_G * u - YUV_V_TO_G * v) >> 6);
+    *b = clamp_pixel((luma + YUV_U_TO_B * u) >> 6);
+}
+
+// Output layouts: byte order of R, G, B within a pixel, plus optional fourth byte
+typedef enum {
+    YUV_OUT_BGRX,
+    YUV_OUT_BGR,
+    YUV_OUT_RGBA
+} yuv_output_t;
+
+#if defined(GVC_SIMD_SSE2)
+// 8 pixels: 8 luma samples and 4 chroma pairs, to 8-bit R, G, B in the low halves
+static inline void yuv_to_rgb_sse2(const uint8_t* y_row, const uint8_t* u_row, const uint8_t* v_row,
+                                   __m128i* r_out, __m128i* g_out, __m128i* b_out) {
+    const __m128i zero = _mm_setzero_si128();
+    int32_t u4, v4;
+    memcpy(&u4, u_row, 4);
+    memcpy(&v4, v_row, 4);
+    
+    __m128i y8 = _mm_loadl_epi64((const __m128i*)y_row);
+    __m128i luma = _mm_mulhi_epu16(_mm_unpacklo_epi8(y8, y8), _mm_set1_epi16(YUV_Y_SCALE));
+    luma = _mm_sub_epi16(luma, _mm_set1_epi16(YUV_Y_BIAS));
+    
+    // Duplicate each chroma sample for the two pixels it covers
+    __m128i u8 = _mm_cvtsi32_si128(u4);
+    __m128i v8 = _mm_cvtsi32_si128(v4);
+    __m128i u = _mm_unpacklo_epi8(_mm_unpacklo_epi8(u8, u8), zero);
+    __m128i v = _mm_unpacklo_epi8(_mm_unpacklo_epi8(v8, v8), zero);
+    u = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    v = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    
+    __m128i r = _mm_adds_epi16(luma, _mm_mullo_epi16(v, _mm_set1_epi16(YUV_V_TO_R)));
+    __m128i g = _mm_subs_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(YUV_U_TO_G)));
+    g = _mm_subs_epi16(g, _mm_mullo_epi16(v, _mm_set1_epi16(YUV_V_TO_G)));
+    __m128i b = _mm_adds_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(YUV_U_TO_B)));
+    
+    *r_out = _mm_packus_epi16(_mm_srai_epi16(r, 6), zero);
+    *g_out = _mm_packus_epi16(_mm_srai_epi16(g, 6), zero);
+    *b_out = _mm_packus_epi16(_mm_srai_epi16(b, 6), zero);
+}
+#endif
+
+#if defined(GVC_SIMD_NEON)
+static inline void yuv_to_rgb_neon(const uint8_t* y_row, const uint8_t* u_row, const uint8_t* v_row,
+                                   uint8x8_t* r_out, uint8x8_t* g_out, uint8x8_t* b_out) {
+    uint32_t u4, v4;
+    memcpy(&u4, u_row, 4);
+    memcpy(&v4, v_row, 4);
+    
+    uint16x8_t y16 = vmulq_n_u16(vmovl_u8(vld1_u8(y_row)), 0x0101);
+    uint16x4_t luma_lo = vshrn_n_u32(vmull_n_u16(vget_low_u16(y16), YUV_Y_SCALE), 16);
+    uint16x4_t luma_hi = vshrn_n_u32(vmull_n_u16(vget_high_u16(y16), YUV_Y_SCALE), 16);
+    int16x8_t luma = vsubq_s16(vreinterpretq_s16_u16(vcombine_u16(luma_lo, luma_hi)),
+                               vdupq_n_s16(YUV_Y_BIAS));
+    
+    // Duplicate each chroma sample for the two pixels it covers
+    uint8x8_t u8 = vreinterpret_u8_u32(vdup_n_u32(u4));
+    uint8x8_t v8 = vreinterpret_u8_u32(vdup_n_u32(v4));
+    int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vzip_u8(u8, u8).val[0])), vdupq_n_s16(128));
+    int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vzip_u8(v8, v8).val[0])), vdupq_n_s16(128));
+    
+    int16x8_t r = vqaddq_s16(luma, vmulq_n_s16(v, YUV_V_TO_R));
+    int16x8_t g = vqsubq_s16(vqsubq_s16(luma, vmulq_n_s16(u, YUV_U_TO_G)), vmulq_n_s16(v, YUV_V_TO_G));
+    int16x8_t b = vqaddq_s16(luma, vmulq_n_s16(u, YUV_U_TO_B));
+    
+    *r_out = vqmovun_s16(vshrq_n_s16(r, 6));
+    *g_out = vqmovun_s16(vshrq_n_s16(g, 6));
+    *b_out = vqmovun_s16(vshrq_n_s16(b, 6));
+}
+#endif
+
+// Convert one output row; chroma rows are shared by each pair of luma rows
+static void yuv420p_row(const uint8_t* y_row, const uint8_t* u_row, const uint8_t* v_row,
+                        uint8_t* dst, uint32_t width, yuv_output_t output) {
+    uint32_t x = 0;
+
+#if defined(GVC_SIMD_SSE2)
+    if (output != YUV_OUT_BGR) {
+        const __m128i alpha = output == YUV_OUT_RGBA ? _mm_set1_epi8((char)0xFF) : _mm_setzero_si128();
+        for (; x + 8 <= width; x += 8) {
+            __m128i r, g, b;
+            yuv_to_rgb_sse2(y_row + x, u_row + x / 2, v_row + x / 2, &r, &g, &b);
+            
+            __m128i lo_pair, hi_pair;
+            if (output == YUV_OUT_RGBA) {
+                lo_pair = _mm_unpacklo_epi8(r, g);
+                hi_pair = _mm_unpacklo_epi8(b, alpha);
+            } else {
+                lo_pair = _mm_unpacklo_epi8(b, g);
+                hi_pair = _mm_unpacklo_epi8(r, alpha);
+            }
+            _mm_storeu_si128((__m128i*)(dst + x * 4), _mm_unpacklo_epi16(lo_pair, hi_pair));
+            _mm_storeu_si128((__m128i*)(dst + x * 4 + 16), _mm_unpackhi_epi16(lo_pair, hi_pair));
+        }
+    }
+#elif defined(GVC_SIMD_NEON)
+    for (; x + 8 <= width; x += 8) {
+        uint8x8_t r, g, b;
+        yuv_to_rgb_neon(y_row + x, u_row + x / 2, v_row + x / 2, &r, &g, &b);
+        
+        if (output == YUV_OUT_BGR) {
+            uint8x8x3_t pixels = {{ b, g, r }};
+            vst3_u8(dst + x * 3, pixels);
+        } else if (output == YUV_OUT_RGBA) {
+            uint8x8x4_t pixels = {{ r, g, b, vdup_n_u8(255) }};
+            vst4_u8(dst + x * 4, pixels);
+        } else {
+            uint8x8x4_t pixels = {{ b, g, r, vdup_n_u8(0) }};
+            vst4_u8(dst + x * 4, pixels);
+        }
+    }
+#endif
+
+    // Scalar tail (and the whole row where no SIMD path applies)
+    for (; x < width; x++) {
+        uint8_t r, g, b;
+        yuv_to_rgb_pixel(y_row[x], u_row[x / 2], v_row[x / 2], &r, &g, &b);
+        
+        if (output == YUV_OUT_BGR) {
+            uint8_t* d = dst + x * 3;
+            d[0] = b;
+            d[1] = g;
+            d[2] = r;
+        } else if (output == YUV_OUT_RGBA) {
+            uint8_t* d = dst + x * 4;
+            d[0] = r;
+            d[1] = g;
+            d[2] = b;
+            d[3] = 255;
+        } else {
+            uint8_t* d = dst + x * 4;
+            d[0] = b;
+            d[1] = g;
+            d[2] = r;
+            d[3] = 0;
+        }
+    }
+}
+
+static void yuv420p_convert(const uint8_t* src, uint8_t* dst, uint32_t width, uint32_t height,
+                            yuv_output_t output) {
+    uint32_t chroma_width = (width + 1) / 2;
+    uint32_t chroma_height = (height + 1) / 2;
+    const uint8_t* y_plane = src;
+    const uint8_t* u_plane = y_plane + (size_t)width * height;
+    const uint8_t* v_plane = u_plane + (size_t)chroma_width * chroma_height;
+    size_t dst_stride = (size_t)width * (output == YUV_OUT_BGR ? 3 : 4);
+    
+    for (uint32_t y = 0; y < height; y++) {
+        yuv420p_row(y_plane + (size_t)y * width,
+                    u_plane + (size_t)(y / 2) * chroma_width,
+                    v_plane + (size_t)(y / 2) * chroma_width,
+                    dst + y * dst_stride, width, output);
+    }
+}
+
+static void yuv420p_to_bgrx(const uint8_t* src, uint8_t* dst,
+                            uint32_t width, uint32_t height, uint32_t channels) {
+    (void)channels;
+    yuv420p_convert(src, dst, width, height, YUV_OUT_BGRX);
+}
+
+static void yuv420p_to_bgr(const uint8_t* src, uint8_t* dst,
+                           uint32_t width, uint32_t height, uint32_t channels) {
+    (void)channels;
+    yuv420p_convert(src, dst, width, height, YUV_OUT_BGR);
+}
+
+static void yuv420p_to_rgba(const uint8_t* src, uint8_t* dst,
+                            uint32_t width, uint32_t height, uint32_t channels) {
+    (void)channels;
+    yuv420p_convert(src, dst, width, height, YUV_OUT_RGBA);
+}
+
+// RGB24 kernels with compile-time dimensions
+#define DEFINE_RGB24_KERNELS(W, H)                                                  \
+static void rgb24_to_bgrx_##W##x##H(const uint8_t* src, uint8_t* dst,               \
+                                    uint32_t width, uint32_t height,                \
+                                    uint32_t channels) {                            \
+    (void)width; (void)height; (void)channels;                                      \
+    for (uint32_t y = 0; y < (H); y++) {                                            \
+        const uint8_t* s = src + (size_t)y * (W) * 3;                               \
+        uint8_t* d = dst + (size_t)y * (W) * 4;                                     \
+        for (uint32_t x = 0; x < (W); x++) {                                        \
+            d[x * 4] = s[x * 3 + 2];                                                \
+            d[x * 4 + 1] = s[x * 3 + 1];                                            \
+            d[x * 4 + 2] = s[x * 3];                                                \
+            d[x * 4 + 3] = 0;                                                       \
+        }                                                                           \
+    }                                                                               \
+}                                                                                   \
+static void rgb24_to_bgr_##W##x##H(const uint8_t* src, uint8_t* dst,                \
+                                   uint32_t width, uint32_t height,                 \
+                                   uint32_t channels) {                             \
+    (void)width; (void)height; (void)channels;                                      \
+    for (uint32_t y = 0; y < (H); y++) {                                            \
+        const uint8_t* s = src + (size_t)y * (W) * 3;                               \
+        uint8_t* d = dst + (size_t)y * (W) * 3;                                     \
+        for (uint32_t x = 0; x < (W); x++) {                                        \
+            d[x * 3] = s[x * 3 + 2];                                                \
+            d[x * 3 + 1] = s[x * 3 + 1];                                            \
+            d[x * 3 + 2] = s[x * 3];                                                \
+        }                                                                           \
+    }                                                                               \
+}                                                                                   \
+static void rgb24_to_rgba_##W##x##H(const uint8_t* src, uint8_t* dst,               \
+                                    uint32_t width, uint32_t height,                \
+                                    uint32_t channels) {                            \
+    (void)width; (void)height; (void)channels;                                      \
+    for (uint32_t y = 0; y < (H); y++) {                                            \
+        const uint8_t* s = src + (size_t)y * (W) * 3;                               \
+        uint8_t* d = dst + (size_t)y * (W) * 4;                                     \
+        for (uint32_t x = 0; x < (W); x++) {                                        \
+            d[x * 4] = s[x * 3];                                                    \
+            d[x * 4 + 1] = s[x * 3 + 1];                                            \
+            d[x * 4 + 2] = s[x * 3 + 2];                                            \
+            d[x * 4 + 3] = 255;                                                     \
+        }                                                                           \
+    }                                                                               \
+}
+
+DEFINE_RGB24_KERNELS(1280, 720)
+DEFINE_RGB24_KERNELS(1920, 1080)
+DEFINE_RGB24_KERNELS(3840, 2160)
+
+#define RGB24_KERNEL_ENTRY(W, H) \
+    { W, H, { #W "x" #H " rgb24", rgb24_to_bgrx_##W##x##H, rgb24_to_bgr_##W##x##H, rgb24_to_rgba_##W##x##H } }
+
+static const struct {
+    uint32_t width;
+    uint32_t height;
+    frame_kernels_t kernels;
+} specialized_kernels[] = {
+    RGB24_KERNEL_ENTRY(1280, 720),
+    RGB24_KERNEL_ENTRY(1920, 1080),
+    RGB24_KERNEL_ENTRY(3840, 2160),
+};
+
+static const frame_kernels_t generic_kernels = {
+    "generic", generic_to_bgrx, generic_to_bgr, generic_to_rgba
+};
+
+static const frame_kernels_t yuv420p_kernels = {
+#if defined(GVC_SIMD_NEON)
+    "yuv420p neon",
+#elif defined(GVC_SIMD_SSE2)
+    "yuv420p sse2",
+#else
+    "yuv420p",
+#endif
+    yuv420p_to_bgrx, yuv420p_to_bgr, yuv420p_to_rgba
+};
+
+// Pick the fastest kernels for a frame shape; always returns a usable set
+const frame_kernels_t* select_frame_kernels(uint32_t width, uint32_t height, uint32_t channels,
+                                            uint32_t pixel_format) {
+    if (pixel_format == PIXEL_FORMAT_YUV420P) {
+        return &yuv420p_kernels;
+    }
+    if (channels == 3) {
+        for (size_t i = 0; i < sizeof(specialized_kernels) / sizeof(specialized_kernels[0]); i++) {
+            if (specialized_kernels[i].width == width && specialized_kernels[i].height == height) {
+                return &specialized_kernels[i].kernels;
+            }
+        }
+    }
+    return &generic_kernels;
+}
+
+// Sum of absolute byte differences
+uint64_t sum_abs_diff_u8(const uint8_t* a, const uint8_t* b, size_t size) {
+    uint64_t sum = 0;
+    size_t i = 0;
+
+#if defined(GVC_SIMD_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    sum = lanes[0] + lanes[1];
+#elif defined(GVC_SIMD_NEON)
+    uint64x2_t acc = vdupq_n_u64(0);
+    while (i + 16 <= size) {
+        // 32-bit lanes gain at most 1020 per step; widen well before they can overflow
+        uint32x4_t acc32 = vdupq_n_u32(0);
+        size_t block_end = MIN(size & ~(size_t)15, i + 16 * 4096);
+        for (; i < block_end; i += 16) {
+            uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+            acc32 = vpadalq_u16(acc32, vpaddlq_u8(diff));
+        }
+        acc = vpadalq_u32(acc, acc32);
+    }
+    sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#endif
+
+    for (; i < size; i++) {
+        sum += (uint64_t)abs((int)a[i] - (int)b[i]);
+    }
+    return sum;
+}
+
+// Rounded average of two byte buffers, (a + b + 1) / 2, as used by bidirectional prediction
+void average_u8(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size) {
+    size_t i = 0;
+
+#if defined(GVC_SIMD_SSE2)
+    for (; i + 16 <= size; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_avg_epu8(va, vb));
+    }
+#elif defined(GVC_SIMD_NEON)
+    for (; i + 16 <= size; i += 16) {
+        vst1q_u8(dst + i, vrhaddq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+    }
+#endif
+
+    for (; i < size; i++) {
+        dst[i] = (uint8_t)((a[i] + b[i] + 1) >> 1);
+    }
+}
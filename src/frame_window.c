@@ -0,0 +1,158 @@
+#include "git_vid_codec.h"
+
+// Shared window of loaded source frames. Every encoded frame is also a reference
+// for the frames after it (and a B frame's future frame is one about to be coded
+// anyway), so without sharing each worker loads the same frame up to
+// REFERENCE_CACHE_SIZE + 2 times; for synthetic sources every load is a full render.
+//
+// The window wraps a frame_source_t and is itself one: load pins the cached frame
+// for that index, loading it once if absent, and release unpins it. Unpinned
+// frames stay cached until their entry is needed for another index. When every
+// entry is pinned, loads fall through to the underlying source uncached.
+
+static frame_window_entry_t* find_entry(frame_window_t* window, int frame_index) {
+    for (int i = 0; i < window->capacity; i++) {
+        if (window->entries[i].frame_index == frame_index) {
+            return &window->entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Empty entry if there is one, otherwise the least recently used unpinned one
+static frame_window_entry_t* claim_entry(frame_window_t* window) {
+    frame_window_entry_t* victim = NULL;
+    for (int i = 0; i < window->capacity; i++) {
+        frame_window_entry_t* entry = &window->entries[i];
+        if (entry->frame_index == -1) {
+            return entry;
+        }
+        if (entry->refs == 0 && !entry->loading &&
+            (!victim || entry->last_use < victim->last_use)) {
+            victim = entry;
+        }
+    }
+    return victim;
+}
+
+static int window_load(void* ctx, int frame_index, raw_frame_t* frame_out) {
+    frame_window_t* window = (frame_window_t*)ctx;
+    const frame_source_t* source = window->source;
+    
+    pthread_mutex_lock(&window->mutex);
+    frame_window_entry_t* entry;
+    while ((entry = find_entry(window, frame_index)) != NULL && entry->loading) {
+        pthread_cond_wait(&window->changed, &window->mutex);
+    }
+    if (entry) {
+        entry->refs++;
+        entry->last_use = ++window->clock;
+        *frame_out = entry->frame;
+        pthread_mutex_unlock(&window->mutex);
+        return GVC_SUCCESS;
+    }
+    
+    entry = claim_entry(window);
+    if (!entry) {
+        pthread_mutex_unlock(&window->mutex);
+        return source->load(source->ctx, frame_index, frame_out);
+    }
+    
+    raw_frame_t evicted = entry->frame;
+    int had_frame = entry->frame_index != -1;
+    entry->frame_index = frame_index;
+    entry->loading = 1;
+    entry->refs = 1;
+    memset(&entry->frame, 0, sizeof(entry->frame));
+    pthread_mutex_unlock(&window->mutex);
+    
+    if (had_frame) {
+        source->release(source->ctx, &evicted);
+    }
+    raw_frame_t loaded;
+    int result = source->load(source->ctx, frame_index, &loaded);
+    
+    pthread_mutex_lock(&window->mutex);
+    entry->loading = 0;
+    if (result == GVC_SUCCESS) {
+        entry->frame = loaded;
+        entry->last_use = ++window->clock;
+        *frame_out = loaded;
+    } else {
+        // Waiters retry the load themselves and see the error first-hand
+        entry->frame_index = -1;
+        entry->refs = 0;
+    }
+    pthread_cond_broadcast(&window->changed);
+    pthread_mutex_unlock(&window->mutex);
+    
+    return result;
+}
+
+static void window_release(void* ctx, raw_frame_t* frame) {
+    frame_window_t* window = (frame_window_t*)ctx;
+    
+    pthread_mutex_lock(&window->mutex);
+    for (int i = 0; i < window->capacity; i++) {
+        frame_window_entry_t* entry = &window->entries[i];
+        if (entry->frame_index != -1 && !entry->loading && entry->refs > 0 &&
+            entry->frame.pixels == frame->pixels) {
+            entry->refs--;
+            pthread_mutex_unlock(&window->mutex);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&window->mutex);
+    
+    // Loaded while the window was full
+    window->source->release(window->source->ctx, frame);
+}
+
+int frame_window_init(frame_window_t* window, const frame_source_t* source, int capacity) {
+    if (!window || !source || !source->load || !source->release || capacity < 1) {
+        return GVC_ERROR_MEMORY;
+    }
+    
+    memset(window, 0, sizeof(*window));
+    window->source = source;
+    window->capacity = capacity;
+    window->entries = calloc(capacity, sizeof(frame_window_entry_t));
+    if (!window->entries) return GVC_ERROR_MEMORY;
+    for (int i = 0; i < capacity; i++) {
+        window->entries[i].frame_index = -1;
+    }
+    
+    if (pthread_mutex_init(&window->mutex, NULL) != 0) {
+        free(window->entries);
+        return GVC_ERROR_THREAD;
+    }
+    if (pthread_cond_init(&window->changed, NULL) != 0) {
+        pthread_mutex_destroy(&window->mutex);
+        free(window->entries);
+        return GVC_ERROR_THREAD;
+    }
+    
+    return GVC_SUCCESS;
+}
+
+void frame_window_source(frame_window_t* window, frame_source_t* source_out) {
+    source_out->ctx = window;
+    source_out->num_frames = window->source->num_frames;
+    source_out->load = window_load;
+    source_out->release = window_release;
+}
+
+// Releases every cached frame; all holders must have released theirs
+void frame_window_destroy(frame_window_t* window) {
+    if (!window || !window->entries) return;
+    
+    for (int i = 0; i < window->capacity; i++) {
+        if (window->entries[i].frame_index != -1) {
+            window->source->release(window->source->ctx, &window->entries[i].frame);
+        }
+    }
+    pthread_cond_destroy(&window->changed);
+    pthread_mutex_destroy(&window->mutex);
+    free(window->entries);
+    window->entries = NULL;
+}
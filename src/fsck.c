@@ -0,0 +1,379 @@
+#include "git_vid_codec.h"
+#include <unistd.h>
+#include <sys/time.h>
+
+// git-vid-fsck: check that every commit of a video repository holds a frame that a
+// player can decode. The commit chain is checked first; then each frame's blob is
+// checked for truncation, its magic number, header fields and payload checksum,
+// and decoded (in parallel, see repo_walk) to find frames with no reachable
+// keyframe or reference, decoder failures and pixel hash mismatches. Problems are
+// printed as they are found and, with -o, written as JSON Lines for pipelines:
+//
+//   {"check":"checksum_mismatch","severity":"error","index":41,"frame":41,"commit":"...","detail":"..."}
+//   ...
+//   {"summary":true,"commits":600,"decoded":599,"errors":2,"warnings":1,...}
+
+typedef enum {
+    FSCK_WARNING,  // Playable, but not as the encoder wrote it
+    FSCK_ERROR     // A frame players cannot show, or show wrongly
+} fsck_severity_t;
+
+typedef struct {
+    uint32_t frame_number;
+    int index;
+} fsck_numbered_frame_t;
+
+typedef struct {
+    pthread_mutex_t mutex;  // Guards everything below and both outputs
+    FILE* report;           // JSON Lines report, or NULL
+    int errors;
+    int warnings;
+    int decoded;
+    int hashed;
+    fsck_numbered_frame_t* numbered;  // Frames whose header could be read
+    int num_numbered;
+} fsck_state_t;
+
+// Object names and details never hold control characters; quotes and
+// backslashes are the only characters JSON needs escaped
+static void write_json_string(FILE* out, const char* value) {
+    fputc('"', out);
+    for (const char* c = value; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+        }
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+// Print one problem and append it to the report. Caller holds state->mutex.
+// frame_number is -1 when the frame's header could not be read.
+static void report_problem(fsck_state_t* state, fsck_severity_t severity, const char* check,
+                           int index, const char* commit, int64_t frame_number, const char* detail) {
+    const char* severity_name = severity == FSCK_ERROR ? "error" : "warning";
+    if (severity == FSCK_ERROR) {
+        state->errors++;
+    } else {
+        state->warnings++;
+    }
+    
+    if (frame_number >= 0) {
+        printf("%-7s commit %d (%.12s) frame %06lld: %s: %s\n", severity_name, index,
+               commit ? commit : "-", (long long)frame_number, check, detail);
+    } else {
+        printf("%-7s commit %d (%.12s): %s: %s\n", severity_name, index,
+               commit ? commit : "-", check, detail);
+    }
+    fflush(stdout);
+    
+    if (!state->report) return;
+    fprintf(state->report, "{\"check\":\"%s\",\"severity\":\"%s\",\"index\":%d,", check, severity_name, index);
+    if (frame_number >= 0) {
+        fprintf(state->report, "\"frame\":%lld,", (long long)frame_number);
+    } else {
+        fprintf(state->report, "\"frame\":null,");
+    }
+    fprintf(state->report, "\"commit\":");
+    if (commit) {
+        write_json_string(state->report, commit);
+    } else {
+        fprintf(state->report, "null");
+    }
+    fprintf(state->report, ",\"detail\":");
+    write_json_string(state->report, detail);
+    fprintf(state->report, "}\n");
+    fflush(state->report);
+}
+
+// Every commit must have exactly the previous frame's commit as its only parent
+static void check_parent_chain(fsck_state_t* state, char** commits, char** parents, int num_commits) {
+    char detail[256];
+    for (int i = 0; i < num_commits; i++) {
+        const char* expected = i > 0 ? commits[i - 1] : "";
+        if (strcmp(parents[i], expected) == 0) continue;
+        
+        if (i == 0) {
+            snprintf(detail, sizeof(detail), "first commit has parents %.200s", parents[i]);
+        } else if (parents[i][0] == '\0') {
+            snprintf(detail, sizeof(detail), "second root commit; expected parent %.12s", expected);
+        } else if (strchr(parents[i], ' ')) {
+            snprintf(detail, sizeof(detail), "merge commit (parents %.200s)", parents[i]);
+        } else {
+            snprintf(detail, sizeof(detail), "parent %.12s is not the previous frame's commit %.12s",
+                     parents[i], expected);
+        }
+        report_problem(state, FSCK_ERROR, "parent_chain", i, commits[i], -1, detail);
+    }
+}
+
+// Structural checks on a frame blob, in the order a reader depends on them.
+// Returns the failed check's name, or NULL if the blob is a well-formed frame.
+static const char* check_blob(const repo_frame_t* frame, fsck_severity_t* severity_out,
+                              char* detail, size_t detail_size) {
+    const size_t header_size = sizeof(uint32_t) + sizeof(frame_header_t);
+    *severity_out = FSCK_ERROR;
+    
+    if (!frame->blob) {
+        snprintf(detail, detail_size, frame->read_result == GVC_ERROR_FORMAT ?
+                 "frame.bin is larger than any frame" : "commit has no frame.bin");
+        return "missing_blob";
+    }
+    if (frame->blob_size < header_size) {
+        snprintf(detail, detail_size, "%zu of %zu header bytes", frame->blob_size, header_size);
+        return "truncated_header";
+    }
+    
+    uint32_t magic;
+    memcpy(&magic, frame->blob, sizeof(magic));
+    if (!frame_magic_supported(magic)) {
+        snprintf(detail, detail_size, "magic 0x%08x, expected 0x%08x or 0x%08x", magic, FRAME_MAGIC,
+                 FRAME_MAGIC_V2);
+        return "bad_magic";
+    }
+    
+    frame_header_t header;
+    unpack_frame_header(frame->blob, &header);
+    if (validate_frame_header(&header) != GVC_SUCCESS) {
+        snprintf(detail, detail_size, "%ux%u, %u channels, format %u, type %u, backend byte 0x%02x, reference %u",
+                 header.width, header.height, header.channels, header.pixel_format,
+                 header.compression_type, header.backend, header.reference);
+        return "invalid_header";
+    }
+    
+    size_t available = frame->blob_size - header_size;
+    if (header.compressed_size > available) {
+        snprintf(detail, detail_size, "%zu of %u payload bytes", available, header.compressed_size);
+        return "truncated_payload";
+    }
+    
+    if (header.compressed_size > 0) {
+        uint32_t computed = calculate_payload_checksum(FRAME_CHECKSUM_TYPE(&header),
+                                                       frame->blob + header_size, header.compressed_size);
+        if (computed != header.checksum) {
+            snprintf(detail, detail_size, "%s stored %08x, computed %08x",
+                     checksum_name(FRAME_CHECKSUM_TYPE(&header)), header.checksum, computed);
+            return "checksum_mismatch";
+        }
+    }
+    
+    // Anything after the payload must be exactly a pixel hash trailer
+    size_t trailing = available - header.compressed_size;
+    pixel_hash_t hash;
+    if (trailing > 0 && !(trailing == PIXEL_HASH_TRAILER_SIZE &&
+                          read_frame_pixel_hash(frame->blob, frame->blob_size, &hash) == GVC_SUCCESS)) {
+        *severity_out = FSCK_WARNING;
+        snprintf(detail, detail_size, "%zu unexpected bytes after the payload", trailing);
+        return "trailing_data";
+    }
+    return NULL;
+}
+
+static void check_frame(void* ctx, const repo_frame_t* frame) {
+    fsck_state_t* state = (fsck_state_t*)ctx;
+    
+    fsck_severity_t blob_severity;
+    char blob_detail[160];
+    const char* blob_problem = check_blob(frame, &blob_severity, blob_detail, sizeof(blob_detail));
+    
+    frame_header_t header;
+    int has_header = frame->blob && read_frame_header(frame->blob, frame->blob_size, &header) == GVC_SUCCESS;
+    int64_t frame_number = has_header ? (int64_t)header.frame_number : -1;
+    
+    // The pixel hash is compared outside the lock so workers hash in parallel
+    pixel_hash_t expected, actual;
+    int hashed = frame->state == REPO_FRAME_DECODED &&
+                 read_frame_pixel_hash(frame->blob, frame->blob_size, &expected) == GVC_SUCCESS;
+    if (hashed) {
+        hash_frame_pixels(frame->decoded, &actual);
+    }
+    
+    char detail[192];
+    pthread_mutex_lock(&state->mutex);
+    if (has_header) {
+        state->numbered[state->num_numbered].frame_number = header.frame_number;
+        state->numbered[state->num_numbered].index = frame->index;
+        state->num_numbered++;
+    }
+    if (blob_problem) {
+        report_problem(state, blob_severity, blob_problem, frame->index, frame->commit,
+                       frame_number, blob_detail);
+    }
+    
+    switch (frame->state) {
+        case REPO_FRAME_DECODED:
+            state->decoded++;
+            if (hashed && !pixel_hash_equal(&expected, &actual)) {
+                char expected_hex[PIXEL_HASH_HEX_SIZE], actual_hex[PIXEL_HASH_HEX_SIZE];
+                format_pixel_hash(&expected, expected_hex);
+                format_pixel_hash(&actual, actual_hex);
+                snprintf(detail, sizeof(detail), "stored %s, decoded %s", expected_hex, actual_hex);
+                report_problem(state, FSCK_ERROR, "pixel_hash_mismatch", frame->index, frame->commit,
+                               frame_number, detail);
+            }
+            state->hashed += hashed;
+            break;
+        case REPO_FRAME_UNREADABLE:
+            // Already explained by the blob checks unless deserializing failed for another reason
+            if (!blob_problem || blob_severity != FSCK_ERROR) {
+                snprintf(detail, sizeof(detail), "frame blob does not deserialize (error %d)",
+                         frame->deserialize_result);
+                report_problem(state, FSCK_ERROR, "unreadable", frame->index, frame->commit,
+                               frame_number, detail);
+            }
+            break;
+        case REPO_FRAME_NO_REFERENCE:
+            snprintf(detail, sizeof(detail), "type %u frame with reference %u has no reachable keyframe or reference frame",
+                     header.compression_type, header.reference);
+            report_problem(state, FSCK_ERROR, "no_reference", frame->index, frame->commit,
+                           frame_number, detail);
+            break;
+        case REPO_FRAME_DECODE_FAILED:
+            snprintf(detail, sizeof(detail), "type %u frame failed to decode (error %d)",
+                     header.compression_type, frame->decode_result);
+            report_problem(state, FSCK_ERROR, "undecodable", frame->index, frame->commit,
+                           frame_number, detail);
+            break;
+        case REPO_FRAME_SKIPPED:
+            report_problem(state, FSCK_WARNING, "not_decoded", frame->index, frame->commit, frame_number,
+                           "an earlier frame of its GOP failed; decoding resumes at the next keyframe");
+            break;
+    }
+    pthread_mutex_unlock(&state->mutex);
+}
+
+static int compare_numbered_frames(const void* a, const void* b) {
+    const fsck_numbered_frame_t* fa = (const fsck_numbered_frame_t*)a;
+    const fsck_numbered_frame_t* fb = (const fsck_numbered_frame_t*)b;
+    if (fa->frame_number != fb->frame_number) return fa->frame_number < fb->frame_number ? -1 : 1;
+    return fa->index - fb->index;
+}
+
+// Frame numbers must cover a range without repeats. Commits are in coding order,
+// so B frames legitimately appear after the frame that follows them.
+static void check_frame_numbers(fsck_state_t* state, char** commits) {
+    qsort(state->numbered, state->num_numbered, sizeof(fsck_numbered_frame_t), compare_numbered_frames);
+    
+    char detail[128];
+    for (int i = 1; i < state->num_numbered; i++) {
+        const fsck_numbered_frame_t* previous = &state->numbered[i - 1];
+        const fsck_numbered_frame_t* current = &state->numbered[i];
+        if (current->frame_number == previous->frame_number) {
+            snprintf(detail, sizeof(detail), "frame number already used by commit %d (%.12s)",
+                     previous->index, commits[previous->index]);
+            report_problem(state, FSCK_ERROR, "duplicate_frame", current->index, commits[current->index],
+                           current->frame_number, detail);
+        } else if (current->frame_number != previous->frame_number + 1) {
+            if (current->frame_number == previous->frame_number + 2) {
+                snprintf(detail, sizeof(detail), "no commit holds frame %u", previous->frame_number + 1);
+            } else {
+                snprintf(detail, sizeof(detail), "no commit holds frames %u to %u",
+                         previous->frame_number + 1, current->frame_number - 1);
+            }
+            report_problem(state, FSCK_ERROR, "missing_frames", current->index, commits[current->index],
+                           current->frame_number, detail);
+        }
+    }
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-j threads] [-o report.jsonl] <repo_path>\n", program);
+    printf("\nChecks the commit chain, then the header, payload checksum and decodability of\n");
+    printf("every frame, and compares decoded pixels with stored pixel hashes.\n");
+    printf("\nOptions:\n");
+    printf("  -j threads   Decoder threads (default: one per CPU)\n");
+    printf("  -o file      Also write every problem and a summary as JSON Lines\n");
+    printf("\nExit status is 0 if no errors were found; warnings alone do not fail.\n");
+}
+
+int main(int argc, char* argv[]) {
+    int num_threads = 0;
+    const char* report_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:o:")) != -1) {
+        switch (opt) {
+            case 'j':
+                num_threads = atoi(optarg);
+                break;
+            case 'o':
+                report_path = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    fsck_state_t state;
+    memset(&state, 0, sizeof(state));
+    pthread_mutex_init(&state.mutex, NULL);
+    
+    // Opened before changing directory so relative report paths mean what the caller meant
+    if (report_path) {
+        state.report = fopen(report_path, "w");
+        if (!state.report) {
+            fprintf(stderr, "Error: Cannot write report: %s\n", report_path);
+            return 1;
+        }
+    }
+    
+    const char* repo_path = argv[optind];
+    if (chdir(repo_path) != 0) {
+        fprintf(stderr, "Error: Failed to change to repository directory: %s\n", repo_path);
+        return 1;
+    }
+    
+    char** commits;
+    char** parents;
+    int num_commits;
+    if (git_list_commits(&commits, &parents, &num_commits) != GVC_SUCCESS || num_commits == 0) {
+        fprintf(stderr, "Error: No commits found in repository\n");
+        return 1;
+    }
+    
+    state.numbered = malloc(sizeof(fsck_numbered_frame_t) * num_commits);
+    if (!state.numbered) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return 1;
+    }
+    num_threads = repo_walk_threads(num_threads, num_commits);
+    
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);
+    
+    check_parent_chain(&state, commits, parents, num_commits);
+    if (repo_walk(commits, num_commits, num_threads, check_frame, &state) != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Failed to start git cat-file\n");
+        return 1;
+    }
+    check_frame_numbers(&state, commits);
+    
+    gettimeofday(&end_time, NULL);
+    double elapsed = (end_time.tv_sec - start_time.tv_sec) +
+                     (end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+    
+    printf("\nChecked %d commits in %.2fs (%.0f fps, %d threads)\n", num_commits, elapsed,
+           elapsed > 0 ? num_commits / elapsed : 0.0, num_threads);
+    printf("  Decoded:  %d (%d against a stored pixel hash)\n", state.decoded, state.hashed);
+    printf("  Errors:   %d\n", state.errors);
+    printf("  Warnings: %d\n", state.warnings);
+    
+    if (state.report) {
+        fprintf(state.report, "{\"summary\":true,\"commits\":%d,\"decoded\":%d,\"hashed\":%d,"
+                "\"errors\":%d,\"warnings\":%d,\"threads\":%d,\"seconds\":%.3f}\n",
+                num_commits, state.decoded, state.hashed, state.errors, state.warnings,
+                num_threads, elapsed);
+        fclose(state.report);
+    }
+    
+    pthread_mutex_destroy(&state.mutex);
+    git_free_commit_list(commits, num_commits);
+    git_free_commit_list(parents, num_commits);
+    free(state.numbered);
+    
+    return state.errors == 0 ? 0 : 1;
+}
@@ -1,8 +1,10 @@
 #include "git_vid_codec.h"
+#include "probes.h"
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <errno.h>
+#include <fcntl.h>
 
 // Helper function to execute git commands
 static int execute_git_command(const char* command, char* output, size_t output_size) {
@@ -36,16 +38,29 @@ static int execute_git_command(const char* command, char* output, size_t output_
 }
 
 // Helper function to write data to a temporary file
+// mkstemp keeps names unique when encoder workers create blobs concurrently
 static int write_temp_file(const uint8_t* data, size_t size, char* filename_out) {
-    sprintf(filename_out, "/tmp/git_vid_blob_%d_%ld", getpid(), time(NULL));
+    strcpy(filename_out, "/tmp/git_vid_blob_XXXXXX");
     
-    FILE* file = fopen(filename_out, "wb");
-    if (!file) return GVC_ERROR_IO;
+    int fd = mkstemp(filename_out);
+    if (fd < 0) return GVC_ERROR_IO;
+    
+    FILE* file = fdopen(fd, "wb");
+    if (!file) {
+        close(fd);
+        unlink(filename_out);
+        return GVC_ERROR_IO;
+    }
     
     size_t written = fwrite(data, 1, size, file);
     fclose(file);
     
-    return (written == size) ? GVC_SUCCESS : GVC_ERROR_IO;
+    if (written != size) {
+        unlink(filename_out);
+        return GVC_ERROR_IO;
+    }
+    
+    return GVC_SUCCESS;
 }
 
 int git_init_repo(const char* path) {
@@ -174,7 +189,7 @@ int git_read_blob(const char* hash, uint8_t** data_out, size_t* size_out) {
         return GVC_SUCCESS;
     }
     
-
+    
     free(buffer);
     return GVC_ERROR_GIT;
 }
@@ -229,10 +244,7 @@ int git_get_blob_from_commit(const char* commit_hash, char* blob_hash_out) {
     return execute_git_command(command, blob_hash_out, GIT_HASH_SIZE + 1);
 }
 
-// Optimized function to read frame data from a specific commit
-int git_read_frame_from_commit(const char* commit_hash, uint8_t** data_out, size_t* size_out) {
-    if (!commit_hash || !data_out || !size_out) return GVC_ERROR_MEMORY;
-    
+static int read_frame_blob(const char* commit_hash, uint8_t** data_out, size_t* size_out) {
     // Use git show to directly read the file content in one command
     char command[256];
     snprintf(command, sizeof(command), "git show %s:frame.bin", commit_hash);
@@ -281,4 +293,322 @@ int git_read_frame_from_commit(const char* commit_hash, uint8_t** data_out, size
     
     free(buffer);
     return GVC_ERROR_GIT;
-}
\ No newline at end of file
+}
+
+// Optimized function to read frame data from a specific commit
+int git_read_frame_from_commit(const char* commit_hash, uint8_t** data_out, size_t* size_out) {
+    if (!commit_hash || !data_out || !size_out) return GVC_ERROR_MEMORY;
+    
+    GVC_PROBE1(commit_read_start, commit_hash);
+    int result = read_frame_blob(commit_hash, data_out, size_out);
+    GVC_PROBE3(commit_read_done, commit_hash, result == GVC_SUCCESS ? *size_out : 0, result);
+    return result;
+}
+
+// Single-quote text for the shell; a quote inside becomes '\''
+static int shell_quote(const char* text, char* out, size_t out_size) {
+    size_t length = 0;
+    if (out_size < 3) return GVC_ERROR_MEMORY;
+    out[length++] = '\'';
+    for (; *text; text++) {
+        if (length + 5 >= out_size) return GVC_ERROR_MEMORY;
+        if (*text == '\'') {
+            memcpy(out + length, "'\\''", 4);
+            length += 4;
+        } else {
+            out[length++] = *text;
+        }
+    }
+    out[length++] = '\'';
+    out[length] = '\0';
+    return GVC_SUCCESS;
+}
+
+// Every commit on HEAD's first-parent chain, oldest first, and optionally each one's
+// parents (space-separated, empty for a root); free both with git_free_commit_list
+int git_list_commits(char*** commit_hashes_out, char*** parents_out, int* num_commits_out) {
+    return git_list_repo_commits(NULL, commit_hashes_out, parents_out, num_commits_out);
+}
+
+// git_list_commits for the repository at repo_path, or the current directory if NULL
+int git_list_repo_commits(const char* repo_path, char*** commit_hashes_out, char*** parents_out,
+                          int* num_commits_out) {
+    if (!commit_hashes_out || !num_commits_out) return GVC_ERROR_MEMORY;
+    
+    char quoted_path[1100] = "";
+    if (repo_path && shell_quote(repo_path, quoted_path, sizeof(quoted_path)) != GVC_SUCCESS) {
+        return GVC_ERROR_MEMORY;
+    }
+    char command[1200];
+    snprintf(command, sizeof(command), "git%s%s log --reverse --first-parent --format='%%H %%P'",
+             repo_path ? " -C " : "", quoted_path);
+    FILE* pipe = popen(command, "r");
+    if (!pipe) return GVC_ERROR_GIT;
+    
+    int capacity = 1024;
+    int count = 0;
+    char** hashes = malloc(sizeof(char*) * capacity);
+    char** parents = parents_out ? malloc(sizeof(char*) * capacity) : NULL;
+    if (!hashes || (parents_out && !parents)) {
+        free(hashes);
+        free(parents);
+        pclose(pipe);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    char line[1024];
+    int result = GVC_SUCCESS;
+    while (fgets(line, sizeof(line), pipe) != NULL) {
+        size_t len = strlen(line);
+        if (len > 0 && line[len - 1] == '\n') {
+            line[--len] = '\0';
+        }
+        if (len < GIT_HASH_SIZE + 1 || line[GIT_HASH_SIZE] != ' ') continue;
+        line[GIT_HASH_SIZE] = '\0';
+        
+        if (count == capacity) {
+            capacity *= 2;
+            char** grown = realloc(hashes, sizeof(char*) * capacity);
+            if (grown) {
+                hashes = grown;
+            }
+            if (grown && parents) {
+                grown = realloc(parents, sizeof(char*) * capacity);
+                if (grown) {
+                    parents = grown;
+                }
+            }
+            if (!grown) {
+                result = GVC_ERROR_MEMORY;
+                break;
+            }
+        }
+        hashes[count] = strdup(line);
+        if (parents) {
+            parents[count] = strdup(line + GIT_HASH_SIZE + 1);
+        }
+        if (!hashes[count] || (parents && !parents[count])) {
+            free(hashes[count]);
+            if (parents) {
+                free(parents[count]);
+            }
+            result = GVC_ERROR_MEMORY;
+            break;
+        }
+        count++;
+    }
+    
+    int status = pclose(pipe);
+    if (result == GVC_SUCCESS && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+        result = GVC_ERROR_GIT;
+    }
+    if (result != GVC_SUCCESS) {
+        git_free_commit_list(hashes, count);
+        git_free_commit_list(parents, count);
+        return result;
+    }
+    
+    *commit_hashes_out = hashes;
+    if (parents_out) {
+        *parents_out = parents;
+    }
+    *num_commits_out = count;
+    return GVC_SUCCESS;
+}
+
+void git_free_commit_list(char** commit_hashes, int num_commits) {
+    if (!commit_hashes) return;
+    for (int i = 0; i < num_commits; i++) {
+        free(commit_hashes[i]);
+    }
+    free(commit_hashes);
+}
+
+// A long-lived `git cat-file --batch` process, so tools reading thousands of
+// frames pay for one fork instead of one per frame. Open readers before starting
+// threads: the pipes are close-on-exec, but a fork racing with pipe() could still
+// leak an end into another child and keep its git from seeing EOF.
+int git_batch_open(git_batch_reader_t* reader) {
+    return git_batch_open_repo(reader, NULL);
+}
+
+// git_batch_open for the repository at repo_path, or the current directory if NULL
+int git_batch_open_repo(git_batch_reader_t* reader, const char* repo_path) {
+    if (!reader) return GVC_ERROR_MEMORY;
+    memset(reader, 0, sizeof(*reader));
+    
+    int request_pipe[2], response_pipe[2];
+    if (pipe(request_pipe) != 0) return GVC_ERROR_GIT;
+    if (pipe(response_pipe) != 0) {
+        close(request_pipe[0]);
+        close(request_pipe[1]);
+        return GVC_ERROR_GIT;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(request_pipe[i], F_SETFD, FD_CLOEXEC);
+        fcntl(response_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+    
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(request_pipe[0]);
+        close(request_pipe[1]);
+        close(response_pipe[0]);
+        close(response_pipe[1]);
+        return GVC_ERROR_GIT;
+    }
+    if (pid == 0) {
+        dup2(request_pipe[0], STDIN_FILENO);
+        dup2(response_pipe[1], STDOUT_FILENO);
+        if (repo_path) {
+            execlp("git", "git", "-C", repo_path, "cat-file", "--batch", (char*)NULL);
+        } else {
+            execlp("git", "git", "cat-file", "--batch", (char*)NULL);
+        }
+        _exit(127);
+    }
+    
+    close(request_pipe[0]);
+    close(response_pipe[1]);
+    reader->pid = pid;
+    reader->request = fdopen(request_pipe[1], "w");
+    reader->response = fdopen(response_pipe[0], "r");
+    if (!reader->request || !reader->response) {
+        git_batch_close(reader);
+        return GVC_ERROR_GIT;
+    }
+    return GVC_SUCCESS;
+}
+
+// Read any object git can name ("<commit>:frame.bin", a blob hash, ...)
+// Request object_name and read the size from its response header
+static int batch_request(git_batch_reader_t* reader, const char* object_name, unsigned long long* size_out) {
+    if (fprintf(reader->request, "%s\n", object_name) < 0 || fflush(reader->request) != 0) {
+        return GVC_ERROR_GIT;
+    }
+    
+    // "<hash> <type> <size>", or "<name> missing"
+    char line[256];
+    if (!fgets(line, sizeof(line), reader->response)) return GVC_ERROR_GIT;
+    
+    char hash[GIT_HASH_SIZE + 1];
+    char type[16];
+    if (sscanf(line, "%40s %15s %llu", hash, type, size_out) != 3) {
+        return GVC_ERROR_GIT;  // Missing or ambiguous object
+    }
+    return GVC_SUCCESS;
+}
+
+// Drain contents nobody wants so the next request still lines up with its response
+static int batch_skip(git_batch_reader_t* reader, unsigned long long left) {
+    char discard[4096];
+    while (left > 0) {
+        size_t chunk = left < sizeof(discard) ? (size_t)left : sizeof(discard);
+        if (fread(discard, 1, chunk, reader->response) != chunk) return GVC_ERROR_GIT;
+        left -= chunk;
+    }
+    return GVC_SUCCESS;
+}
+
+int git_batch_read(git_batch_reader_t* reader, const char* object_name,
+                   uint8_t** data_out, size_t* size_out) {
+    if (!reader || !reader->request || !object_name || !data_out || !size_out) return GVC_ERROR_MEMORY;
+    
+    unsigned long long size;
+    int result = batch_request(reader, object_name, &size);
+    if (result != GVC_SUCCESS) return result;
+    if (size > MAX_GIT_OBJECT_SIZE) {
+        result = batch_skip(reader, size + 1);
+        return result == GVC_SUCCESS ? GVC_ERROR_FORMAT : result;
+    }
+    
+    uint8_t* buffer = malloc(size > 0 ? size : 1);
+    if (!buffer) return GVC_ERROR_MEMORY;
+    
+    // The contents are followed by a newline
+    if (fread(buffer, 1, size, reader->response) != size || fgetc(reader->response) != '\n') {
+        free(buffer);
+        return GVC_ERROR_GIT;
+    }
+    
+    *data_out = buffer;
+    *size_out = size;
+    return GVC_SUCCESS;
+}
+
+// The first bytes of an object, without holding the rest in memory; git still
+// sends all of it, and the rest is read past
+int git_batch_read_prefix(git_batch_reader_t* reader, const char* object_name,
+                          uint8_t* prefix, size_t capacity, size_t* size_out) {
+    if (!reader || !reader->request || !object_name || !prefix || !size_out) return GVC_ERROR_MEMORY;
+    
+    unsigned long long size;
+    int result = batch_request(reader, object_name, &size);
+    if (result != GVC_SUCCESS) return result;
+    
+    size_t wanted = size < capacity ? (size_t)size : capacity;
+    if (fread(prefix, 1, wanted, reader->response) != wanted) return GVC_ERROR_GIT;
+    result = batch_skip(reader, size - wanted);
+    if (result != GVC_SUCCESS || fgetc(reader->response) != '\n') return GVC_ERROR_GIT;
+    
+    *size_out = wanted;
+    return GVC_SUCCESS;
+}
+
+void git_batch_close(git_batch_reader_t* reader) {
+    if (!reader) return;
+    
+    if (reader->request) {
+        fclose(reader->request);
+    }
+    if (reader->response) {
+        fclose(reader->response);
+    }
+    if (reader->pid > 0) {
+        waitpid(reader->pid, NULL, 0);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+// Bulk commits through one `git fast-import`, which writes objects straight into
+// a pack (deltified against the previous blob) instead of a loose file per
+// object. Each frame becomes a commit whose tree holds only frame.bin, on the
+// branch HEAD points at, like git_create_commit's. Run from inside the repository.
+int git_import_open(git_import_t* importer) {
+    if (!importer) return GVC_ERROR_MEMORY;
+    memset(importer, 0, sizeof(*importer));
+    
+    if (execute_git_command("git symbolic-ref -q HEAD", importer->ref, sizeof(importer->ref)) != GVC_SUCCESS ||
+        importer->ref[0] == '\0') {
+        snprintf(importer->ref, sizeof(importer->ref), "refs/heads/master");
+    }
+    
+    // --done: a stream cut short by a crash is rejected instead of committed
+    importer->stream = popen("git fast-import --quiet --done", "w");
+    return importer->stream ? GVC_SUCCESS : GVC_ERROR_GIT;
+}
+
+int git_import_commit(git_import_t* importer, const uint8_t* data, size_t size,
+                      const char* message, time_t timestamp) {
+    if (!importer || !importer->stream || !message || (!data && size > 0)) return GVC_ERROR_MEMORY;
+    
+    FILE* out = importer->stream;
+    fprintf(out, "commit %s\ncommitter GitFlix <gitflix@localhost> %lld +0000\ndata %zu\n%s\n",
+            importer->ref, (long long)timestamp, strlen(message), message);
+    fprintf(out, "M 100644 inline frame.bin\ndata %zu\n", size);
+    if ((size > 0 && fwrite(data, 1, size, out) != size) || fputc('\n', out) == EOF) {
+        return GVC_ERROR_GIT;
+    }
+    importer->commits++;
+    return ferror(out) ? GVC_ERROR_GIT : GVC_SUCCESS;
+}
+
+// Finish the pack and move the branch; fails if fast-import rejected anything
+int git_import_close(git_import_t* importer) {
+    if (!importer || !importer->stream) return GVC_ERROR_MEMORY;
+    
+    fprintf(importer->stream, "done\n");
+    int status = pclose(importer->stream);
+    importer->stream = NULL;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? GVC_SUCCESS : GVC_ERROR_GIT;
+}
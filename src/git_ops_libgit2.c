@@ -1,4 +1,5 @@
 #include "git_vid_codec.h"
+#include "probes.h"
 #include <git2.h>
 #include <string.h>
 #include <stdlib.h>
@@ -99,6 +100,7 @@ static void add_blob_to_cache(const char* oid_str, git_blob* blob) {
 // Background prefetch worker
 static void* prefetch_worker(void* arg) {
     (void)arg;
+    trace_thread_name("prefetch");
     
     while (prefetch_running) {
         pthread_mutex_lock(&prefetch_mutex);
@@ -128,9 +130,13 @@ static void* prefetch_worker(void* arg) {
         git_oid oid;
         if (git_oid_fromstr(&oid, oid_str) == 0) {
             git_blob* blob;
+            uint64_t span_start = trace_begin();
             pthread_mutex_lock(&repo_mutex);
+            trace_end("lock repo_mutex", span_start);
+            span_start = trace_begin();
             int error = git_blob_lookup(&blob, repo, &oid);
             pthread_mutex_unlock(&repo_mutex);
+            trace_end("prefetch blob", span_start);
             
             if (error == 0) {
                 add_blob_to_cache(oid_str, blob);
@@ -182,8 +188,7 @@ void git_stop_prefetch(void) {
     printf("Prefetch thread stopped\n");
 }
 
-// High-performance blob read using libgit2
-int git_read_blob_libgit2(const char* commit_hash, uint8_t** data_out, size_t* size_out) {
+static int read_blob(const char* commit_hash, uint8_t** data_out, size_t* size_out) {
     if (!repo) {
         fprintf(stderr, "Repository not initialized\n");
         return GVC_ERROR_GIT;
@@ -191,6 +196,7 @@ int git_read_blob_libgit2(const char* commit_hash, uint8_t** data_out, size_t* s
     
     // Try cache first
     git_blob* cached_blob = find_blob_in_cache(commit_hash);
+    telemetry_count_cache(TELEMETRY_CACHE_BLOB, cached_blob != NULL);
     if (cached_blob) {
         const void* blob_data = git_blob_rawcontent(cached_blob);
         size_t blob_size = git_blob_rawsize(cached_blob);
@@ -214,7 +220,9 @@ int git_read_blob_libgit2(const char* commit_hash, uint8_t** data_out, size_t* s
         return GVC_ERROR_GIT;
     }
     
+    uint64_t span_start = trace_begin();
     pthread_mutex_lock(&repo_mutex);
+    trace_end("lock repo_mutex", span_start);
     
     // Look up the commit
     git_commit* commit;
@@ -283,6 +291,14 @@ int git_read_blob_libgit2(const char* commit_hash, uint8_t** data_out, size_t* s
     return GVC_SUCCESS;
 }
 
+// High-performance blob read using libgit2
+int git_read_blob_libgit2(const char* commit_hash, uint8_t** data_out, size_t* size_out) {
+    GVC_PROBE1(blob_read_start, commit_hash);
+    int result = read_blob(commit_hash, data_out, size_out);
+    GVC_PROBE3(blob_read_done, commit_hash, result == GVC_SUCCESS ? *size_out : 0, result);
+    return result;
+}
+
 // Get commit chain using libgit2 (faster than git log)
 int git_get_commit_chain_libgit2(char*** commit_hashes_out, int* num_commits_out) {
     if (!repo) {
@@ -7,12 +7,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include "gitflix.h"  // Public reader API; also the GVC_* return codes
 
 // Frame dimensions and format
 #define FRAME_WIDTH 1920
 #define FRAME_HEIGHT 1080
 #define FRAME_CHANNELS 3  // RGB
 #define FRAME_SIZE (FRAME_WIDTH * FRAME_HEIGHT * FRAME_CHANNELS)
+#define MAX_FRAME_WIDTH 7680   // Largest dimensions accepted from a frame header (8K UHD)
+#define MAX_FRAME_HEIGHT 4320
+#define PIXEL_FORMAT_RGB 0      // Interleaved, `channels` bytes per pixel
+#define PIXEL_FORMAT_YUV420P 1  // Planar Y, U, V with 2x2 subsampled chroma (BT.601 limited range)
 #define TARGET_FPS 60
 #define FRAME_TIME_NS (1000000000 / TARGET_FPS)  // 16.67ms in nanoseconds
 
@@ -25,7 +31,62 @@
 #define COMPRESSION_BLOCK_SIZE 64
 #define MAX_DELTA_SIZE (FRAME_SIZE / 2)  // Conservative estimate
 
+// Frame payload types (frame_header_t.compression_type)
+#define COMPRESSION_TYPE_RAW 0     // Whole frame, backend-compressed
+#define COMPRESSION_TYPE_DELTA 1   // RLE delta against a reference frame, backend-compressed
+#define COMPRESSION_TYPE_REPEAT 3  // Identical to a reference frame; payload is its u32 frame number
+#define COMPRESSION_TYPE_BIDIR 4   // Delta against a per-tile prediction from a past and a future frame
+#define COMPRESSION_TYPE_SCREEN 5  // Palette and block-copy coding for screen content
+#define COMPRESSION_TYPE_DELTA_RANS 6  // Delta tokens split into streams and rANS coded, no backend
+
+// Bidirectional prediction; each tile of the frame buffer picks one source
+#define BIDIR_TILE_BYTES 4096
+#define BIDIR_PREDICT_PAST 0
+#define BIDIR_PREDICT_FUTURE 1
+#define BIDIR_PREDICT_AVERAGE 2
+
+// Reference frames (frame_header_t.reference)
+#define REFERENCE_CACHE_SIZE 8   // Recent decoded frames a decoder keeps; a delta reaches back at most this far
+#define REFERENCE_LONG_TERM 0xFF // Delta: predict from the long-term frame. Raw: become the long-term frame
+
+// Entropy backends applied to frame payloads (frame_header_t.backend)
+#define BACKEND_LZFSE 0
+#define BACKEND_LZ4 1
+#define BACKEND_ZLIB 2
+#define BACKEND_LZMA 3
+#define BACKEND_COUNT 4
+
+// Payload checksum algorithms; the high nibble of frame_header_t.backend selects one
+#define CHECKSUM_CRC32 0   // zlib CRC32, the only checksum in frames written before the field
+#define CHECKSUM_CRC32C 1  // Castagnoli CRC, hardware-accelerated on SSE4.2 and ARMv8
+#define CHECKSUM_COUNT 2
+#define FRAME_BACKEND(header) ((header)->backend & 0x0F)
+#define FRAME_CHECKSUM_TYPE(header) ((header)->backend >> 4)
+
+// How much of a stream players check against payload checksums
+typedef enum {
+    VERIFY_OFF,        // Trust the object store
+    VERIFY_SAMPLED,    // Every VERIFY_SAMPLE_INTERVAL-th frame
+    VERIFY_KEYFRAMES,  // Intra frames, which every later frame in their GOP depends on
+    VERIFY_FULL        // Every frame (the default)
+} verify_policy_t;
+
+#define VERIFY_SAMPLE_INTERVAL 30
+
+typedef struct {
+    uint8_t backend;  // BACKEND_*
+    int level;        // zlib level 1-9 for BACKEND_ZLIB (encoder -l), 0 = library default; ignored by others
+    int entropy_delta; // Code delta tokens with the rANS coder instead of the backend
+    uint8_t checksum;  // CHECKSUM_* stamped on payloads by the encoder
+} compression_params_t;
+
 // Frame format structures
+// One of these precedes the header in a frame blob. Encoders before YUV support
+// wrote FRAME_MAGIC and left the header bytes after compression_type
+// uninitialized; readers take those bytes as 0 under it.
+#define FRAME_MAGIC 0x47564346     // "GVCF" in little endian
+#define FRAME_MAGIC_V2 0x47564332  // "GVC2": every header byte is meaningful
+
 typedef struct {
     uint32_t frame_number;
     uint32_t width;
@@ -33,8 +94,11 @@ typedef struct {
     uint32_t channels;
     uint32_t compressed_size;
     uint32_t checksum;
-    uint8_t compression_type;  // 0=raw, 1=delta, 2=entropy
-    uint8_t reserved[3];
+    uint8_t compression_type;  // COMPRESSION_TYPE_*
+    uint8_t pixel_format;      // PIXEL_FORMAT_*, read as 0 (RGB) under FRAME_MAGIC
+    uint8_t backend;           // Low nibble: BACKEND_* used for the payload, read as 0 (LZFSE) under FRAME_MAGIC.
+                               // High nibble: CHECKSUM_* of `checksum`, read as 0 (CRC32) under FRAME_MAGIC
+    uint8_t reference;         // Delta: frames back to predict from (0 = previous, always under FRAME_MAGIC), or REFERENCE_LONG_TERM
 } frame_header_t;
 
 typedef struct {
@@ -48,8 +112,22 @@ typedef struct {
     uint32_t width;
     uint32_t height;
     uint32_t channels;
+    uint32_t pixel_format;  // PIXEL_FORMAT_*; YUV420P frames have channels == 3 (planes)
 } raw_frame_t;
 
+// Hash of a frame's decoded pixels, stored in a trailer after the payload
+typedef struct {
+    uint64_t low;
+    uint64_t high;
+} pixel_hash_t;
+
+#define PIXEL_HASH_HEX_SIZE 33  // 32 hex digits and a terminator
+
+// Optional trailer after the payload holding the pixel hash of the source frame.
+// Readers that predate it ignore bytes past compressed_size.
+#define PIXEL_HASH_MAGIC 0x48435647  // "GVCH" in little endian
+#define PIXEL_HASH_TRAILER_SIZE (sizeof(uint32_t) + 2 * sizeof(uint64_t))
+
 // Git operations
 typedef struct {
     char hash[GIT_HASH_SIZE + 1];
@@ -59,17 +137,73 @@ typedef struct {
 
 // Function prototypes
 
-// compression.c
+// screen_codec.c (palette and block-copy coding of screen content)
+#define SCREEN_BLOCK_SIZE 16        // Block edge in pixels
+#define SCREEN_MAX_PALETTE 16       // Colours a palette block may use
+#define SCREEN_MAX_RAW_PERCENT 25   // Encoders fall back to generic coding above this share of raw blocks
+
+typedef struct {
+    int blocks;
+    int solid_blocks;
+    int palette_blocks;
+    int copy_blocks;       // Copies of an earlier block of the same frame
+    int previous_blocks;   // Copies from the reference frame
+    int raw_blocks;
+} screen_stats_t;
+
+size_t screen_stream_bound(uint32_t width, uint32_t height, uint32_t channels, uint32_t pixel_format);
+int screen_encode_blocks(const raw_frame_t* current, const raw_frame_t* reference,
+                         uint8_t** stream_out, size_t* stream_size_out, screen_stats_t* stats_out);
+int screen_decode_blocks(const uint8_t* stream, size_t stream_size, const raw_frame_t* reference,
+                         raw_frame_t* output);
+
+// entropy_coder.c (order-0 rANS for delta token streams)
+size_t rans_encode_bound(size_t size);
+size_t rans_encode(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_size);
+int rans_decode(const uint8_t* src, size_t src_size, uint8_t* dst, size_t size);
+
+// compression.c (params may be NULL for LZFSE)
 int compress_frame_delta(const raw_frame_t* current, const raw_frame_t* previous, 
-                        frame_t* output);
+                        const compression_params_t* params, frame_t* output);
 int decompress_frame_delta(const frame_t* compressed, const raw_frame_t* previous,
                           raw_frame_t* output);
-int compress_frame_raw(const raw_frame_t* input, frame_t* output);
+int compress_frame_delta_rans(const raw_frame_t* current, const raw_frame_t* previous,
+                             frame_t* output);
+int decompress_frame_delta_rans(const frame_t* compressed, const raw_frame_t* previous,
+                               raw_frame_t* output);
+int compress_frame_raw(const raw_frame_t* input, const compression_params_t* params,
+                      frame_t* output);
 int decompress_frame_raw(const frame_t* compressed, raw_frame_t* output);
+int compress_frame_repeat(const raw_frame_t* current, uint32_t reference_frame_number,
+                         frame_t* output);
+int compress_frame_bidir(const raw_frame_t* current, const raw_frame_t* past, const raw_frame_t* future,
+                        uint32_t past_frame_number, uint32_t future_frame_number,
+                        const compression_params_t* params, frame_t* output);
+int decompress_frame_bidir(const frame_t* compressed, const raw_frame_t* past, const raw_frame_t* future,
+                          raw_frame_t* output);
+int bidir_frame_references(const frame_t* compressed, uint32_t* past_frame_number_out,
+                           uint32_t* future_frame_number_out);
+int compress_frame_screen(const raw_frame_t* current, const raw_frame_t* reference,
+                         const compression_params_t* params, frame_t* output,
+                         screen_stats_t* stats_out);
+int decompress_frame_screen(const frame_t* compressed, const raw_frame_t* reference,
+                           raw_frame_t* output);
+int decompress_frame(const frame_t* compressed, const raw_frame_t* reference,
+                    raw_frame_t* output);
+const char* compression_type_name(uint8_t compression_type);
 int decompress_frames_batch(const frame_t* frame1, const frame_t* frame2,
                            const raw_frame_t* previous_frame,
                            raw_frame_t* output1, raw_frame_t* output2);
+const char* backend_name(uint8_t backend);
+
+// checksum.c (payload checksums and decoded-pixel hashes)
 uint32_t calculate_checksum(const uint8_t* data, size_t size);
+uint32_t calculate_payload_checksum(uint8_t checksum_type, const uint8_t* data, size_t size);
+const char* checksum_name(uint8_t checksum_type);
+int parse_checksum_type(const char* name, uint8_t* checksum_type_out);
+void hash_frame_pixels(const raw_frame_t* frame, pixel_hash_t* hash_out);
+int pixel_hash_equal(const pixel_hash_t* a, const pixel_hash_t* b);
+void format_pixel_hash(const pixel_hash_t* hash, char* hex_out);
 
 // Git operations (legacy)
 int git_init_repo(const char* path);
@@ -81,6 +215,35 @@ int git_get_commit_chain(char commits[][GIT_HASH_SIZE + 1], int max_commits);
 int git_checkout_commit(const char* commit_hash);
 int git_read_frame_from_commit(const char* commit_hash, uint8_t** data_out, size_t* size_out);
 int git_show(const char* commit_hash, uint8_t** data_out, size_t* size_out);
+int git_list_commits(char*** commit_hashes_out, char*** parents_out, int* num_commits_out);
+int git_list_repo_commits(const char* repo_path, char*** commit_hashes_out, char*** parents_out,
+                          int* num_commits_out);
+void git_free_commit_list(char** commit_hashes, int num_commits);
+
+typedef struct {
+    int pid;          // git cat-file --batch
+    FILE* request;    // Object names to git
+    FILE* response;   // Object headers and contents from git
+} git_batch_reader_t;
+
+int git_batch_open(git_batch_reader_t* reader);
+int git_batch_open_repo(git_batch_reader_t* reader, const char* repo_path);
+int git_batch_read(git_batch_reader_t* reader, const char* object_name,
+                   uint8_t** data_out, size_t* size_out);
+int git_batch_read_prefix(git_batch_reader_t* reader, const char* object_name,
+                          uint8_t* prefix, size_t capacity, size_t* size_out);  // Up to capacity bytes
+void git_batch_close(git_batch_reader_t* reader);
+
+typedef struct {
+    FILE* stream;     // Commands to git fast-import
+    char ref[256];    // Branch the commits extend
+    uint64_t commits;
+} git_import_t;
+
+int git_import_open(git_import_t* importer);
+int git_import_commit(git_import_t* importer, const uint8_t* data, size_t size,
+                      const char* message, time_t timestamp);
+int git_import_close(git_import_t* importer);
 
 // High-performance Git operations using libgit2
 int git_init_libgit2(const char* repo_path);
@@ -92,7 +255,27 @@ void git_cleanup_libgit2(void);
 
 // frame_format.c
 int serialize_frame(const frame_t* frame, uint8_t** buffer_out, size_t* size_out);
+int serialize_frame_with_hash(const frame_t* frame, const pixel_hash_t* pixel_hash,
+                              uint8_t** buffer_out, size_t* size_out);
+int read_frame_pixel_hash(const uint8_t* buffer, size_t size, pixel_hash_t* hash_out);
 int deserialize_frame(const uint8_t* buffer, size_t size, frame_t* frame_out);
+int deserialize_frame_verified(const uint8_t* buffer, size_t size, verify_policy_t policy,
+                               frame_t* frame_out);
+int frame_needs_verification(const frame_header_t* header, verify_policy_t policy);
+int verify_frame_checksum(const frame_t* frame);
+void set_frame_checksum(frame_t* frame, uint8_t checksum_type);
+const char* verify_policy_name(verify_policy_t policy);
+int parse_verify_policy(const char* name, verify_policy_t* policy_out);
+int frame_magic_supported(uint32_t magic);
+void unpack_frame_header(const uint8_t* buffer, frame_header_t* header_out);
+int read_frame_header(const uint8_t* buffer, size_t size, frame_header_t* header_out);
+int validate_frame_dimensions(uint32_t width, uint32_t height, uint32_t channels);
+int validate_pixel_format(uint32_t channels, uint32_t pixel_format);
+int validate_frame_header(const frame_header_t* header);
+size_t frame_buffer_size(uint32_t width, uint32_t height, uint32_t channels, uint32_t pixel_format);
+size_t raw_frame_size(const raw_frame_t* frame);
+const char* pixel_format_name(uint32_t pixel_format);
+int parse_pixel_format(const char* name, uint32_t* pixel_format_out);
 void free_frame(frame_t* frame);
 void free_raw_frame(raw_frame_t* frame);
 int copy_raw_frame(const raw_frame_t* src, raw_frame_t* dst);
@@ -100,23 +283,443 @@ void generate_frame_filename(uint32_t frame_number, char* filename_out, size_t m
 void generate_frame_path(const char* directory, uint32_t frame_number, char* path_out, size_t max_len);
 int parse_frame_number_from_filename(const char* filename, uint32_t* frame_number_out);
 
+// reference_cache.c (decoded frames that later frames may predict from)
+typedef struct {
+    raw_frame_t frames[REFERENCE_CACHE_SIZE];  // Ring of the most recently decoded frames
+    uint32_t frame_numbers[REFERENCE_CACHE_SIZE];
+    int count;
+    int newest;
+    raw_frame_t long_term;
+    uint32_t long_term_number;
+    int has_long_term;
+} reference_cache_t;
+
+void reference_cache_init(reference_cache_t* cache);
+int reference_cache_add(reference_cache_t* cache, const frame_header_t* header, const raw_frame_t* frame);
+const raw_frame_t* reference_cache_find(const reference_cache_t* cache, uint32_t frame_number);
+const raw_frame_t* reference_cache_resolve(const reference_cache_t* cache, const frame_t* compressed);
+int reference_cache_has_references(const reference_cache_t* cache, const frame_t* compressed);
+int decode_frame(const reference_cache_t* cache, const frame_t* compressed, raw_frame_t* output);
+void reference_cache_free(reference_cache_t* cache);
+
+// reorder_buffer.c (decode order back to presentation order)
+#define REORDER_DEPTH 4  // Decoded frames held back; a B frame arrives after its future reference
+
+typedef struct {
+    raw_frame_t frames[REORDER_DEPTH];
+    uint32_t frame_numbers[REORDER_DEPTH];
+    int occupied[REORDER_DEPTH];
+    int count;
+    uint32_t next_frame_number;  // Next frame due for presentation
+    uint32_t lost;               // Frames that will never arrive and are not yet passed
+} reorder_buffer_t;
+
+void reorder_buffer_init(reorder_buffer_t* buffer, uint32_t first_frame_number);
+int reorder_buffer_push(reorder_buffer_t* buffer, uint32_t frame_number, raw_frame_t* frame);
+int reorder_buffer_pop(reorder_buffer_t* buffer, raw_frame_t* frame_out, uint32_t* frame_number_out);
+int reorder_buffer_flush(reorder_buffer_t* buffer, raw_frame_t* frame_out, uint32_t* frame_number_out);
+void reorder_buffer_skip(reorder_buffer_t* buffer, uint32_t frame_number);
+void reorder_buffer_lose(reorder_buffer_t* buffer);  // A frame whose number is unknown will not arrive
+void reorder_buffer_free(reorder_buffer_t* buffer);
+
+// repo_walk.c (parallel decode of every frame in a repository, one GOP per worker at a time)
+typedef enum {
+    REPO_FRAME_DECODED,
+    REPO_FRAME_UNREADABLE,     // frame.bin missing, or not a frame that deserializes
+    REPO_FRAME_NO_REFERENCE,   // A frame it predicts from was never decoded
+    REPO_FRAME_DECODE_FAILED,
+    REPO_FRAME_SKIPPED         // An earlier frame of its GOP failed
+} repo_frame_state_t;
+
+typedef struct {
+    int index;                   // Position in the commit list, oldest first
+    const char* commit;
+    const uint8_t* blob;         // NULL if frame.bin could not be read
+    size_t blob_size;
+    int read_result;
+    const frame_t* compressed;   // NULL unless the blob deserialized
+    int deserialize_result;
+    repo_frame_state_t state;
+    const raw_frame_t* decoded;  // Set when state is REPO_FRAME_DECODED
+    int decode_result;
+} repo_frame_t;
+
+typedef void (*repo_frame_fn)(void* ctx, const repo_frame_t* frame);
+
+int repo_walk(char** commits, int num_commits, int num_threads, repo_frame_fn fn, void* ctx);
+int repo_walk_threads(int requested, int num_commits);
+int repo_frame_is_gop_start(const frame_header_t* header);
+const char* repo_frame_state_name(repo_frame_state_t state);
+
+// reader.c (libgitflix; the public API is in gitflix.h)
+int gvc_reader_next_grow(gvc_reader_t* reader, gvc_frame_t* frame);  // gvc_reader_next, reallocating pixels to fit
+void gvc_frame_view(const gvc_frame_t* frame, raw_frame_t* view_out);  // Shares frame->pixels
+
+// frame_kernels.c (pixel conversion for display, specialized for common sizes; SIMD byte kernels)
+typedef void (*pixel_convert_fn)(const uint8_t* src, uint8_t* dst,
+                                 uint32_t width, uint32_t height, uint32_t channels);
+
+typedef struct {
+    const char* name;
+    pixel_convert_fn to_bgrx;  // 4 bytes/pixel B,G,R,0 (X11 32-bit visuals, Windows DIB)
+    pixel_convert_fn to_bgr;   // 3 bytes/pixel B,G,R (X11 24-bit visuals)
+    pixel_convert_fn to_rgba;  // 4 bytes/pixel R,G,B,A (Core Graphics, Metal)
+} frame_kernels_t;
+
+const frame_kernels_t* select_frame_kernels(uint32_t width, uint32_t height, uint32_t channels,
+                                            uint32_t pixel_format);
+uint64_t sum_abs_diff_u8(const uint8_t* a, const uint8_t* b, size_t size);
+void average_u8(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t size);
+
+// telemetry.c (per-stage latency histograms and counters for the players)
+typedef enum {
+    TELEMETRY_FETCH,        // Reading the frame blob from the object store
+    TELEMETRY_DESERIALIZE,  // Header parsing and payload checksum
+    TELEMETRY_DECOMPRESS,   // Entropy decoding of the payload (LZ backend or rANS)
+    TELEMETRY_DELTA_APPLY,  // Rebuilding pixels from references: deltas, predictions, block copies
+    TELEMETRY_CONVERT,      // Pixel conversion to the display format
+    TELEMETRY_PRESENT,      // Handing the converted frame to the window system
+    TELEMETRY_STAGE_COUNT
+} telemetry_stage_t;
+
+typedef struct {
+    uint64_t samples;
+    double mean;
+    uint64_t p50;
+    uint64_t p95;
+    uint64_t p99;
+    uint64_t max;
+    uint64_t over_budget;  // Samples longer than FRAME_TIME_NS
+} telemetry_summary_t;
+
+typedef enum {
+    TELEMETRY_CACHE_REFERENCE,  // Predicted frames whose references were decoded and kept
+    TELEMETRY_CACHE_BLOB,       // libgit2 blob reads served by the prefetch cache
+    TELEMETRY_CACHE_COUNT
+} telemetry_cache_t;
+
+typedef struct {
+    uint64_t frames_presented;
+    uint64_t frames_dropped;
+    double elapsed_seconds;
+    double first_frame_seconds;  // From telemetry_init to the first presented frame, 0 before it
+    size_t peak_rss_bytes;
+    size_t rss_bytes;
+    int queue_depth;     // Frames buffered when the display last took one
+    int queue_capacity;  // 0 until the player sets it
+    uint64_t cache_hits[TELEMETRY_CACHE_COUNT];
+    uint64_t cache_misses[TELEMETRY_CACHE_COUNT];
+} telemetry_counters_t;
+
+void telemetry_init(void);
+int telemetry_enabled(void);
+void telemetry_bind_thread(void);      // Send the calling thread's stage timings here (see stage_sink.c)
+void telemetry_record_stage(telemetry_stage_t stage, uint64_t start_ns, uint64_t end_ns);
+void telemetry_frame_done(void);       // Record this thread's stage times as one frame
+void telemetry_record_queue_depth(int depth);
+void telemetry_set_queue_capacity(int capacity);
+void telemetry_count_presented(void);
+void telemetry_count_dropped(int frames);
+void telemetry_count_cache(telemetry_cache_t cache, int hit);
+const char* telemetry_stage_name(telemetry_stage_t stage);
+const char* telemetry_cache_name(telemetry_cache_t cache);
+void telemetry_stage_summary(telemetry_stage_t stage, telemetry_summary_t* summary_out);
+void telemetry_queue_summary(telemetry_summary_t* summary_out);
+void telemetry_counters(telemetry_counters_t* counters_out);
+size_t telemetry_peak_rss(void);
+size_t telemetry_current_rss(void);
+void telemetry_print_summary(FILE* out);
+void telemetry_write_json(FILE* out);
+int telemetry_dump_json(const char* path);
+void telemetry_reader_sink(gvc_reader_telemetry_t* sink_out);  // Forwards a reader's telemetry here
+
+// trace.c (opt-in per-thread timeline spans, written as Chrome trace-event JSON)
+int trace_start(const char* path);
+int trace_enabled(void);
+void trace_thread_name(const char* name);   // Label the calling thread's track
+void trace_set_frame(int64_t frame_number); // Frame attached to this thread's later spans, -1 for none
+uint64_t trace_begin(void);                 // 0 while tracing is off
+void trace_end(const char* name, uint64_t start);  // name must outlive the trace
+void trace_span(const char* name, uint64_t start, uint64_t end);
+int trace_stop(void);
+
+// stage_sink.c (decode stage timings, routed to a sink bound to the calling thread)
+typedef struct {
+    void* ctx;
+    void (*stage)(void* ctx, telemetry_stage_t stage, uint64_t start_ns, uint64_t end_ns);
+    void (*cache)(void* ctx, telemetry_cache_t cache, int hit);  // May be NULL
+} stage_sink_t;
+
+const stage_sink_t* stage_sink_bind(const stage_sink_t* sink);  // NULL unbinds; returns the previous sink
+int stage_sink_bound(void);
+uint64_t stage_sink_now_ns(void);      // CLOCK_MONOTONIC
+uint64_t telemetry_stage_begin(void);  // 0 while no sink is bound
+void telemetry_stage_end(telemetry_stage_t stage, uint64_t start);
+void stage_sink_count_cache(telemetry_cache_t cache, int hit);
+
+// metrics.c (live telemetry in Prometheus text format on a Unix domain socket)
+int metrics_server_start(const char* socket_path);
+void metrics_server_stop(void);
+void metrics_write_prometheus(FILE* out, double fps);
+
+// synth.c (deterministic synthetic RGB video: encoder test input, benchmarks, demo)
+#define SYNTH_SCENE_LENGTH 60   // Frames per scene of SYNTH_SCENE_CUTS
+#define SYNTH_PAN_SPEED 4       // Columns SYNTH_PAN scrolls per frame
+
+typedef enum {
+    SYNTH_TEST,         // The encoder's original sliding gradients
+    SYNTH_STATIC,       // One textured still
+    SYNTH_PAN,          // The still scrolling sideways
+    SYNTH_ZOOM,         // The still magnified about its centre, more every frame
+    SYNTH_NOISE,        // New random bytes every frame (incompressible)
+    SYNTH_TEXT,         // Desktop UI with text being typed and a blinking cursor
+    SYNTH_SCENE_CUTS,   // Static, pan, zoom, noise and text, cutting every SYNTH_SCENE_LENGTH frames
+    SYNTH_DEMO,         // The 600-frame demo: rainbow, spiral, circles, plasma, matrix, Mandelbrot
+    SYNTH_CLASS_COUNT
+} synth_class_t;
+
+typedef struct {
+    synth_class_t content;
+    uint32_t width;
+    uint32_t height;
+    uint64_t seed;      // Same seed, same frames, at any thread count
+} synth_params_t;
+
+// Thread pool that renders each frame as row bands
+typedef struct {
+    synth_params_t params;
+    pthread_t* threads;
+    int num_workers;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    uint64_t generation;       // Bumped for every frame handed to the workers
+    uint32_t num_bands;
+    uint32_t next_band;        // Next band of the current frame to claim
+    uint32_t bands_left;       // Bands of the current frame not yet finished
+    uint32_t frame_number;
+    raw_frame_t* frame;
+    int stopping;
+} synth_generator_t;
+
+void synth_params_init(synth_params_t* params);  // SYNTH_TEST, FRAME_WIDTH x FRAME_HEIGHT, seed 1
+const char* synth_class_name(synth_class_t content);
+int parse_synth_class(const char* name, synth_class_t* content_out);
+int synth_alloc_frame(const synth_params_t* params, raw_frame_t* frame_out);
+int synth_render(const synth_params_t* params, uint32_t frame_number, raw_frame_t* frame);
+int synth_generator_open(synth_generator_t* generator, const synth_params_t* params, int num_threads);
+int synth_generator_render(synth_generator_t* generator, uint32_t frame_number, raw_frame_t* frame);
+void synth_generator_close(synth_generator_t* generator);
+int synth_write_frame(const raw_frame_t* frame, FILE* out);
+
 // display.c (platform-specific)
 int display_init(uint32_t width, uint32_t height);
 int display_frame(const raw_frame_t* frame);
 void display_cleanup(void);
 int display_should_close(void);
 
+// frame_ingest.c (zero-copy mmap ingest of raw frame files)
+#define INGEST_READAHEAD_FRAMES 8  // Frames of kernel read-ahead kept in flight
+
+typedef struct {
+    char directory[512];
+    uint32_t first_file_number;  // File number of frame index 0 (FFmpeg starts at 1)
+    int num_frames;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t pixel_format;
+    int readahead;
+    int next_advised;            // Next frame index to issue read-ahead for
+    pthread_mutex_t advise_mutex;
+} frame_ingest_t;
+
+// Pull-based source of input frames; load may be called from several threads
+typedef struct {
+    void* ctx;
+    int num_frames;
+    int (*load)(void* ctx, int frame_index, raw_frame_t* frame_out);
+    void (*release)(void* ctx, raw_frame_t* frame);
+} frame_source_t;
+
+int frame_ingest_open(frame_ingest_t* ingest, const char* directory,
+                      uint32_t first_file_number, int num_frames,
+                      uint32_t width, uint32_t height, uint32_t channels,
+                      uint32_t pixel_format);
+int frame_ingest_map(frame_ingest_t* ingest, int frame_index, raw_frame_t* frame_out);
+void frame_ingest_unmap(raw_frame_t* frame);
+void frame_ingest_close(frame_ingest_t* ingest);
+void frame_ingest_source(frame_ingest_t* ingest, frame_source_t* source_out);
+
+// frame_window.c (refcounted cache of loaded source frames shared by encoder threads)
+typedef struct {
+    int frame_index;   // -1 when empty
+    int refs;          // Holders that have not released it yet
+    int loading;       // Being loaded; waiters block on `changed`
+    uint64_t last_use; // Eviction picks the unreferenced entry with the oldest use
+    raw_frame_t frame;
+} frame_window_entry_t;
+
+typedef struct {
+    const frame_source_t* source;
+    frame_window_entry_t* entries;
+    int capacity;
+    uint64_t clock;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+} frame_window_t;
+
+int frame_window_init(frame_window_t* window, const frame_source_t* source, int capacity);
+void frame_window_source(frame_window_t* window, frame_source_t* source_out);
+void frame_window_destroy(frame_window_t* window);
+
+// encode_pipeline.c (parallel compress/blob workers, ordered commit stage)
+#define PIPELINE_FRAMES_PER_THREAD 4      // Frames each worker may run ahead of the commit stage
+#define PIPELINE_DECODE_SAMPLE_INTERVAL 16  // Every Nth frame is decoded to estimate playback cost
+
+// Encoder effort presets: trade encode time for repository size and decode speed
+typedef enum {
+    ENCODE_PRESET_FAST,      // Live ingest: LZ4, delta against every previous frame
+    ENCODE_PRESET_BALANCED,  // LZFSE, sampled intra/delta decision
+    ENCODE_PRESET_MAX        // Archive: LZMA, every frame coded both ways
+} encode_preset_t;
+
+#define MODE_DECISION_NONE 0        // Delta whenever a previous frame exists
+#define MODE_DECISION_ESTIMATE 1    // Sampled difference magnitude picks intra or delta
+#define MODE_DECISION_EXHAUSTIVE 2  // Encode intra and delta, keep the smaller
+
+typedef struct {
+    encode_preset_t preset;
+    const char* name;
+    compression_params_t compression;
+    int mode_decision;  // MODE_DECISION_*
+    int max_references; // Recent frames searched for the best delta reference (1 = previous only)
+    int screen_content; // Try palette/block-copy coding first (screen recordings)
+} encode_profile_t;
+
+// Candidate reference frames for one encode, nearest first
+typedef struct {
+    const raw_frame_t* frames[REFERENCE_CACHE_SIZE + 1];
+    uint32_t frame_numbers[REFERENCE_CACHE_SIZE + 1];
+    uint8_t references[REFERENCE_CACHE_SIZE + 1];  // frame_header_t.reference selecting each
+    int count;
+    const raw_frame_t* future;     // Following frame, coded first, for FRAME_MODE_BIDIR
+    uint32_t future_frame_number;
+} reference_set_t;
+
+// Keyframe placement: scene cuts start a new GOP, but never closer than min_gop
+// frames to the previous keyframe; max_gop bounds the delta chain a seek decodes
+#define DEFAULT_MIN_GOP 12
+#define DEFAULT_MAX_GOP 300
+
+typedef struct {
+    int min_gop;
+    int max_gop;
+} keyframe_params_t;
+
+typedef struct {
+    int num_threads;        // Worker threads, 0 = one per online CPU
+    uint32_t pixel_format;  // Storage format for converted input (PIXEL_FORMAT_*)
+    uint32_t width;         // Frame size of frame-file and synthetic input
+    uint32_t height;
+    encode_profile_t profile;
+    keyframe_params_t keyframes;
+    int two_pass;           // Analyze every byte first, also finding repeated frames
+    int bframes;            // Code eligible frames bidirectionally, after the frame that follows them
+} encode_options_t;
+
+// Per-frame coding decisions; AUTO leaves the choice to the profile
+#define FRAME_MODE_AUTO 0
+#define FRAME_MODE_INTRA 1
+#define FRAME_MODE_DELTA 2
+#define FRAME_MODE_REPEAT 3
+#define FRAME_MODE_BIDIR 4   // Predicted from the previous and the next frame
+
+typedef struct {
+    int frames_encoded;
+    int num_threads;
+    int intra_frames;
+    int repeat_frames;      // Frames stored as references to an identical earlier frame
+    int bidir_frames;
+    int screen_frames;      // Frames coded with palette/block copies
+    size_t original_bytes;
+    size_t encoded_bytes;
+    double elapsed_seconds;
+    double encode_fps;
+    double decode_ms_per_frame;  // Sampled single-threaded decode time, 0 if nothing sampled
+} encode_stats_t;
+
+int encode_pipeline_run(const frame_source_t* source, const encode_options_t* options,
+                        encode_stats_t* stats_out);
+
+// encode_analysis.c (scene-cut detection, keyframe placement, two-pass analysis)
+#define ANALYSIS_SAMPLE_ROW_STEP 4        // Sampled scans compare every Nth row (luma only for YUV)
+#define ANALYSIS_SCENE_WINDOW 8           // Frames either side used as the local motion baseline
+#define ANALYSIS_SCENE_CUT_MIN_DIFF 16.0  // Mean absolute difference a cut must exceed outright
+#define ANALYSIS_SCENE_CUT_RATIO 3.0      // ... and relative to its neighbourhood
+
+typedef enum {
+    ANALYSIS_SAMPLED,  // Single pass: sparse rows, scene cuts and keyframes only
+    ANALYSIS_FULL      // Two pass: every byte, so exact repeats can be found too
+} analysis_scan_t;
+
+typedef struct {
+    double mean_abs_diff;  // Mean absolute byte difference from the previous frame
+    int duplicate;         // Bit-identical to the previous frame (full scans only)
+    int scene_cut;
+    int keyframe;
+    int gop_start;         // Keyframe of the GOP this frame belongs to; its long-term reference
+    int mode;              // Planned FRAME_MODE_* for the encode
+} frame_analysis_t;
+
+typedef struct {
+    int num_frames;
+    frame_analysis_t* frames;
+    int keyframes;
+    int scene_cuts;
+    int duplicate_frames;
+    int static_spans;      // Runs of two or more identical frames
+    int bidir_frames;
+    double elapsed_seconds;
+} video_analysis_t;
+
+double frame_difference_sampled(const raw_frame_t* current, const raw_frame_t* reference);
+int analyze_video(const frame_source_t* source, int num_threads, analysis_scan_t scan,
+                  const keyframe_params_t* keyframes, video_analysis_t* analysis_out);
+void plan_bidir_frames(video_analysis_t* analysis);
+int plan_coding_order(const video_analysis_t* analysis, int* order_out);
+void free_video_analysis(video_analysis_t* analysis);
+
 // encoder.c
-int read_raw_frame(const char* filename, raw_frame_t* frame);
+int read_raw_frame(const char* filename, uint32_t width, uint32_t height,
+                   uint32_t channels, raw_frame_t* frame);
+int encode_frame_to_blob(const raw_frame_t* current_frame,
+                        const reference_set_t* references,
+                        uint32_t frame_number,
+                        const encode_profile_t* profile,
+                        int frame_mode,
+                        char* blob_hash_out,
+                        frame_header_t* header_out,
+                        double* decode_seconds_out);
+int commit_encoded_frame(const char* blob_hash,
+                        const frame_header_t* header,
+                        const char* parent_commit_hash,
+                        char* commit_hash_out);
 int encode_frame_to_commit(const raw_frame_t* current_frame, 
                           const raw_frame_t* previous_frame,
                           uint32_t frame_number,
                           const char* parent_commit_hash,
                           char* commit_hash_out);
-int encode_video_sequence(const char* input_path, const char* repo_path);
+void encode_profile_init(encode_profile_t* profile, encode_preset_t preset);
+int parse_encode_preset(const char* name, encode_profile_t* profile_out);
+void encode_options_init(encode_options_t* options);
+void print_encode_stats(const encode_stats_t* stats, const encode_options_t* options);
+int encode_video_sequence(const char* input_path, const char* repo_path,
+                          const encode_options_t* options);
 
 // mp4_converter.c
-int convert_mp4_to_repo(const char* mp4_path, const char* repo_path);
+int convert_mp4_to_repo(const char* mp4_path, const char* repo_path,
+                        const encode_options_t* options);
 
 // player.c
 int play_from_stdin(void);
@@ -131,14 +734,4 @@ int play_from_repo(const char* repo_path);
 #endif
 #define CLAMP(x, min, max) (MIN(MAX(x, min), max))
 
-// Error codes
-#define GVC_SUCCESS 0
-#define GVC_ERROR_MEMORY -1
-#define GVC_ERROR_IO -2
-#define GVC_ERROR_GIT -3
-#define GVC_ERROR_COMPRESSION -4
-#define GVC_ERROR_FORMAT -5
-#define GVC_ERROR_DISPLAY -6
-#define GVC_ERROR_THREAD -7
-
 #endif // GIT_VID_CODEC_H
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifndef GITFLIX_H
+#define GITFLIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// libgitflix: decode the frames of a GitFlix repository from another program.
+//
+// A reader owns everything it uses: the repository's commit list, a pool of
+// fetch threads with one `git cat-file --batch` each, the window of frames they
+// fetch ahead of the decoder, and the reference frames decoding needs. Readers
+// share no state, so any number can be open at once, on one repository or many.
+// Each reader must be used by one thread at a time. Frames come back in
+// presentation order, from 0 to gvc_reader_frame_count() - 1.
+//
+//   gvc_reader_t* reader;
+//   if (gvc_reader_open("./video_repo", NULL, &reader) == GVC_SUCCESS) {
+//       gvc_frame_t frame;
+//       gvc_reader_format(reader, &frame);
+//       frame.pixels = malloc(frame.size);
+//       frame.capacity = frame.size;
+//       while (gvc_reader_next(reader, &frame) == GVC_SUCCESS) {
+//           ...frame.width x frame.height, frame.channels bytes per pixel...
+//       }
+//       gvc_reader_close(reader);
+//   }
+
+// Return codes: GVC_SUCCESS, a negative GVC_ERROR_*, or GVC_READER_END
+#define GVC_SUCCESS 0
+#define GVC_ERROR_MEMORY -1
+#define GVC_ERROR_IO -2
+#define GVC_ERROR_GIT -3
+#define GVC_ERROR_COMPRESSION -4
+#define GVC_ERROR_FORMAT -5
+#define GVC_ERROR_DISPLAY -6
+#define GVC_ERROR_THREAD -7
+#define GVC_READER_END 1  // gvc_reader_next: every frame has been returned
+
+// The library is built with hidden visibility; only these functions are exported
+#if defined(__GNUC__)
+#define GVC_API __attribute__((visibility("default")))
+#else
+#define GVC_API
+#endif
+
+#define GVC_READER_DEFAULT_PREFETCH 32
+
+// Payload checksums a reader verifies (the player's -V)
+#define GVC_VERIFY_OFF 0
+#define GVC_VERIFY_SAMPLED 1
+#define GVC_VERIFY_KEYFRAMES 2
+#define GVC_VERIFY_FULL 3
+
+// Stages a reader reports to its telemetry sink
+#define GVC_STAGE_FETCH 0        // Reading the frame blob from the object store
+#define GVC_STAGE_DESERIALIZE 1  // Header parsing and payload checksum
+#define GVC_STAGE_DECOMPRESS 2   // Entropy decoding of the payload
+#define GVC_STAGE_DELTA_APPLY 3  // Rebuilding pixels from reference frames
+#define GVC_STAGE_WAIT 4         // gvc_reader_next waiting on the fetch threads
+
+typedef struct gvc_reader gvc_reader_t;
+
+// Where a reader reports what it is doing; any callback may be NULL. Callbacks run
+// on the reader's fetch threads and on the thread calling gvc_reader_next, each on
+// the thread doing the work it reports, so they must be thread-safe. Readers given
+// different sinks never see each other's events.
+typedef struct {
+    void* ctx;
+    void (*thread_start)(void* ctx, const char* name);  // A fetch thread starts
+    void (*frame_start)(void* ctx, uint32_t index);     // This thread starts on a commit (decode order)
+    void (*stage)(void* ctx, int stage, uint64_t start_ns, uint64_t end_ns);  // GVC_STAGE_*, CLOCK_MONOTONIC
+    void (*frame_done)(void* ctx);                      // This thread is done with its commit
+    void (*reference)(void* ctx, int hit);              // A predicted frame had its references (1) or not
+    void (*dropped)(void* ctx, uint32_t frames);        // B frames skipped by gvc_reader_set_drop_bidir
+} gvc_reader_telemetry_t;
+
+typedef struct {
+    int num_threads;  // Fetch threads; 0 for one per CPU
+    int prefetch;     // Frames fetched ahead of the decoder
+    int verify;       // GVC_VERIFY_*
+    gvc_reader_telemetry_t telemetry;  // Copied at open
+} gvc_reader_options_t;
+
+typedef struct {
+    uint8_t* pixels;        // Caller's buffer; gvc_reader_next fills it
+    size_t capacity;        // Bytes at pixels
+    size_t size;            // Bytes the frame takes
+    uint32_t frame_number;  // Presentation position
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;      // Bytes per pixel (1, 3 or 4), or 3 planes for YUV 4:2:0
+    uint32_t pixel_format;  // 0 interleaved, 1 planar YUV 4:2:0 (BT.601 limited range)
+} gvc_frame_t;
+
+// Defaults: one thread per CPU, GVC_READER_DEFAULT_PREFETCH, GVC_VERIFY_FULL, no telemetry
+GVC_API void gvc_reader_options_init(gvc_reader_options_t* options);
+
+// Open the first-parent history of HEAD in repo_path (NULL for the current
+// directory); options may be NULL for the defaults
+GVC_API int gvc_reader_open(const char* repo_path, const gvc_reader_options_t* options, gvc_reader_t** reader_out);
+
+// Open an explicit list of frame commits, in decode order; the list is copied
+GVC_API int gvc_reader_open_commits(const char* repo_path, const char* const* commits, uint32_t num_commits,
+                            const gvc_reader_options_t* options, gvc_reader_t** reader_out);
+
+GVC_API uint32_t gvc_reader_frame_count(const gvc_reader_t* reader);
+
+// Shape and buffer size of the first frame, for sizing a display or buffers; pixels is left alone
+GVC_API void gvc_reader_format(const gvc_reader_t* reader, gvc_frame_t* format_out);
+
+// Make frame_number the next frame gvc_reader_next returns. Decoding restarts at
+// the keyframe that begins its GOP, so a seek costs up to a GOP of decoding.
+GVC_API int gvc_reader_seek(gvc_reader_t* reader, uint32_t frame_number);
+
+// Decode the next frame into frame->pixels. A frame larger than frame->capacity
+// returns GVC_ERROR_MEMORY with size and shape set, and is returned again by the
+// next call. A frame that cannot be read or decoded returns its error and the
+// next call moves on; frames predicted from it fail until the next keyframe.
+GVC_API int gvc_reader_next(gvc_reader_t* reader, gvc_frame_t* frame);
+
+// While set, bidirectional frames (which nothing predicts from) are skipped
+// instead of decoded, so a player that has fallen behind can catch up
+GVC_API void gvc_reader_set_drop_bidir(gvc_reader_t* reader, int drop);
+GVC_API uint32_t gvc_reader_dropped_frames(const gvc_reader_t* reader);
+
+GVC_API void gvc_reader_close(gvc_reader_t* reader);
+
+#endif // GITFLIX_H
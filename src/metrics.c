@@ -0,0 +1,261 @@
+#include "git_vid_codec.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Live metrics for long-running players. A background thread listens on a Unix
+// domain socket and answers every connection with the current telemetry in the
+// Prometheus text exposition format, then closes it. Everything it reports is
+// read from telemetry's relaxed atomic counters, so a scrape never takes a lock
+// that the decoder or display threads hold. Clients that send an HTTP request
+// get an HTTP response, so both of these work:
+//
+//   curl --unix-socket /run/gitflix.sock http://localhost/metrics
+//   socat - UNIX-CONNECT:/run/gitflix.sock
+//
+// Latency quantiles and hit counts cover the whole run, as Prometheus expects of
+// summaries and counters; fps is presented frames over the last sample interval.
+
+#define METRICS_POLL_MS 250
+#define METRICS_FPS_INTERVAL_NS 1000000000ULL
+#define METRICS_REQUEST_TIMEOUT_MS 100   // Time a client gets to send its request line
+#define METRICS_REQUEST_MAX 4096
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // macOS: SO_NOSIGPIPE is set on the client socket instead
+#endif
+
+static struct {
+    int listen_fd;
+    char path[1024];             // Absolute, as playing from a repository changes directory
+    pthread_t thread;
+    atomic_int running;
+    double fps;                  // Only touched by the server thread
+    uint64_t fps_sample_ns;
+    uint64_t fps_sample_frames;
+} metrics = { .listen_fd = -1 };
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void write_latency_summary(FILE* out, const char* stage, const telemetry_summary_t* summary) {
+    fprintf(out, "gitflix_stage_latency_seconds{stage=\"%s\",quantile=\"0.5\"} %.9f\n", stage, summary->p50 / 1e9);
+    fprintf(out, "gitflix_stage_latency_seconds{stage=\"%s\",quantile=\"0.95\"} %.9f\n", stage, summary->p95 / 1e9);
+    fprintf(out, "gitflix_stage_latency_seconds{stage=\"%s\",quantile=\"0.99\"} %.9f\n", stage, summary->p99 / 1e9);
+    fprintf(out, "gitflix_stage_latency_seconds_sum{stage=\"%s\"} %.9f\n", stage,
+            summary->mean * summary->samples / 1e9);
+    fprintf(out, "gitflix_stage_latency_seconds_count{stage=\"%s\"} %llu\n", stage,
+            (unsigned long long)summary->samples);
+}
+
+// The full exposition; fps is supplied by the caller, which owns the sampling
+void metrics_write_prometheus(FILE* out, double fps) {
+    telemetry_counters_t counters;
+    telemetry_counters(&counters);
+    
+    fprintf(out, "# HELP gitflix_uptime_seconds Time since playback telemetry started.\n"
+                 "# TYPE gitflix_uptime_seconds gauge\n"
+                 "gitflix_uptime_seconds %.3f\n", counters.elapsed_seconds);
+    fprintf(out, "# HELP gitflix_fps Frames presented per second over the last second.\n"
+                 "# TYPE gitflix_fps gauge\n"
+                 "gitflix_fps %.2f\n", fps);
+    fprintf(out, "# HELP gitflix_frames_presented_total Frames shown.\n"
+                 "# TYPE gitflix_frames_presented_total counter\n"
+                 "gitflix_frames_presented_total %llu\n", (unsigned long long)counters.frames_presented);
+    fprintf(out, "# HELP gitflix_frames_dropped_total Frames decoded but never shown.\n"
+                 "# TYPE gitflix_frames_dropped_total counter\n"
+                 "gitflix_frames_dropped_total %llu\n", (unsigned long long)counters.frames_dropped);
+    
+    fprintf(out, "# HELP gitflix_stage_latency_seconds Per-frame time spent in each pipeline stage.\n"
+                 "# TYPE gitflix_stage_latency_seconds summary\n");
+    for (int stage = 0; stage < TELEMETRY_STAGE_COUNT; stage++) {
+        telemetry_summary_t summary;
+        telemetry_stage_summary(stage, &summary);
+        write_latency_summary(out, telemetry_stage_name(stage), &summary);
+    }
+    fprintf(out, "# HELP gitflix_stage_over_budget_total Stage samples longer than one frame interval.\n"
+                 "# TYPE gitflix_stage_over_budget_total counter\n");
+    for (int stage = 0; stage < TELEMETRY_STAGE_COUNT; stage++) {
+        telemetry_summary_t summary;
+        telemetry_stage_summary(stage, &summary);
+        fprintf(out, "gitflix_stage_over_budget_total{stage=\"%s\"} %llu\n", telemetry_stage_name(stage),
+                (unsigned long long)summary.over_budget);
+    }
+    
+    fprintf(out, "# HELP gitflix_buffer_frames Decoded frames waiting when the display last took one.\n"
+                 "# TYPE gitflix_buffer_frames gauge\n"
+                 "gitflix_buffer_frames %d\n", counters.queue_depth);
+    fprintf(out, "# HELP gitflix_buffer_capacity_frames Size of the decoded frame buffer.\n"
+                 "# TYPE gitflix_buffer_capacity_frames gauge\n"
+                 "gitflix_buffer_capacity_frames %d\n", counters.queue_capacity);
+    
+    fprintf(out, "# HELP gitflix_cache_hits_total Lookups served from a cache.\n"
+                 "# TYPE gitflix_cache_hits_total counter\n");
+    for (int cache = 0; cache < TELEMETRY_CACHE_COUNT; cache++) {
+        fprintf(out, "gitflix_cache_hits_total{cache=\"%s\"} %llu\n", telemetry_cache_name(cache),
+                (unsigned long long)counters.cache_hits[cache]);
+    }
+    fprintf(out, "# HELP gitflix_cache_misses_total Lookups a cache could not serve.\n"
+                 "# TYPE gitflix_cache_misses_total counter\n");
+    for (int cache = 0; cache < TELEMETRY_CACHE_COUNT; cache++) {
+        fprintf(out, "gitflix_cache_misses_total{cache=\"%s\"} %llu\n", telemetry_cache_name(cache),
+                (unsigned long long)counters.cache_misses[cache]);
+    }
+    
+    fprintf(out, "# HELP gitflix_resident_memory_bytes Resident set size.\n"
+                 "# TYPE gitflix_resident_memory_bytes gauge\n"
+                 "gitflix_resident_memory_bytes %zu\n", counters.rss_bytes);
+    fprintf(out, "# HELP gitflix_peak_resident_memory_bytes Largest resident set size so far.\n"
+                 "# TYPE gitflix_peak_resident_memory_bytes gauge\n"
+                 "gitflix_peak_resident_memory_bytes %zu\n", counters.peak_rss_bytes);
+}
+
+// Refresh the fps gauge once per interval from the presented-frame counter
+static void sample_fps(void) {
+    uint64_t now = now_ns();
+    if (now - metrics.fps_sample_ns < METRICS_FPS_INTERVAL_NS) return;
+    
+    telemetry_counters_t counters;
+    telemetry_counters(&counters);
+    if (metrics.fps_sample_ns) {
+        metrics.fps = (counters.frames_presented - metrics.fps_sample_frames) * 1e9 /
+                      (double)(now - metrics.fps_sample_ns);
+    }
+    metrics.fps_sample_ns = now;
+    metrics.fps_sample_frames = counters.frames_presented;
+}
+
+// Whether the client opened with an HTTP request; its request is read and discarded
+static int read_http_request(int client) {
+    struct pollfd pfd = { .fd = client, .events = POLLIN };
+    char request[METRICS_REQUEST_MAX];
+    size_t used = 0;
+    
+    while (used < sizeof(request) - 1 && poll(&pfd, 1, METRICS_REQUEST_TIMEOUT_MS) > 0) {
+        ssize_t received = recv(client, request + used, sizeof(request) - 1 - used, 0);
+        if (received <= 0) break;
+        used += (size_t)received;
+        request[used] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+    return used >= 4 && memcmp(request, "GET ", 4) == 0;
+}
+
+static void send_all(int client, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(client, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return;
+        data += sent;
+        size -= (size_t)sent;
+    }
+}
+
+static void serve_client(int client) {
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    // A stuck client must not hold the server thread for long
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    int http = read_http_request(client);
+    
+    char* body = NULL;
+    size_t body_size = 0;
+    FILE* out = open_memstream(&body, &body_size);
+    if (!out) return;
+    metrics_write_prometheus(out, metrics.fps);
+    if (fclose(out) != 0) {
+        free(body);
+        return;
+    }
+    
+    if (http) {
+        char header[160];
+        int header_size = snprintf(header, sizeof(header),
+                                   "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                   "Content-Length: %zu\r\nConnection: close\r\n\r\n", body_size);
+        send_all(client, header, (size_t)header_size);
+    }
+    send_all(client, body, body_size);
+    free(body);
+}
+
+static void* metrics_thread(void* arg) {
+    (void)arg;
+    trace_thread_name("metrics");
+    
+    while (atomic_load(&metrics.running)) {
+        sample_fps();
+    
+        struct pollfd pfd = { .fd = metrics.listen_fd, .events = POLLIN };
+        if (poll(&pfd, 1, METRICS_POLL_MS) <= 0) continue;
+    
+        int client = accept(metrics.listen_fd, NULL, NULL);
+        if (client < 0) continue;
+        serve_client(client);
+        close(client);
+    }
+    return NULL;
+}
+
+// Listen on socket_path, replacing a stale socket left by an earlier run
+int metrics_server_start(const char* socket_path) {
+    if (!socket_path || metrics.listen_fd >= 0) return GVC_ERROR_IO;
+    
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) return GVC_ERROR_IO;
+    strcpy(address.sun_path, socket_path);
+    
+    struct stat info;
+    if (lstat(socket_path, &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) return GVC_ERROR_IO;  // Never unlink anything else
+        unlink(socket_path);
+    }
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return GVC_ERROR_IO;
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 8) != 0) {
+        close(fd);
+        return GVC_ERROR_IO;
+    }
+    
+    metrics.listen_fd = fd;
+    if (socket_path[0] == '/' || !getcwd(metrics.path, sizeof(metrics.path)) ||
+        strlen(metrics.path) + strlen(socket_path) + 2 > sizeof(metrics.path)) {
+        snprintf(metrics.path, sizeof(metrics.path), "%s", socket_path);
+    } else {
+        strcat(metrics.path, "/");
+        strcat(metrics.path, socket_path);
+    }
+    atomic_store(&metrics.running, 1);
+    if (pthread_create(&metrics.thread, NULL, metrics_thread, NULL) != 0) {
+        atomic_store(&metrics.running, 0);
+        close(fd);
+        unlink(metrics.path);
+        metrics.listen_fd = -1;
+        return GVC_ERROR_IO;
+    }
+    return GVC_SUCCESS;
+}
+
+void metrics_server_stop(void) {
+    if (metrics.listen_fd < 0) return;
+    
+    atomic_store(&metrics.running, 0);
+    pthread_join(metrics.thread, NULL);
+    close(metrics.listen_fd);
+    unlink(metrics.path);
+    metrics.listen_fd = -1;
+}
@@ -67,27 +67,117 @@ static int get_video_info(const char* input_file, int* width, int* height, doubl
     return GVC_SUCCESS;
 }
 
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-j threads] [-p format] [-e preset] [-l level] [-g max] [-G min] [-2] [-b] [-s] [-r] [-c checksum] <input.mp4> <output_repo_path>\n", program);
+    fprintf(stderr, "\nConverts an MP4 video file to a Git repository using the Git Video Codec.\n");
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "  -j threads   Encoder worker threads (default: one per CPU)\n");
+    fprintf(stderr, "  -p format    Stored pixel format: yuv420p (as decoded, default) or rgb24\n");
+    fprintf(stderr, "  -e preset    Encoder effort: fast, balanced (default) or max\n");
+    fprintf(stderr, "  -l level     Compress payloads with zlib at this level (1-9) instead of the\n");
+    fprintf(stderr, "               preset's backend\n");
+    fprintf(stderr, "  -g frames    Maximum keyframe interval (default: %d)\n", DEFAULT_MAX_GOP);
+    fprintf(stderr, "  -G frames    Minimum keyframe interval at scene cuts (default: %d)\n", DEFAULT_MIN_GOP);
+    fprintf(stderr, "  -2           Two-pass: also store repeated frames as references\n");
+    fprintf(stderr, "  -b           B frames: predict alternate frames from both neighbours\n");
+    fprintf(stderr, "  -s           Screen content: palette and block-copy coding for recordings\n");
+    fprintf(stderr, "  -r           Entropy-code delta frames with rANS instead of the backend\n");
+    fprintf(stderr, "               (faster to decode, larger on camera footage)\n");
+    fprintf(stderr, "  -c checksum  Payload checksum: crc32c (default, hardware-accelerated)\n");
+    fprintf(stderr, "               or crc32\n");
+    fprintf(stderr, "\nRequirements:\n");
+    fprintf(stderr, "  - FFmpeg must be installed and available in PATH\n");
+    fprintf(stderr, "  - Frames are kept at the input resolution (up to %dx%d)\n",
+            MAX_FRAME_WIDTH, MAX_FRAME_HEIGHT);
+    fprintf(stderr, "\nExample:\n");
+    fprintf(stderr, "  %s input.mp4 ./video_repo\n", program);
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <input.mp4> <output_repo_path>\n", argv[0]);
-        fprintf(stderr, "\nConverts an MP4 video file to a Git repository using the Git Video Codec.\n");
-        fprintf(stderr, "\nRequirements:\n");
-        fprintf(stderr, "  - FFmpeg must be installed and available in PATH\n");
-        fprintf(stderr, "  - Input video will be scaled to 1920x1080 at 60fps\n");
-        fprintf(stderr, "\nExample:\n");
-        fprintf(stderr, "  %s input.mp4 ./video_repo\n", argv[0]);
+    encode_options_t options;
+    encode_options_init(&options);
+    options.pixel_format = PIXEL_FORMAT_YUV420P; // H.264 decodes to 4:2:0, store it as is
+    
+    int screen_content = 0;
+    int entropy_delta = 0;
+    int zlib_level = 0;
+    uint8_t checksum = CHECKSUM_CRC32C;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:p:e:l:g:G:2bsrc:")) != -1) {
+        switch (opt) {
+            case 'j':
+                options.num_threads = atoi(optarg);
+                break;
+            case 'p':
+                if (parse_pixel_format(optarg, &options.pixel_format) != GVC_SUCCESS) {
+                    fprintf(stderr, "Unknown pixel format: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'e':
+                if (parse_encode_preset(optarg, &options.profile) != GVC_SUCCESS) {
+                    fprintf(stderr, "Unknown preset: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'l':
+                zlib_level = atoi(optarg);
+                if (zlib_level < 1 || zlib_level > 9) {
+                    fprintf(stderr, "zlib level must be 1-9\n");
+                    return 1;
+                }
+                break;
+            case 'g':
+                options.keyframes.max_gop = atoi(optarg);
+                break;
+            case 'G':
+                options.keyframes.min_gop = atoi(optarg);
+                break;
+            case '2':
+                options.two_pass = 1;
+                break;
+            case 'b':
+                options.bframes = 1;
+                break;
+            case 's':
+                screen_content = 1;
+                break;
+            case 'r':
+                entropy_delta = 1;
+                break;
+            case 'c':
+                if (parse_checksum_type(optarg, &checksum) != GVC_SUCCESS) {
+                    fprintf(stderr, "Unknown checksum: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    options.profile.screen_content = screen_content; // -e resets the profile, so apply last
+    options.profile.compression.entropy_delta = entropy_delta;
+    options.profile.compression.checksum = checksum;
+    if (zlib_level > 0) {
+        options.profile.compression.backend = BACKEND_ZLIB;
+        options.profile.compression.level = zlib_level;
+    }
+    
+    if (argc - optind != 2) {
+        print_usage(argv[0]);
         return 1;
     }
-
-    const char* mp4_path = argv[1];
-    const char* repo_path = argv[2];
-
+    
+    const char* mp4_path = argv[optind];
+    const char* repo_path = argv[optind + 1];
+    
     printf("Git Video Codec - MP4 Converter\n");
     printf("Input: %s\n", mp4_path);
     printf("Output: %s\n", repo_path);
     printf("\n");
-
-    int result = convert_mp4_to_repo(mp4_path, repo_path);
+    
+    int result = convert_mp4_to_repo(mp4_path, repo_path, &options);
     
     if (result == GVC_SUCCESS) {
         printf("\nConversion completed successfully!\n");
@@ -100,7 +190,8 @@ int main(int argc, char* argv[]) {
 }
 
 // Function to extract frames from MP4 to temporary directory
-static int extract_frames_to_temp(const char* input_file, const char* temp_dir) {
+static int extract_frames_to_temp(const char* input_file, const char* temp_dir,
+                                  int width, int height, uint32_t pixel_format) {
     char cmd[2048];
     
     // Create temporary directory
@@ -108,12 +199,13 @@ static int extract_frames_to_temp(const char* input_file, const char* temp_dir)
         return GVC_ERROR_IO;
     }
     
-    // Extract frames as RGB raw format
-    // Scale to 1920x1080 if needed, maintain aspect ratio with padding
+    // Extract frames as raw video in the storage pixel format; yuv420p keeps
+    // the decoder's planes untouched instead of upsampling chroma to RGB
+    // Scale only when the source exceeds the supported maximum
     snprintf(cmd, sizeof(cmd), 
-        "ffmpeg -i '%s' -vf 'scale=1920:1080:force_original_aspect_ratio=decrease,pad=1920:1080:(ow-iw)/2:(oh-ih)/2:black' "
-        "-f image2 -vcodec rawvideo -pix_fmt rgb24 '%s/frame_%%06d.rgb' -y > /dev/null 2>&1", 
-        input_file, temp_dir);
+        "ffmpeg -i '%s' -vf 'scale=%d:%d' "
+        "-f image2 -vcodec rawvideo -pix_fmt %s '%s/frame_%%06d.rgb' -y > /dev/null 2>&1", 
+        input_file, width, height, pixel_format_name(pixel_format), temp_dir);
     
     printf("Extracting frames from MP4...\n");
     int status = system(cmd);
@@ -152,11 +244,19 @@ static void cleanup_temp_dir(const char* temp_dir) {
 }
 
 // Main function to convert MP4 to Git Video Codec repository
-int convert_mp4_to_repo(const char* input_file, const char* repo_path) {
+int convert_mp4_to_repo(const char* input_file, const char* repo_path,
+                        const encode_options_t* options) {
     if (!input_file || !repo_path) {
         return GVC_ERROR_MEMORY;
     }
     
+    encode_options_t default_options;
+    if (!options) {
+        encode_options_init(&default_options);
+        default_options.pixel_format = PIXEL_FORMAT_YUV420P;
+        options = &default_options;
+    }
+    
     // Check if input file exists
     struct stat st;
     if (stat(input_file, &st) != 0) {
@@ -190,9 +290,27 @@ int convert_mp4_to_repo(const char* input_file, const char* repo_path) {
         printf(", frame count unknown\n");
     }
     
-    // Warn if not 1920x1080
-    if (width != FRAME_WIDTH || height != FRAME_HEIGHT) {
-        printf("Note: Video will be scaled/padded to %dx%d\n", FRAME_WIDTH, FRAME_HEIGHT);
+    if (width <= 0 || height <= 0) {
+        fprintf(stderr, "Error: Invalid video dimensions %dx%d\n", width, height);
+        return GVC_ERROR_FORMAT;
+    }
+    
+    // Encode at native resolution; only oversized input is scaled down, keeping aspect ratio
+    int frame_width = width;
+    int frame_height = height;
+    if (frame_width > MAX_FRAME_WIDTH) {
+        frame_height = (int)((int64_t)frame_height * MAX_FRAME_WIDTH / frame_width);
+        frame_width = MAX_FRAME_WIDTH;
+    }
+    if (frame_height > MAX_FRAME_HEIGHT) {
+        frame_width = (int)((int64_t)frame_width * MAX_FRAME_HEIGHT / frame_height);
+        frame_height = MAX_FRAME_HEIGHT;
+    }
+    frame_width = MAX(frame_width, 1);
+    frame_height = MAX(frame_height, 1);
+    
+    if (frame_width != width || frame_height != height) {
+        printf("Note: Video will be scaled to %dx%d\n", frame_width, frame_height);
     }
     
     // Create temporary directory for extracted frames
@@ -200,7 +318,10 @@ int convert_mp4_to_repo(const char* input_file, const char* repo_path) {
     snprintf(temp_dir, sizeof(temp_dir), "/tmp/gvc_frames_%d", getpid());
     
     // Extract frames
-    result = extract_frames_to_temp(input_file, temp_dir);
+    uint32_t pixel_format = options->pixel_format;
+    printf("Storage format: %s\n", pixel_format_name(pixel_format));
+    
+    result = extract_frames_to_temp(input_file, temp_dir, frame_width, frame_height, pixel_format);
     if (result != GVC_SUCCESS) {
         cleanup_temp_dir(temp_dir);
         return result;
@@ -239,60 +360,23 @@ int convert_mp4_to_repo(const char* input_file, const char* repo_path) {
     
     printf("Encoding frames to Git repository...\n");
     
-    // Encode frames to Git commits
-    raw_frame_t current_frame, previous_frame;
-    char current_commit_hash[GIT_HASH_SIZE + 1] = {0};
-    char previous_commit_hash[GIT_HASH_SIZE + 1] = {0};
-    
-    size_t total_original_size = 0;
-    
-    for (int frame_num = 0; frame_num < actual_frame_count; frame_num++) {
-        // Read frame from temporary directory
-        char frame_filename[512];
-        generate_frame_path(temp_dir, frame_num + 1, frame_filename, sizeof(frame_filename)); // FFmpeg starts from 1
-        
-        result = read_raw_frame(frame_filename, &current_frame);
-        if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Error: Failed to read frame %d\n", frame_num);
-            break;
-        }
-        
-        // Encode frame to Git commit
-        const char* parent_hash = (frame_num == 0) ? NULL : previous_commit_hash;
-        const raw_frame_t* prev_frame = (frame_num == 0) ? NULL : &previous_frame;
-        
-        result = encode_frame_to_commit(&current_frame, prev_frame, frame_num, 
-                                       parent_hash, current_commit_hash);
-        
-        if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Error: Failed to encode frame %d\n", frame_num);
-            free_raw_frame(&current_frame);
-            break;
-        }
-        
-        // Update statistics
-        total_original_size += FRAME_SIZE;
-        
-        // Free previous frame and update
-        if (frame_num > 0) {
-            free_raw_frame(&previous_frame);
-        }
-        
-        previous_frame = current_frame;
-        strcpy(previous_commit_hash, current_commit_hash);
-        
-        // Progress indicator
-        if (frame_num % 30 == 0 || frame_num == actual_frame_count - 1) {
-            printf("Progress: %d/%d frames (%.1f%%)\n", 
-                   frame_num + 1, actual_frame_count, 
-                   (float)(frame_num + 1) / actual_frame_count * 100.0f);
-        }
+    // Map extracted frames read-only and encode them on the worker pipeline
+    frame_ingest_t ingest;
+    result = frame_ingest_open(&ingest, temp_dir, 1, actual_frame_count, // FFmpeg starts from 1
+                               (uint32_t)frame_width, (uint32_t)frame_height, FRAME_CHANNELS,
+                               pixel_format);
+    if (result != GVC_SUCCESS) {
+        chdir(original_cwd);
+        cleanup_temp_dir(temp_dir);
+        return result;
     }
     
-    // Cleanup last frame
-    if (actual_frame_count > 0) {
-        free_raw_frame(&previous_frame);
-    }
+    frame_source_t source;
+    frame_ingest_source(&ingest, &source);
+    
+    encode_stats_t stats;
+    result = encode_pipeline_run(&source, options, &stats);
+    frame_ingest_close(&ingest);
     
     // Return to original directory
     chdir(original_cwd);
@@ -302,10 +386,9 @@ int convert_mp4_to_repo(const char* input_file, const char* repo_path) {
     
     if (result == GVC_SUCCESS) {
         printf("\nConversion complete!\n");
-        printf("Frames encoded: %d\n", actual_frame_count);
         printf("Original video: %s\n", input_file);
         printf("Git repository: %s\n", repo_path);
-        printf("Original size: %.2f MB\n", total_original_size / (1024.0 * 1024.0));
+        print_encode_stats(&stats, options);
         
         // Get repository size
         char cmd[1024];
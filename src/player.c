@@ -1,4 +1,5 @@
 #include "git_vid_codec.h"
+#include "probes.h"
 #include <signal.h>
 #include <sys/time.h>
 #include <time.h>
@@ -9,6 +10,12 @@
 static volatile int should_exit = 0;
 static volatile int frame_count = 0;
 static struct timeval start_time;
+static verify_policy_t verify_policy = VERIFY_FULL;
+static const char* trace_path = NULL;      // Timeline of this run, written at exit
+static const char* metrics_path = NULL;    // Unix socket serving live Prometheus metrics
+static const char* telemetry_path = NULL;  // JSON telemetry dump, or NULL for stderr on SIGUSR1 only
+static volatile sig_atomic_t telemetry_dump_requested = 0;
+static int headless = 0;                   // Decode every frame, but open no window and never pace
 
 // Frame buffer for performance optimization
 #define FRAME_BUFFER_SIZE 16
@@ -19,13 +26,58 @@ static volatile int buffer_count = 0;
 static pthread_mutex_t buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t buffer_not_empty = PTHREAD_COND_INITIALIZER;
 static pthread_cond_t buffer_not_full = PTHREAD_COND_INITIALIZER;
+static int decoder_done = 0;  // Every frame has been put, under buffer_mutex
+static int decoder_result = GVC_SUCCESS;  // The first frame the decoder thread could not decode
 
 // Signal handler for graceful exit
 void signal_handler(int sig) {
-    (void)sig; // Suppress unused parameter warning
+    if (sig == SIGUSR1) {
+        telemetry_dump_requested = 1;
+        return;
+    }
     should_exit = 1;
 }
 
+// Write the telemetry JSON if SIGUSR1 asked for it since the last check
+static void check_telemetry_dump(void) {
+    if (telemetry_dump_requested) {
+        telemetry_dump_requested = 0;
+        if (telemetry_dump_json(telemetry_path) != GVC_SUCCESS) {
+            fprintf(stderr, "Warning: Failed to write telemetry to %s\n", telemetry_path);
+        }
+    }
+}
+
+// Print the stage summary, write the JSON dump requested with -T and the trace requested with -t
+static void finish_telemetry(void) {
+    telemetry_print_summary(stdout);
+    if (telemetry_path && telemetry_dump_json(telemetry_path) != GVC_SUCCESS) {
+        fprintf(stderr, "Warning: Failed to write telemetry to %s\n", telemetry_path);
+    }
+    if (trace_path && trace_stop() != GVC_SUCCESS) {
+        fprintf(stderr, "Warning: Failed to write trace to %s\n", trace_path);
+    }
+}
+
+// The display, unless running headless
+static int output_init(uint32_t width, uint32_t height) {
+    return headless ? GVC_SUCCESS : display_init(width, height);
+}
+
+static int output_frame(const raw_frame_t* frame) {
+    return headless ? GVC_SUCCESS : display_frame(frame);
+}
+
+static int output_should_close(void) {
+    return headless ? 0 : display_should_close();
+}
+
+static void output_cleanup(void) {
+    if (!headless) {
+        display_cleanup();
+    }
+}
+
 // High-precision timer functions
 static uint64_t get_time_ns(void) {
     struct timespec ts;
@@ -40,23 +92,25 @@ static void sleep_ns(uint64_t nanoseconds) {
     nanosleep(&ts, NULL);
 }
 
-// Frame buffer management functions
+// Frame buffer management functions; the buffer takes ownership of frame's pixels
 static void buffer_put_frame(const raw_frame_t* frame) {
+    uint64_t span_start = trace_begin();
     pthread_mutex_lock(&buffer_mutex);
+    trace_end("lock buffer_mutex", span_start);
     
+    span_start = trace_begin();
     while (buffer_count >= FRAME_BUFFER_SIZE && !should_exit) {
         pthread_cond_wait(&buffer_not_full, &buffer_mutex);
     }
+    trace_end("wait buffer_not_full", span_start);
     
-    if (!should_exit) {
-        // Deep copy frame data
+    if (should_exit) {
+        free(frame->pixels);
+    } else {
         frame_buffer[buffer_write_pos] = *frame;
-        size_t data_size = frame->width * frame->height * frame->channels;
-        frame_buffer[buffer_write_pos].pixels = malloc(data_size);
-        memcpy(frame_buffer[buffer_write_pos].pixels, frame->pixels, data_size);
-        
         buffer_write_pos = (buffer_write_pos + 1) % FRAME_BUFFER_SIZE;
         buffer_count++;
+        GVC_PROBE2(ring_put, buffer_count, raw_frame_size(frame));
         pthread_cond_signal(&buffer_not_empty);
     }
     
@@ -64,17 +118,23 @@ static void buffer_put_frame(const raw_frame_t* frame) {
 }
 
 static int buffer_get_frame(raw_frame_t* frame) {
+    uint64_t span_start = trace_begin();
     pthread_mutex_lock(&buffer_mutex);
+    trace_end("lock buffer_mutex", span_start);
     
-    while (buffer_count == 0 && !should_exit) {
+    span_start = trace_begin();
+    while (buffer_count == 0 && !should_exit && !decoder_done) {
         pthread_cond_wait(&buffer_not_empty, &buffer_mutex);
     }
+    trace_end("wait buffer_not_empty", span_start);
     
-    if (should_exit) {
+    if (should_exit || buffer_count == 0) {
         pthread_mutex_unlock(&buffer_mutex);
         return GVC_ERROR_IO;
     }
     
+    telemetry_record_queue_depth(buffer_count);
+    GVC_PROBE2(ring_get, buffer_count, raw_frame_size(&frame_buffer[buffer_read_pos]));
     *frame = frame_buffer[buffer_read_pos];
     buffer_read_pos = (buffer_read_pos + 1) % FRAME_BUFFER_SIZE;
     buffer_count--;
@@ -84,91 +144,41 @@ static int buffer_get_frame(raw_frame_t* frame) {
     return GVC_SUCCESS;
 }
 
-// Optimized decode function without display
-static int decode_and_display_frame_buffered(const char* commit_hash, 
-                                           const raw_frame_t* previous_frame,
-                                           raw_frame_t* current_frame_out) {
-    // Read frame data from Git commit
-    uint8_t* frame_data;
-    size_t frame_data_size;
-    
-    int result = git_read_frame_from_commit(commit_hash, &frame_data, &frame_data_size);
-    if (result != GVC_SUCCESS) {
-        return result;
-    }
-    
-    // Deserialize frame
-    frame_t compressed_frame;
-    result = deserialize_frame(frame_data, frame_data_size, &compressed_frame);
-    free(frame_data);
-    
-    if (result != GVC_SUCCESS) {
-        return result;
-    }
-    
-    // Decompress frame
-    if (compressed_frame.header.compression_type == 0) {
-        // Raw compression
-        result = decompress_frame_raw(&compressed_frame, current_frame_out);
-    } else if (compressed_frame.header.compression_type == 1) {
-        // Delta compression
-        if (!previous_frame) {
-            free_frame(&compressed_frame);
-            return GVC_ERROR_FORMAT;
-        }
-        result = decompress_frame_delta(&compressed_frame, previous_frame, current_frame_out);
-    } else {
-        free_frame(&compressed_frame);
-        return GVC_ERROR_FORMAT;
-    }
-    
-    free_frame(&compressed_frame);
-    return result;
-}
-
-// Decoder thread data structure
-typedef struct {
-    char** commit_hashes;
-    int num_commits;
-    int current_commit;
-    raw_frame_t previous_frame;
-    int has_previous_frame;
-} decoder_thread_data_t;
-
-// Decoder thread function
+// Decoder thread: hands frames over in presentation order, each decoded straight
+// into a buffer the frame buffer then owns
 static void* decoder_thread(void* arg) {
-    decoder_thread_data_t* data = (decoder_thread_data_t*)arg;
+    gvc_reader_t* reader = (gvc_reader_t*)arg;
+    trace_thread_name("decoder");
     
-    while (data->current_commit < data->num_commits && !should_exit) {
-        raw_frame_t current_frame;
-        const raw_frame_t* prev_frame = data->has_previous_frame ? &data->previous_frame : NULL;
-        
-        int result = decode_and_display_frame_buffered(data->commit_hashes[data->current_commit], 
-                                                      prev_frame, &current_frame);
-        
-        if (result == GVC_SUCCESS) {
-            // Make a copy for the buffer
-            raw_frame_t buffer_frame = current_frame;
-            size_t data_size = current_frame.width * current_frame.height * current_frame.channels;
-            buffer_frame.pixels = malloc(data_size);
-            memcpy(buffer_frame.pixels, current_frame.pixels, data_size);
-            buffer_put_frame(&buffer_frame);
-            
-            // Update previous frame - transfer ownership instead of copying
-            if (data->has_previous_frame) {
-                free(data->previous_frame.pixels);
+    gvc_frame_t frame;
+    gvc_reader_format(reader, &frame);
+    frame.pixels = NULL;
+    frame.capacity = 0;
+    int result;
+    uint32_t decoded_count = 0;
+    while (!should_exit && (result = gvc_reader_next_grow(reader, &frame)) != GVC_READER_END) {
+        // The reader moves past a failed frame, so playback goes on without it
+        if (result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Failed to decode the frame after %u (error %d)\n", decoded_count, result);
+            if (decoder_result == GVC_SUCCESS) {
+                decoder_result = result;
             }
-            
-            // Transfer ownership of current frame to previous frame
-            data->previous_frame = current_frame;
-            data->has_previous_frame = 1;
-            
-            // Don't free current_frame.pixels - ownership transferred to previous_frame
+            continue;
         }
         
-        data->current_commit++;
+        raw_frame_t decoded;
+        gvc_frame_view(&frame, &decoded);
+        buffer_put_frame(&decoded);
+        frame.pixels = NULL;
+        frame.capacity = 0;
+        decoded_count++;
     }
+    free(frame.pixels);
     
+    pthread_mutex_lock(&buffer_mutex);
+    decoder_done = 1;
+    pthread_cond_signal(&buffer_not_empty);
+    pthread_mutex_unlock(&buffer_mutex);
     return NULL;
 }
 
@@ -235,58 +245,28 @@ static int expand_hashes_batch(char** short_hashes, int num_hashes, char** full_
     return GVC_SUCCESS;
 }
 
-// Function to decode and display a single frame
-static int decode_and_display_frame(const char* commit_hash, 
-                                   const raw_frame_t* previous_frame,
-                                   raw_frame_t* current_frame_out) {
-    // Read frame data from Git commit
-    uint8_t* frame_data;
-    size_t frame_data_size;
-    
-    int result = git_read_frame_from_commit(commit_hash, &frame_data, &frame_data_size);
-    if (result != GVC_SUCCESS) {
-        return result;
-    }
-    
-    // Deserialize frame
-    frame_t compressed_frame;
-    result = deserialize_frame(frame_data, frame_data_size, &compressed_frame);
-    free(frame_data);
-    
+// Open a reader with the player's options and size the display from its first frame
+static int open_reader(const char* repo_path, const char* const* commits, int num_commits,
+                       gvc_reader_t** reader_out) {
+    gvc_reader_options_t options;
+    gvc_reader_options_init(&options);
+    options.verify = verify_policy;
+    telemetry_reader_sink(&options.telemetry);
+    int result = commits ? gvc_reader_open_commits(repo_path, commits, (uint32_t)num_commits, &options, reader_out)
+                         : gvc_reader_open(repo_path, &options, reader_out);
     if (result != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Failed to read frames from %s\n", repo_path ? repo_path : "the repository");
         return result;
     }
     
-    // Decompress frame
-    if (compressed_frame.header.compression_type == 0) {
-        // Raw compression
-        result = decompress_frame_raw(&compressed_frame, current_frame_out);
-    } else if (compressed_frame.header.compression_type == 1) {
-        // Delta compression
-        if (!previous_frame) {
-            free_frame(&compressed_frame);
-            return GVC_ERROR_FORMAT;
-        }
-        result = decompress_frame_delta(&compressed_frame, previous_frame, current_frame_out);
-    } else {
-        free_frame(&compressed_frame);
-        return GVC_ERROR_FORMAT;
-    }
-    
-    free_frame(&compressed_frame);
-    
+    gvc_frame_t format;
+    gvc_reader_format(*reader_out, &format);
+    result = output_init(format.width, format.height);
     if (result != GVC_SUCCESS) {
-        return result;
-    }
-    
-    // Display frame
-    result = display_frame(current_frame_out);
-    if (result != GVC_SUCCESS) {
-        free_raw_frame(current_frame_out);
-        return result;
+        fprintf(stderr, "Error: Failed to initialize display\n");
+        gvc_reader_close(*reader_out);
     }
-    
-    return GVC_SUCCESS;
+    return result;
 }
 
 // Function to play video from stdin (commit hashes) with multithreaded buffering
@@ -298,13 +278,7 @@ int play_from_stdin(void) {
     // Setup signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
-    
-    // Initialize display
-    int result = display_init(FRAME_WIDTH, FRAME_HEIGHT);
-    if (result != GVC_SUCCESS) {
-        fprintf(stderr, "Error: Failed to initialize display\n");
-        return result;
-    }
+    signal(SIGUSR1, signal_handler);
     
     // Read all short commit hashes first
     char** short_hashes = malloc(sizeof(char*) * 1000); // Assume max 1000 frames
@@ -330,7 +304,6 @@ int play_from_stdin(void) {
             }
             free(short_hashes);
             free(commit_hashes);
-            display_cleanup();
             return expand_result;
         }
     }
@@ -344,27 +317,31 @@ int play_from_stdin(void) {
     if (num_commits == 0) {
         fprintf(stderr, "No frames to play\n");
         free(commit_hashes);
-        display_cleanup();
         return GVC_ERROR_IO;
     }
     
-    // Initialize decoder thread data
-    decoder_thread_data_t decoder_data = {
-        .commit_hashes = commit_hashes,
-        .num_commits = num_commits,
-        .current_commit = 0,
-        .has_previous_frame = 0
-    };
+    // The reader keeps its own copy of the list
+    gvc_reader_t* reader;
+    int result = open_reader(NULL, (const char* const*)commit_hashes, num_commits, &reader);
+    for (int i = 0; i < num_commits; i++) {
+        free(commit_hashes[i]);
+    }
+    free(commit_hashes);
+    if (result != GVC_SUCCESS) {
+        return result;
+    }
     
     // Start decoder thread
     pthread_t decoder_tid;
-    pthread_create(&decoder_tid, NULL, decoder_thread, &decoder_data);
+    pthread_create(&decoder_tid, NULL, decoder_thread, reader);
     
     gettimeofday(&start_time, NULL);
+    trace_thread_name("display");
     
     // Main display loop
-    while (!should_exit && !display_should_close() && frame_count < num_commits) {
+    while (!should_exit && !output_should_close()) {
         raw_frame_t frame;
+        trace_set_frame(frame_count);
         
         // Get frame from buffer
         if (buffer_get_frame(&frame) != GVC_SUCCESS) {
@@ -372,13 +349,17 @@ int play_from_stdin(void) {
         }
         
         // Display frame
-        result = display_frame(&frame);
+        result = output_frame(&frame);
+        telemetry_frame_done();
         if (result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Failed to display frame\n");
             free(frame.pixels);
             break;
         }
         
         frame_count++;
+        telemetry_count_presented();
+        check_telemetry_dump();
         
         // Free frame data
         free(frame.pixels);
@@ -411,18 +392,8 @@ int play_from_stdin(void) {
         free(frame.pixels);
     }
     
-    // Clean up commit hashes
-    for (int i = 0; i < num_commits; i++) {
-        free(commit_hashes[i]);
-    }
-    free(commit_hashes);
-    
-    // Clean up decoder data
-    if (decoder_data.has_previous_frame) {
-        free(decoder_data.previous_frame.pixels);
-    }
-    
-    display_cleanup();
+    gvc_reader_close(reader);
+    output_cleanup();
     
     // Final statistics
     struct timeval end_time;
@@ -435,125 +406,186 @@ int play_from_stdin(void) {
     printf("Total frames: %d\n", frame_count);
     printf("Total time: %.2f seconds\n", total_elapsed);
     printf("Average FPS: %.2f\n", avg_fps);
+    finish_telemetry();
     
-    return GVC_SUCCESS;
+    // Display errors end playback; decode errors only skip their frame
+    return result != GVC_SUCCESS ? result : decoder_result;
 }
 
 // Function to play video directly from repository
 int play_from_repo(const char* repo_path) {
     if (!repo_path) return GVC_ERROR_MEMORY;
     
-    // Change to repository directory
-    if (chdir(repo_path) != 0) {
-        fprintf(stderr, "Error: Failed to change to repository directory: %s\n", repo_path);
-        return GVC_ERROR_IO;
-    }
-    
-    // Get commit chain
-    char commits[1000][GIT_HASH_SIZE + 1];
-    int commit_count = git_get_commit_chain(commits, 1000);
-    
-    if (commit_count <= 0) {
-        fprintf(stderr, "No commits found in repository\n");
-        return GVC_ERROR_GIT;
-    }
-    
-    printf("Found %d commits in repository\n", commit_count);
-    
     // Setup signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGUSR1, signal_handler);
     
-    // Initialize display
-    int result = display_init(FRAME_WIDTH, FRAME_HEIGHT);
+    gvc_reader_t* reader;
+    int result = open_reader(repo_path, NULL, 0, &reader);
     if (result != GVC_SUCCESS) {
-        fprintf(stderr, "Error: Failed to initialize display\n");
         return result;
     }
+    uint32_t commit_count = gvc_reader_frame_count(reader);
+    printf("Found %u commits in repository\n", commit_count);
     
     gettimeofday(&start_time, NULL);
     
-    raw_frame_t current_frame, previous_frame;
-    memset(&current_frame, 0, sizeof(current_frame));
-    memset(&previous_frame, 0, sizeof(previous_frame));
+    // Every frame is decoded into the same buffer
+    gvc_frame_t current_frame;
+    gvc_reader_format(reader, &current_frame);
+    current_frame.pixels = NULL;
+    current_frame.capacity = 0;
+    int behind = 0;  // The last frame overran its time slot
+    int decode_result = GVC_SUCCESS;  // The first frame that could not be decoded
     
     uint64_t frame_start_time = get_time_ns();
-    int has_previous_frame = 0;
-    
-    for (int i = 0; i < commit_count && !should_exit && !display_should_close(); i++) {
-        // Decode and display frame
-        const raw_frame_t* prev_frame = has_previous_frame ? &previous_frame : NULL;
-        result = decode_and_display_frame(commits[i], prev_frame, &current_frame);
+    trace_thread_name("player");
+    
+    while (!should_exit && !output_should_close()) {
+        // B frames are the first to go when behind; headless runs decode everything
+        gvc_reader_set_drop_bidir(reader, behind && !headless);
+        trace_set_frame(frame_count);
+        result = gvc_reader_next_grow(reader, &current_frame);
+        if (result == GVC_READER_END) {
+            result = GVC_SUCCESS;
+            break;
+        }
+        // The reader moves past a failed frame, so playback goes on without it
+        if (result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: Failed to decode the frame after %d (error %d)\n", frame_count, result);
+            if (decode_result == GVC_SUCCESS) {
+                decode_result = result;
+            }
+            result = GVC_SUCCESS;
+            continue;
+        }
         
+        raw_frame_t decoded;
+        gvc_frame_view(&current_frame, &decoded);
+        result = output_frame(&decoded);
+        telemetry_frame_done();
         if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Error: Failed to decode frame from commit %s\n", commits[i]);
+            fprintf(stderr, "Error: Failed to display frame\n");
             break;
         }
         
         frame_count++;
+        telemetry_count_presented();
+        check_telemetry_dump();
         
         // Frame timing control
         uint64_t frame_end_time = get_time_ns();
         uint64_t frame_duration = frame_end_time - frame_start_time;
         
-        if (frame_duration < FRAME_TIME_NS) {
+        behind = frame_duration > FRAME_TIME_NS;
+        if (!behind && !headless) {
+            uint64_t span_start = trace_begin();
             sleep_ns(FRAME_TIME_NS - frame_duration);
+            trace_end("pace", span_start);
         }
         
-        // Update for next frame
-        if (has_previous_frame) {
-            free_raw_frame(&previous_frame);
-        }
-        
-        previous_frame = current_frame;
-        memset(&current_frame, 0, sizeof(current_frame));
-        has_previous_frame = 1;
-        
         frame_start_time = get_time_ns();
         
         // Progress indicator
         if (frame_count % 60 == 0) {
-            printf("\rFrame %d/%d (%.1f%%)", i + 1, commit_count, 
-                   (float)(i + 1) / commit_count * 100.0f);
+            printf("\rFrame %u/%u (%.1f%%)", current_frame.frame_number + 1, commit_count,
+                   (float)(current_frame.frame_number + 1) / commit_count * 100.0f);
             fflush(stdout);
         }
     }
     
-    // Cleanup
-    if (has_previous_frame) {
-        free_raw_frame(&previous_frame);
-    }
-    if (current_frame.pixels) {
-        free_raw_frame(&current_frame);
-    }
-    
-    display_cleanup();
+    free(current_frame.pixels);
+    uint32_t dropped_frames = gvc_reader_dropped_frames(reader);
+    gvc_reader_close(reader);
+    output_cleanup();
     
     printf("\nPlayback complete\n");
-    return GVC_SUCCESS;
+    if (dropped_frames > 0) {
+        printf("Dropped %u B frames to keep up\n", dropped_frames);
+    }
+    finish_telemetry();
+    
+    // Display errors end playback; decode errors only skip their frame
+    return result != GVC_SUCCESS ? result : decode_result;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-H] [-V policy] [-T telemetry.json] [-t trace.json] [-M metrics.sock] [repo_path]\n", program);
+    printf("\nIf repo_path is provided, plays directly from repository.\n");
+    printf("Otherwise, reads commit hashes from stdin.\n");
+    printf("\nOptions:\n");
+    printf("  -H           Headless: decode every frame as fast as possible, without a window\n");
+    printf("  -V policy    Payload checksums to verify (default: full):\n");
+    printf("                 off        none\n");
+    printf("                 sampled    every %dth frame\n", VERIFY_SAMPLE_INTERVAL);
+    printf("                 keyframes  intra frames only\n");
+    printf("                 full       every frame\n");
+    printf("  -T file      Write per-stage latency telemetry as JSON at exit and on SIGUSR1\n");
+    printf("               (without -T, SIGUSR1 writes it to stderr)\n");
+    printf("  -t file      Write a per-thread timeline as Chrome trace-event JSON at exit\n");
+    printf("               (open in chrome://tracing or ui.perfetto.dev)\n");
+    printf("  -M socket    Serve live metrics in Prometheus text format on a Unix socket\n");
+    printf("\nExamples:\n");
+    printf("  git log --reverse --format=%%H | %s\n", program);
+    printf("  %s ./video_repo\n", program);
 }
 
 // Main function for player binary
 int main(int argc, char* argv[]) {
-    if (argc > 2) {
-        printf("Usage: %s [repo_path]\n", argv[0]);
-        printf("\nIf repo_path is provided, plays directly from repository.\n");
-        printf("Otherwise, reads commit hashes from stdin.\n");
-        printf("\nExamples:\n");
-        printf("  git log --reverse --format=%%H | %s\n", argv[0]);
-        printf("  %s ./video_repo\n", argv[0]);
+    int opt;
+    while ((opt = getopt(argc, argv, "HV:T:t:M:")) != -1) {
+        switch (opt) {
+            case 'H':
+                headless = 1;
+                break;
+            case 'V':
+                if (parse_verify_policy(optarg, &verify_policy) != GVC_SUCCESS) {
+                    fprintf(stderr, "Unknown verification policy: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'T':
+                telemetry_path = optarg;
+                break;
+            case 't':
+                trace_path = optarg;
+                break;
+            case 'M':
+                metrics_path = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    
+    if (argc - optind > 1) {
+        print_usage(argv[0]);
         return 1;
     }
     
     int result;
+    telemetry_init();
+    telemetry_set_queue_capacity(FRAME_BUFFER_SIZE);
+    if (trace_path && trace_start(trace_path) != GVC_SUCCESS) {
+        fprintf(stderr, "Invalid trace path: %s\n", trace_path);
+        return 1;
+    }
+    telemetry_bind_thread();  // Display conversion and presentation run here
+    if (metrics_path && metrics_server_start(metrics_path) != GVC_SUCCESS) {
+        fprintf(stderr, "Cannot serve metrics on %s\n", metrics_path);
+        return 1;
+    }
     
-    if (argc == 2) {
+    if (argc - optind == 1) {
         // Play from repository
-        result = play_from_repo(argv[1]);
+        result = play_from_repo(argv[optind]);
     } else {
         // Play from stdin
         result = play_from_stdin();
     }
+    metrics_server_stop();
     
     if (result != GVC_SUCCESS) {
         fprintf(stderr, "Error: Playback failed with error code: %d\n", result);
@@ -561,4 +593,4 @@ int main(int argc, char* argv[]) {
     }
     
     return 0;
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 #include "git_vid_codec.h"
+#include "probes.h"
 #include <signal.h>
 #include <sys/time.h>
 #include <time.h>
@@ -11,6 +12,11 @@
 static volatile int should_exit = 0;
 static volatile int frame_count = 0;
 static struct timeval start_time;
+static verify_policy_t verify_policy = VERIFY_FULL;
+static const char* trace_path = NULL;      // Timeline of this run, written at exit
+static const char* metrics_path = NULL;    // Unix socket serving live Prometheus metrics
+static const char* telemetry_path = NULL;  // JSON telemetry dump, or NULL for stderr on SIGUSR1 only
+static volatile sig_atomic_t telemetry_dump_requested = 0;
 
 // Lock-free ring buffer for decoded frames
 #define RING_BUFFER_SIZE 16
@@ -24,8 +30,7 @@ static atomic_int write_index = 0;
 static atomic_int read_index = 0;
 static atomic_int frame_count_atomic = 0;
 
-// Parallel decode/display queues
-static dispatch_queue_t decode_queue;
+// Display queue, fed by the decoder on the main thread
 static dispatch_queue_t display_queue;
 static dispatch_semaphore_t frame_semaphore;
 
@@ -36,7 +41,10 @@ static int performance_samples = 0;
 
 // Signal handler for graceful exit
 void signal_handler(int sig) {
-    (void)sig;
+    if (sig == SIGUSR1) {
+        telemetry_dump_requested = 1;
+        return;
+    }
     should_exit = 1;
 }
 
@@ -67,8 +75,9 @@ static int ring_put_frame(const raw_frame_t* frame) {
     slot->frame.width = frame->width;
     slot->frame.height = frame->height;
     slot->frame.channels = frame->channels;
+    slot->frame.pixel_format = frame->pixel_format;
     
-    size_t frame_size = frame->width * frame->height * frame->channels;
+    size_t frame_size = raw_frame_size(frame);
     if (!slot->frame.pixels) {
         slot->frame.pixels = malloc(frame_size);
     }
@@ -80,6 +89,7 @@ static int ring_put_frame(const raw_frame_t* frame) {
     // Advance write index
     atomic_store(&write_index, (write_idx + 1) % RING_BUFFER_SIZE);
     atomic_fetch_add(&frame_count_atomic, 1);
+    GVC_PROBE2(ring_put, current_count + 1, frame_size);
     
     return 1;
 }
@@ -100,6 +110,8 @@ static int ring_get_frame(raw_frame_t* frame) {
     }
     
     // Copy frame data
+    telemetry_record_queue_depth(current_count);
+    GVC_PROBE2(ring_get, current_count, raw_frame_size(&slot->frame));
     *frame = slot->frame;
     slot->frame.pixels = NULL; // Transfer ownership
     
@@ -110,86 +122,29 @@ static int ring_get_frame(raw_frame_t* frame) {
     return 1;
 }
 
-// High-performance frame decoder
-static void decode_frame_async(const char* commit_hash, const raw_frame_t* previous_frame) {
-    dispatch_async(decode_queue, ^{
-        if (should_exit) return;
-        
-        uint64_t decode_start = get_time_ns();
-        
-        // Read compressed frame data using libgit2
-        uint8_t* compressed_data;
-        size_t compressed_size;
-        int result = git_read_blob_libgit2(commit_hash, &compressed_data, &compressed_size);
-        
-        if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Failed to read blob %s\n", commit_hash);
-            return;
-        }
-        
-        // Deserialize frame
-        frame_t compressed_frame;
-        result = deserialize_frame(compressed_data, compressed_size, &compressed_frame);
-        free(compressed_data);
-        
-        if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Failed to deserialize frame %s (error %d)\n", commit_hash, result);
-            return;
-        }
-        
-        // Decompress frame
-        raw_frame_t decoded_frame;
-        if (compressed_frame.header.compression_type == 1) {
-            if (previous_frame) {
-                // Delta compression with previous frame
-                result = decompress_frame_delta(&compressed_frame, previous_frame, &decoded_frame);
-                if (result != GVC_SUCCESS) {
-                    fprintf(stderr, "Failed to decompress delta frame %s (error %d, type=%d, size=%zu)\n", 
-                           commit_hash, result, compressed_frame.header.compression_type, compressed_frame.data_size);
-                }
-            } else {
-                // First frame with delta compression type - treat as raw
-                result = decompress_frame_raw(&compressed_frame, &decoded_frame);
-                if (result != GVC_SUCCESS) {
-                    fprintf(stderr, "Failed to decompress first delta frame as raw %s (error %d, type=%d, size=%zu)\n", 
-                           commit_hash, result, compressed_frame.header.compression_type, compressed_frame.data_size);
-                }
-            }
-        } else {
-            // Raw compression (type 0)
-            result = decompress_frame_raw(&compressed_frame, &decoded_frame);
-            if (result != GVC_SUCCESS) {
-                fprintf(stderr, "Failed to decompress raw frame %s (error %d, type=%d, size=%zu)\n", 
-                       commit_hash, result, compressed_frame.header.compression_type, compressed_frame.data_size);
-            }
-        }
-        
-        free_frame(&compressed_frame);
-        
-        if (result != GVC_SUCCESS) {
-            return;
-        }
-        
-        uint64_t decode_end = get_time_ns();
-        decode_time_total += (decode_end - decode_start);
-        
-        // Put frame in ring buffer
-        while (!ring_put_frame(&decoded_frame) && !should_exit) {
-            usleep(100); // Brief wait if buffer full
-        }
-        
-        // Signal frame available
-        dispatch_semaphore_signal(frame_semaphore);
-    });
+// Hand a decoded frame to the display; the ring keeps its own copy
+static void ring_put_decoded(const raw_frame_t* frame) {
+    uint64_t span_start = trace_begin();
+    while (!ring_put_frame(frame) && !should_exit) {
+        usleep(100); // Brief wait if buffer full
+    }
+    trace_end("wait ring_not_full", span_start);
+    dispatch_semaphore_signal(frame_semaphore);
 }
 
 // High-performance display loop
 static void display_loop(void) {
     dispatch_async(display_queue, ^{
+        trace_thread_name("display");
+        telemetry_bind_thread();
         while (!should_exit && !display_should_close()) {
             // Wait for frame
+            trace_set_frame(frame_count);
+            uint64_t span_start = trace_begin();
             dispatch_time_t timeout = dispatch_time(DISPATCH_TIME_NOW, 16 * NSEC_PER_MSEC); // 16ms timeout
-            if (dispatch_semaphore_wait(frame_semaphore, timeout) != 0) {
+            long waited = dispatch_semaphore_wait(frame_semaphore, timeout);
+            trace_end("wait frame_semaphore", span_start);
+            if (waited != 0) {
                 continue; // Timeout, check exit condition
             }
             
@@ -205,10 +160,19 @@ static void display_loop(void) {
             
             // Display frame using Metal
             int result = display_frame(&frame);
+            telemetry_frame_done();
             if (result != GVC_SUCCESS) {
                 free(frame.pixels);
                 break;
             }
+            telemetry_count_presented();
+            
+            if (telemetry_dump_requested) {
+                telemetry_dump_requested = 0;
+                if (telemetry_dump_json(telemetry_path) != GVC_SUCCESS) {
+                    fprintf(stderr, "\nFailed to write telemetry to %s\n", telemetry_path);
+                }
+            }
             
             uint64_t display_end = get_time_ns();
             display_time_total += (display_end - display_start);
@@ -246,40 +210,28 @@ int play_from_repo_metal(const char* repo_path) {
     // Setup signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
-    
-    // Initialize libgit2
-    int result = git_init_libgit2(repo_path);
-    if (result != GVC_SUCCESS) {
-        fprintf(stderr, "Failed to initialize libgit2\n");
-        return result;
-    }
-    
-    // Get commit chain using libgit2
-    char** commit_hashes;
-    int num_commits;
-    result = git_get_commit_chain_libgit2(&commit_hashes, &num_commits);
+    signal(SIGUSR1, signal_handler);
+    
+    // The reader fetches ahead on its own threads and decodes on this one
+    gvc_reader_options_t options;
+    gvc_reader_options_init(&options);
+    options.verify = verify_policy;
+    telemetry_reader_sink(&options.telemetry);
+    gvc_reader_t* reader;
+    int result = gvc_reader_open(repo_path, &options, &reader);
     if (result != GVC_SUCCESS) {
-        fprintf(stderr, "Failed to get commit chain\n");
-        git_cleanup_libgit2();
+        fprintf(stderr, "Failed to read frames from %s\n", repo_path);
         return result;
     }
-    
-    if (num_commits == 0) {
-        fprintf(stderr, "No commits found\n");
-        git_cleanup_libgit2();
-        return GVC_ERROR_IO;
-    }
-    
-    printf("Found %d frames to play\n", num_commits);
-    
-    // Start prefetch thread
-    git_start_prefetch(commit_hashes, num_commits);
+    printf("Found %u frames to play\n", gvc_reader_frame_count(reader));
     
     // Initialize Metal display
-    result = display_init(FRAME_WIDTH, FRAME_HEIGHT);
+    gvc_frame_t format;
+    gvc_reader_format(reader, &format);
+    result = display_init(format.width, format.height);
     if (result != GVC_SUCCESS) {
         fprintf(stderr, "Failed to initialize Metal display\n");
-        git_cleanup_libgit2();
+        gvc_reader_close(reader);
         return result;
     }
     
@@ -289,10 +241,7 @@ int play_from_repo_metal(const char* repo_path) {
         frame_ring[i].frame.pixels = NULL;
     }
     
-    // Create dispatch queues
-    decode_queue = dispatch_queue_create("decode_queue", 
-                                        dispatch_queue_attr_make_with_qos_class(
-                                            DISPATCH_QUEUE_CONCURRENT, QOS_CLASS_USER_INTERACTIVE, 0));
+    // Create the display queue
     display_queue = dispatch_queue_create("display_queue", 
                                          dispatch_queue_attr_make_with_qos_class(
                                              DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0));
@@ -304,155 +253,36 @@ int play_from_repo_metal(const char* repo_path) {
     // Start display loop
     display_loop();
     
-    // Decode frames with batch optimization when possible
-    raw_frame_t previous_frame = {0};
-    int has_previous = 0;
-    
-    for (int i = 0; i < num_commits && !should_exit; i++) {
+    // Decode in presentation order, into one buffer the ring copies from
+    trace_thread_name("decoder");
+    gvc_frame_t frame = format;
+    frame.pixels = NULL;
+    frame.capacity = 0;
+    int decode_result = GVC_SUCCESS;  // The first failure; playback goes on past it
+    while (!should_exit) {
         uint64_t decode_start = get_time_ns();
-        
-        // Try batch decompression for two consecutive raw frames
-        if (i + 1 < num_commits && !should_exit) {
-            // Read both frames
-            uint8_t* compressed_data1;
-            size_t compressed_size1;
-            uint8_t* compressed_data2;
-            size_t compressed_size2;
-            
-            int result1 = git_read_blob_libgit2(commit_hashes[i], &compressed_data1, &compressed_size1);
-            int result2 = git_read_blob_libgit2(commit_hashes[i + 1], &compressed_data2, &compressed_size2);
-            
-            if (result1 == GVC_SUCCESS && result2 == GVC_SUCCESS) {
-                // Deserialize both frames
-                frame_t compressed_frame1, compressed_frame2;
-                int deser1 = deserialize_frame(compressed_data1, compressed_size1, &compressed_frame1);
-                int deser2 = deserialize_frame(compressed_data2, compressed_size2, &compressed_frame2);
-                
-                free(compressed_data1);
-                free(compressed_data2);
-                
-                // Check if both are raw frames (type 0) for batch processing
-                if (deser1 == GVC_SUCCESS && deser2 == GVC_SUCCESS &&
-                    compressed_frame1.header.compression_type == 0 &&
-                    compressed_frame2.header.compression_type == 0) {
-                    
-                    // Use batch decompression
-                    raw_frame_t decoded_frame1, decoded_frame2;
-                    int batch_result = decompress_frames_batch(&compressed_frame1, &compressed_frame2,
-                                                             NULL, &decoded_frame1, &decoded_frame2);
-                    
-                    free_frame(&compressed_frame1);
-                    free_frame(&compressed_frame2);
-                    
-                    if (batch_result == GVC_SUCCESS) {
-                        uint64_t decode_end = get_time_ns();
-                        decode_time_total += (decode_end - decode_start);
-                        
-                        // Put both frames in ring buffer
-                        while (!ring_put_frame(&decoded_frame1) && !should_exit) {
-                            usleep(100);
-                        }
-                        dispatch_semaphore_signal(frame_semaphore);
-                        
-                        while (!ring_put_frame(&decoded_frame2) && !should_exit) {
-                            usleep(100);
-                        }
-                        dispatch_semaphore_signal(frame_semaphore);
-                        
-                        // Update previous frame
-                        if (has_previous) {
-                            free(previous_frame.pixels);
-                        }
-                        copy_raw_frame(&decoded_frame2, &previous_frame);
-                        has_previous = 1;
-                        
-                        // Skip next iteration since we processed two frames
-                        i++;
-                        usleep(1000);
-                        continue;
-                    } else {
-                        // Batch failed, fall back to individual processing
-                        free(decoded_frame1.pixels);
-                        free(decoded_frame2.pixels);
-                    }
-                } else {
-                    // Not suitable for batch, clean up and fall back
-                    if (deser1 == GVC_SUCCESS) free_frame(&compressed_frame1);
-                    if (deser2 == GVC_SUCCESS) free_frame(&compressed_frame2);
-                }
-            } else {
-                // Failed to read one or both frames, clean up
-                if (result1 == GVC_SUCCESS) free(compressed_data1);
-                if (result2 == GVC_SUCCESS) free(compressed_data2);
-            }
-        }
-        
-        // Single frame processing (fallback or delta frames)
-        uint8_t* compressed_data;
-        size_t compressed_size;
-        int result = git_read_blob_libgit2(commit_hashes[i], &compressed_data, &compressed_size);
-        
-        if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Failed to read blob %s\n", commit_hashes[i]);
-            continue;
-        }
-        
-        // Deserialize frame
-        frame_t compressed_frame;
-        result = deserialize_frame(compressed_data, compressed_size, &compressed_frame);
-        free(compressed_data);
-        
+        result = gvc_reader_next_grow(reader, &frame);
+        if (result == GVC_READER_END) break;
         if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Failed to deserialize frame %s (error %d)\n", commit_hashes[i], result);
-            continue;
-        }
-        
-        // Decompress frame
-        raw_frame_t decoded_frame;
-        if (compressed_frame.header.compression_type == 1) {
-            if (has_previous) {
-                // Delta compression with previous frame
-                result = decompress_frame_delta(&compressed_frame, &previous_frame, &decoded_frame);
-            } else {
-                // First frame with delta compression - treat as raw
-                result = decompress_frame_raw(&compressed_frame, &decoded_frame);
+            fprintf(stderr, "Failed to decode a frame (error %d)\n", result);
+            if (decode_result == GVC_SUCCESS) {
+                decode_result = result;
             }
-        } else {
-            // Raw compression (type 0)
-            result = decompress_frame_raw(&compressed_frame, &decoded_frame);
-        }
-        
-        free_frame(&compressed_frame);
-        
-        if (result != GVC_SUCCESS) {
-            fprintf(stderr, "Failed to decompress frame %s (error %d)\n", commit_hashes[i], result);
             continue;
         }
         
         uint64_t decode_end = get_time_ns();
         decode_time_total += (decode_end - decode_start);
-        
-        // Put frame in ring buffer
-        while (!ring_put_frame(&decoded_frame) && !should_exit) {
-            usleep(100); // Brief wait if buffer full
-        }
-        
-        // Signal frame available
-        dispatch_semaphore_signal(frame_semaphore);
-        
-        // Update previous frame for next iteration
-        if (has_previous) {
-            free(previous_frame.pixels);
-        }
-        copy_raw_frame(&decoded_frame, &previous_frame);
-         has_previous = 1;
-        
-        // Throttle decode rate to prevent overwhelming the system
-        usleep(1000); // 1ms delay
+        trace_set_frame(frame.frame_number);
+        raw_frame_t decoded_frame;
+        gvc_frame_view(&frame, &decoded_frame);
+        ring_put_decoded(&decoded_frame);
     }
+    free(frame.pixels);
+    gvc_reader_close(reader);
     
     // Wait for display to finish
-    while (!should_exit && frame_count < num_commits) {
+    while (!should_exit && atomic_load(&frame_count_atomic) > 0) {
         usleep(10000); // 10ms
     }
     
@@ -470,18 +300,7 @@ int play_from_repo_metal(const char* repo_path) {
         }
     }
     
-    // Clean up commit hashes
-    for (int i = 0; i < num_commits; i++) {
-        free(commit_hashes[i]);
-    }
-    free(commit_hashes);
-    
-    if (has_previous) {
-        free(previous_frame.pixels);
-    }
-    
     display_cleanup();
-    git_cleanup_libgit2();
     
     // Final statistics
     struct timeval end_time;
@@ -502,19 +321,55 @@ int play_from_repo_metal(const char* repo_path) {
         printf("Average display time: %.2f ms\n", avg_display_ms);
     }
     
-    return GVC_SUCCESS;
+    telemetry_print_summary(stdout);
+    if (telemetry_path && telemetry_dump_json(telemetry_path) != GVC_SUCCESS) {
+        fprintf(stderr, "Failed to write telemetry to %s\n", telemetry_path);
+    }
+    if (trace_path && trace_stop() != GVC_SUCCESS) {
+        fprintf(stderr, "Failed to write trace to %s\n", trace_path);
+    }
+    
+    return decode_result;
 }
 
 // Main function for Metal player
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <git_repository_path>\n", argv[0]);
+    int opt;
+    while ((opt = getopt(argc, argv, "V:T:t:M:")) != -1) {
+        if (opt == 'T') {
+            telemetry_path = optarg;
+        } else if (opt == 't') {
+            trace_path = optarg;
+        } else if (opt == 'M') {
+            metrics_path = optarg;
+        } else if (opt != 'V' || parse_verify_policy(optarg, &verify_policy) != GVC_SUCCESS) {
+            optind = argc;  // Fall through to the usage message
+            break;
+        }
+    }
+    
+    if (argc - optind < 1) {
+        fprintf(stderr, "Usage: %s [-V off|sampled|keyframes|full] [-T telemetry.json] [-t trace.json] [-M metrics.sock]"
+                " <git_repository_path>\n",
+                argv[0]);
+        return 1;
+    }
+    
+    telemetry_init();
+    telemetry_set_queue_capacity(RING_BUFFER_SIZE);
+    if (trace_path && trace_start(trace_path) != GVC_SUCCESS) {
+        fprintf(stderr, "Invalid trace path: %s\n", trace_path);
+        return 1;
+    }
+    if (metrics_path && metrics_server_start(metrics_path) != GVC_SUCCESS) {
+        fprintf(stderr, "Cannot serve metrics on %s\n", metrics_path);
         return 1;
     }
     
-    const char* repo_path = argv[1];
+    const char* repo_path = argv[optind];
     
     int result = play_from_repo_metal(repo_path);
+    metrics_server_stop();
     if (result != GVC_SUCCESS) {
         fprintf(stderr, "Playback failed with error code: %d\n", result);
         return 1;
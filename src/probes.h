@@ -0,0 +1,32 @@
+#ifndef GVC_PROBES_H
+#define GVC_PROBES_H
+
+// USDT static tracepoints, provider "gitflix". Built with -DGVC_USDT (the Makefile
+// adds it when <sys/sdt.h> is installed), each probe is a single nop plus a note
+// section entry until a tracer attaches, so they stay compiled into release builds:
+//
+//   bpftrace -e 'usdt:./git-vid-play:gitflix:decompress_delta_done { @[arg1] = count(); }'
+//
+// Without GVC_USDT the probes expand to nothing. Arguments must be side-effect
+// free, as they are not evaluated in that case.
+//
+//   blob_read_start(hash)                   blob_read_done(hash, bytes, result)
+//   commit_read_start(hash)                 commit_read_done(hash, bytes, result)
+//   deserialize_start(bytes)                deserialize_done(frame, payload_bytes, result)
+//   decompress_raw_start(frame, bytes)      decompress_raw_done(frame, pixel_bytes, result)
+//   decompress_delta_start(frame, bytes)    decompress_delta_done(frame, pixel_bytes, result)
+//   display_start(width, height)            display_done(pixel_bytes, result)
+//   ring_put(depth, pixel_bytes)            ring_get(depth, pixel_bytes)
+
+#ifdef GVC_USDT
+#include <sys/sdt.h>
+#define GVC_PROBE1(name, a) DTRACE_PROBE1(gitflix, name, a)
+#define GVC_PROBE2(name, a, b) DTRACE_PROBE2(gitflix, name, a, b)
+#define GVC_PROBE3(name, a, b, c) DTRACE_PROBE3(gitflix, name, a, b, c)
+#else
+#define GVC_PROBE1(name, a) do { } while (0)
+#define GVC_PROBE2(name, a, b) do { } while (0)
+#define GVC_PROBE3(name, a, b, c) do { } while (0)
+#endif
+
+#endif // GVC_PROBES_H
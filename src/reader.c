@@ -0,0 +1,562 @@
+#include "git_vid_codec.h"
+
+// libgitflix reader: sequential decode of a repository's frames with
+// prefetching, shared by git-vid-play, git-vid-play-metal and other programs
+// (see gitflix.h).
+//
+// Fetch threads claim the commits after the decoder's position, up to a window
+// of `prefetch` commits ahead. Each one reads its frame blob through its own
+// `git cat-file --batch`, verifies and deserializes it, and decodes intra frames
+// outright since they need no reference. Commit i waits in slots[i % window]
+// until the decoder takes it, in commit order, on the caller's thread, where the
+// reference cache and reorder buffer live. All state is in the reader; stage
+// timings and counts go only to the sink the caller passed in its options.
+
+typedef enum {
+    SLOT_EMPTY,
+    SLOT_FETCHING,
+    SLOT_READY
+} reader_slot_state_t;
+
+// What the reader knows of each commit, from fetches and seek probes
+typedef enum {
+    KEYFRAME_UNKNOWN,
+    KEYFRAME_YES,
+    KEYFRAME_NO
+} reader_keyframe_t;
+
+typedef struct {
+    reader_slot_state_t state;
+    uint32_t index;       // Commit the slot holds
+    int result;           // Read or deserialize result; compressed is valid on success
+    frame_t compressed;
+    raw_frame_t decoded;  // Intra frames, decoded by the fetch thread; pixels NULL otherwise
+} reader_slot_t;
+
+typedef struct {
+    gvc_reader_t* reader;
+    git_batch_reader_t git;
+    pthread_t thread;
+    int started;
+} reader_worker_t;
+
+struct gvc_reader {
+    char** commits;
+    uint32_t num_commits;
+    verify_policy_t verify;
+    gvc_reader_telemetry_t telemetry;
+    stage_sink_t sink;       // Routes the decoder's stage timings to telemetry
+    int has_sink;            // The caller wants stage timings or reference counts
+    frame_header_t first_header;
+    git_batch_reader_t control;  // The caller's: first header and seek probes
+    int marked;                  // Keyframes are marked; older repositories seek from 0
+    
+    // Prefetch window, under mutex
+    reader_slot_t* slots;
+    uint32_t window;
+    uint32_t fetch_next;   // Next commit for a fetch thread to claim
+    uint32_t decode_next;  // Next commit for the decoder to take
+    int fetching;          // Claimed slots not yet filled
+    int paused;            // A seek is emptying the window
+    int stopping;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;   // Fetch threads: a slot freed, a seek ended, or stopping
+    pthread_cond_t slot_filled;  // Decoder and seek: a fetch finished
+    reader_worker_t* workers;
+    int num_workers;
+    uint8_t* keyframes;    // reader_keyframe_t per commit
+    
+    // Decoder, on the caller's thread only
+    reference_cache_t references;
+    reorder_buffer_t reorder;
+    uint32_t skip_before;  // Frames before a seek target are decoded for reference, not returned
+    int drop_bidir;
+    uint32_t dropped;
+    raw_frame_t pending;   // A frame that did not fit the caller's buffer
+    uint32_t pending_number;
+};
+
+void gvc_reader_options_init(gvc_reader_options_t* options) {
+    if (!options) return;
+    options->num_threads = 0;
+    options->prefetch = GVC_READER_DEFAULT_PREFETCH;
+    options->verify = GVC_VERIFY_FULL;
+    memset(&options->telemetry, 0, sizeof(options->telemetry));
+}
+
+// TELEMETRY_FETCH..TELEMETRY_DELTA_APPLY are GVC_STAGE_FETCH..GVC_STAGE_DELTA_APPLY
+static void sink_stage(void* ctx, telemetry_stage_t stage, uint64_t start_ns, uint64_t end_ns) {
+    gvc_reader_t* reader = (gvc_reader_t*)ctx;
+    if (reader->telemetry.stage && stage <= TELEMETRY_DELTA_APPLY) {
+        reader->telemetry.stage(reader->telemetry.ctx, (int)stage, start_ns, end_ns);
+    }
+}
+
+static void sink_cache(void* ctx, telemetry_cache_t cache, int hit) {
+    gvc_reader_t* reader = (gvc_reader_t*)ctx;
+    if (reader->telemetry.reference && cache == TELEMETRY_CACHE_REFERENCE) {
+        reader->telemetry.reference(reader->telemetry.ctx, hit);
+    }
+}
+
+// Route the calling thread's stage timings to this reader's sink, or nowhere
+static const stage_sink_t* bind_sink(gvc_reader_t* reader) {
+    return stage_sink_bind(reader->has_sink ? &reader->sink : NULL);
+}
+
+static void report_frame_start(const gvc_reader_t* reader, uint32_t index) {
+    if (reader->telemetry.frame_start) {
+        reader->telemetry.frame_start(reader->telemetry.ctx, index);
+    }
+}
+
+static void report_frame_done(const gvc_reader_t* reader) {
+    if (reader->telemetry.frame_done) {
+        reader->telemetry.frame_done(reader->telemetry.ctx);
+    }
+}
+
+// A keyframe's commit holds its own frame number and nothing after it reaches
+// past it, so decoding can restart there
+static reader_keyframe_t classify_keyframe(uint32_t index, const frame_header_t* header) {
+    return repo_frame_is_gop_start(header) && header->frame_number == index ? KEYFRAME_YES : KEYFRAME_NO;
+}
+
+static void format_object_name(const gvc_reader_t* reader, uint32_t index, char* name, size_t size) {
+    snprintf(name, size, "%s:frame.bin", reader->commits[index]);
+}
+
+// Fill a claimed slot: fetch, verify, deserialize and, for intra frames, decode
+static void fetch_slot(gvc_reader_t* reader, git_batch_reader_t* git, reader_slot_t* slot) {
+    char object_name[GIT_HASH_SIZE + 16];
+    format_object_name(reader, slot->index, object_name, sizeof(object_name));
+    memset(&slot->decoded, 0, sizeof(slot->decoded));
+    report_frame_start(reader, slot->index);
+    
+    uint8_t* blob;
+    size_t blob_size;
+    uint64_t start = telemetry_stage_begin();
+    slot->result = git_batch_read(git, object_name, &blob, &blob_size);
+    telemetry_stage_end(TELEMETRY_FETCH, start);
+    if (slot->result == GVC_SUCCESS) {
+        start = telemetry_stage_begin();
+        slot->result = deserialize_frame_verified(blob, blob_size, reader->verify, &slot->compressed);
+        telemetry_stage_end(TELEMETRY_DESERIALIZE, start);
+        free(blob);
+    }
+    
+    // A failure is left for the decoder to repeat and report
+    if (slot->result == GVC_SUCCESS && slot->compressed.header.compression_type == COMPRESSION_TYPE_RAW &&
+        decompress_frame(&slot->compressed, NULL, &slot->decoded) != GVC_SUCCESS) {
+        memset(&slot->decoded, 0, sizeof(slot->decoded));
+    }
+    report_frame_done(reader);
+}
+
+static void* reader_worker(void* arg) {
+    reader_worker_t* worker = (reader_worker_t*)arg;
+    gvc_reader_t* reader = worker->reader;
+    bind_sink(reader);
+    if (reader->telemetry.thread_start) {
+        reader->telemetry.thread_start(reader->telemetry.ctx, "prefetch");
+    }
+    
+    pthread_mutex_lock(&reader->mutex);
+    for (;;) {
+        while (!reader->stopping &&
+               (reader->paused || reader->fetch_next >= reader->num_commits ||
+                reader->fetch_next - reader->decode_next >= reader->window)) {
+            pthread_cond_wait(&reader->work_ready, &reader->mutex);
+        }
+        if (reader->stopping) break;
+    
+        reader_slot_t* slot = &reader->slots[reader->fetch_next % reader->window];
+        slot->index = reader->fetch_next++;
+        slot->state = SLOT_FETCHING;
+        reader->fetching++;
+        pthread_mutex_unlock(&reader->mutex);
+    
+        fetch_slot(reader, &worker->git, slot);
+    
+        pthread_mutex_lock(&reader->mutex);
+        if (slot->result == GVC_SUCCESS) {
+            reader->keyframes[slot->index] = (uint8_t)classify_keyframe(slot->index, &slot->compressed.header);
+        }
+        slot->state = SLOT_READY;
+        reader->fetching--;
+        pthread_cond_broadcast(&reader->slot_filled);
+    }
+    pthread_mutex_unlock(&reader->mutex);
+    return NULL;
+}
+
+static void free_slot(reader_slot_t* slot) {
+    if (slot->state == SLOT_READY) {
+        if (slot->result == GVC_SUCCESS) {
+            free_frame(&slot->compressed);
+        }
+        free_raw_frame(&slot->decoded);
+    }
+    slot->state = SLOT_EMPTY;
+}
+
+// Wait for the decoder's next commit and take its frame out of the window
+static int take_frame(gvc_reader_t* reader, frame_t* compressed_out, raw_frame_t* decoded_out) {
+    pthread_mutex_lock(&reader->mutex);
+    reader_slot_t* slot = &reader->slots[reader->decode_next % reader->window];
+    uint64_t wait_start = reader->telemetry.stage ? stage_sink_now_ns() : 0;
+    while (slot->state != SLOT_READY || slot->index != reader->decode_next) {
+        pthread_cond_wait(&reader->slot_filled, &reader->mutex);
+    }
+    if (wait_start) {
+        reader->telemetry.stage(reader->telemetry.ctx, GVC_STAGE_WAIT, wait_start, stage_sink_now_ns());
+    }
+    
+    int result = slot->result;
+    *compressed_out = slot->compressed;
+    *decoded_out = slot->decoded;
+    slot->state = SLOT_EMPTY;
+    reader->decode_next++;
+    pthread_cond_signal(&reader->work_ready);
+    pthread_mutex_unlock(&reader->mutex);
+    return result;
+}
+
+// Decode the decoder's next commit into the reorder buffer
+static int decode_next_commit(gvc_reader_t* reader) {
+    frame_t compressed;
+    raw_frame_t decoded;
+    report_frame_start(reader, reader->decode_next);
+    int result = take_frame(reader, &compressed, &decoded);
+    if (result != GVC_SUCCESS) {
+        reorder_buffer_lose(&reader->reorder);
+        report_frame_done(reader);
+        return result;
+    }
+    uint32_t frame_number = compressed.header.frame_number;
+    
+    // Nothing predicts from B frames: skip them to catch up, or before a seek target
+    if (compressed.header.compression_type == COMPRESSION_TYPE_BIDIR &&
+        (reader->drop_bidir || frame_number < reader->skip_before)) {
+        reorder_buffer_skip(&reader->reorder, frame_number);
+        free_frame(&compressed);
+        if (reader->drop_bidir && frame_number >= reader->skip_before) {
+            reader->dropped++;
+            if (reader->telemetry.dropped) {
+                reader->telemetry.dropped(reader->telemetry.ctx, 1);
+            }
+        }
+        report_frame_done(reader);
+        return GVC_SUCCESS;
+    }
+    
+    if (!decoded.pixels) {
+        result = decode_frame(&reader->references, &compressed, &decoded);
+    }
+    if (result == GVC_SUCCESS) {
+        result = reference_cache_add(&reader->references, &compressed.header, &decoded);
+        if (result == GVC_SUCCESS) {
+            result = reorder_buffer_push(&reader->reorder, frame_number, &decoded);
+        }
+        if (result != GVC_SUCCESS) {
+            free_raw_frame(&decoded);
+        }
+    } else {
+        reorder_buffer_skip(&reader->reorder, frame_number);
+    }
+    
+    free_frame(&compressed);
+    report_frame_done(reader);
+    return result;
+}
+
+static int next_frame(gvc_reader_t* reader, raw_frame_t* frame_out, uint32_t* frame_number_out) {
+    for (;;) {
+        uint32_t frame_number;
+        int has_frame = reader->decode_next < reader->num_commits
+                        ? reorder_buffer_pop(&reader->reorder, frame_out, &frame_number)
+                        : reorder_buffer_flush(&reader->reorder, frame_out, &frame_number);
+        if (has_frame) {
+            if (frame_number >= reader->skip_before) {
+                if (frame_number_out) *frame_number_out = frame_number;
+                return GVC_SUCCESS;
+            }
+            free_raw_frame(frame_out);
+            continue;
+        }
+        if (reader->decode_next >= reader->num_commits) {
+            return GVC_READER_END;
+        }
+    
+        int result = decode_next_commit(reader);
+        if (result != GVC_SUCCESS) return result;
+    }
+}
+
+static void describe_frame(const raw_frame_t* frame, uint32_t frame_number, gvc_frame_t* out) {
+    out->size = raw_frame_size(frame);
+    out->frame_number = frame_number;
+    out->width = frame->width;
+    out->height = frame->height;
+    out->channels = frame->channels;
+    out->pixel_format = frame->pixel_format;
+}
+
+int gvc_reader_next(gvc_reader_t* reader, gvc_frame_t* frame) {
+    if (!reader || !frame) return GVC_ERROR_MEMORY;
+    
+    if (!reader->pending.pixels) {
+        const stage_sink_t* previous = bind_sink(reader);
+        int result = next_frame(reader, &reader->pending, &reader->pending_number);
+        stage_sink_bind(previous);
+        if (result != GVC_SUCCESS) return result;
+    }
+    describe_frame(&reader->pending, reader->pending_number, frame);
+    if (!frame->pixels || frame->capacity < frame->size) {
+        return GVC_ERROR_MEMORY;  // Kept for a call with a larger buffer
+    }
+    memcpy(frame->pixels, reader->pending.pixels, frame->size);
+    free_raw_frame(&reader->pending);
+    return GVC_SUCCESS;
+}
+
+int gvc_reader_next_grow(gvc_reader_t* reader, gvc_frame_t* frame) {
+    int result = gvc_reader_next(reader, frame);
+    if (result != GVC_ERROR_MEMORY || !reader || !frame || (frame->pixels && frame->capacity >= frame->size)) {
+        return result;
+    }
+    
+    uint8_t* pixels = realloc(frame->pixels, frame->size);
+    if (!pixels) return GVC_ERROR_MEMORY;
+    frame->pixels = pixels;
+    frame->capacity = frame->size;
+    return gvc_reader_next(reader, frame);
+}
+
+void gvc_frame_view(const gvc_frame_t* frame, raw_frame_t* view_out) {
+    view_out->pixels = frame->pixels;
+    view_out->width = frame->width;
+    view_out->height = frame->height;
+    view_out->channels = frame->channels;
+    view_out->pixel_format = frame->pixel_format;
+}
+
+// Only the header is kept; the payload is read past
+static int read_header(gvc_reader_t* reader, uint32_t index, frame_header_t* header_out) {
+    char object_name[GIT_HASH_SIZE + 16];
+    format_object_name(reader, index, object_name, sizeof(object_name));
+    
+    uint8_t prefix[sizeof(uint32_t) + sizeof(frame_header_t)];
+    size_t prefix_size;
+    int result = git_batch_read_prefix(&reader->control, object_name, prefix, sizeof(prefix), &prefix_size);
+    if (result != GVC_SUCCESS) return result;
+    return read_frame_header(prefix, prefix_size, header_out);
+}
+
+// Whether commit index is a keyframe, probing its header the first time it is asked
+static reader_keyframe_t probe_keyframe(gvc_reader_t* reader, uint32_t index) {
+    pthread_mutex_lock(&reader->mutex);
+    reader_keyframe_t known = (reader_keyframe_t)reader->keyframes[index];
+    pthread_mutex_unlock(&reader->mutex);
+    if (known != KEYFRAME_UNKNOWN) return known;
+    
+    frame_header_t header;
+    if (read_header(reader, index, &header) != GVC_SUCCESS) {
+        return KEYFRAME_NO;  // Asked again next time
+    }
+    known = classify_keyframe(index, &header);
+    pthread_mutex_lock(&reader->mutex);
+    reader->keyframes[index] = (uint8_t)known;
+    pthread_mutex_unlock(&reader->mutex);
+    return known;
+}
+
+int gvc_reader_seek(gvc_reader_t* reader, uint32_t frame_number) {
+    if (!reader) return GVC_ERROR_MEMORY;
+    if (frame_number >= reader->num_commits) return GVC_ERROR_FORMAT;
+    
+    // Decoding restarts at the nearest keyframe at or before the target. Commits
+    // already fetched are known; the rest cost a header read each. Repositories
+    // written before keyframes were marked restart from the beginning.
+    uint32_t start = reader->marked ? frame_number : 0;
+    while (start > 0 && probe_keyframe(reader, start) != KEYFRAME_YES) {
+        start--;
+    }
+    
+    // Let fetches in flight land, then empty the window and refill it from start
+    pthread_mutex_lock(&reader->mutex);
+    reader->paused = 1;
+    while (reader->fetching > 0) {
+        pthread_cond_wait(&reader->slot_filled, &reader->mutex);
+    }
+    for (uint32_t i = 0; i < reader->window; i++) {
+        free_slot(&reader->slots[i]);
+    }
+    reader->fetch_next = start;
+    reader->decode_next = start;
+    reader->paused = 0;
+    pthread_cond_broadcast(&reader->work_ready);
+    pthread_mutex_unlock(&reader->mutex);
+    
+    reference_cache_free(&reader->references);
+    reference_cache_init(&reader->references);
+    reorder_buffer_free(&reader->reorder);
+    reorder_buffer_init(&reader->reorder, start);
+    free_raw_frame(&reader->pending);
+    reader->skip_before = frame_number;
+    return GVC_SUCCESS;
+}
+
+uint32_t gvc_reader_frame_count(const gvc_reader_t* reader) {
+    return reader ? reader->num_commits : 0;
+}
+
+void gvc_reader_format(const gvc_reader_t* reader, gvc_frame_t* format_out) {
+    if (!reader || !format_out) return;
+    raw_frame_t shape = {
+        .pixels = NULL,
+        .width = reader->first_header.width,
+        .height = reader->first_header.height,
+        .channels = reader->first_header.channels,
+        .pixel_format = reader->first_header.pixel_format
+    };
+    describe_frame(&shape, 0, format_out);
+}
+
+void gvc_reader_set_drop_bidir(gvc_reader_t* reader, int drop) {
+    if (reader) reader->drop_bidir = drop;
+}
+
+uint32_t gvc_reader_dropped_frames(const gvc_reader_t* reader) {
+    return reader ? reader->dropped : 0;
+}
+
+void gvc_reader_close(gvc_reader_t* reader) {
+    if (!reader) return;
+    
+    pthread_mutex_lock(&reader->mutex);
+    reader->stopping = 1;
+    pthread_cond_broadcast(&reader->work_ready);
+    pthread_mutex_unlock(&reader->mutex);
+    for (int i = 0; i < reader->num_workers; i++) {
+        if (reader->workers[i].started) {
+            pthread_join(reader->workers[i].thread, NULL);
+        }
+        git_batch_close(&reader->workers[i].git);
+    }
+    git_batch_close(&reader->control);
+    
+    for (uint32_t i = 0; reader->slots && i < reader->window; i++) {
+        free_slot(&reader->slots[i]);
+    }
+    reference_cache_free(&reader->references);
+    reorder_buffer_free(&reader->reorder);
+    free_raw_frame(&reader->pending);
+    pthread_mutex_destroy(&reader->mutex);
+    pthread_cond_destroy(&reader->work_ready);
+    pthread_cond_destroy(&reader->slot_filled);
+    git_free_commit_list(reader->commits, (int)reader->num_commits);
+    free(reader->workers);
+    free(reader->slots);
+    free(reader->keyframes);
+    free(reader);
+}
+
+// Takes ownership of commits, freeing them on failure
+static int open_reader(const char* repo_path, char** commits, uint32_t num_commits,
+                       const gvc_reader_options_t* options, gvc_reader_t** reader_out) {
+    gvc_reader_options_t defaults;
+    if (!options) {
+        gvc_reader_options_init(&defaults);
+        options = &defaults;
+    }
+    if (options->verify < GVC_VERIFY_OFF || options->verify > GVC_VERIFY_FULL || num_commits == 0) {
+        git_free_commit_list(commits, (int)num_commits);
+        return num_commits == 0 ? GVC_ERROR_GIT : GVC_ERROR_FORMAT;
+    }
+    
+    gvc_reader_t* reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        git_free_commit_list(commits, (int)num_commits);
+        return GVC_ERROR_MEMORY;
+    }
+    reader->commits = commits;
+    reader->num_commits = num_commits;
+    reader->verify = (verify_policy_t)options->verify;
+    reader->telemetry = options->telemetry;
+    reader->sink.ctx = reader;
+    reader->sink.stage = sink_stage;
+    reader->sink.cache = sink_cache;
+    reader->has_sink = options->telemetry.stage || options->telemetry.reference;
+    reader->num_workers = repo_walk_threads(options->num_threads, (int)MIN(num_commits, (uint32_t)INT32_MAX));
+    reader->window = (uint32_t)MAX(options->prefetch, reader->num_workers);
+    reader->slots = calloc(reader->window, sizeof(reader_slot_t));
+    reader->workers = calloc(reader->num_workers, sizeof(reader_worker_t));
+    reader->keyframes = calloc(num_commits, sizeof(uint8_t));
+    pthread_mutex_init(&reader->mutex, NULL);
+    pthread_cond_init(&reader->work_ready, NULL);
+    pthread_cond_init(&reader->slot_filled, NULL);
+    reference_cache_init(&reader->references);
+    reorder_buffer_init(&reader->reorder, 0);
+    if (!reader->slots || !reader->workers || !reader->keyframes) {
+        reader->num_workers = 0;
+        gvc_reader_close(reader);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    // Every git process starts before any thread (see git_batch_open)
+    int result = git_batch_open_repo(&reader->control, repo_path);
+    for (int i = 0; i < reader->num_workers && result == GVC_SUCCESS; i++) {
+        reader->workers[i].reader = reader;
+        result = git_batch_open_repo(&reader->workers[i].git, repo_path);
+    }
+    if (result == GVC_SUCCESS) {
+        result = read_header(reader, 0, &reader->first_header);
+    }
+    if (result == GVC_SUCCESS) {
+        reader->keyframes[0] = (uint8_t)classify_keyframe(0, &reader->first_header);
+        reader->marked = reader->keyframes[0] == KEYFRAME_YES;
+    }
+    
+    int started = 0;
+    for (int i = 0; i < reader->num_workers && result == GVC_SUCCESS; i++) {
+        reader->workers[i].started =
+            pthread_create(&reader->workers[i].thread, NULL, reader_worker, &reader->workers[i]) == 0;
+        started += reader->workers[i].started;
+    }
+    if (result == GVC_SUCCESS && started == 0) {
+        result = GVC_ERROR_THREAD;
+    }
+    if (result != GVC_SUCCESS) {
+        gvc_reader_close(reader);
+        return result;
+    }
+    *reader_out = reader;
+    return GVC_SUCCESS;
+}
+
+int gvc_reader_open(const char* repo_path, const gvc_reader_options_t* options, gvc_reader_t** reader_out) {
+    if (!reader_out) return GVC_ERROR_MEMORY;
+    
+    char** commits;
+    int num_commits;
+    int result = git_list_repo_commits(repo_path, &commits, NULL, &num_commits);
+    if (result != GVC_SUCCESS) return result;
+    return open_reader(repo_path, commits, (uint32_t)num_commits, options, reader_out);
+}
+
+int gvc_reader_open_commits(const char* repo_path, const char* const* commits, uint32_t num_commits,
+                            const gvc_reader_options_t* options, gvc_reader_t** reader_out) {
+    if (!commits || !reader_out) return GVC_ERROR_MEMORY;
+    
+    char** copies = calloc(MAX(num_commits, 1), sizeof(char*));
+    if (!copies) return GVC_ERROR_MEMORY;
+    for (uint32_t i = 0; i < num_commits; i++) {
+        copies[i] = strdup(commits[i]);
+        if (!copies[i]) {
+            git_free_commit_list(copies, (int)i);
+            return GVC_ERROR_MEMORY;
+        }
+    }
+    return open_reader(repo_path, copies, num_commits, options, reader_out);
+}
@@ -0,0 +1,154 @@
+#include "git_vid_codec.h"
+
+// Decoded frames kept for prediction. Delta and repeat frames may reference
+// any of the last REFERENCE_CACHE_SIZE decoded frames, or the long-term frame:
+// the most recent raw frame that asked to be kept (the keyframe its GOP's
+// content keeps returning to). Memory stays bounded at that many frames plus one.
+// Bidirectional frames are never referenced, so they are not cached at all.
+
+void reference_cache_init(reference_cache_t* cache) {
+    if (!cache) return;
+    memset(cache, 0, sizeof(*cache));
+    cache->newest = -1;
+}
+
+// Copy a frame into a cache slot, reusing the slot's buffer when the size matches
+static int store_frame(raw_frame_t* slot, const raw_frame_t* frame) {
+    if (slot->pixels && raw_frame_size(slot) == raw_frame_size(frame)) {
+        memcpy(slot->pixels, frame->pixels, raw_frame_size(frame));
+        slot->width = frame->width;
+        slot->height = frame->height;
+        slot->channels = frame->channels;
+        slot->pixel_format = frame->pixel_format;
+        return GVC_SUCCESS;
+    }
+    
+    free_raw_frame(slot);
+    return copy_raw_frame(frame, slot);
+}
+
+// Record a decoded frame; the oldest entry is evicted once the cache is full
+int reference_cache_add(reference_cache_t* cache, const frame_header_t* header, const raw_frame_t* frame) {
+    if (!cache || !header || !frame) return GVC_ERROR_MEMORY;
+    if (header->compression_type == COMPRESSION_TYPE_BIDIR) return GVC_SUCCESS;
+    
+    int slot = (cache->newest + 1) % REFERENCE_CACHE_SIZE;
+    int result = store_frame(&cache->frames[slot], frame);
+    if (result != GVC_SUCCESS) return result;
+    
+    cache->frame_numbers[slot] = header->frame_number;
+    cache->newest = slot;
+    if (cache->count < REFERENCE_CACHE_SIZE) {
+        cache->count++;
+    }
+    
+    if ((header->compression_type == COMPRESSION_TYPE_RAW || header->compression_type == COMPRESSION_TYPE_SCREEN) &&
+        header->reference == REFERENCE_LONG_TERM) {
+        result = store_frame(&cache->long_term, frame);
+        if (result != GVC_SUCCESS) return result;
+        cache->long_term_number = header->frame_number;
+        cache->has_long_term = 1;
+    }
+    
+    return GVC_SUCCESS;
+}
+
+const raw_frame_t* reference_cache_find(const reference_cache_t* cache, uint32_t frame_number) {
+    if (!cache) return NULL;
+    
+    for (int i = 0; i < cache->count; i++) {
+        int slot = (cache->newest - i + REFERENCE_CACHE_SIZE) % REFERENCE_CACHE_SIZE;
+        if (cache->frame_numbers[slot] == frame_number) {
+            return &cache->frames[slot];
+        }
+    }
+    if (cache->has_long_term && cache->long_term_number == frame_number) {
+        return &cache->long_term;
+    }
+    return NULL;
+}
+
+// The frame a compressed frame predicts from, or NULL if it needs none or it is not cached
+const raw_frame_t* reference_cache_resolve(const reference_cache_t* cache, const frame_t* compressed) {
+    if (!cache || !compressed || cache->count == 0) return NULL;
+    
+    const frame_header_t* header = &compressed->header;
+    switch (header->compression_type) {
+        case COMPRESSION_TYPE_SCREEN:
+            // Intra screen frames predict from nothing
+            if (header->reference == REFERENCE_LONG_TERM) {
+                return NULL;
+            }
+            // fall through
+        case COMPRESSION_TYPE_DELTA:
+        case COMPRESSION_TYPE_DELTA_RANS:
+            // 0 = previous; GVCF frames only ever predicted from it and are read as 0
+            if (header->reference == 0) {
+                return &cache->frames[cache->newest];
+            }
+            if (header->reference == REFERENCE_LONG_TERM) {
+                return cache->has_long_term ? &cache->long_term : NULL;
+            }
+            return reference_cache_find(cache, header->frame_number - header->reference);
+        case COMPRESSION_TYPE_REPEAT: {
+            uint32_t reference_frame_number;
+            if (!compressed->data || compressed->data_size < sizeof(reference_frame_number)) {
+                return NULL;
+            }
+            memcpy(&reference_frame_number, compressed->data, sizeof(reference_frame_number));
+            return reference_cache_find(cache, reference_frame_number);
+        }
+        default:
+            return NULL;
+    }
+}
+
+// Whether every frame a compressed frame predicts from is cached
+int reference_cache_has_references(const reference_cache_t* cache, const frame_t* compressed) {
+    if (!cache || !compressed) return 0;
+    
+    const frame_header_t* header = &compressed->header;
+    switch (header->compression_type) {
+        case COMPRESSION_TYPE_RAW:
+            return 1;
+        case COMPRESSION_TYPE_SCREEN:
+            return header->reference == REFERENCE_LONG_TERM || reference_cache_resolve(cache, compressed) != NULL;
+        case COMPRESSION_TYPE_BIDIR: {
+            uint32_t past_frame_number, future_frame_number;
+            return bidir_frame_references(compressed, &past_frame_number, &future_frame_number) == GVC_SUCCESS &&
+                   reference_cache_find(cache, past_frame_number) != NULL &&
+                   reference_cache_find(cache, future_frame_number) != NULL;
+        }
+        default:
+            return reference_cache_resolve(cache, compressed) != NULL;
+    }
+}
+
+// Decode any frame against the cached references it needs
+int decode_frame(const reference_cache_t* cache, const frame_t* compressed, raw_frame_t* output) {
+    if (!cache || !compressed || !output) return GVC_ERROR_MEMORY;
+    
+    if (stage_sink_bound() && compressed->header.compression_type != COMPRESSION_TYPE_RAW) {
+        stage_sink_count_cache(TELEMETRY_CACHE_REFERENCE, reference_cache_has_references(cache, compressed));
+    }
+    
+    if (compressed->header.compression_type == COMPRESSION_TYPE_BIDIR) {
+        uint32_t past_frame_number, future_frame_number;
+        int result = bidir_frame_references(compressed, &past_frame_number, &future_frame_number);
+        if (result != GVC_SUCCESS) return result;
+        return decompress_frame_bidir(compressed, reference_cache_find(cache, past_frame_number),
+                                      reference_cache_find(cache, future_frame_number), output);
+    }
+    
+    return decompress_frame(compressed, reference_cache_resolve(cache, compressed), output);
+}
+
+void reference_cache_free(reference_cache_t* cache) {
+    if (!cache) return;
+    
+    for (int i = 0; i < REFERENCE_CACHE_SIZE; i++) {
+        free_raw_frame(&cache->frames[i]);
+    }
+    free_raw_frame(&cache->long_term);
+    reference_cache_init(cache);
+}
@@ -0,0 +1,116 @@
+#include "git_vid_codec.h"
+
+// Frames are stored in decode order, and a bidirectional frame is stored after
+// the frame that follows it. Players push every decoded frame here and pop them
+// back out in frame-number order. A frame that never arrives (dropped, or a
+// damaged stream) does not stall playback: frames known to be gone let the
+// frames after them out as if they had arrived, and once the buffer is full the
+// lowest held frame goes out regardless.
+
+void reorder_buffer_init(reorder_buffer_t* buffer, uint32_t first_frame_number) {
+    if (!buffer) return;
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->next_frame_number = first_frame_number;
+}
+
+// Hand a decoded frame to the buffer; its pixels are owned by the buffer from here on
+int reorder_buffer_push(reorder_buffer_t* buffer, uint32_t frame_number, raw_frame_t* frame) {
+    if (!buffer || !frame) return GVC_ERROR_MEMORY;
+    
+    for (int i = 0; i < REORDER_DEPTH; i++) {
+        if (!buffer->occupied[i]) {
+            buffer->frames[i] = *frame;
+            buffer->frame_numbers[i] = frame_number;
+            buffer->occupied[i] = 1;
+            buffer->count++;
+            memset(frame, 0, sizeof(*frame));
+            return GVC_SUCCESS;
+        }
+    }
+    
+    return GVC_ERROR_MEMORY;  // Caller must pop before pushing into a full buffer
+}
+
+static int lowest_slot(const reorder_buffer_t* buffer) {
+    int lowest = -1;
+    for (int i = 0; i < REORDER_DEPTH; i++) {
+        if (buffer->occupied[i] &&
+            (lowest < 0 || buffer->frame_numbers[i] < buffer->frame_numbers[lowest])) {
+            lowest = i;
+        }
+    }
+    return lowest;
+}
+
+static void take_slot(reorder_buffer_t* buffer, int slot, raw_frame_t* frame_out,
+                      uint32_t* frame_number_out) {
+    *frame_out = buffer->frames[slot];
+    if (frame_number_out) {
+        *frame_number_out = buffer->frame_numbers[slot];
+    }
+    // A gap before this frame is lost frames being passed
+    if (buffer->frame_numbers[slot] > buffer->next_frame_number) {
+        buffer->lost -= MIN(buffer->lost, buffer->frame_numbers[slot] - buffer->next_frame_number);
+    }
+    buffer->next_frame_number = MAX(buffer->next_frame_number, buffer->frame_numbers[slot] + 1);
+    buffer->occupied[slot] = 0;
+    buffer->count--;
+    memset(&buffer->frames[slot], 0, sizeof(buffer->frames[slot]));
+}
+
+// Take the next frame in presentation order; returns 1 if one is ready, 0 if it
+// has not been decoded yet. The caller owns (and must free) the returned frame.
+int reorder_buffer_pop(reorder_buffer_t* buffer, raw_frame_t* frame_out, uint32_t* frame_number_out) {
+    if (!buffer || !frame_out) return 0;
+    
+    int lowest = lowest_slot(buffer);
+    if (lowest < 0) return 0;
+    
+    if (buffer->frame_numbers[lowest] <= buffer->next_frame_number + buffer->lost ||
+        buffer->count == REORDER_DEPTH) {
+        take_slot(buffer, lowest, frame_out, frame_number_out);
+        return 1;
+    }
+    return 0;
+}
+
+// Drain remaining frames in order at the end of a stream; returns 0 when empty
+int reorder_buffer_flush(reorder_buffer_t* buffer, raw_frame_t* frame_out, uint32_t* frame_number_out) {
+    if (!buffer || !frame_out) return 0;
+    
+    int lowest = lowest_slot(buffer);
+    if (lowest < 0) return 0;
+    
+    take_slot(buffer, lowest, frame_out, frame_number_out);
+    return 1;
+}
+
+// A frame that was not decoded, by choice or because it failed; presentation moves past it
+void reorder_buffer_skip(reorder_buffer_t* buffer, uint32_t frame_number) {
+    if (!buffer) return;
+    if (frame_number == buffer->next_frame_number) {
+        buffer->next_frame_number++;
+    } else if (frame_number > buffer->next_frame_number) {
+        buffer->lost++;  // Passed once the frames before it are out
+    }
+}
+
+// A frame that could not even be read, so its number is unknown. Its commit
+// sits at most one frame from its presentation position, so the next gap in
+// the frames that follow is where it was.
+void reorder_buffer_lose(reorder_buffer_t* buffer) {
+    if (buffer) {
+        buffer->lost++;
+    }
+}
+
+void reorder_buffer_free(reorder_buffer_t* buffer) {
+    if (!buffer) return;
+    
+    for (int i = 0; i < REORDER_DEPTH; i++) {
+        if (buffer->occupied[i]) {
+            free_raw_frame(&buffer->frames[i]);
+        }
+    }
+    reorder_buffer_init(buffer, 0);
+}
@@ -0,0 +1,198 @@
+#include "git_vid_codec.h"
+#include <unistd.h>
+
+// Parallel decode of every frame in a repository, shared by git-vid-verify and
+// git-vid-fsck.
+//
+// Frames only reference frames of their own GOP, so GOPs decode independently.
+// The commit list is cut into one chunk per worker; a worker owns the frames from
+// the first keyframe in its chunk up to the first keyframe at or after the chunk's
+// end, so every frame is handed to the callback exactly once whichever worker
+// reaches it. Repositories written before keyframes were marked decode on one
+// worker. Ownership depends only on each blob's header, never on whether earlier
+// frames decoded, so a damaged GOP cannot make two workers report the same frames.
+
+typedef struct {
+    char** commits;
+    int num_commits;
+    int first;  // Chunk [first, end) of commits
+    int end;
+    git_batch_reader_t reader;
+    repo_frame_fn fn;
+    void* ctx;
+} repo_walk_worker_t;
+
+// Planned keyframes are marked as long-term references; no later frame reaches past one
+int repo_frame_is_gop_start(const frame_header_t* header) {
+    return header->reference == REFERENCE_LONG_TERM &&
+           (header->compression_type == COMPRESSION_TYPE_RAW ||
+            header->compression_type == COMPRESSION_TYPE_SCREEN);
+}
+
+const char* repo_frame_state_name(repo_frame_state_t state) {
+    switch (state) {
+        case REPO_FRAME_DECODED: return "decoded";
+        case REPO_FRAME_UNREADABLE: return "unreadable";
+        case REPO_FRAME_NO_REFERENCE: return "no reference";
+        case REPO_FRAME_DECODE_FAILED: return "decode failed";
+        case REPO_FRAME_SKIPPED:
+        default: return "skipped";
+    }
+}
+
+// Workers for a repository: one per CPU unless requested, never more than frames
+int repo_walk_threads(int requested, int num_commits) {
+    int num_threads = requested;
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    return MAX(1, MIN(num_threads, num_commits));
+}
+
+// Decode one owned frame against the cache and hand it to the callback.
+// Returns nonzero if later frames of the GOP can still be decoded.
+static int walk_frame(repo_walk_worker_t* worker, repo_frame_t* frame, int broken,
+                      reference_cache_t* cache) {
+    frame_t compressed;
+    raw_frame_t decoded;
+    
+    if (frame->blob) {
+        frame->deserialize_result = deserialize_frame(frame->blob, frame->blob_size, &compressed);
+        if (frame->deserialize_result == GVC_SUCCESS) {
+            frame->compressed = &compressed;
+        }
+    }
+    
+    if (!frame->compressed) {
+        frame->state = REPO_FRAME_UNREADABLE;
+    } else if (broken) {
+        frame->state = REPO_FRAME_SKIPPED;
+    } else if (!reference_cache_has_references(cache, &compressed)) {
+        frame->state = REPO_FRAME_NO_REFERENCE;
+    } else if ((frame->decode_result = decode_frame(cache, &compressed, &decoded)) != GVC_SUCCESS) {
+        frame->state = REPO_FRAME_DECODE_FAILED;
+    } else {
+        frame->state = REPO_FRAME_DECODED;
+        frame->decoded = &decoded;
+    }
+    
+    worker->fn(worker->ctx, frame);
+    
+    int intact = 1;
+    if (frame->state == REPO_FRAME_DECODED) {
+        intact = reference_cache_add(cache, &compressed.header, &decoded) == GVC_SUCCESS;
+        free_raw_frame(&decoded);
+    } else if (frame->state != REPO_FRAME_SKIPPED) {
+        // Nothing predicts from B frames, so a lost one leaves the GOP decodable
+        intact = frame->compressed && compressed.header.compression_type == COMPRESSION_TYPE_BIDIR;
+    }
+    if (frame->compressed) {
+        free_frame(&compressed);
+    }
+    return intact && !broken;
+}
+
+static void* repo_walk_worker(void* arg) {
+    repo_walk_worker_t* worker = (repo_walk_worker_t*)arg;
+    if (worker->first >= worker->end) return NULL;
+    
+    reference_cache_t cache;
+    reference_cache_init(&cache);
+    int owned = worker->first == 0;
+    int broken = 0;
+    
+    for (int i = worker->first; i < worker->num_commits; i++) {
+        char object_name[GIT_HASH_SIZE + 16];
+        snprintf(object_name, sizeof(object_name), "%s:frame.bin", worker->commits[i]);
+        
+        repo_frame_t frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.index = i;
+        frame.commit = worker->commits[i];
+        uint8_t* blob = NULL;
+        frame.read_result = git_batch_read(&worker->reader, object_name, &blob, &frame.blob_size);
+        frame.blob = blob;
+        
+        frame_header_t header;
+        int gop_start = blob && read_frame_header(blob, frame.blob_size, &header) == GVC_SUCCESS &&
+                        repo_frame_is_gop_start(&header);
+        if (i >= worker->end && (gop_start || !owned)) {
+            free(blob);
+            break;  // The next keyframe's worker owns the rest
+        }
+        if (gop_start) {
+            // Nothing after a keyframe reaches past it; start the GOP from a clean cache
+            reference_cache_free(&cache);
+            reference_cache_init(&cache);
+            owned = 1;
+            broken = 0;
+        }
+        
+        if (owned) {
+            broken = !walk_frame(worker, &frame, broken, &cache);
+        }
+        free(blob);
+    }
+    
+    reference_cache_free(&cache);
+    return NULL;
+}
+
+// Call fn for every frame, from num_threads workers (see repo_walk_threads).
+// fn runs concurrently and must be thread-safe; the frame is only valid during the call.
+int repo_walk(char** commits, int num_commits, int num_threads, repo_frame_fn fn, void* ctx) {
+    if (!commits || !fn) return GVC_ERROR_MEMORY;
+    if (num_commits <= 0) return GVC_SUCCESS;
+    num_threads = repo_walk_threads(num_threads, num_commits);
+    
+    repo_walk_worker_t* workers = calloc(num_threads, sizeof(repo_walk_worker_t));
+    pthread_t* threads = malloc(sizeof(pthread_t) * num_threads);
+    int* started = calloc(num_threads, sizeof(int));
+    if (!workers || !threads || !started) {
+        free(workers);
+        free(threads);
+        free(started);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    // Readers are opened before any thread starts (see git_batch_open)
+    int result = GVC_SUCCESS;
+    int num_open = 0;
+    int chunk_size = (num_commits + num_threads - 1) / num_threads;
+    for (; num_open < num_threads; num_open++) {
+        repo_walk_worker_t* worker = &workers[num_open];
+        worker->commits = commits;
+        worker->num_commits = num_commits;
+        worker->first = MIN(num_commits, num_open * chunk_size);
+        worker->end = MIN(num_commits, (num_open + 1) * chunk_size);
+        worker->fn = fn;
+        worker->ctx = ctx;
+        if (git_batch_open(&worker->reader) != GVC_SUCCESS) {
+            result = GVC_ERROR_GIT;
+            break;
+        }
+    }
+    
+    if (result == GVC_SUCCESS) {
+        for (int i = 0; i < num_threads; i++) {
+            started[i] = pthread_create(&threads[i], NULL, repo_walk_worker, &workers[i]) == 0;
+        }
+        // A chunk whose thread could not start is walked here instead
+        for (int i = 0; i < num_threads; i++) {
+            if (started[i]) {
+                pthread_join(threads[i], NULL);
+            } else {
+                repo_walk_worker(&workers[i]);
+            }
+        }
+    }
+    
+    for (int i = 0; i < num_open; i++) {
+        git_batch_close(&workers[i].reader);
+    }
+    free(workers);
+    free(threads);
+    free(started);
+    return result;
+}
@@ -0,0 +1,248 @@
+#include "git_vid_codec.h"
+#include <sys/time.h>
+#include <unistd.h>
+
+// git-vid-scale: build a repository of any length quickly, for scaling tests of
+// the players and tools (revwalk, prefetch, caches, memory at 10^5-10^6 frames).
+//
+// One GOP of synthetic content is encoded once, a keyframe followed by deltas
+// against the previous frame, and serialized with its pixel hashes. Frame n is
+// then clip frame n % GOP with frame_number patched into the header: payload
+// checksums cover only the payload, so nothing is recompressed, and every frame
+// still decodes to its clip frame and passes git-vid-verify. The frames stream
+// into one `git fast-import`, which packs them directly; its object table takes
+// roughly 100 bytes per frame in memory.
+
+#define SCALE_DEFAULT_FRAMES 100000
+#define SCALE_PROGRESS_INTERVAL 50000
+#define SCALE_EPOCH 1700000000  // Commit time of frame 0; later frames follow at 1 s steps
+
+typedef struct {
+    uint8_t* blob;     // Serialized frame, frame_number patched per use
+    size_t size;
+    frame_header_t header;
+} scale_clip_frame_t;
+
+static double get_time_seconds(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void free_clip(scale_clip_frame_t* clip, int count) {
+    for (int i = 0; i < count; i++) {
+        free(clip[i].blob);
+    }
+    free(clip);
+}
+
+// Encode clip frames 0..length-1: intra first, then deltas against the previous frame
+static int encode_clip(const synth_params_t* synth, const encode_profile_t* profile, int length,
+                       scale_clip_frame_t** clip_out) {
+    scale_clip_frame_t* clip = calloc(length, sizeof(*clip));
+    raw_frame_t frames[2];
+    memset(frames, 0, sizeof(frames));
+    if (!clip || synth_alloc_frame(synth, &frames[0]) != GVC_SUCCESS ||
+        synth_alloc_frame(synth, &frames[1]) != GVC_SUCCESS) {
+        free(clip);
+        free_raw_frame(&frames[0]);
+        free_raw_frame(&frames[1]);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    int result = GVC_SUCCESS;
+    for (int i = 0; i < length && result == GVC_SUCCESS; i++) {
+        raw_frame_t* current = &frames[i % 2];
+        const raw_frame_t* previous = &frames[(i + 1) % 2];
+        synth_render(synth, (uint32_t)i, current);
+    
+        frame_t compressed;
+        if (i == 0) {
+            result = compress_frame_raw(current, &profile->compression, &compressed);
+        } else if (profile->compression.entropy_delta) {
+            result = compress_frame_delta_rans(current, previous, &compressed);
+        } else {
+            result = compress_frame_delta(current, previous, &profile->compression, &compressed);
+        }
+        if (result != GVC_SUCCESS) break;
+    
+        compressed.header.frame_number = (uint32_t)i;
+        if (profile->compression.checksum != CHECKSUM_CRC32) {
+            set_frame_checksum(&compressed, profile->compression.checksum);
+        }
+        pixel_hash_t pixel_hash;
+        hash_frame_pixels(current, &pixel_hash);
+        result = serialize_frame_with_hash(&compressed, &pixel_hash, &clip[i].blob, &clip[i].size);
+        clip[i].header = compressed.header;
+        free_frame(&compressed);
+    }
+    
+    free_raw_frame(&frames[0]);
+    free_raw_frame(&frames[1]);
+    if (result != GVC_SUCCESS) {
+        free_clip(clip, length);
+        return result;
+    }
+    *clip_out = clip;
+    return GVC_SUCCESS;
+}
+
+static int write_frames(git_import_t* importer, scale_clip_frame_t* clip, int clip_length,
+                        uint32_t num_frames, int quiet) {
+    double start = get_time_seconds();
+    uint64_t bytes = 0;
+    
+    for (uint32_t n = 0; n < num_frames; n++) {
+        scale_clip_frame_t* frame = &clip[n % clip_length];
+        memcpy(frame->blob + sizeof(uint32_t) + offsetof(frame_header_t, frame_number), &n, sizeof(n));
+    
+        char message[MAX_COMMIT_MESSAGE];
+        snprintf(message, sizeof(message), "Frame %06u (%s, %u bytes)", n,
+                 compression_type_name(frame->header.compression_type), frame->header.compressed_size);
+        int result = git_import_commit(importer, frame->blob, frame->size, message, SCALE_EPOCH + (time_t)n);
+        if (result != GVC_SUCCESS) {
+            fprintf(stderr, "Error: git fast-import stopped at frame %u\n", n);
+            return result;
+        }
+        bytes += frame->size;
+    
+        if (!quiet && (n + 1) % SCALE_PROGRESS_INTERVAL == 0) {
+            double elapsed = get_time_seconds() - start;
+            printf("  %u frames, %.1f MB of frame blobs, %.0f frames/s\n", n + 1, bytes / 1e6,
+                   (n + 1) / MAX(elapsed, 1e-9));
+            fflush(stdout);
+        }
+    }
+    return GVC_SUCCESS;
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-n frames] [-g gop] [-c content] [-s WxH] [-S seed] [-e preset] [-r] [-q] <output_repo_path>\n",
+           program);
+    printf("\nWrites a GitFlix repository of any length in one git fast-import pass, for\n");
+    printf("scaling tests. One GOP of synthetic content is encoded and repeated.\n");
+    printf("\nOptions:\n");
+    printf("  -n frames    Frames to write (default: %d)\n", SCALE_DEFAULT_FRAMES);
+    printf("  -g frames    Keyframe interval, the length of the repeated clip (default: %d)\n", DEFAULT_MAX_GOP);
+    printf("  -c content   Synthetic content: static, pan, zoom, noise, text, scene_cuts, test\n");
+    printf("               or demo (default: text)\n");
+    printf("  -s WxH       Frame size (default: %dx%d)\n", FRAME_WIDTH, FRAME_HEIGHT);
+    printf("  -S seed      Content seed (default: 1)\n");
+    printf("  -e preset    Backend of the encoder preset: fast (LZ4, default), balanced (LZFSE)\n");
+    printf("               or max (LZMA)\n");
+    printf("  -r           Entropy-code delta frames with rANS\n");
+    printf("  -q           No progress output\n");
+    printf("\nExample:\n");
+    printf("  %s -n 1000000 ./scale_repo && ./git-vid-verify ./scale_repo\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    synth_params_t synth;
+    synth_params_init(&synth);
+    synth.content = SYNTH_TEXT;
+    encode_profile_t profile;
+    encode_profile_init(&profile, ENCODE_PRESET_FAST);
+    long long num_frames = SCALE_DEFAULT_FRAMES;
+    int gop = DEFAULT_MAX_GOP;
+    int entropy_delta = 0;
+    int quiet = 0;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "n:g:c:s:S:e:rq")) != -1) {
+        switch (opt) {
+            case 'n':
+                num_frames = atoll(optarg);
+                break;
+            case 'g':
+                gop = atoi(optarg);
+                break;
+            case 'c':
+                if (parse_synth_class(optarg, &synth.content) != GVC_SUCCESS) {
+                    fprintf(stderr, "Error: Unknown content '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 's':
+                if (sscanf(optarg, "%ux%u", &synth.width, &synth.height) != 2) {
+                    fprintf(stderr, "Error: Frame size must be WxH, e.g. 1920x1080\n");
+                    return 1;
+                }
+                break;
+            case 'S':
+                synth.seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'e':
+                if (parse_encode_preset(optarg, &profile) != GVC_SUCCESS) {
+                    fprintf(stderr, "Error: Unknown preset '%s' (fast, balanced or max)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'r':
+                entropy_delta = 1;
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (num_frames <= 0 || num_frames > UINT32_MAX || gop <= 0) {
+        fprintf(stderr, "Error: Frame count and keyframe interval must be positive\n");
+        return 1;
+    }
+    const char* repo_path = argv[optind];
+    profile.compression.entropy_delta = entropy_delta;
+    
+    double start = get_time_seconds();
+    scale_clip_frame_t* clip;
+    int clip_length = (int)MIN((long long)gop, num_frames);
+    int result = encode_clip(&synth, &profile, clip_length, &clip);
+    if (result != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Failed to encode the %s clip (%d)\n", synth_class_name(synth.content), result);
+        return 1;
+    }
+    size_t clip_bytes = 0;
+    for (int i = 0; i < clip_length; i++) {
+        clip_bytes += clip[i].size;
+    }
+    if (!quiet) {
+        printf("Encoded a %d-frame %s clip at %ux%u (%s): %.1f KB per frame\n", clip_length,
+               synth_class_name(synth.content), synth.width, synth.height, profile.name,
+               clip_bytes / 1024.0 / clip_length);
+    }
+    
+    if (git_init_repo(repo_path) != GVC_SUCCESS || chdir(repo_path) != 0) {
+        fprintf(stderr, "Error: Failed to initialize Git repository: %s\n", repo_path);
+        free_clip(clip, clip_length);
+        return 1;
+    }
+    
+    git_import_t importer;
+    if (git_import_open(&importer) != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Failed to start git fast-import\n");
+        free_clip(clip, clip_length);
+        return 1;
+    }
+    if (!quiet) {
+        printf("Writing %lld frames to %s (%s)\n", num_frames, repo_path, importer.ref);
+    }
+    result = write_frames(&importer, clip, clip_length, (uint32_t)num_frames, quiet);
+    if (git_import_close(&importer) != GVC_SUCCESS) {
+        result = GVC_ERROR_GIT;
+    }
+    free_clip(clip, clip_length);
+    if (result != GVC_SUCCESS) {
+        fprintf(stderr, "Error: git fast-import failed\n");
+        return 1;
+    }
+    
+    double elapsed = get_time_seconds() - start;
+    printf("Wrote %lld frames in %.1fs (%.0f frames/s)\n", num_frames, elapsed, num_frames / MAX(elapsed, 1e-9));
+    return 0;
+}
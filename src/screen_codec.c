@@ -0,0 +1,520 @@
+#include "git_vid_codec.h"
+
+// Screen-content block coding. Screen recordings are mostly flat colour, text
+// and UI chrome that repeats within a frame and from frame to frame. Byte-wise
+// deltas and generic LZ see that as long runs of slightly different bytes;
+// here each SCREEN_BLOCK_SIZE square block is instead described as one of:
+//
+//   solid     one colour
+//   palette   up to SCREEN_MAX_PALETTE colours plus packed per-pixel indices
+//   copy      an identical earlier block of the same frame (intra block copy)
+//   previous  an identical block of the reference frame, usually co-located
+//   raw       the pixels as they are (photos, video playing in a window)
+//
+// Packed frames are coded as one plane of `channels` bytes per pixel; YUV420P
+// frames as three single-byte planes. Copies are whole blocks at block-aligned
+// offsets, found through a hash of every full block, so decoding is a sequence
+// of row memcpys and fills. The block stream is compressed with the frame's
+// backend afterwards (see compress_frame_screen).
+
+#define SCREEN_BLOCK_SOLID 0
+#define SCREEN_BLOCK_PALETTE 1
+#define SCREEN_BLOCK_COPY 2
+#define SCREEN_BLOCK_PREVIOUS 3
+#define SCREEN_BLOCK_RAW 4
+
+typedef struct {
+    size_t offset;     // Start of the plane within the frame buffer
+    uint32_t width;
+    uint32_t height;
+    uint32_t bpp;      // Bytes per pixel
+    size_t stride;
+    uint32_t blocks_x;
+    uint32_t blocks_y;
+} screen_plane_t;
+
+typedef struct {
+    int32_t* slots;    // Block index per slot, -1 when empty
+    uint64_t* hashes;  // Hash of the block in each slot
+    uint32_t mask;
+} block_table_t;
+
+static int frame_planes(uint32_t width, uint32_t height, uint32_t channels, uint32_t pixel_format,
+                        screen_plane_t* planes) {
+    int count;
+    if (pixel_format == PIXEL_FORMAT_YUV420P) {
+        uint32_t chroma_width = (width + 1) / 2;
+        uint32_t chroma_height = (height + 1) / 2;
+        size_t luma_size = (size_t)width * height;
+        size_t chroma_size = (size_t)chroma_width * chroma_height;
+        
+        planes[0] = (screen_plane_t){0, width, height, 1, width, 0, 0};
+        planes[1] = (screen_plane_t){luma_size, chroma_width, chroma_height, 1, chroma_width, 0, 0};
+        planes[2] = (screen_plane_t){luma_size + chroma_size, chroma_width, chroma_height, 1,
+                                     chroma_width, 0, 0};
+        count = 3;
+    } else {
+        planes[0] = (screen_plane_t){0, width, height, channels, (size_t)width * channels, 0, 0};
+        count = 1;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        planes[i].blocks_x = (planes[i].width + SCREEN_BLOCK_SIZE - 1) / SCREEN_BLOCK_SIZE;
+        planes[i].blocks_y = (planes[i].height + SCREEN_BLOCK_SIZE - 1) / SCREEN_BLOCK_SIZE;
+    }
+    return count;
+}
+
+// Worst case stream size: every block raw, plus its mode byte. encode_plane codes
+// a block raw whenever the other modes would take more bytes than that.
+size_t screen_stream_bound(uint32_t width, uint32_t height, uint32_t channels, uint32_t pixel_format) {
+    screen_plane_t planes[3];
+    int num_planes = frame_planes(width, height, channels, pixel_format, planes);
+    size_t blocks = 0;
+    for (int i = 0; i < num_planes; i++) {
+        blocks += (size_t)planes[i].blocks_x * planes[i].blocks_y;
+    }
+    return frame_buffer_size(width, height, channels, pixel_format) + blocks;
+}
+
+static uint32_t block_width(const screen_plane_t* plane, uint32_t bx) {
+    return MIN(SCREEN_BLOCK_SIZE, plane->width - bx * SCREEN_BLOCK_SIZE);
+}
+
+static uint32_t block_height(const screen_plane_t* plane, uint32_t by) {
+    return MIN(SCREEN_BLOCK_SIZE, plane->height - by * SCREEN_BLOCK_SIZE);
+}
+
+static int is_full_block(const screen_plane_t* plane, uint32_t bx, uint32_t by) {
+    return block_width(plane, bx) == SCREEN_BLOCK_SIZE && block_height(plane, by) == SCREEN_BLOCK_SIZE;
+}
+
+static uint8_t* block_origin(uint8_t* pixels, const screen_plane_t* plane, uint32_t bx, uint32_t by) {
+    return pixels + plane->offset + (size_t)by * SCREEN_BLOCK_SIZE * plane->stride +
+           (size_t)bx * SCREEN_BLOCK_SIZE * plane->bpp;
+}
+
+static uint32_t load_pixel(const uint8_t* p, uint32_t bpp) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < bpp; i++) {
+        value |= (uint32_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+static void store_pixel(uint8_t* p, uint32_t bpp, uint32_t value) {
+    for (uint32_t i = 0; i < bpp; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+// FNV-1a over the rows of a full block
+static uint64_t hash_block(const uint8_t* origin, const screen_plane_t* plane) {
+    uint64_t hash = 1469598103934665603ULL;
+    size_t row_bytes = (size_t)SCREEN_BLOCK_SIZE * plane->bpp;
+    for (uint32_t y = 0; y < SCREEN_BLOCK_SIZE; y++) {
+        const uint8_t* row = origin + y * plane->stride;
+        for (size_t x = 0; x < row_bytes; x++) {
+            hash = (hash ^ row[x]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+static int blocks_equal(const uint8_t* a, const uint8_t* b, const screen_plane_t* plane,
+                        uint32_t width, uint32_t height) {
+    size_t row_bytes = (size_t)width * plane->bpp;
+    for (uint32_t y = 0; y < height; y++) {
+        if (memcmp(a + y * plane->stride, b + y * plane->stride, row_bytes) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int block_table_init(block_table_t* table, size_t num_blocks) {
+    uint32_t size = 16;
+    while (size < num_blocks * 2) {
+        size <<= 1;
+    }
+    table->slots = malloc(sizeof(int32_t) * size);
+    table->hashes = malloc(sizeof(uint64_t) * size);
+    if (!table->slots || !table->hashes) {
+        free(table->slots);
+        free(table->hashes);
+        return GVC_ERROR_MEMORY;
+    }
+    memset(table->slots, 0xFF, sizeof(int32_t) * size);
+    table->mask = size - 1;
+    return GVC_SUCCESS;
+}
+
+static void block_table_free(block_table_t* table) {
+    free(table->slots);
+    free(table->hashes);
+}
+
+static void block_table_insert(block_table_t* table, uint64_t hash, int32_t block_index) {
+    uint32_t slot = (uint32_t)hash & table->mask;
+    while (table->slots[slot] >= 0) {
+        if (table->hashes[slot] == hash) return;  // Keep the first block with this content
+        slot = (slot + 1) & table->mask;
+    }
+    table->slots[slot] = block_index;
+    table->hashes[slot] = hash;
+}
+
+// First full block of `pixels` with the same content as `target`, or -1
+static int32_t block_table_find(const block_table_t* table, uint64_t hash, const uint8_t* pixels,
+                                const screen_plane_t* plane, const uint8_t* target) {
+    uint32_t slot = (uint32_t)hash & table->mask;
+    while (table->slots[slot] >= 0) {
+        if (table->hashes[slot] == hash) {
+            int32_t index = table->slots[slot];
+            const uint8_t* candidate = block_origin((uint8_t*)pixels, plane, index % plane->blocks_x,
+                                                    index / plane->blocks_x);
+            if (blocks_equal(candidate, target, plane, SCREEN_BLOCK_SIZE, SCREEN_BLOCK_SIZE)) {
+                return index;
+            }
+        }
+        slot = (slot + 1) & table->mask;
+    }
+    return -1;
+}
+
+static void put_offset(uint8_t** out, int32_t dx, int32_t dy) {
+    int16_t offsets[2] = {(int16_t)dx, (int16_t)dy};
+    memcpy(*out, offsets, sizeof(offsets));
+    *out += sizeof(offsets);
+}
+
+// Distinct colours of a block, up to SCREEN_MAX_PALETTE; returns 0 when there are more
+static int build_palette(const uint8_t* origin, const screen_plane_t* plane, uint32_t width,
+                         uint32_t height, uint32_t* palette) {
+    int count = 0;
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* row = origin + y * plane->stride;
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t colour = load_pixel(row + x * plane->bpp, plane->bpp);
+            int found = 0;
+            for (int i = 0; i < count && !found; i++) {
+                found = palette[i] == colour;
+            }
+            if (!found) {
+                if (count == SCREEN_MAX_PALETTE) return 0;
+                palette[count++] = colour;
+            }
+        }
+    }
+    return count;
+}
+
+static int palette_index_bits(int count) {
+    return count <= 2 ? 1 : count <= 4 ? 2 : 4;
+}
+
+// Bytes of a palette block after its mode byte
+static size_t palette_block_size(const screen_plane_t* plane, uint32_t width, uint32_t height, int count) {
+    size_t index_bits = (size_t)width * height * palette_index_bits(count);
+    return 1 + (size_t)count * plane->bpp + (index_bits + 7) / 8;
+}
+
+static uint8_t* encode_palette_block(uint8_t* out, const uint8_t* origin, const screen_plane_t* plane,
+                                     uint32_t width, uint32_t height, const uint32_t* palette,
+                                     int count) {
+    *out++ = (uint8_t)count;
+    for (int i = 0; i < count; i++) {
+        store_pixel(out, plane->bpp, palette[i]);
+        out += plane->bpp;
+    }
+    
+    // Indices packed most significant bits first, row by row across the block
+    int bits = palette_index_bits(count);
+    uint32_t accumulator = 0;
+    int pending = 0;
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* row = origin + y * plane->stride;
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t colour = load_pixel(row + x * plane->bpp, plane->bpp);
+            int index = 0;
+            while (palette[index] != colour) {
+                index++;
+            }
+            accumulator = (accumulator << bits) | (uint32_t)index;
+            pending += bits;
+            if (pending == 8) {
+                *out++ = (uint8_t)accumulator;
+                accumulator = 0;
+                pending = 0;
+            }
+        }
+    }
+    if (pending > 0) {
+        *out++ = (uint8_t)(accumulator << (8 - pending));
+    }
+    return out;
+}
+
+static int encode_plane(const raw_frame_t* current, const raw_frame_t* reference,
+                        const screen_plane_t* plane, uint8_t** out, screen_stats_t* stats) {
+    size_t num_blocks = (size_t)plane->blocks_x * plane->blocks_y;
+    block_table_t current_table, reference_table;
+    if (block_table_init(&current_table, num_blocks) != GVC_SUCCESS) return GVC_ERROR_MEMORY;
+    if (block_table_init(&reference_table, reference ? num_blocks : 1) != GVC_SUCCESS) {
+        block_table_free(&current_table);
+        return GVC_ERROR_MEMORY;
+    }
+    
+    if (reference) {
+        for (uint32_t by = 0; by < plane->blocks_y; by++) {
+            for (uint32_t bx = 0; bx < plane->blocks_x; bx++) {
+                if (is_full_block(plane, bx, by)) {
+                    uint64_t hash = hash_block(block_origin(reference->pixels, plane, bx, by), plane);
+                    block_table_insert(&reference_table, hash, (int32_t)(by * plane->blocks_x + bx));
+                }
+            }
+        }
+    }
+    
+    uint32_t palette[SCREEN_MAX_PALETTE];
+    for (uint32_t by = 0; by < plane->blocks_y; by++) {
+        for (uint32_t bx = 0; bx < plane->blocks_x; bx++) {
+            uint32_t width = block_width(plane, bx);
+            uint32_t height = block_height(plane, by);
+            int32_t index = (int32_t)(by * plane->blocks_x + bx);
+            const uint8_t* origin = block_origin(current->pixels, plane, bx, by);
+            int full = width == SCREEN_BLOCK_SIZE && height == SCREEN_BLOCK_SIZE;
+            uint64_t hash = full ? hash_block(origin, plane) : 0;
+            int colours = build_palette(origin, plane, width, height, palette);
+            int32_t match;
+            
+            // Small edge blocks can cost more as a palette or an offset than raw,
+            // which the stream bound does not allow for
+            size_t raw_size = (size_t)width * height * plane->bpp;
+            int offset_fits = 2 * sizeof(int16_t) <= raw_size;
+            if (colours > 1 && palette_block_size(plane, width, height, colours) > raw_size) {
+                colours = 0;
+            }
+            
+            stats->blocks++;
+            if (colours == 1) {
+                *(*out)++ = SCREEN_BLOCK_SOLID;
+                store_pixel(*out, plane->bpp, palette[0]);
+                *out += plane->bpp;
+                stats->solid_blocks++;
+            } else if (reference && offset_fits &&
+                       blocks_equal(origin, block_origin(reference->pixels, plane, bx, by), plane,
+                                    width, height)) {
+                // Static content: the co-located block of the reference
+                *(*out)++ = SCREEN_BLOCK_PREVIOUS;
+                put_offset(out, 0, 0);
+                stats->previous_blocks++;
+            } else if (full && (match = block_table_find(&current_table, hash, current->pixels,
+                                                         plane, origin)) >= 0) {
+                *(*out)++ = SCREEN_BLOCK_COPY;
+                put_offset(out, match % (int32_t)plane->blocks_x - (int32_t)bx,
+                           match / (int32_t)plane->blocks_x - (int32_t)by);
+                stats->copy_blocks++;
+            } else if (full && reference &&
+                       (match = block_table_find(&reference_table, hash, reference->pixels,
+                                                 plane, origin)) >= 0) {
+                // Moved content (scrolling, dragged windows) at block granularity
+                *(*out)++ = SCREEN_BLOCK_PREVIOUS;
+                put_offset(out, match % (int32_t)plane->blocks_x - (int32_t)bx,
+                           match / (int32_t)plane->blocks_x - (int32_t)by);
+                stats->previous_blocks++;
+            } else if (colours > 0) {
+                *(*out)++ = SCREEN_BLOCK_PALETTE;
+                *out = encode_palette_block(*out, origin, plane, width, height, palette, colours);
+                stats->palette_blocks++;
+            } else {
+                *(*out)++ = SCREEN_BLOCK_RAW;
+                size_t row_bytes = (size_t)width * plane->bpp;
+                for (uint32_t y = 0; y < height; y++) {
+                    memcpy(*out, origin + y * plane->stride, row_bytes);
+                    *out += row_bytes;
+                }
+                stats->raw_blocks++;
+            }
+            
+            if (full) {
+                block_table_insert(&current_table, hash, index);
+            }
+        }
+    }
+    
+    block_table_free(&current_table);
+    block_table_free(&reference_table);
+    return GVC_SUCCESS;
+}
+
+// Describe a frame as a block stream; the reference may be NULL for intra coding
+int screen_encode_blocks(const raw_frame_t* current, const raw_frame_t* reference,
+                         uint8_t** stream_out, size_t* stream_size_out, screen_stats_t* stats_out) {
+    if (!current || !stream_out || !stream_size_out || !stats_out) return GVC_ERROR_MEMORY;
+    if (reference && (reference->width != current->width || reference->height != current->height ||
+                      reference->channels != current->channels ||
+                      reference->pixel_format != current->pixel_format)) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    memset(stats_out, 0, sizeof(*stats_out));
+    size_t bound = screen_stream_bound(current->width, current->height, current->channels,
+                                       current->pixel_format);
+    uint8_t* stream = malloc(bound);
+    if (!stream) return GVC_ERROR_MEMORY;
+    
+    screen_plane_t planes[3];
+    int num_planes = frame_planes(current->width, current->height, current->channels,
+                                  current->pixel_format, planes);
+    uint8_t* out = stream;
+    for (int i = 0; i < num_planes; i++) {
+        int result = encode_plane(current, reference, &planes[i], &out, stats_out);
+        if (result != GVC_SUCCESS) {
+            free(stream);
+            return result;
+        }
+    }
+    
+    *stream_out = stream;
+    *stream_size_out = (size_t)(out - stream);
+    return GVC_SUCCESS;
+}
+
+static int copy_block(uint8_t* dst_pixels, const uint8_t* src_pixels, const screen_plane_t* plane,
+                      uint32_t bx, uint32_t by, int32_t src_bx, int32_t src_by) {
+    if (src_bx < 0 || src_by < 0 || src_bx >= (int32_t)plane->blocks_x ||
+        src_by >= (int32_t)plane->blocks_y) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    uint32_t width = block_width(plane, bx);
+    uint32_t height = block_height(plane, by);
+    if (block_width(plane, (uint32_t)src_bx) < width || block_height(plane, (uint32_t)src_by) < height) {
+        return GVC_ERROR_FORMAT;
+    }
+    
+    uint8_t* dst = block_origin(dst_pixels, plane, bx, by);
+    const uint8_t* src = block_origin((uint8_t*)src_pixels, plane, (uint32_t)src_bx, (uint32_t)src_by);
+    size_t row_bytes = (size_t)width * plane->bpp;
+    for (uint32_t y = 0; y < height; y++) {
+        memcpy(dst + y * plane->stride, src + y * plane->stride, row_bytes);
+    }
+    return GVC_SUCCESS;
+}
+
+static int decode_plane(const uint8_t** in, const uint8_t* end, const raw_frame_t* reference,
+                        const screen_plane_t* plane, raw_frame_t* output) {
+    uint32_t bpp = plane->bpp;
+    
+    for (uint32_t by = 0; by < plane->blocks_y; by++) {
+        for (uint32_t bx = 0; bx < plane->blocks_x; bx++) {
+            uint32_t width = block_width(plane, bx);
+            uint32_t height = block_height(plane, by);
+            uint8_t* origin = block_origin(output->pixels, plane, bx, by);
+            
+            if (*in >= end) return GVC_ERROR_FORMAT;
+            uint8_t mode = *(*in)++;
+            
+            switch (mode) {
+                case SCREEN_BLOCK_SOLID: {
+                    if ((size_t)(end - *in) < bpp) return GVC_ERROR_FORMAT;
+                    if (bpp == 1) {
+                        for (uint32_t y = 0; y < height; y++) {
+                            memset(origin + y * plane->stride, **in, width);
+                        }
+                    } else {
+                        // Fill the first row, then replicate it
+                        for (uint32_t x = 0; x < width; x++) {
+                            memcpy(origin + x * bpp, *in, bpp);
+                        }
+                        for (uint32_t y = 1; y < height; y++) {
+                            memcpy(origin + y * plane->stride, origin, (size_t)width * bpp);
+                        }
+                    }
+                    *in += bpp;
+                    break;
+                }
+                case SCREEN_BLOCK_PALETTE: {
+                    if (*in >= end) return GVC_ERROR_FORMAT;
+                    int count = *(*in)++;
+                    if (count < 1 || count > SCREEN_MAX_PALETTE) return GVC_ERROR_FORMAT;
+                    
+                    int bits = palette_index_bits(count);
+                    size_t index_bytes = ((size_t)width * height * bits + 7) / 8;
+                    if ((size_t)(end - *in) < (size_t)count * bpp + index_bytes) return GVC_ERROR_FORMAT;
+                    
+                    const uint8_t* colours = *in;
+                    const uint8_t* indices = colours + (size_t)count * bpp;
+                    uint32_t mask = (1u << bits) - 1;
+                    size_t bit_pos = 0;
+                    for (uint32_t y = 0; y < height; y++) {
+                        uint8_t* row = origin + y * plane->stride;
+                        for (uint32_t x = 0; x < width; x++) {
+                            uint32_t index = (indices[bit_pos / 8] >> (8 - bits - bit_pos % 8)) & mask;
+                            bit_pos += bits;
+                            if ((int)index >= count) return GVC_ERROR_FORMAT;
+                            memcpy(row + x * bpp, colours + index * bpp, bpp);
+                        }
+                    }
+                    *in += (size_t)count * bpp + index_bytes;
+                    break;
+                }
+                case SCREEN_BLOCK_COPY:
+                case SCREEN_BLOCK_PREVIOUS: {
+                    int16_t offsets[2];
+                    if ((size_t)(end - *in) < sizeof(offsets)) return GVC_ERROR_FORMAT;
+                    memcpy(offsets, *in, sizeof(offsets));
+                    *in += sizeof(offsets);
+                    
+                    int32_t src_bx = (int32_t)bx + offsets[0];
+                    int32_t src_by = (int32_t)by + offsets[1];
+                    int result;
+                    if (mode == SCREEN_BLOCK_COPY) {
+                        // Only blocks already decoded may be copied
+                        if (src_by > (int32_t)by || (src_by == (int32_t)by && src_bx >= (int32_t)bx)) {
+                            return GVC_ERROR_FORMAT;
+                        }
+                        result = copy_block(output->pixels, output->pixels, plane, bx, by, src_bx, src_by);
+                    } else {
+                        if (!reference) return GVC_ERROR_FORMAT;
+                        result = copy_block(output->pixels, reference->pixels, plane, bx, by, src_bx, src_by);
+                    }
+                    if (result != GVC_SUCCESS) return result;
+                    break;
+                }
+                case SCREEN_BLOCK_RAW: {
+                    size_t row_bytes = (size_t)width * bpp;
+                    if ((size_t)(end - *in) < row_bytes * height) return GVC_ERROR_FORMAT;
+                    for (uint32_t y = 0; y < height; y++) {
+                        memcpy(origin + y * plane->stride, *in, row_bytes);
+                        *in += row_bytes;
+                    }
+                    break;
+                }
+                default:
+                    return GVC_ERROR_FORMAT;
+            }
+        }
+    }
+    return GVC_SUCCESS;
+}
+
+// Rebuild a frame from its block stream; output must already hold a buffer of the
+// frame's size. The reference is only needed when the stream copies from it.
+int screen_decode_blocks(const uint8_t* stream, size_t stream_size, const raw_frame_t* reference,
+                         raw_frame_t* output) {
+    if (!stream || !output || !output->pixels) return GVC_ERROR_MEMORY;
+    if (reference && raw_frame_size(reference) != raw_frame_size(output)) return GVC_ERROR_FORMAT;
+    
+    screen_plane_t planes[3];
+    int num_planes = frame_planes(output->width, output->height, output->channels,
+                                  output->pixel_format, planes);
+    const uint8_t* in = stream;
+    const uint8_t* end = stream + stream_size;
+    for (int i = 0; i < num_planes; i++) {
+        int result = decode_plane(&in, end, reference, &planes[i], output);
+        if (result != GVC_SUCCESS) return result;
+    }
+    return in == end ? GVC_SUCCESS : GVC_ERROR_FORMAT;
+}
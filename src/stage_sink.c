@@ -0,0 +1,41 @@
+#include "git_vid_codec.h"
+
+// Decode stage timing without process-wide state. Code deep in the decoder
+// brackets each stage with telemetry_stage_begin/end; the timings go to the
+// sink bound to the calling thread, and nowhere when none is. The players bind
+// telemetry.c's sink to their own threads (telemetry_bind_thread), and a
+// libgitflix reader binds its caller's sink to its fetch threads and, for the
+// duration of a call, to the thread calling it.
+
+static __thread const stage_sink_t* bound_sink = NULL;
+
+const stage_sink_t* stage_sink_bind(const stage_sink_t* sink) {
+    const stage_sink_t* previous = bound_sink;
+    bound_sink = sink;
+    return previous;
+}
+
+int stage_sink_bound(void) {
+    return bound_sink != NULL;
+}
+
+uint64_t stage_sink_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t telemetry_stage_begin(void) {
+    return bound_sink ? stage_sink_now_ns() : 0;
+}
+
+void telemetry_stage_end(telemetry_stage_t stage, uint64_t start) {
+    if (start == 0 || !bound_sink) return;
+    bound_sink->stage(bound_sink->ctx, stage, start, stage_sink_now_ns());
+}
+
+void stage_sink_count_cache(telemetry_cache_t cache, int hit) {
+    if (bound_sink && bound_sink->cache) {
+        bound_sink->cache(bound_sink->ctx, cache, hit);
+    }
+}
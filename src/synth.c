@@ -0,0 +1,563 @@
+#include "git_vid_codec.h"
+#include <math.h>
+#include <unistd.h>
+
+// Synthetic video for the encoder's test input, the benchmarks and the demo.
+// Every class is a pure function of (params, frame number, row): a frame is the
+// same whichever thread renders which rows, so any thread count gives
+// byte-identical output, and the same seed always gives the same video. The
+// integer classes fill a row with straight-line byte loops the compiler
+// vectorizes; only the demo's float scenes are computed pixel by pixel.
+//
+// synth_render draws a whole frame on the calling thread and is re-entrant.
+// A synth_generator_t keeps a pool of threads that split each frame into row
+// bands, for the demo tool and the benchmarks.
+
+#define SYNTH_BANDS_PER_THREAD 4   // Bands are claimed dynamically; Mandelbrot rows vary in cost
+#define SYNTH_ZOOM_PERIOD 300      // Zoom restarts from 1x after this many frames (4x at the end)
+#define SYNTH_DEMO_SCENE_LENGTH 100
+
+// Text/UI layout, in pixels
+#define SYNTH_TITLE_HEIGHT 32
+#define SYNTH_MARGIN 16
+#define SYNTH_CELL_WIDTH 10
+#define SYNTH_CELL_HEIGHT 20
+#define SYNTH_GLYPH_TOP 4          // Glyphs are 8x12 inside their cell
+#define SYNTH_GLYPH_HEIGHT 12
+#define SYNTH_MENU_ITEM_HEIGHT 28
+#define SYNTH_CHARS_PER_FRAME 4
+#define SYNTH_CURSOR_BLINK 30      // Frames per cursor phase
+#define SYNTH_MENU_SELECT 45       // Frames before the sidebar selection moves
+
+typedef void (*synth_rows_fn)(const synth_params_t* params, uint32_t frame_number,
+                              uint8_t* pixels, uint32_t first_row, uint32_t end_row);
+
+typedef struct {
+    uint8_t r, g, b;
+} synth_color_t;
+
+static const char* synth_class_names[SYNTH_CLASS_COUNT] = {
+    "test", "static", "pan", "zoom", "noise", "text", "scene_cuts", "demo"
+};
+
+// Classes a SYNTH_SCENE_CUTS video cycles through
+static const synth_class_t scene_cut_classes[] = {
+    SYNTH_STATIC, SYNTH_PAN, SYNTH_ZOOM, SYNTH_NOISE, SYNTH_TEXT
+};
+
+// splitmix64 finalizer
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static synth_color_t seed_tint(uint64_t seed) {
+    uint64_t h = mix64(seed);
+    synth_color_t tint = { (uint8_t)h, (uint8_t)(h >> 8), (uint8_t)(h >> 16) };
+    return tint;
+}
+
+static inline void fill_color(uint8_t* row, uint32_t first, uint32_t end, synth_color_t color) {
+    for (uint32_t x = first; x < end; x++) {
+        row[x * 3] = color.r;
+        row[x * 3 + 1] = color.g;
+        row[x * 3 + 2] = color.b;
+    }
+}
+
+// The encoder's original pattern: three gradients sliding at different speeds
+static void render_test(const synth_params_t* params, uint32_t frame_number,
+                        uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    uint32_t width = params->width;
+    for (uint32_t y = first_row; y < end_row; y++) {
+        uint8_t* row = pixels + (size_t)y * width * 3;
+        uint8_t g = (uint8_t)(y + frame_number / 2);
+        for (uint32_t x = 0; x < width; x++) {
+            row[x * 3] = (uint8_t)(x + frame_number);
+            row[x * 3 + 1] = g;
+            row[x * 3 + 2] = (uint8_t)(x + y + frame_number);
+        }
+    }
+}
+
+// The still that static, pan and zoom show: two gradients under a grid of
+// 32-pixel tiles, so it has both smooth areas and hard edges. (u, v) are
+// texture coordinates; the texture repeats every 1024 columns.
+static inline void put_texel(uint8_t* pixel, uint32_t u, uint32_t v, synth_color_t tint) {
+    pixel[0] = (uint8_t)((u >> 2) + tint.r);
+    pixel[1] = (uint8_t)((v >> 1) + tint.g);
+    pixel[2] = (uint8_t)(((((u >> 5) ^ (v >> 5)) & 7) << 5) + tint.b);
+}
+
+static void render_texture_rows(const synth_params_t* params, uint32_t offset,
+                                uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    uint32_t width = params->width;
+    synth_color_t tint = seed_tint(params->seed);
+    for (uint32_t y = first_row; y < end_row; y++) {
+        uint8_t* row = pixels + (size_t)y * width * 3;
+        for (uint32_t x = 0; x < width; x++) {
+            put_texel(row + x * 3, x + offset, y, tint);
+        }
+    }
+}
+
+static void render_static(const synth_params_t* params, uint32_t frame_number,
+                          uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    (void)frame_number;
+    render_texture_rows(params, 0, pixels, first_row, end_row);
+}
+
+static void render_pan(const synth_params_t* params, uint32_t frame_number,
+                       uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    render_texture_rows(params, frame_number * SYNTH_PAN_SPEED, pixels, first_row, end_row);
+}
+
+// The still magnified about the frame centre, 1% more each frame. Coordinates
+// are 16.16 fixed point so every pixel maps the same way on every platform.
+static void render_zoom(const synth_params_t* params, uint32_t frame_number,
+                        uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    uint32_t width = params->width;
+    synth_color_t tint = seed_tint(params->seed);
+    int64_t step = (int64_t)65536 * 100 / (100 + frame_number % SYNTH_ZOOM_PERIOD);
+    int64_t cx = width / 2;
+    int64_t cy = params->height / 2;
+    
+    for (uint32_t y = first_row; y < end_row; y++) {
+        uint8_t* row = pixels + (size_t)y * width * 3;
+        uint32_t v = (uint32_t)(((cy << 16) + ((int64_t)y - cy) * step) >> 16);
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t u = (uint32_t)(((cx << 16) + ((int64_t)x - cx) * step) >> 16);
+            put_texel(row + x * 3, u, v, tint);
+        }
+    }
+}
+
+// Fresh bytes every frame from an xorshift64* stream seeded per row
+static void render_noise(const synth_params_t* params, uint32_t frame_number,
+                         uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    size_t stride = (size_t)params->width * 3;
+    for (uint32_t y = first_row; y < end_row; y++) {
+        uint8_t* row = pixels + (size_t)y * stride;
+        uint64_t state = mix64(params->seed ^ mix64(((uint64_t)frame_number << 32) | y)) | 1;
+        size_t i = 0;
+        for (; i + 8 <= stride; i += 8) {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            uint64_t bits = state * 0x2545f4914f6cdd1dULL;
+            memcpy(row + i, &bits, 8);
+        }
+        for (; i < stride; i++) {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            row[i] = (uint8_t)((state * 0x2545f4914f6cdd1dULL) >> 56);
+        }
+    }
+}
+
+// A pseudo-glyph: 16 bits on a 4x4 grid of 2x3-pixel blocks; 0 for a space
+static uint16_t glyph_bits(uint64_t seed, uint32_t line, uint32_t column, uint32_t columns) {
+    uint64_t line_hash = mix64(seed ^ ((uint64_t)line << 20));
+    uint32_t length = columns / 2 + (uint32_t)(line_hash % (columns / 2 + 1));
+    if (column >= length) return 0;
+    uint64_t h = mix64(line_hash + column);
+    if ((h & 7) == 0) return 0;
+    return (uint16_t)(h >> 16);
+}
+
+// A desktop: title bar, sidebar menu whose selection moves now and then, and a
+// page of text typed a few glyphs per frame, scrolling once it fills, with a
+// blinking block cursor. Flat colours and repeated shapes, like screen recordings.
+static void render_text(const synth_params_t* params, uint32_t frame_number,
+                        uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    uint32_t width = params->width;
+    uint32_t height = params->height;
+    synth_color_t tint = seed_tint(params->seed);
+    synth_color_t title = { (uint8_t)(tint.r / 2), (uint8_t)(tint.g / 2), (uint8_t)(tint.b / 2) };
+    synth_color_t sidebar = { (uint8_t)(40 + tint.r / 8), (uint8_t)(40 + tint.g / 8), (uint8_t)(48 + tint.b / 8) };
+    synth_color_t menu_item = { (uint8_t)(sidebar.r + 40), (uint8_t)(sidebar.g + 40), (uint8_t)(sidebar.b + 40) };
+    synth_color_t selected = { (uint8_t)(128 + tint.r / 2), (uint8_t)(128 + tint.g / 2), (uint8_t)(128 + tint.b / 2) };
+    synth_color_t page = { 250, 250, 246 };
+    synth_color_t ink = { 28, 30, 40 };
+    
+    uint32_t sidebar_width = width / 5;
+    uint32_t text_left = sidebar_width + SYNTH_MARGIN;
+    uint32_t text_top = SYNTH_TITLE_HEIGHT + SYNTH_MARGIN;
+    uint32_t columns = width > text_left + SYNTH_MARGIN ? (width - text_left - SYNTH_MARGIN) / SYNTH_CELL_WIDTH : 0;
+    uint32_t lines = height > text_top + SYNTH_MARGIN ? (height - text_top - SYNTH_MARGIN) / SYNTH_CELL_HEIGHT : 0;
+    uint32_t menu_items = height > SYNTH_TITLE_HEIGHT ? (height - SYNTH_TITLE_HEIGHT) / SYNTH_MENU_ITEM_HEIGHT : 0;
+    uint32_t selected_item = menu_items ? (frame_number / SYNTH_MENU_SELECT) % menu_items : 0;
+    
+    uint64_t typed = (uint64_t)frame_number * SYNTH_CHARS_PER_FRAME;
+    uint32_t typed_line = columns ? (uint32_t)(typed / columns) : 0;
+    uint32_t typed_column = columns ? (uint32_t)(typed % columns) : 0;
+    uint32_t first_line = lines && typed_line >= lines ? typed_line - lines + 1 : 0;
+    int cursor_on = (frame_number / SYNTH_CURSOR_BLINK) % 2 == 0;
+    
+    for (uint32_t y = first_row; y < end_row; y++) {
+        uint8_t* row = pixels + (size_t)y * width * 3;
+        if (y < SYNTH_TITLE_HEIGHT) {
+            fill_color(row, 0, width, title);
+            continue;
+        }
+    
+        // Sidebar: one bar per menu item, of a length fixed by the seed
+        uint32_t item = (y - SYNTH_TITLE_HEIGHT) / SYNTH_MENU_ITEM_HEIGHT;
+        uint32_t item_y = (y - SYNTH_TITLE_HEIGHT) % SYNTH_MENU_ITEM_HEIGHT;
+        int is_selected = item < menu_items && item == selected_item;
+        synth_color_t item_back = is_selected ? selected : sidebar;
+        fill_color(row, 0, sidebar_width, item_back);
+        if (item < menu_items && item_y >= 10 && item_y < 18 && sidebar_width > 2 * SYNTH_MARGIN) {
+            uint32_t bar = (uint32_t)(mix64(params->seed + item) % (sidebar_width - 2 * SYNTH_MARGIN)) + 1;
+            fill_color(row, SYNTH_MARGIN, SYNTH_MARGIN + bar, is_selected ? ink : menu_item);
+        }
+        fill_color(row, sidebar_width, width, page);
+    
+        if (y < text_top || !columns) continue;
+        uint32_t screen_line = (y - text_top) / SYNTH_CELL_HEIGHT;
+        if (screen_line >= lines) continue;
+        uint32_t line = first_line + screen_line;
+        uint32_t cell_y = (y - text_top) % SYNTH_CELL_HEIGHT;
+        if (cell_y < SYNTH_GLYPH_TOP || cell_y >= SYNTH_GLYPH_TOP + SYNTH_GLYPH_HEIGHT) continue;
+        uint32_t block_row = (cell_y - SYNTH_GLYPH_TOP) / 3;
+    
+        uint32_t visible = line < typed_line ? columns : (line == typed_line ? typed_column : 0);
+        for (uint32_t column = 0; column < visible; column++) {
+            uint32_t bits = (glyph_bits(params->seed, line, column, columns) >> (block_row * 4)) & 0xF;
+            uint8_t* cell = row + (size_t)(text_left + column * SYNTH_CELL_WIDTH + 1) * 3;
+            for (uint32_t gx = 0; gx < 8; gx++) {
+                if (bits & (1u << (gx / 2))) {
+                    cell[gx * 3] = ink.r;
+                    cell[gx * 3 + 1] = ink.g;
+                    cell[gx * 3 + 2] = ink.b;
+                }
+            }
+        }
+        if (cursor_on && line == typed_line) {
+            uint32_t cursor_x = text_left + typed_column * SYNTH_CELL_WIDTH + 1;
+            fill_color(row, cursor_x, cursor_x + 8, ink);
+        }
+    }
+}
+
+// The 600-frame demo's six 100-frame scenes, repeating after frame 599
+static void demo_pixel(uint32_t width, uint32_t height, int frame, int x, int y, uint8_t* pixel) {
+    uint8_t r = 0, g = 0, b = 0;
+    
+    // Scene 1: Animated rainbow gradient (frames 0-99)
+    if (frame < 100) {
+        float t = (float)frame / 99.0f;
+        float hue = fmod((float)x / width + t, 1.0f) * 6.0f;
+        int hi = (int)hue;
+        float f = hue - hi;
+    
+        switch (hi % 6) {
+            case 0: r = 255; g = (uint8_t)(255 * f); b = 0; break;
+            case 1: r = (uint8_t)(255 * (1-f)); g = 255; b = 0; break;
+            case 2: r = 0; g = 255; b = (uint8_t)(255 * f); break;
+            case 3: r = 0; g = (uint8_t)(255 * (1-f)); b = 255; break;
+            case 4: r = (uint8_t)(255 * f); g = 0; b = 255; break;
+            case 5: r = 255; g = 0; b = (uint8_t)(255 * (1-f)); break;
+        }
+    }
+    // Scene 2: Rotating spiral pattern (frames 100-199)
+    else if (frame < 200) {
+        float cx = width / 2.0f;
+        float cy = height / 2.0f;
+        float dx = x - cx;
+        float dy = y - cy;
+        float angle = atan2(dy, dx) + (frame - 100) * 0.1f;
+        float dist = sqrt(dx*dx + dy*dy);
+    
+        float spiral = sin(angle * 8 + dist * 0.1f) * 0.5f + 0.5f;
+        r = (uint8_t)(spiral * 255);
+        g = (uint8_t)((1-spiral) * 255);
+        b = (uint8_t)(sin(dist * 0.05f + frame * 0.1f) * 127 + 128);
+    }
+    // Scene 3: Bouncing circles (frames 200-299)
+    else if (frame < 300) {
+        r = g = b = 20; // Dark background
+    
+        for (int i = 0; i < 5; i++) {
+            float t = (frame - 200) * 0.1f + i * 1.2f;
+            float cx = width * 0.5f + sin(t) * width * 0.3f;
+            float cy = height * 0.5f + cos(t * 1.3f + i) * height * 0.3f;
+            float dist = sqrt((x-cx)*(x-cx) + (y-cy)*(y-cy));
+    
+            if (dist < 40) {
+                r = (uint8_t)(255 * (i % 3 == 0));
+                g = (uint8_t)(255 * (i % 3 == 1));
+                b = (uint8_t)(255 * (i % 3 == 2));
+            }
+        }
+    }
+    // Scene 4: Plasma effect (frames 300-399)
+    else if (frame < 400) {
+        float t = (frame - 300) * 0.1f;
+        float plasma = sin(x * 0.02f + t) + sin(y * 0.03f + t) +
+                      sin((x + y) * 0.02f + t) + sin(sqrt(x*x + y*y) * 0.02f + t);
+        plasma = (plasma + 4) / 8; // Normalize to 0-1
+    
+        r = (uint8_t)(sin(plasma * M_PI) * 255);
+        g = (uint8_t)(sin(plasma * M_PI + 2) * 255);
+        b = (uint8_t)(sin(plasma * M_PI + 4) * 255);
+    }
+    // Scene 5: Matrix-style falling code (frames 400-499)
+    else if (frame < 500) {
+        int stream_x = x / 20;
+        int stream_y = (y + (frame - 400) * 5) % (height + 100);
+    
+        if (stream_x % 3 == 0 && stream_y < (int)height &&
+            (stream_y % 20) < 15 && (x % 20) < 15) {
+            float intensity = 1.0f - (float)stream_y / height;
+            g = (uint8_t)(intensity * 255);
+        }
+    }
+    // Scene 6: Mandelbrot zoom (frames 500-599)
+    else {
+        float zoom = pow(1.05f, frame - 500);
+        float cx = -0.7269f;
+        float cy = 0.1889f;
+    
+        float zx = (x - width/2.0f) / (width/4.0f) / zoom + cx;
+        float zy = (y - height/2.0f) / (height/4.0f) / zoom + cy;
+    
+        int iter = 0;
+        float x0 = zx, y0 = zy;
+        while (iter < 100 && x0*x0 + y0*y0 < 4) {
+            float xtemp = x0*x0 - y0*y0 + zx;
+            y0 = 2*x0*y0 + zy;
+            x0 = xtemp;
+            iter++;
+        }
+    
+        if (iter < 100) {
+            float t = (float)iter / 100.0f;
+            r = (uint8_t)(sin(t * 16) * 127 + 128);
+            g = (uint8_t)(sin(t * 13 + 2) * 127 + 128);
+            b = (uint8_t)(sin(t * 11 + 4) * 127 + 128);
+        }
+    }
+    
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+}
+
+static void render_demo(const synth_params_t* params, uint32_t frame_number,
+                        uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    uint32_t width = params->width;
+    int frame = (int)(frame_number % (6 * SYNTH_DEMO_SCENE_LENGTH));
+    for (uint32_t y = first_row; y < end_row; y++) {
+        uint8_t* row = pixels + (size_t)y * width * 3;
+        for (uint32_t x = 0; x < width; x++) {
+            demo_pixel(width, params->height, frame, (int)x, (int)y, row + x * 3);
+        }
+    }
+}
+
+static void render_rows(const synth_params_t* params, uint32_t frame_number,
+                        uint8_t* pixels, uint32_t first_row, uint32_t end_row);
+
+// Static, pan, zoom, noise and text in turn; each scene gets its own seed, so
+// consecutive stills differ everywhere, and starts again from frame 0
+static void render_scene_cuts(const synth_params_t* params, uint32_t frame_number,
+                              uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    uint32_t scene = frame_number / SYNTH_SCENE_LENGTH;
+    synth_params_t scene_params = *params;
+    scene_params.content = scene_cut_classes[scene % (sizeof(scene_cut_classes) / sizeof(scene_cut_classes[0]))];
+    scene_params.seed = mix64(params->seed + scene);
+    render_rows(&scene_params, frame_number % SYNTH_SCENE_LENGTH, pixels, first_row, end_row);
+}
+
+static const synth_rows_fn synth_renderers[SYNTH_CLASS_COUNT] = {
+    render_test, render_static, render_pan, render_zoom,
+    render_noise, render_text, render_scene_cuts, render_demo
+};
+
+static void render_rows(const synth_params_t* params, uint32_t frame_number,
+                        uint8_t* pixels, uint32_t first_row, uint32_t end_row) {
+    synth_renderers[params->content](params, frame_number, pixels, first_row, end_row);
+}
+
+void synth_params_init(synth_params_t* params) {
+    params->content = SYNTH_TEST;
+    params->width = FRAME_WIDTH;
+    params->height = FRAME_HEIGHT;
+    params->seed = 1;
+}
+
+const char* synth_class_name(synth_class_t content) {
+    return content < SYNTH_CLASS_COUNT ? synth_class_names[content] : "unknown";
+}
+
+int parse_synth_class(const char* name, synth_class_t* content_out) {
+    for (int i = 0; i < SYNTH_CLASS_COUNT; i++) {
+        if (strcmp(name, synth_class_names[i]) == 0) {
+            *content_out = (synth_class_t)i;
+            return GVC_SUCCESS;
+        }
+    }
+    return GVC_ERROR_FORMAT;
+}
+
+static int validate_params(const synth_params_t* params) {
+    if (!params || params->content >= SYNTH_CLASS_COUNT) return GVC_ERROR_FORMAT;
+    return validate_frame_dimensions(params->width, params->height, FRAME_CHANNELS);
+}
+
+// An RGB frame of the generator's size; free with free_raw_frame
+int synth_alloc_frame(const synth_params_t* params, raw_frame_t* frame_out) {
+    int result = validate_params(params);
+    if (result != GVC_SUCCESS) return result;
+    
+    frame_out->width = params->width;
+    frame_out->height = params->height;
+    frame_out->channels = FRAME_CHANNELS;
+    frame_out->pixel_format = PIXEL_FORMAT_RGB;
+    frame_out->pixels = malloc(raw_frame_size(frame_out));
+    return frame_out->pixels ? GVC_SUCCESS : GVC_ERROR_MEMORY;
+}
+
+static int check_frame(const synth_params_t* params, const raw_frame_t* frame) {
+    int result = validate_params(params);
+    if (result != GVC_SUCCESS) return result;
+    if (!frame || !frame->pixels) return GVC_ERROR_MEMORY;
+    if (frame->width != params->width || frame->height != params->height ||
+        frame->channels != FRAME_CHANNELS || frame->pixel_format != PIXEL_FORMAT_RGB) {
+        return GVC_ERROR_FORMAT;
+    }
+    return GVC_SUCCESS;
+}
+
+// Draw one frame on the calling thread into a frame from synth_alloc_frame
+int synth_render(const synth_params_t* params, uint32_t frame_number, raw_frame_t* frame) {
+    int result = check_frame(params, frame);
+    if (result != GVC_SUCCESS) return result;
+    render_rows(params, frame_number, frame->pixels, 0, params->height);
+    return GVC_SUCCESS;
+}
+
+// Claim and draw bands of the current frame until none are left. Called, and
+// returns, with the mutex held.
+static void render_bands(synth_generator_t* generator) {
+    while (generator->next_band < generator->num_bands) {
+        uint32_t band = generator->next_band++;
+        uint32_t height = generator->params.height;
+        uint32_t first_row = (uint32_t)((uint64_t)height * band / generator->num_bands);
+        uint32_t end_row = (uint32_t)((uint64_t)height * (band + 1) / generator->num_bands);
+        pthread_mutex_unlock(&generator->mutex);
+    
+        render_rows(&generator->params, generator->frame_number, generator->frame->pixels,
+                    first_row, end_row);
+    
+        pthread_mutex_lock(&generator->mutex);
+        if (--generator->bands_left == 0) {
+            pthread_cond_signal(&generator->work_done);
+        }
+    }
+}
+
+static void* synth_worker(void* arg) {
+    synth_generator_t* generator = arg;
+    uint64_t seen = 0;
+    trace_thread_name("synth");
+    
+    pthread_mutex_lock(&generator->mutex);
+    for (;;) {
+        while (!generator->stopping && generator->generation == seen) {
+            pthread_cond_wait(&generator->work_ready, &generator->mutex);
+        }
+        if (generator->stopping) break;
+        seen = generator->generation;
+        render_bands(generator);
+    }
+    pthread_mutex_unlock(&generator->mutex);
+    return NULL;
+}
+
+// Start num_threads - 1 workers (0: one thread per CPU); the caller is the last
+int synth_generator_open(synth_generator_t* generator, const synth_params_t* params, int num_threads) {
+    int result = validate_params(params);
+    if (result != GVC_SUCCESS) return result;
+    
+    memset(generator, 0, sizeof(*generator));
+    generator->params = *params;
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    num_threads = MAX(1, MIN(num_threads, (int)params->height));
+    generator->num_bands = num_threads == 1 ? 1 : (uint32_t)MIN(num_threads * SYNTH_BANDS_PER_THREAD,
+                                                                 (int)params->height);
+    
+    pthread_mutex_init(&generator->mutex, NULL);
+    pthread_cond_init(&generator->work_ready, NULL);
+    pthread_cond_init(&generator->work_done, NULL);
+    
+    if (num_threads > 1) {
+        generator->threads = malloc(sizeof(pthread_t) * (num_threads - 1));
+        if (!generator->threads) {
+            synth_generator_close(generator);
+            return GVC_ERROR_MEMORY;
+        }
+    }
+    for (int i = 0; i < num_threads - 1; i++) {
+        if (pthread_create(&generator->threads[i], NULL, synth_worker, generator) != 0) {
+            synth_generator_close(generator);
+            return GVC_ERROR_THREAD;
+        }
+        generator->num_workers++;
+    }
+    return GVC_SUCCESS;
+}
+
+// Draw one frame with every thread of the pool; returns when it is complete
+int synth_generator_render(synth_generator_t* generator, uint32_t frame_number, raw_frame_t* frame) {
+    int result = check_frame(&generator->params, frame);
+    if (result != GVC_SUCCESS) return result;
+    
+    pthread_mutex_lock(&generator->mutex);
+    generator->frame = frame;
+    generator->frame_number = frame_number;
+    generator->next_band = 0;
+    generator->bands_left = generator->num_bands;
+    generator->generation++;
+    pthread_cond_broadcast(&generator->work_ready);
+    
+    render_bands(generator);
+    while (generator->bands_left > 0) {
+        pthread_cond_wait(&generator->work_done, &generator->mutex);
+    }
+    generator->frame = NULL;
+    pthread_mutex_unlock(&generator->mutex);
+    return GVC_SUCCESS;
+}
+
+void synth_generator_close(synth_generator_t* generator) {
+    pthread_mutex_lock(&generator->mutex);
+    generator->stopping = 1;
+    pthread_cond_broadcast(&generator->work_ready);
+    pthread_mutex_unlock(&generator->mutex);
+    
+    for (int i = 0; i < generator->num_workers; i++) {
+        pthread_join(generator->threads[i], NULL);
+    }
+    free(generator->threads);
+    generator->threads = NULL;
+    generator->num_workers = 0;
+    
+    pthread_mutex_destroy(&generator->mutex);
+    pthread_cond_destroy(&generator->work_ready);
+    pthread_cond_destroy(&generator->work_done);
+}
+
+// Write a frame's pixels as raw rgb24, e.g. to a pipe into ffmpeg or git-vid-encode's frame files
+int synth_write_frame(const raw_frame_t* frame, FILE* out) {
+    size_t size = raw_frame_size(frame);
+    return fwrite(frame->pixels, 1, size, out) == size ? GVC_SUCCESS : GVC_ERROR_IO;
+}
@@ -0,0 +1,386 @@
+#include "git_vid_codec.h"
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+// Playback telemetry: a latency histogram per pipeline stage, plus queue depth,
+// dropped and presented frame counts and cache hits. Histograms are log-linear
+// in the manner of HdrHistogram: values below 2^HISTOGRAM_SUB_BITS nanoseconds
+// get a bucket each, and every power of two above that is split into
+// 2^(HISTOGRAM_SUB_BITS - 1) equal buckets, so any recorded value is within
+// about 3% of its bucket's bounds from a microsecond to minutes. Counters are
+// relaxed atomics, so recording never blocks and a reader only sees slightly
+// stale totals.
+//
+// Stage timings reach here from threads bound with telemetry_bind_thread and
+// from libgitflix readers given telemetry_reader_sink. They are gathered per
+// thread and recorded once per frame by telemetry_frame_done, so a stage that
+// runs twice for one frame (the residual and the prediction of a bidirectional
+// frame) counts as one sample. While a timeline trace is running, every stage is
+// also recorded there as a span.
+
+#define HISTOGRAM_SUB_BITS 6
+#define HISTOGRAM_SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_HALF_COUNT (HISTOGRAM_SUB_COUNT / 2)
+#define HISTOGRAM_MAX_BITS 40  // ~18 minutes in nanoseconds; longer values land in the last bucket
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_COUNT + (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS) * HISTOGRAM_HALF_COUNT)
+
+typedef struct {
+    atomic_uint_fast64_t counts[HISTOGRAM_BUCKETS];
+    atomic_uint_fast64_t samples;
+    atomic_uint_fast64_t sum;
+    atomic_uint_fast64_t max;
+    atomic_uint_fast64_t over_budget;  // Samples longer than FRAME_TIME_NS
+} histogram_t;
+
+static struct {
+    atomic_int enabled;
+    uint64_t start_ns;
+    histogram_t stages[TELEMETRY_STAGE_COUNT];
+    histogram_t queue_depth;
+    atomic_uint_fast64_t frames_presented;
+    atomic_uint_fast64_t frames_dropped;
+    atomic_uint_fast64_t first_frame_ns;  // Since start_ns; 0 until a frame is presented
+    atomic_int queue_depth_now;
+    atomic_int queue_capacity;
+    atomic_uint_fast64_t cache_hits[TELEMETRY_CACHE_COUNT];
+    atomic_uint_fast64_t cache_misses[TELEMETRY_CACHE_COUNT];
+} telemetry;
+
+// Time spent in each stage by this thread since its last telemetry_frame_done
+static __thread uint64_t pending_ns[TELEMETRY_STAGE_COUNT];
+static __thread unsigned pending_stages;  // Bit per stage with pending time
+
+static const char* const stage_names[TELEMETRY_STAGE_COUNT] = {
+    "fetch", "deserialize", "decompress", "delta_apply", "convert", "present"
+};
+
+static const char* const cache_names[TELEMETRY_CACHE_COUNT] = {
+    "reference", "blob"
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int histogram_bucket(uint64_t value) {
+    if (value < HISTOGRAM_SUB_COUNT) {
+        return (int)value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - HISTOGRAM_SUB_BITS + 1;
+    if (shift > HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    int top = (int)(value >> shift);  // In [HALF_COUNT, SUB_COUNT)
+    return HISTOGRAM_SUB_COUNT + (shift - 1) * HISTOGRAM_HALF_COUNT + (top - HISTOGRAM_HALF_COUNT);
+}
+
+// Largest value that lands in a bucket
+static uint64_t histogram_bucket_limit(int bucket) {
+    if (bucket < HISTOGRAM_SUB_COUNT) {
+        return (uint64_t)bucket;
+    }
+    int shift = (bucket - HISTOGRAM_SUB_COUNT) / HISTOGRAM_HALF_COUNT + 1;
+    uint64_t top = HISTOGRAM_HALF_COUNT + (bucket - HISTOGRAM_SUB_COUNT) % HISTOGRAM_HALF_COUNT;
+    return ((top + 1) << shift) - 1;
+}
+
+static void histogram_record(histogram_t* histogram, uint64_t value) {
+    atomic_fetch_add_explicit(&histogram->counts[histogram_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->samples, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum, value, memory_order_relaxed);
+    if (value > FRAME_TIME_NS) {
+        atomic_fetch_add_explicit(&histogram->over_budget, 1, memory_order_relaxed);
+    }
+    
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (value > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max, &max, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+// Summarize a histogram; percentiles report their bucket's upper bound, capped at the maximum
+static void histogram_summarize(histogram_t* histogram, telemetry_summary_t* summary_out) {
+    memset(summary_out, 0, sizeof(*summary_out));
+    summary_out->samples = atomic_load_explicit(&histogram->samples, memory_order_relaxed);
+    summary_out->max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    summary_out->over_budget = atomic_load_explicit(&histogram->over_budget, memory_order_relaxed);
+    if (summary_out->samples == 0) return;
+    
+    summary_out->mean = (double)atomic_load_explicit(&histogram->sum, memory_order_relaxed) /
+                        summary_out->samples;
+    
+    static const double quantiles[3] = {0.50, 0.95, 0.99};
+    uint64_t* results[3] = {&summary_out->p50, &summary_out->p95, &summary_out->p99};
+    uint64_t seen = 0;
+    int next = 0;
+    for (int bucket = 0; bucket < HISTOGRAM_BUCKETS && next < 3; bucket++) {
+        seen += atomic_load_explicit(&histogram->counts[bucket], memory_order_relaxed);
+        // Counts may move on while we scan; the last quantile always resolves
+        while (next < 3 && (seen >= quantiles[next] * summary_out->samples || bucket == HISTOGRAM_BUCKETS - 1)) {
+            *results[next++] = MIN(histogram_bucket_limit(bucket), summary_out->max);
+        }
+    }
+}
+
+void telemetry_init(void) {
+    memset(&telemetry, 0, sizeof(telemetry));
+    telemetry.start_ns = now_ns();
+    atomic_store(&telemetry.enabled, 1);
+}
+
+int telemetry_enabled(void) {
+    return atomic_load_explicit(&telemetry.enabled, memory_order_relaxed);
+}
+
+void telemetry_record_stage(telemetry_stage_t stage, uint64_t start_ns, uint64_t end_ns) {
+    trace_span(stage_names[stage], start_ns, end_ns);
+    if (telemetry_enabled()) {
+        pending_ns[stage] += end_ns - start_ns;
+        pending_stages |= 1u << stage;
+    }
+}
+
+static void sink_stage(void* ctx, telemetry_stage_t stage, uint64_t start_ns, uint64_t end_ns) {
+    (void)ctx;
+    telemetry_record_stage(stage, start_ns, end_ns);
+}
+
+static void sink_cache(void* ctx, telemetry_cache_t cache, int hit) {
+    (void)ctx;
+    telemetry_count_cache(cache, hit);
+}
+
+static const stage_sink_t telemetry_sink = { NULL, sink_stage, sink_cache };
+
+// A no-op unless telemetry or a trace is running, so unobserved threads pay nothing
+void telemetry_bind_thread(void) {
+    if (telemetry_enabled() || trace_enabled()) {
+        stage_sink_bind(&telemetry_sink);
+    }
+}
+
+void telemetry_frame_done(void) {
+    if (!pending_stages) return;
+    for (int stage = 0; stage < TELEMETRY_STAGE_COUNT; stage++) {
+        if (pending_stages & (1u << stage)) {
+            histogram_record(&telemetry.stages[stage], pending_ns[stage]);
+            pending_ns[stage] = 0;
+        }
+    }
+    pending_stages = 0;
+}
+
+void telemetry_record_queue_depth(int depth) {
+    if (!telemetry_enabled()) return;
+    atomic_store_explicit(&telemetry.queue_depth_now, depth, memory_order_relaxed);
+    histogram_record(&telemetry.queue_depth, (uint64_t)MAX(depth, 0));
+}
+
+void telemetry_set_queue_capacity(int capacity) {
+    atomic_store_explicit(&telemetry.queue_capacity, capacity, memory_order_relaxed);
+}
+
+void telemetry_count_presented(void) {
+    if (atomic_fetch_add_explicit(&telemetry.frames_presented, 1, memory_order_relaxed) == 0) {
+        uint64_t since_start = now_ns() - telemetry.start_ns;
+        atomic_store_explicit(&telemetry.first_frame_ns, MAX(since_start, 1), memory_order_relaxed);
+    }
+}
+
+void telemetry_count_dropped(int frames) {
+    atomic_fetch_add_explicit(&telemetry.frames_dropped, (uint64_t)frames, memory_order_relaxed);
+}
+
+void telemetry_count_cache(telemetry_cache_t cache, int hit) {
+    if (!telemetry_enabled()) return;
+    atomic_fetch_add_explicit(hit ? &telemetry.cache_hits[cache] : &telemetry.cache_misses[cache], 1,
+                              memory_order_relaxed);
+}
+
+// libgitflix reader callbacks; reader stages 0-3 are the first telemetry stages
+static void reader_thread_start(void* ctx, const char* name) {
+    (void)ctx;
+    trace_thread_name(name);
+}
+
+static void reader_frame_start(void* ctx, uint32_t index) {
+    (void)ctx;
+    trace_set_frame(index);
+}
+
+static void reader_stage(void* ctx, int stage, uint64_t start_ns, uint64_t end_ns) {
+    (void)ctx;
+    if (stage == GVC_STAGE_WAIT) {
+        trace_span("wait prefetch", start_ns, end_ns);
+    } else if (stage >= 0 && stage <= GVC_STAGE_DELTA_APPLY) {
+        telemetry_record_stage((telemetry_stage_t)stage, start_ns, end_ns);
+    }
+}
+
+static void reader_frame_done(void* ctx) {
+    (void)ctx;
+    telemetry_frame_done();
+}
+
+static void reader_reference(void* ctx, int hit) {
+    (void)ctx;
+    telemetry_count_cache(TELEMETRY_CACHE_REFERENCE, hit);
+}
+
+static void reader_dropped(void* ctx, uint32_t frames) {
+    (void)ctx;
+    telemetry_count_dropped((int)frames);
+}
+
+void telemetry_reader_sink(gvc_reader_telemetry_t* sink_out) {
+    memset(sink_out, 0, sizeof(*sink_out));
+    if (!telemetry_enabled() && !trace_enabled()) return;
+    sink_out->thread_start = reader_thread_start;
+    sink_out->frame_start = reader_frame_start;
+    sink_out->stage = reader_stage;
+    sink_out->frame_done = reader_frame_done;
+    sink_out->reference = reader_reference;
+    sink_out->dropped = reader_dropped;
+}
+
+const char* telemetry_stage_name(telemetry_stage_t stage) {
+    return stage < TELEMETRY_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
+
+const char* telemetry_cache_name(telemetry_cache_t cache) {
+    return cache < TELEMETRY_CACHE_COUNT ? cache_names[cache] : "unknown";
+}
+
+void telemetry_stage_summary(telemetry_stage_t stage, telemetry_summary_t* summary_out) {
+    histogram_summarize(&telemetry.stages[stage], summary_out);
+}
+
+void telemetry_queue_summary(telemetry_summary_t* summary_out) {
+    histogram_summarize(&telemetry.queue_depth, summary_out);
+}
+
+// ru_maxrss is kilobytes on Linux and bytes on macOS
+size_t telemetry_peak_rss(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+// Resident set size right now; falls back to the peak where it cannot be read
+size_t telemetry_current_rss(void) {
+#ifdef __linux__
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        unsigned long size_pages, resident_pages;
+        int parsed = fscanf(statm, "%lu %lu", &size_pages, &resident_pages) == 2;
+        fclose(statm);
+        if (parsed) return (size_t)resident_pages * (size_t)sysconf(_SC_PAGESIZE);
+    }
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS) {
+        return (size_t)info.resident_size;
+    }
+#endif
+    return telemetry_peak_rss();
+}
+
+void telemetry_counters(telemetry_counters_t* counters_out) {
+    counters_out->frames_presented = atomic_load_explicit(&telemetry.frames_presented, memory_order_relaxed);
+    counters_out->frames_dropped = atomic_load_explicit(&telemetry.frames_dropped, memory_order_relaxed);
+    counters_out->elapsed_seconds = (now_ns() - telemetry.start_ns) / 1e9;
+    counters_out->first_frame_seconds = atomic_load_explicit(&telemetry.first_frame_ns, memory_order_relaxed) / 1e9;
+    counters_out->rss_bytes = telemetry_current_rss();
+    // getrusage can lag the live figure by a few pages
+    counters_out->peak_rss_bytes = MAX(telemetry_peak_rss(), counters_out->rss_bytes);
+    counters_out->queue_depth = atomic_load_explicit(&telemetry.queue_depth_now, memory_order_relaxed);
+    counters_out->queue_capacity = atomic_load_explicit(&telemetry.queue_capacity, memory_order_relaxed);
+    for (int cache = 0; cache < TELEMETRY_CACHE_COUNT; cache++) {
+        counters_out->cache_hits[cache] = atomic_load_explicit(&telemetry.cache_hits[cache], memory_order_relaxed);
+        counters_out->cache_misses[cache] = atomic_load_explicit(&telemetry.cache_misses[cache], memory_order_relaxed);
+    }
+}
+
+void telemetry_print_summary(FILE* out) {
+    telemetry_counters_t counters;
+    telemetry_counters(&counters);
+    
+    fprintf(out, "\nStage latency (ms)    samples      p50      p95      p99      max  over %.2fms\n",
+            FRAME_TIME_NS / 1e6);
+    for (int stage = 0; stage < TELEMETRY_STAGE_COUNT; stage++) {
+        telemetry_summary_t summary;
+        telemetry_stage_summary(stage, &summary);
+        if (summary.samples == 0) continue;
+        fprintf(out, "  %-18s %10llu %8.2f %8.2f %8.2f %8.2f  %llu\n", stage_names[stage],
+                (unsigned long long)summary.samples, summary.p50 / 1e6, summary.p95 / 1e6,
+                summary.p99 / 1e6, summary.max / 1e6, (unsigned long long)summary.over_budget);
+    }
+    
+    telemetry_summary_t queue;
+    telemetry_queue_summary(&queue);
+    if (queue.samples > 0) {
+        fprintf(out, "Queue depth: p50 %llu, p95 %llu, p99 %llu, max %llu\n",
+                (unsigned long long)queue.p50, (unsigned long long)queue.p95,
+                (unsigned long long)queue.p99, (unsigned long long)queue.max);
+    }
+    fprintf(out, "Frames presented: %llu, dropped: %llu, first after %.1f ms, peak RSS: %.1f MB\n",
+            (unsigned long long)counters.frames_presented, (unsigned long long)counters.frames_dropped,
+            counters.first_frame_seconds * 1e3, counters.peak_rss_bytes / (1024.0 * 1024.0));
+}
+
+static void write_summary_json(FILE* out, const telemetry_summary_t* summary, double scale) {
+    fprintf(out, "{\"samples\":%llu,\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f",
+            (unsigned long long)summary->samples, summary->mean / scale, summary->p50 / scale,
+            summary->p95 / scale, summary->p99 / scale, summary->max / scale);
+}
+
+// One JSON object; stage latencies are in milliseconds
+void telemetry_write_json(FILE* out) {
+    telemetry_counters_t counters;
+    telemetry_counters(&counters);
+    
+    fprintf(out, "{\"elapsed_seconds\":%.3f,\"first_frame_ms\":%.3f,\"frames_presented\":%llu,"
+            "\"frames_dropped\":%llu,\"peak_rss_bytes\":%zu,\"frame_budget_ms\":%.3f,\"stages\":{",
+            counters.elapsed_seconds, counters.first_frame_seconds * 1e3,
+            (unsigned long long)counters.frames_presented, (unsigned long long)counters.frames_dropped,
+            counters.peak_rss_bytes, FRAME_TIME_NS / 1e6);
+    for (int stage = 0; stage < TELEMETRY_STAGE_COUNT; stage++) {
+        telemetry_summary_t summary;
+        telemetry_stage_summary(stage, &summary);
+        fprintf(out, "%s\"%s\":", stage > 0 ? "," : "", stage_names[stage]);
+        write_summary_json(out, &summary, 1e6);
+        fprintf(out, ",\"over_budget\":%llu}", (unsigned long long)summary.over_budget);
+    }
+    
+    telemetry_summary_t queue;
+    telemetry_queue_summary(&queue);
+    fprintf(out, "},\"queue_depth\":");
+    write_summary_json(out, &queue, 1.0);
+    fprintf(out, "}}\n");
+}
+
+// Write the JSON dump to path (replacing it), or to stderr when path is NULL
+int telemetry_dump_json(const char* path) {
+    if (!path) {
+        telemetry_write_json(stderr);
+        return GVC_SUCCESS;
+    }
+    
+    FILE* out = fopen(path, "w");
+    if (!out) return GVC_ERROR_IO;
+    telemetry_write_json(out);
+    return fclose(out) == 0 ? GVC_SUCCESS : GVC_ERROR_IO;
+}
@@ -0,0 +1,186 @@
+#include "git_vid_codec.h"
+#include <stdatomic.h>
+#include <unistd.h>
+
+// Opt-in timeline tracing. Every thread appends complete spans (name, start,
+// duration, frame) to its own chunked buffer, so recording takes no lock and no
+// I/O; a mutex is only taken when a thread records its first span. trace_stop
+// writes every thread's spans as Chrome trace-event JSON, which chrome://tracing
+// and ui.perfetto.dev both open. A process is traced once, from trace_start to
+// trace_stop; buffers live until exit, as threads may still be appending.
+//
+// Span names are stored by pointer and must outlive the trace (string literals).
+
+#define TRACE_CHUNK_EVENTS 16384
+
+typedef struct {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    int64_t frame;  // -1 when the span is not about one frame
+} trace_event_t;
+
+typedef struct trace_chunk {
+    trace_event_t events[TRACE_CHUNK_EVENTS];
+    atomic_int count;
+    struct trace_chunk* _Atomic next;
+} trace_chunk_t;
+
+typedef struct trace_thread {
+    int tid;
+    char name[32];
+    trace_chunk_t* first;
+    trace_chunk_t* current;
+    struct trace_thread* next;
+} trace_thread_t;
+
+static struct {
+    atomic_int enabled;
+    FILE* out;                // Opened by trace_start, so a bad path fails early
+    uint64_t start_ns;
+    trace_thread_t* threads;
+    int next_tid;
+    pthread_mutex_t mutex;    // Guards threads and next_tid
+} trace = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static __thread trace_thread_t* thread_buffer;
+static __thread int64_t thread_frame = -1;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// This thread's buffer, registered on first use; NULL if out of memory
+static trace_thread_t* current_thread(void) {
+    if (thread_buffer) {
+        return thread_buffer;
+    }
+    
+    trace_thread_t* thread = calloc(1, sizeof(*thread));
+    trace_chunk_t* chunk = calloc(1, sizeof(*chunk));
+    if (!thread || !chunk) {
+        free(thread);
+        free(chunk);
+        return NULL;
+    }
+    thread->first = chunk;
+    thread->current = chunk;
+    
+    pthread_mutex_lock(&trace.mutex);
+    thread->tid = ++trace.next_tid;
+    thread->next = trace.threads;
+    trace.threads = thread;
+    pthread_mutex_unlock(&trace.mutex);
+    
+    thread_buffer = thread;
+    return thread;
+}
+
+int trace_start(const char* path) {
+    if (!path || trace.start_ns) return GVC_ERROR_IO;  // Already traced
+    
+    pthread_mutex_lock(&trace.mutex);
+    trace.out = fopen(path, "w");
+    if (!trace.out) {
+        pthread_mutex_unlock(&trace.mutex);
+        return GVC_ERROR_IO;
+    }
+    trace.start_ns = now_ns();
+    pthread_mutex_unlock(&trace.mutex);
+    atomic_store(&trace.enabled, 1);
+    return GVC_SUCCESS;
+}
+
+int trace_enabled(void) {
+    return atomic_load_explicit(&trace.enabled, memory_order_relaxed);
+}
+
+void trace_thread_name(const char* name) {
+    if (!trace_enabled()) return;
+    trace_thread_t* thread = current_thread();
+    if (thread) {
+        snprintf(thread->name, sizeof(thread->name), "%s", name);
+    }
+}
+
+void trace_set_frame(int64_t frame_number) {
+    thread_frame = frame_number;
+}
+
+uint64_t trace_begin(void) {
+    return trace_enabled() ? now_ns() : 0;
+}
+
+void trace_span(const char* name, uint64_t start, uint64_t end) {
+    if (start == 0 || !trace_enabled()) return;
+    trace_thread_t* thread = current_thread();
+    if (!thread) return;
+    
+    trace_chunk_t* chunk = thread->current;
+    int count = atomic_load_explicit(&chunk->count, memory_order_relaxed);
+    if (count == TRACE_CHUNK_EVENTS) {
+        trace_chunk_t* next = calloc(1, sizeof(*next));
+        if (!next) return;  // Drop spans rather than fail the traced program
+        atomic_store_explicit(&chunk->next, next, memory_order_release);
+        thread->current = chunk = next;
+        count = 0;
+    }
+    
+    trace_event_t* event = &chunk->events[count];
+    event->name = name;
+    event->start_ns = start;
+    event->duration_ns = end > start ? end - start : 0;
+    event->frame = thread_frame;
+    atomic_store_explicit(&chunk->count, count + 1, memory_order_release);
+}
+
+void trace_end(const char* name, uint64_t start) {
+    if (start == 0) return;
+    trace_span(name, start, now_ns());
+}
+
+static void write_thread_events(FILE* out, int pid, const trace_thread_t* thread, int* first) {
+    if (thread->name[0]) {
+        fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                *first ? "" : ",", pid, thread->tid, thread->name);
+        *first = 0;
+    }
+    
+    for (trace_chunk_t* chunk = thread->first; chunk;
+         chunk = atomic_load_explicit(&chunk->next, memory_order_acquire)) {
+        int count = atomic_load_explicit(&chunk->count, memory_order_acquire);
+        for (int i = 0; i < count; i++) {
+            const trace_event_t* event = &chunk->events[i];
+            fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"gitflix\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f",
+                    *first ? "" : ",", event->name, pid, thread->tid,
+                    (event->start_ns - trace.start_ns) / 1000.0, event->duration_ns / 1000.0);
+            if (event->frame >= 0) {
+                fprintf(out, ",\"args\":{\"frame\":%lld}", (long long)event->frame);
+            }
+            fputc('}', out);
+            *first = 0;
+        }
+    }
+}
+
+// Write all spans recorded so far and stop tracing
+int trace_stop(void) {
+    if (!atomic_exchange(&trace.enabled, 0)) return GVC_SUCCESS;
+    
+    pthread_mutex_lock(&trace.mutex);
+    int pid = (int)getpid();
+    int first = 1;
+    fprintf(trace.out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (trace_thread_t* thread = trace.threads; thread; thread = thread->next) {
+        write_thread_events(trace.out, pid, thread, &first);
+    }
+    fprintf(trace.out, "\n]}\n");
+    int result = fclose(trace.out) == 0 ? GVC_SUCCESS : GVC_ERROR_IO;
+    trace.out = NULL;
+    pthread_mutex_unlock(&trace.mutex);
+    
+    return result;
+}
@@ -0,0 +1,140 @@
+#include "git_vid_codec.h"
+#include <unistd.h>
+#include <sys/time.h>
+
+// git-vid-verify: decode every frame of a repository and compare its pixels with
+// the hash the encoder stored from the source frame. GOPs are decoded in parallel
+// by repo_walk.
+
+typedef struct {
+    pthread_mutex_t mutex;  // Guards the counters and stdout
+    int matched;
+    int unhashed;
+    int mismatched;
+    int failed;
+    int skipped;
+} verify_stats_t;
+
+static void report_frame(const repo_frame_t* frame, const char* problem) {
+    uint32_t frame_number = frame->compressed ? frame->compressed->header.frame_number : (uint32_t)frame->index;
+    printf("Frame %06u (%.12s): %s\n", frame_number, frame->commit, problem);
+    fflush(stdout);
+}
+
+// Check one decoded frame against its stored hash
+static void verify_frame(void* ctx, const repo_frame_t* frame) {
+    verify_stats_t* stats = (verify_stats_t*)ctx;
+    
+    pixel_hash_t expected, actual;
+    int hashed = frame->state == REPO_FRAME_DECODED &&
+                 read_frame_pixel_hash(frame->blob, frame->blob_size, &expected) == GVC_SUCCESS;
+    if (hashed) {
+        hash_frame_pixels(frame->decoded, &actual);
+    }
+    
+    pthread_mutex_lock(&stats->mutex);
+    switch (frame->state) {
+        case REPO_FRAME_DECODED:
+            if (!hashed) {
+                stats->unhashed++;
+            } else if (pixel_hash_equal(&expected, &actual)) {
+                stats->matched++;
+            } else {
+                char expected_hex[PIXEL_HASH_HEX_SIZE], actual_hex[PIXEL_HASH_HEX_SIZE];
+                char problem[128];
+                format_pixel_hash(&expected, expected_hex);
+                format_pixel_hash(&actual, actual_hex);
+                snprintf(problem, sizeof(problem), "pixel hash mismatch (stored %s, decoded %s)",
+                         expected_hex, actual_hex);
+                report_frame(frame, problem);
+                stats->mismatched++;
+            }
+            break;
+        case REPO_FRAME_SKIPPED:
+            stats->skipped++;
+            break;
+        case REPO_FRAME_UNREADABLE:
+            report_frame(frame, frame->blob ? "corrupt frame blob" : "frame blob unreadable");
+            stats->failed++;
+            break;
+        default:
+            report_frame(frame, repo_frame_state_name(frame->state));
+            stats->failed++;
+            break;
+    }
+    pthread_mutex_unlock(&stats->mutex);
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [-j threads] <repo_path>\n", program);
+    printf("\nDecodes every frame and compares it with the pixel hash stored by the encoder.\n");
+    printf("\nOptions:\n");
+    printf("  -j threads   Decoder threads (default: one per CPU)\n");
+    printf("\nExit status is 0 only if every frame decoded and every stored hash matched.\n");
+}
+
+int main(int argc, char* argv[]) {
+    int num_threads = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:")) != -1) {
+        switch (opt) {
+            case 'j':
+                num_threads = atoi(optarg);
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    const char* repo_path = argv[optind];
+    if (chdir(repo_path) != 0) {
+        fprintf(stderr, "Error: Failed to change to repository directory: %s\n", repo_path);
+        return 1;
+    }
+    
+    char** commits;
+    int num_commits;
+    if (git_list_commits(&commits, NULL, &num_commits) != GVC_SUCCESS || num_commits == 0) {
+        fprintf(stderr, "Error: No commits found in repository\n");
+        return 1;
+    }
+    
+    num_threads = repo_walk_threads(num_threads, num_commits);
+    
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);
+    
+    verify_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    pthread_mutex_init(&stats.mutex, NULL);
+    if (repo_walk(commits, num_commits, num_threads, verify_frame, &stats) != GVC_SUCCESS) {
+        fprintf(stderr, "Error: Failed to start git cat-file\n");
+        return 1;
+    }
+    pthread_mutex_destroy(&stats.mutex);
+    
+    gettimeofday(&end_time, NULL);
+    double elapsed = (end_time.tv_sec - start_time.tv_sec) +
+                     (end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+    
+    printf("\nVerified %d frames in %.2fs (%.0f fps, %d threads)\n", num_commits, elapsed,
+           elapsed > 0 ? num_commits / elapsed : 0.0, num_threads);
+    printf("  Matched:    %d\n", stats.matched);
+    printf("  Mismatched: %d\n", stats.mismatched);
+    printf("  Failed:     %d\n", stats.failed);
+    if (stats.skipped > 0) {
+        printf("  Skipped:    %d (after a failure, up to the next keyframe)\n", stats.skipped);
+    }
+    if (stats.unhashed > 0) {
+        printf("  No hash:    %d (decoded only; encoded before pixel hashes)\n", stats.unhashed);
+    }
+    
+    git_free_commit_list(commits, num_commits);
+    
+    return (stats.mismatched == 0 && stats.failed == 0 && stats.skipped == 0) ? 0 : 1;
+}